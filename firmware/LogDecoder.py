@@ -0,0 +1,217 @@
+#!/usr/bin/env python3
+# Turns the terminal output of a BUILDCONFIG_BINARY_LOGGING build back into text.
+# Log records are looked up in the firmware's ELF, see src/LogRecord.hpp for the frame layout.
+# Text in between (UI, bring-up output) is passed through.
+#
+#   ./LogDecoder.py build/debug/remote_control_device.elf /dev/ttyACM0
+#   ./LogDecoder.py build/debug/remote_control_device.elf capture.bin
+#   ./LogDecoder.py build/debug/remote_control_device.elf - < capture.bin
+import re
+import struct
+import sys
+from elftools.elf.constants import SH_FLAGS
+from elftools.elf.elffile import ELFFile
+
+FRAME_MAGIC = 0xB1
+MAX_ARGS_SIZE = 32
+# COBS encoded payload without the delimiters, see LogFrameMaxSize
+MAX_FRAME_SIZE = 1 + 4 + 4 + 1 + 1 + 1 + MAX_ARGS_SIZE + 1 + 1
+FLAG_TRUNCATED = 1 << 0
+DROPPED_ID = 0
+BAUDRATE = 115200
+
+# Logging::Level and Logging::Origin, keep in order
+LEVELS = ["[DEBUG]", "[INFO]", "[WARNING]", "[ERROR]"]
+ORIGINS = ["[CanIO]", "[CF Timers]", "[LED]", "[Radio control]", "[State Machine]",
+           "[Bus Devices]", "[Commands]", "[CanFestival]", "[General]"]
+
+# same conversions LogRecord::encodeArgs copies
+CONVERSION = re.compile(r"%([-+ #0]*)(\*|\d+)?(?:\.(\*|\d+))?([hlzjt]*)([diuxXocfFeEgGps%])")
+
+
+def crc8(data):
+    crc = 0
+    for byte in data:
+        crc ^= byte
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x07) & 0xFF if crc & 0x80 else (crc << 1) & 0xFF
+    return crc
+
+
+def cobsDecode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            return None
+        out += data[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+class FormatStrings:
+    def __init__(self, elfPath):
+        self._sections = []
+        self._cache = {}
+        with open(elfPath, "rb") as f:
+            elf = ELFFile(f)
+            for section in elf.iter_sections():
+                if section["sh_flags"] & SH_FLAGS.SHF_ALLOC and section["sh_type"] == "SHT_PROGBITS":
+                    self._sections.append((section["sh_addr"], section.data()))
+
+    def get(self, address):
+        if address not in self._cache:
+            self._cache[address] = None
+            for start, data in self._sections:
+                if start <= address < start + len(data):
+                    end = data.find(b"\0", address - start)
+                    self._cache[address] = data[address - start:end].decode(errors="replace")
+                    break
+        return self._cache[address]
+
+
+def formatMessage(fmt, args, truncated):
+    values = []
+    pos = 0
+
+    def take(size, code):
+        nonlocal pos
+        if pos + size > len(args):
+            raise ValueError
+        value = struct.unpack_from("<" + code, args, pos)[0]
+        pos += size
+        return value
+
+    pyFormat = ""
+    last = 0
+    try:
+        for m in CONVERSION.finditer(fmt):
+            flags, width, precision, length, conversion = m.groups()
+            pyFormat += fmt[last:m.start()].replace("%", "%%")
+            last = m.end()
+            if conversion == "%":
+                pyFormat += "%%"
+                continue
+            if width == "*":
+                width = str(take(4, "i"))
+            if precision == "*":
+                precision = str(take(4, "i"))
+            spec = "%" + flags + (width or "") + ("." + precision if precision else "")
+            longLong = length.count("l") >= 2
+            if conversion in "di":
+                values.append(take(8, "q") if longLong else take(4, "i"))
+                pyFormat += spec + "d"
+            elif conversion in "uxXoc":
+                values.append(take(8, "Q") if longLong else take(4, "I"))
+                pyFormat += spec + ("d" if conversion == "u" else conversion)
+            elif conversion in "fFeEgG":
+                values.append(take(8, "d"))
+                pyFormat += spec + conversion
+            elif conversion == "p":
+                values.append(take(4, "I"))
+                pyFormat += "0x%08x"
+            elif conversion == "s":
+                size = take(1, "B")
+                if pos + size > len(args):
+                    raise ValueError
+                values.append(args[pos:pos + size].decode(errors="replace"))
+                pos += size
+                pyFormat += spec + "s"
+        pyFormat += fmt[last:].replace("%", "%%")
+        return pyFormat % tuple(values)
+    except ValueError:
+        if not truncated:
+            raise
+        # arguments that didn't fit into the record
+        return fmt + " (arguments truncated)"
+
+
+def decodeFrame(body, formats):
+    payload = cobsDecode(body)
+    if payload is None or len(payload) < 13 or payload[0] != FRAME_MAGIC:
+        return None
+    if crc8(payload[:-1]) != payload[-1]:
+        return None
+    timestamp, logId, origin, level, flags = struct.unpack_from("<IIBBB", payload, 1)
+    args = payload[12:-1]
+
+    if logId == DROPPED_ID:
+        return "%10.3f [DROPPED] %d log records\n" % (timestamp / 1000, struct.unpack("<I", args)[0])
+
+    fmt = formats.get(logId)
+    if fmt is None:
+        message = "unknown format string at 0x%08x, wrong ELF?" % logId
+    else:
+        try:
+            message = formatMessage(fmt, args, flags & FLAG_TRUNCATED)
+        except (ValueError, TypeError, struct.error):
+            message = fmt + " (arguments don't match)"
+    levelName = LEVELS[level] if level < len(LEVELS) else "[UNKNOWN]"
+    originName = ORIGINS[origin] if origin < len(ORIGINS) else "[UNKNOWN]"
+    return "%10.3f %s%s %s\n" % (timestamp / 1000, levelName, originName, message)
+
+
+class Decoder:
+    def __init__(self, formats, out):
+        self._formats = formats
+        self._out = out
+        # bytes after an opening zero, a frame unless it gets too long or doesn't decode
+        self._frame = None
+
+    def feed(self, data):
+        for byte in data:
+            if byte == 0:
+                # closes a frame that decodes, otherwise opens one
+                if self._frame and self._frameDone():
+                    self._frame = None
+                else:
+                    self._frame = bytearray()
+            elif self._frame is None:
+                self._text(bytes([byte]))
+            else:
+                self._frame.append(byte)
+                if len(self._frame) > MAX_FRAME_SIZE:
+                    self._text(self._frame)
+                    self._frame = None
+        self._out.flush()
+
+    def _frameDone(self):
+        line = decodeFrame(bytes(self._frame), self._formats)
+        if line is None:
+            self._text(self._frame)
+            return False
+        self._out.write(line)
+        return True
+
+    def _text(self, data):
+        self._out.write(bytes(data).decode(errors="replace"))
+
+
+if __name__ == "__main__":
+    if len(sys.argv) != 3:
+        print("usage: " + sys.argv[0] + " firmware.elf serial-port|file|-")
+        sys.exit(1)
+
+    decoder = Decoder(FormatStrings(sys.argv[1]), sys.stdout)
+    source = sys.argv[2]
+    if source == "-":
+        stream = sys.stdin.buffer
+    elif source.startswith("/dev/"):
+        import serial
+        stream = serial.Serial(source, BAUDRATE, timeout=0.1)
+    else:
+        stream = open(source, "rb")
+
+    try:
+        while True:
+            data = stream.read(256)
+            if not data:
+                if source.startswith("/dev/"):
+                    continue
+                break
+            decoder.feed(data)
+    except KeyboardInterrupt:
+        pass
@@ -6,6 +6,10 @@ public:
     // https://en.wikipedia.org/wiki/ANSI_escape_code
     static constexpr const char *ClearTerminal = "\x1b[2J";
     static constexpr const char *MoveCursorToHome = "\x1b[H";
+    // printf format, takes the 1 based row
+    static constexpr const char *MoveCursorToRowFormat = "\x1b[%u;1H";
+    static constexpr const char *ClearToEndOfLine = "\x1b[K";
+    static constexpr const char *ClearToEndOfScreen = "\x1b[J";
     static constexpr const char *ColorSection_WhiteText_BlackBackground = "\x1b[37;40m";
     static constexpr const char *ColorSection_WhiteText_RedBackground = "\x1b[37;41m";
     static constexpr const char *ColorSection_BlackText_GreenBackground = "\x1b[90;42m";
@@ -24,16 +24,18 @@ namespace remote_control_device
 Application::Application()
     : _hal(),                                                                               //
       _terminalIO(_hal, huart1),                                                            //
-      _receiverModule(huart2, htim6, _hal, _terminalIO.getLogging()),                       //
-      _canIO(hcan, _terminalIO.getLogging()),                                               //
+      _receiverModule(huart2, htim6, _hal, _terminalIO.getLogging(),                        //
+                      ReceiverModule::RxMode::CircularDMA),                                 //
+      _canIO(hcan, _hal, _terminalIO.getLogging()),                                         //
       _cft(_hal, _terminalIO.getLogging()),                                                 //
       _canOpen(_canIO, _terminalIO.getLogging()),                                           //
       _remoteControl(_hal, _terminalIO.getLogging(), _receiverModule), _hardwareSwitches(), //
       _ledHw(ledHardware_GPIO_Port, ledHardware_Pin, true), // NOLINT
       _ledRc(ledRemote_GPIO_Port, ledRemote_Pin, true),     // NOLINT
       _ledUpdater(_ledHw, _ledRc, _canIO),                  //
-      _stateMachine(_canOpen, _remoteControl, _hardwareSwitches, _ledUpdater, _terminalIO, _hal,
-                    hiwdg, _cft) //
+      _stateMachine(_canOpen, _remoteControl, _hardwareSwitches, _ledUpdater, _terminalIO,
+                    hiwdg), //
+      _uiRenderer(_stateMachine, _remoteControl, _canOpen, _canIO, _cft, _terminalIO, _hal) //
 {
     _canIO.setCanopenInstance(_canOpen);
 }
@@ -11,6 +11,7 @@
 #include "Statemachine/LEDUpdater.hpp"
 #include "Statemachine/RemoteControl.hpp"
 #include "Statemachine/Statemachine.hpp"
+#include "Statemachine/UIRenderer.hpp"
 #include "Wrapper/HAL.hpp"
 
 #ifdef BUILDCONFIG_EMBEDDED_BUILD
@@ -37,6 +38,7 @@ private:
     LED _ledRc;
     LEDUpdater _ledUpdater;
     Statemachine _stateMachine;
+    UIRenderer _uiRenderer;
 
     FirmwareHasher _fwHash;
 };
@@ -0,0 +1,82 @@
+#pragma once
+#include "CanFestivalLocker.hpp"
+#include "CanopenActor.hpp"
+#include "SpecialAssert.hpp"
+#include "Wrapper/SeqLock.hpp"
+
+/**
+ * @brief Value kept up to date by canfestival code and read by any task, e.g. statistics
+ *
+ * Without BUILDCONFIG_CANOPEN_ACTOR the value is guarded by the CFLocker mutex. With it the actor
+ * owns the value and publishes a copy after every process() run, other tasks read that copy
+ * through a SeqLock and never wait for the actor.
+ */
+namespace remote_control_device
+{
+
+template <typename T>
+class ActorPublished
+{
+public:
+    /**
+     * @brief The value itself, with the OD locked / on the actor only
+     *
+     */
+    T &live()
+    {
+        return _value;
+    }
+
+    /**
+     * @brief Any task, in actor mode other tasks get the last published copy
+     *
+     */
+    T read() const
+    {
+#ifdef BUILDCONFIG_CANOPEN_ACTOR
+        if (!CanopenActor::isOwnerContext())
+        {
+            T value;
+            // a torn copy only lasts until the next read
+            (void)_published.read(value);
+            return value;
+        }
+#else
+        CFLocker locker;
+#endif
+        return _value;
+    }
+
+    /**
+     * @brief In actor mode on the actor only
+     *
+     */
+    void reset()
+    {
+#ifdef BUILDCONFIG_CANOPEN_ACTOR
+        specialAssert(CanopenActor::isOwnerContext());
+#else
+        CFLocker locker;
+#endif
+        _value = T();
+    }
+
+#ifdef BUILDCONFIG_CANOPEN_ACTOR
+    /**
+     * @brief Publishes the value for read on other tasks, actor only
+     *
+     */
+    void publish()
+    {
+        _published.write(_value);
+    }
+#endif
+
+private:
+    T _value{};
+#ifdef BUILDCONFIG_CANOPEN_ACTOR
+    wrapper::SeqLock<T> _published;
+#endif
+};
+
+} // namespace remote_control_device
@@ -0,0 +1,126 @@
+#include "CFLockerProfiler.hpp"
+#include "ANSIEscapeCodes.hpp"
+#include "CanFestivalLocker.hpp"
+#include "PeripheralDrivers/TerminalWriter.hpp"
+#include "Wrapper/HAL.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace remote_control_device
+{
+
+std::array<CFLockerCallSite, CFLockerProfiler::MaxCallSites> CFLockerProfiler::_callSites{};
+uint32_t CFLockerProfiler::_untracked = 0;
+
+uint8_t CFLockerProfiler::acquired(const char *file, uint16_t line, uint32_t waitCycles)
+{
+    // string literals of one translation unit share their address, no need to compare them
+    uint8_t index = 0;
+    for (; index < MaxCallSites; ++index)
+    {
+        CFLockerCallSite &site = _callSites[index];
+        if (site.file == nullptr)
+        {
+            site.file = file;
+            site.line = line;
+            break;
+        }
+        if (site.file == file && site.line == line)
+        {
+            break;
+        }
+    }
+    if (index == MaxCallSites)
+    {
+        _untracked++;
+        return NoCallSite;
+    }
+
+    CFLockerCallSite &site = _callSites[index];
+    const uint32_t wait_us = waitCycles / wrapper::HAL::CyclesPerMicrosecond;
+    site.acquisitions++;
+    site.totalWait_us += wait_us;
+    site.maxWait_us = std::max(site.maxWait_us, wait_us);
+
+    const auto &limits = CFLockerCallSite::WaitBucketLimits_us;
+    const auto bucket = std::upper_bound(limits.begin(), limits.end(), wait_us) - limits.begin();
+    site.waitHistogram[bucket]++;
+    return index;
+}
+
+void CFLockerProfiler::released(uint8_t callSite, uint32_t holdCycles)
+{
+    if (callSite >= MaxCallSites)
+    {
+        return;
+    }
+    CFLockerCallSite &site = _callSites[callSite];
+    const uint32_t hold_us = holdCycles / wrapper::HAL::CyclesPerMicrosecond;
+    site.totalHold_us += hold_us;
+    site.maxHold_us = std::max(site.maxHold_us, hold_us);
+}
+
+bool CFLockerProfiler::getCallSite(uint8_t index, CFLockerCallSite &target)
+{
+    if (index >= MaxCallSites || _callSites[index].file == nullptr)
+    {
+        return false;
+    }
+    target = _callSites[index];
+    return true;
+}
+
+uint32_t CFLockerProfiler::getUntrackedAcquisitions()
+{
+    return _untracked;
+}
+
+void CFLockerProfiler::reset()
+{
+    _callSites.fill(CFLockerCallSite());
+    _untracked = 0;
+}
+
+void CFLockerProfiler::drawUIPart(TerminalWriter &term)
+{
+    term.write(ANSIEscapeCodes::ColorSection_WhiteText_GrayBackground);
+    term.write("\r\nCFLocker:\r\n");
+    term.write(ANSIEscapeCodes::ColorSection_End);
+
+    static constexpr size_t buffSize = 100;
+    char buff[buffSize] = {0};
+    term.write("Site: count, wait avg / max, hold avg / max (us), waits <1 <4 <16 <64 <256 <1k "
+               "<4k >=4k\r\n");
+    // slot by slot, the whole table is a lot for the UI task's stack
+    for (uint8_t i = 0; i < MaxCallSites; ++i)
+    {
+        CFLockerCallSite site;
+        {
+            CFLocker locker;
+            if (!getCallSite(i, site))
+            {
+                break;
+            }
+        }
+        const char *name = std::strrchr(site.file, '/');
+        name = name != nullptr ? name + 1 : site.file;
+        const uint32_t count = std::max<uint32_t>(site.acquisitions, 1);
+        snprintf(buff, buffSize, "\t%s:%u: %lu, %lu / %lu, %lu / %lu,", name, site.line,
+                 site.acquisitions, static_cast<uint32_t>(site.totalWait_us / count),
+                 site.maxWait_us, static_cast<uint32_t>(site.totalHold_us / count),
+                 site.maxHold_us);
+        term.write(buff);
+        for (uint32_t bucket : site.waitHistogram)
+        {
+            snprintf(buff, buffSize, " %lu", bucket);
+            term.write(buff);
+        }
+        term.write("\r\n");
+    }
+
+    snprintf(buff, buffSize, "Untracked acquisitions: %lu\r\n", getUntrackedAcquisitions());
+    term.write(buff);
+}
+
+} // namespace remote_control_device
@@ -0,0 +1,95 @@
+#pragma once
+#include <array>
+#include <cstdint>
+
+/**
+ * @brief Wait and hold times of CFLocker per call site
+ *
+ * Only fed with BUILDCONFIG_CFLOCKER_PROFILING, CFLocker's constructor then gets the call site
+ * from the compiler. Times are measured with the cycle counter (clock_gettime on host) and
+ * stored in microseconds. Nested lockers of the same task count as acquisitions without waiting,
+ * their hold time is part of the outer one's as well.
+ *
+ * Everything is recorded while holding the mutex, readers have to take a CFLocker too.
+ */
+namespace remote_control_device
+{
+class TerminalWriter;
+
+struct CFLockerCallSite
+{
+    /**
+     * @brief Upper limits of the wait histogram buckets, the last one takes everything above
+     *
+     */
+    static constexpr std::array<uint32_t, 7> WaitBucketLimits_us = {1, 4, 16, 64, 256, 1024, 4096};
+    static constexpr uint8_t WaitBuckets = WaitBucketLimits_us.size() + 1;
+
+    // nullptr while the slot is unused
+    const char *file{nullptr};
+    uint16_t line{0};
+    uint32_t acquisitions{0};
+    uint64_t totalWait_us{0};
+    uint32_t maxWait_us{0};
+    std::array<uint32_t, WaitBuckets> waitHistogram{};
+    uint64_t totalHold_us{0};
+    uint32_t maxHold_us{0};
+};
+
+class CFLockerProfiler
+{
+public:
+    /**
+     * @brief Call sites beyond this are only counted in getUntrackedAcquisitions
+     *
+     */
+    static constexpr uint8_t MaxCallSites = 24;
+    static constexpr uint8_t NoCallSite = MaxCallSites;
+
+    /**
+     * @brief Records an acquisition, mutex has to be held
+     *
+     * @param file
+     * @param line
+     * @param waitCycles cycle counter difference from before taking the mutex
+     * @return uint8_t call site index to pass to released, NoCallSite if the table is full
+     */
+    static uint8_t acquired(const char *file, uint16_t line, uint32_t waitCycles);
+
+    /**
+     * @brief Records the hold time, mutex has to be held still
+     *
+     * @param callSite index returned by acquired
+     * @param holdCycles
+     */
+    static void released(uint8_t callSite, uint32_t holdCycles);
+
+    /**
+     * @brief Copies one call site, hold a CFLocker
+     *
+     * @param index 0 to MaxCallSites - 1
+     * @param target
+     * @return false slot unused
+     */
+    static bool getCallSite(uint8_t index, CFLockerCallSite &target);
+
+    static uint32_t getUntrackedAcquisitions();
+
+    /**
+     * @brief Clears all counters, hold a CFLocker
+     *
+     */
+    static void reset();
+
+    /**
+     * @brief Writes the profile as UI section, takes CFLocker itself
+     *
+     * @param term
+     */
+    static void drawUIPart(TerminalWriter &term);
+
+private:
+    static std::array<CFLockerCallSite, MaxCallSites> _callSites;
+    static uint32_t _untracked;
+};
+} // namespace remote_control_device
@@ -1,6 +1,9 @@
 #include "CanFestivalLocker.hpp"
-#include "SpecialAssert.hpp"
 #include "BuildConfiguration.hpp"
+#include "CFLockerProfiler.hpp"
+#include "CanopenActor.hpp"
+#include "SpecialAssert.hpp"
+#include "Wrapper/HAL.hpp"
 
 extern "C" {
     //I really hate do do this but I don't see any other """nice"" way to reset the OD 
@@ -17,16 +20,48 @@ extern "C" {
 
 namespace remote_control_device
 {
+#ifdef BUILDCONFIG_CANOPEN_ACTOR
+SemaphoreHandle_t CFLocker::_mtx = nullptr;
+#else
 SemaphoreHandle_t CFLocker::_mtx = xSemaphoreCreateRecursiveMutex();
+#endif
+uint32_t CFLocker::_acquisitions = 0;
 
+#ifdef BUILDCONFIG_CFLOCKER_PROFILING
+CFLocker::CFLocker(const char *file, uint16_t line)
+    : _callSite(CFLockerProfiler::NoCallSite), _acquiredAt(0)
+#else
 CFLocker::CFLocker()
+#endif
 {
+#ifdef BUILDCONFIG_CANOPEN_ACTOR
+    specialAssert(CanopenActor::isOwnerContext());
+#else
+#ifdef BUILDCONFIG_CFLOCKER_PROFILING
+    const uint32_t waitStart = wrapper::HAL::ReadCycleCounter();
+#endif
     xSemaphoreTakeRecursive(_mtx, portMAX_DELAY);
+    _acquisitions++;
+#ifdef BUILDCONFIG_CFLOCKER_PROFILING
+    _acquiredAt = wrapper::HAL::ReadCycleCounter();
+    _callSite = CFLockerProfiler::acquired(file, line, _acquiredAt - waitStart);
+#endif
+#endif
 }
 
 CFLocker::~CFLocker()
 {
+#ifndef BUILDCONFIG_CANOPEN_ACTOR
+#ifdef BUILDCONFIG_CFLOCKER_PROFILING
+    CFLockerProfiler::released(_callSite, wrapper::HAL::ReadCycleCounter() - _acquiredAt);
+#endif
     xSemaphoreGiveRecursive(_mtx);
+#endif
+}
+
+uint32_t CFLocker::getAcquisitionCount()
+{
+    return _acquisitions;
 }
 
 CO_Data *CFLocker::getOD()
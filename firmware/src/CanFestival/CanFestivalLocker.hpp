@@ -9,15 +9,33 @@ extern "C" {
 /**
  * @brief Provides an easy to use mutex for canFestival calls.
  *
+ * With BUILDCONFIG_CANOPEN_ACTOR there is no mutex, only the CanopenActor owner task may touch
+ * the object dictionary and the locker just asserts that.
+ *
+ * With BUILDCONFIG_CFLOCKER_PROFILING wait and hold times are recorded per call site, see
+ * CFLockerProfiler.hpp.
  */
 namespace remote_control_device
 {
 class CFLocker
 {
 public:
+#ifdef BUILDCONFIG_CFLOCKER_PROFILING
+    /**
+     * @brief Call site gets filled in by the compiler, leave the defaults alone
+     *
+     */
+    explicit CFLocker(const char *file = __builtin_FILE(), uint16_t line = __builtin_LINE());
+#else
     CFLocker();
+#endif
     ~CFLocker();
 
+    CFLocker(const CFLocker &) = delete;
+    CFLocker(CFLocker &&) = delete;
+    CFLocker &operator=(const CFLocker &) = delete;
+    CFLocker &operator=(CFLocker &&) = delete;
+
     /**
      * @brief Retrieves the RCD's object dictionary instance
      * 
@@ -32,7 +50,21 @@ public:
      * 
      */
     static void resetOD();
+
+    /**
+     * @brief Number of times the mutex was taken, nested ones included. Stays 0 in actor mode
+     *
+     */
+    static uint32_t getAcquisitionCount();
+
 private:
     static SemaphoreHandle_t _mtx;
+    // only changed while holding _mtx
+    static uint32_t _acquisitions;
+
+#ifdef BUILDCONFIG_CFLOCKER_PROFILING
+    uint8_t _callSite;
+    uint32_t _acquiredAt;
+#endif
 };
 } // namespace remote_control_device
\ No newline at end of file
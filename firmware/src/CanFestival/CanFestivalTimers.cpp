@@ -47,41 +47,45 @@ TIMER_HANDLE CanFestivalTimers::setAlarm(CO_Data *d, UNS32 id, TimerCallback_t c
         return TIMER_NONE;
     }
 
-    // search for free slots
     CFLocker locker;
-    for (TIMER_HANDLE i = 0; i < MAX_NB_TIMER; ++i)
+    if (_instance->_queue.getFreeSlots() == 0)
     {
-        if (_instance->_timers[i].state == TIMER_FREE)
-        {
-            auto &entry = _instance->_timers[i];
-            entry.callback = callback;
-            entry.d = d;
-            entry.id = id;
-            entry.val = value + MS_TO_TIMEVAL(static_cast<TIMEVAL>(_instance->_hal.GetTick()));
-            entry.interval = period;
-            entry.state = TIMER_ARMED;
-            return i;
-        }
+        _instance->_log.logError(Logging::Origin::CFTimers, "No timer slots available");
+        return TIMER_NONE;
     }
 
-    _instance->_log.logError(Logging::Origin::CFTimers, "No timer slots available");
+    const TIMEVAL now = MS_TO_TIMEVAL(static_cast<TIMEVAL>(_instance->_hal.GetTick()));
+    TIMEVAL deadline = value + now;
 
-    // no timer free
-    return TIMER_NONE;
+    // alarm re-arming itself from its callback (e.g. PDO event timers), keep the phase
+    const struct_s_timer_entry &firing = _instance->_firing;
+    if (firing.state == TIMER_TRIG && firing.callback == callback && firing.id == id &&
+        firing.d == d && value > 0)
+    {
+        deadline = _instance->nextPhaseLockedDeadline(firing.val, value, now);
+    }
+
+    const TIMER_HANDLE handle = _instance->_queue.allocate(deadline);
+    auto &entry = _instance->_timers[handle];
+    entry.callback = callback;
+    entry.d = d;
+    entry.id = id;
+    entry.val = deadline;
+    entry.interval = period;
+    entry.state = TIMER_ARMED;
+    if (deadline < _instance->_plannedWakeup)
+    {
+        _instance->wakeTask();
+    }
+    return handle;
 }
 
 uint8_t CanFestivalTimers::getTimersRemaining()
 {
+#ifndef BUILDCONFIG_CANOPEN_ACTOR
     CFLocker locker;
-    uint8_t cnt = 0;
-    for (const auto &e : _timers)
-    {
-        if (e.state == TIMER_FREE)
-        {
-            cnt++;
-        }
-    }
-    return cnt;
+#endif
+    return static_cast<uint8_t>(_queue.getFreeSlots());
 }
 
 TIMER_HANDLE CanFestivalTimers::delAlarm(TIMER_HANDLE handle)
@@ -97,86 +101,196 @@ TIMER_HANDLE CanFestivalTimers::delAlarm(TIMER_HANDLE handle)
     if (handle != TIMER_NONE)
     {
         CFLocker locker;
+        const bool wasNearest = _instance->_queue.isQueued(handle) &&
+                                _instance->_queue.getDeadline(handle) == _instance->_plannedWakeup;
+        _instance->_queue.release(handle);
         _instance->_timers[handle].state = TIMER_FREE;
+
+        // let the task sleep until the next remaining deadline instead of waking for nothing
+        if (wasNearest)
+        {
+            _instance->wakeTask();
+        }
     }
     return TIMER_NONE;
 }
 
+TIMEVAL CanFestivalTimers::getTime()
+{
+    specialAssert(_instance != nullptr);
+    return MS_TO_TIMEVAL(static_cast<TIMEVAL>(_instance->_hal.GetTick()));
+}
+
 TickType_t CanFestivalTimers::dispatch()
 {
     // dispatch registered timers
     TIMEVAL currTime{MS_TO_TIMEVAL(static_cast<TIMEVAL>(_hal.GetTick()))};
-    TIMEVAL nearestTime{std::numeric_limits<TIMEVAL>::max()};
-    static constexpr TickType_t NoTimersRegisteredWaittime = pdMS_TO_TICKS(50);
 
     CFLocker locker;
+    _plannedWakeup = 0;
 
-    // search nearest timer and calculate waittime
-    // mark timers with elapsed time
-    for (struct_s_timer_entry &entry : _timers)
+    // take all elapsed timers out of the queue first so callbacks arming new
+    // alarms can't make us loop forever
+    std::array<TIMER_HANDLE, MAX_TIMERS> triggered;
+    size_t triggeredCount = 0;
+    for (TIMER_HANDLE handle = _queue.popExpired(currTime); handle != TIMER_NONE;
+         handle = _queue.popExpired(currTime))
     {
-        if (entry.state == TIMER_ARMED)
-        {
-            if (entry.val <= currTime)
-            {
-                entry.state = TIMER_TRIG;
-                nearestTime = 0;
-            }
-            else
-            {
-                nearestTime = std::min(nearestTime, entry.val);
-            }
-        }
+        _timers[handle].state = TIMER_TRIG;
+        triggered[triggeredCount++] = handle;
     }
 
-    if (nearestTime > 0)
+    if (triggeredCount == 0)
     {
         // wait if nearest timer is some time away
-        if (nearestTime == std::numeric_limits<TIMEVAL>::max())
+        const TIMEVAL nearestTime = _queue.nextDeadline();
+        _plannedWakeup = nearestTime;
+        if (nearestTime == TimerQueue<MAX_TIMERS>::NoDeadline)
         {
-            // no timers registered, wait short time
-            return NoTimersRegisteredWaittime;
+            // no timers registered, setAlarm wakes us
+            return portMAX_DELAY;
         }
         else
         {
-            return static_cast<TickType_t>(TIMEVAL_TO_MS(nearestTime - currTime));
+            // round up, waking before the deadline would just sleep again for 0 ticks
+            const TIMEVAL waitTime = nearestTime - currTime + MS_TO_TIMEVAL(1) - 1;
+            return pdMS_TO_TICKS(static_cast<TickType_t>(TIMEVAL_TO_MS(waitTime)));
         }
     }
 
     // trigger marked timers
-    for (struct_s_timer_entry &entry : _timers)
+    for (size_t i = 0; i < triggeredCount; ++i)
     {
-        if (entry.state == TIMER_TRIG)
+        const TIMER_HANDLE handle = triggered[i];
+        struct_s_timer_entry &entry = _timers[handle];
+        // an earlier callback may have deleted (and reused) this slot
+        if (entry.state != TIMER_TRIG)
+        {
+            continue;
+        }
+
+        const auto lateness = static_cast<uint32_t>(currTime - entry.val);
+        LatenessStatistics &statistics = _lateness.live();
+        statistics.firedCount++;
+        statistics.lastLateness_us = lateness;
+        statistics.maxLateness_us = std::max(statistics.maxLateness_us, lateness);
+        if (lateness > MS_TO_TIMEVAL(portTICK_PERIOD_MS))
+        {
+            statistics.lateCount++;
+        }
+
+        if (entry.callback != nullptr)
+        {
+            _firing = entry;
+            (entry.callback)(entry.d, entry.id);
+            _firing.state = TIMER_FREE;
+        }
+
+        // callback deleted or replaced its own alarm
+        if (entry.state != TIMER_TRIG)
+        {
+            continue;
+        }
+
+        // when interval timer, schedule next call
+        if (entry.interval > 0)
+        {
+            entry.val = nextPhaseLockedDeadline(entry.val, entry.interval, currTime);
+            entry.state = TIMER_ARMED;
+            _queue.schedule(handle, entry.val);
+        }
+        else
         {
-            if (entry.callback != nullptr)
-            {
-                (entry.callback)(entry.d, entry.id);
-            }
-            // when interval timer, schedule next call
-            if (entry.interval > 0)
-            {
-                entry.val = entry.interval + currTime;
-                entry.state = TIMER_ARMED;
-            }
-            else
-            {
-                entry.state = TIMER_FREE;
-            }
+            entry.state = TIMER_FREE;
+            _queue.release(handle);
         }
     }
 
     return 1;
 }
 
+TIMER_HANDLE CanFestivalTimers::shiftAlarm(TIMER_HANDLE handle, TIMEVAL offset)
+{
+    specialAssert(_instance != nullptr);
+    if (handle >= static_cast<TIMER_HANDLE>(_instance->_timers.size()) || handle < TIMER_NONE)
+    {
+        testHook_ErrorShiftAlarm();
+        _instance->_log.logWarning(Logging::Origin::CFTimers, "shiftAlarm invalid timer handle");
+        return TIMER_NONE;
+    }
+
+    CFLocker locker;
+    if (handle == TIMER_NONE || !_instance->_queue.isQueued(handle))
+    {
+        return TIMER_NONE;
+    }
+
+    // only ever later, no need to wake the task
+    auto &entry = _instance->_timers[handle];
+    entry.val += offset;
+    _instance->_queue.schedule(handle, entry.val);
+    return handle;
+}
+
+TIMEVAL CanFestivalTimers::nextPhaseLockedDeadline(TIMEVAL previous, TIMEVAL period, TIMEVAL now)
+{
+    TIMEVAL next = previous + period;
+    if (next <= now)
+    {
+        // skip periods that are already over instead of firing them back to back
+        const TIMEVAL missed = (now - next) / period + 1;
+        next += missed * period;
+        _lateness.live().missedPeriods += static_cast<uint32_t>(missed);
+    }
+    return next;
+}
+
+void CanFestivalTimers::wakeTask()
+{
+    // notification stays pending when the task is between dispatch() and the wait
+    _plannedWakeup = 0;
+    testHook_WakeTask();
+    if (_taskHandle != nullptr)
+    {
+        xTaskNotify(_taskHandle, NOTIFY_DEADLINE_CHANGED, eSetBits);
+    }
+}
+
+CanFestivalTimers::LatenessStatistics CanFestivalTimers::getLatenessStatistics()
+{
+    return _lateness.read();
+}
+
+void CanFestivalTimers::resetLatenessStatistics()
+{
+    _lateness.reset();
+}
+
 void CanFestivalTimers::taskMain()
 {
+    {
+        CFLocker locker;
+        _taskHandle = xTaskGetCurrentTaskHandle();
+    }
+
     for (;;)
     {
-        const TickType_t ticksToWait = _instance->dispatch();
-        vTaskDelay(pdMS_TO_TICKS(ticksToWait));
+        runOnce();
     }
 }
 
+void CanFestivalTimers::runOnce(TickType_t maxWait)
+{
+    const TickType_t ticksToWait = dispatch();
+#ifdef BUILDCONFIG_CANOPEN_ACTOR
+    // commands may arm alarms, wakeTask() leaves a notification for that
+    _actor.process();
+    _lateness.publish();
+#endif
+    xTaskNotifyWait(0, std::numeric_limits<uint32_t>::max(), nullptr,
+                    std::min(ticksToWait, maxWait));
+}
+
 } // namespace remote_control_device
 
 using remote_control_device::CanFestivalTimers;
@@ -1,6 +1,11 @@
 #pragma once
+#include "ActorPublished.hpp"
+#include "CanopenActor.hpp"
+#include "TimerQueue.hpp"
 #include "Wrapper/HAL.hpp"
+#include <FreeRTOS.h>
 #include <array>
+#include <task.h>
 
 extern "C"
 {
@@ -13,6 +18,9 @@ extern "C"
  * On most targets this is done via hardware timers but this is problematic due to
  * the library not being thread safe.
  * Replaces the functionality of "timers.c" in the library.
+ *
+ * With BUILDCONFIG_CANOPEN_ACTOR the task also is the CanopenActor, executing the commands other
+ * tasks post after every alarm dispatch.
  */
 
 namespace remote_control_device
@@ -45,6 +53,11 @@ public:
      * @param value time in ticks, when to trigger from time of calling
      * @param period time in ticks, period to use for continous calling, 0 for no periodic calling
      * @return TIMER_HANDLE handle to reference this timer
+     *
+     * Periodic alarms are rescheduled from their previous deadline, so late dispatches don't
+     * shift later firings. The same goes for an alarm armed from within its own callback
+     * (same callback, id and OD) as canfestival does for PDO event timers.
+     * Periods that are already over get skipped and counted as missed.
      */
     static TIMER_HANDLE setAlarm(CO_Data *d, UNS32 id, TimerCallback_t callback, TIMEVAL value,
                                  TIMEVAL period);
@@ -57,14 +70,45 @@ public:
      */
     static TIMER_HANDLE delAlarm(TIMER_HANDLE handle);
 
+    /**
+     * @brief Delays an armed alarm. Periodic alarms and alarms re-armed from their own
+     * callback keep the shifted phase
+     *
+     * @param handle alarm to shift, TIMER_NONE is ignored
+     * @param offset time in ticks to add to the next deadline
+     * @return TIMER_HANDLE handle when shifted, TIMER_NONE otherwise
+     */
+    static TIMER_HANDLE shiftAlarm(TIMER_HANDLE handle, TIMEVAL offset);
+
+    /**
+     * @brief Current time of the alarm clock
+     *
+     * @return TIMEVAL in ticks
+     */
+    static TIMEVAL getTime();
+
     /**
      * @brief Checks for alarms to dispatch
      *
-     * @return time in ms until function should be called again
+     * @return ticks until function should be called again, portMAX_DELAY when no alarm is armed
      */
     virtual  TickType_t dispatch();
+
+    /**
+     * @brief Dispatches alarms forever. Sleeps until the next alarm is due or
+     * setAlarm / delAlarm change the nearest deadline (or a CanopenActor command arrives)
+     *
+     */
     virtual void taskMain();
 
+    /**
+     * @brief Internal. One pass of taskMain on the calling task: dispatches the due alarms, in
+     * actor mode executes the posted commands and publishes, then sleeps until the next alarm,
+     * a change or at most maxWait
+     *
+     */
+    virtual void runOnce(TickType_t maxWait = portMAX_DELAY);
+
     static constexpr uint32_t MAX_TIMERS = MAX_NB_TIMER;
 
     /**
@@ -74,15 +118,74 @@ public:
      */
     virtual uint8_t getTimersRemaining();
 
+    struct LatenessStatistics
+    {
+        uint32_t firedCount{0};
+        // fired more than one tick after their deadline
+        uint32_t lateCount{0};
+        uint32_t lastLateness_us{0};
+        uint32_t maxLateness_us{0};
+        // periods skipped because the alarm fired more than a period late
+        uint32_t missedPeriods{0};
+    };
+
+    /**
+     * @brief Time between scheduled and actual execution of alarm callbacks
+     * In actor mode other tasks get the copy the task published after its last dispatch
+     *
+     * @return LatenessStatistics
+     */
+    virtual LatenessStatistics getLatenessStatistics();
+
+    /**
+     * @brief In actor mode on the actor only
+     *
+     */
+    virtual void resetLatenessStatistics();
+
     /* test hooks */
     static void testHook_ErrorDelAlarm(){};
     static void testHook_ErrorSetAlarm(){};
+    static void testHook_ErrorShiftAlarm(){};
+    static void testHook_WakeTask(){};
 
 private:
     wrapper::HAL &_hal;
     Logging &_log;
     static CanFestivalTimers *_instance;
 
+    static constexpr uint32_t NOTIFY_DEADLINE_CHANGED = 1 << 0;
+    TaskHandle_t _taskHandle{nullptr};
+    // deadline taskMain currently sleeps towards, 0 while dispatching
+    TIMEVAL _plannedWakeup{0};
+    ActorPublished<LatenessStatistics> _lateness;
+    // copy of the alarm whose callback is running, state TIMER_TRIG while it does
+    struct_s_timer_entry _firing{};
+
+    /**
+     * @brief Interrupts taskMain's sleep so it recomputes the nearest deadline
+     * Call with CFLocker held
+     *
+     */
+    void wakeTask();
+
+    /**
+     * @brief First deadline after now that is in phase with previous
+     *
+     * @param previous last deadline
+     * @param period
+     * @param now
+     * @return TIMEVAL
+     */
+    TIMEVAL nextPhaseLockedDeadline(TIMEVAL previous, TIMEVAL period, TIMEVAL now);
+
     std::array<struct_s_timer_entry, MAX_TIMERS> _timers;
+    // deadline ordering, handles returned by setAlarm are its slot indices
+    TimerQueue<MAX_TIMERS> _queue;
+
+#ifdef BUILDCONFIG_CANOPEN_ACTOR
+    // constructed in the task that later runs taskMain, which makes it the owner
+    CanopenActor _actor;
+#endif
 };
 } // namespace remote_control_device
\ No newline at end of file
@@ -0,0 +1,94 @@
+#include "CanopenActor.hpp"
+#include "SpecialAssert.hpp"
+#include <algorithm>
+
+namespace remote_control_device
+{
+
+CanopenActor *CanopenActor::_instance{nullptr};
+
+CanopenActor::CanopenActor()
+    : _queue(xQueueCreate(QueueSize, sizeof(CanopenCommand))), _owner(xTaskGetCurrentTaskHandle())
+{
+    specialAssert(_instance == nullptr);
+    specialAssert(_queue != nullptr);
+    _instance = this;
+}
+
+CanopenActor::~CanopenActor()
+{
+    _instance = nullptr;
+    vQueueDelete(_queue);
+}
+
+void CanopenActor::setHandlers(Executor execute, Publisher publish)
+{
+    if (_instance == nullptr)
+    {
+        return;
+    }
+    _instance->_execute = execute;
+    _instance->_publish = publish;
+}
+
+bool CanopenActor::isOwnerContext()
+{
+    return _instance == nullptr || _instance->_owner == xTaskGetCurrentTaskHandle();
+}
+
+bool CanopenActor::post(const CanopenCommand &command)
+{
+    if (_instance == nullptr)
+    {
+        return false;
+    }
+    CanopenActor &inst = *_instance;
+
+    if (xQueueSend(inst._queue, &command, 0) != pdTRUE)
+    {
+        inst._dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    inst._posted.fetch_add(1, std::memory_order_relaxed);
+    xTaskNotify(inst._owner, NOTIFY_COMMAND, eSetBits);
+    return true;
+}
+
+void CanopenActor::process()
+{
+    specialAssert(isOwnerContext());
+    const Executor execute = _execute.load();
+    const Publisher publish = _publish.load();
+
+    // only what is there now so alarms aren't starved, commands posted meanwhile left the
+    // notification pending and get their own run
+    const UBaseType_t waiting = uxQueueMessagesWaiting(_queue);
+    _maxQueued = std::max<uint32_t>(_maxQueued, waiting);
+
+    CanopenCommand command;
+    for (UBaseType_t i = 0; i < waiting && xQueueReceive(_queue, &command, 0) == pdTRUE; ++i)
+    {
+        if (execute != nullptr)
+        {
+            execute(command);
+        }
+        _executed++;
+    }
+
+    if (publish != nullptr)
+    {
+        publish();
+    }
+}
+
+CanopenActor::Statistics CanopenActor::getStatistics() const
+{
+    Statistics stats;
+    stats.posted = _posted.load(std::memory_order_relaxed);
+    stats.executed = _executed;
+    stats.dropped = _dropped.load(std::memory_order_relaxed);
+    stats.maxQueued = _maxQueued;
+    return stats;
+}
+
+} // namespace remote_control_device
@@ -0,0 +1,144 @@
+#pragma once
+#include <FreeRTOS.h>
+#include <atomic>
+#include <cstdint>
+#include <queue.h>
+#include <task.h>
+
+/**
+ * @brief Command channel to the one task owning canfestival's object dictionary
+ *
+ * With BUILDCONFIG_CANOPEN_ACTOR CanFestivalTimers owns an instance and its task becomes the
+ * only one touching CO_Data. Canopen's setters and CanIO's RX notifications are posted here
+ * instead of taking the CFLocker mutex, the owner executes them between alarm dispatches and
+ * publishes the results for the other tasks afterwards. The owner is the task constructing the
+ * actor, commands it issues itself don't need to go through the queue.
+ *
+ * The class itself doesn't know what the commands do, Canopen registers the handlers.
+ */
+namespace remote_control_device
+{
+
+struct CanopenCommand
+{
+    enum class Type : uint8_t
+    {
+        // target: setpoint, value: raw OD value
+        Setpoint,
+        // value: StateId
+        SelfState,
+        // target: TPDO index, value: enable
+        TPDO,
+        // value: enable
+        ActuatorPDOs,
+        // value: Canopen::PDOSchedule
+        PDOSchedule,
+        // all policies from Canopen::setTPDOPolicies
+        TPDOPolicies,
+        // target: node id, value: CanDeviceState
+        DeviceState,
+        // value: brake coupling's state bit 0, steering coupling's state bit 1, see
+        // Canopen::setCouplingStates for which argument drives which
+        Couplings,
+        // all targets from Canopen::setActuatorSetpoints, value: publish now
+        Setpoints,
+        // frames waiting in CanIO's RX ring
+        RxFrames
+    };
+
+    Type type;
+    uint8_t target{0};
+    int32_t value{0};
+};
+
+class CanopenActor
+{
+public:
+    using Executor = void (*)(const CanopenCommand &);
+    using Publisher = void (*)();
+
+    /**
+     * @brief Construct a new Canopen Actor object, the calling task becomes the owner
+     *
+     */
+    CanopenActor();
+    virtual ~CanopenActor();
+
+    CanopenActor(const CanopenActor &) = delete;
+    CanopenActor(CanopenActor &&) = delete;
+    CanopenActor &operator=(const CanopenActor &) = delete;
+    CanopenActor &operator=(CanopenActor &&) = delete;
+
+    /**
+     * @brief Commands waiting for the owner
+     * A Statemachine cycle posts about 8, RX notifications are coalesced by Canopen
+     *
+     */
+    static constexpr UBaseType_t QueueSize = 16;
+
+    /**
+     * @brief Notification bit posting sets on the owner task, the bits CanFestivalTimers uses for
+     * itself are below
+     *
+     */
+    static constexpr uint32_t NOTIFY_COMMAND = 1 << 8;
+
+    /**
+     * @brief Registers what process() does with the commands, ignored without actor
+     *
+     * @param execute called for every command
+     * @param publish called once after every process() run, nullptr for nothing
+     */
+    static void setHandlers(Executor execute, Publisher publish);
+
+    /**
+     * @brief True on the owner task and as long as there is no actor at all (mutex mode)
+     *
+     */
+    static bool isOwnerContext();
+
+    /**
+     * @brief Queues a command for the owner and wakes it, never blocks
+     *
+     * @param command
+     * @return false no actor or queue full, the command was dropped
+     */
+    static bool post(const CanopenCommand &command);
+
+    /**
+     * @brief Executes all queued commands in order, then publishes. Owner task only
+     *
+     */
+    void process();
+
+    struct Statistics
+    {
+        uint32_t posted{0};
+        uint32_t executed{0};
+        // queue was full
+        uint32_t dropped{0};
+        uint32_t maxQueued{0};
+    };
+
+    /**
+     * @brief Counters keep changing while being copied, each one is consistent on its own
+     *
+     * @return Statistics
+     */
+    Statistics getStatistics() const;
+
+private:
+    static CanopenActor *_instance;
+
+    QueueHandle_t _queue;
+    TaskHandle_t _owner;
+    std::atomic<Executor> _execute{nullptr};
+    std::atomic<Publisher> _publish{nullptr};
+
+    std::atomic<uint32_t> _posted{0};
+    std::atomic<uint32_t> _dropped{0};
+    uint32_t _executed{0};
+    uint32_t _maxQueued{0};
+};
+
+} // namespace remote_control_device
@@ -0,0 +1,344 @@
+#include "SdoClientQueue.hpp"
+#include "CanFestivalLocker.hpp"
+#include "CanFestivalTimers.hpp"
+#include "CanopenActor.hpp"
+#include "Logging.hpp"
+#include "SpecialAssert.hpp"
+#include <algorithm>
+
+extern "C"
+{
+#include <canfestival/def.h>
+}
+
+namespace remote_control_device
+{
+namespace
+{
+constexpr TIMEVAL TicksPerMs = MS_TO_TIMEVAL(1);
+} // namespace
+
+SdoClientQueue *SdoClientQueue::_instance = nullptr;
+
+SdoClientQueue::SdoClientQueue(Logging &log) : _log(log)
+{
+    specialAssert(_instance == nullptr);
+    _instance = this;
+}
+
+SdoClientQueue::~SdoClientQueue()
+{
+    CFLocker locker;
+    if (_retryAlarm != TIMER_NONE)
+    {
+        DelAlarm(_retryAlarm);
+    }
+    _instance = nullptr;
+}
+
+bool SdoClientQueue::write(CO_Data *d, const SdoWriteRequest &request)
+{
+    specialAssert(_instance != nullptr);
+    specialAssert(request.nodeId != 0);
+    NodeQueue *node = _instance->findNode(request.nodeId);
+    if (node == nullptr)
+    {
+        node = _instance->findNode(0);
+        if (node == nullptr)
+        {
+            _instance->_statistics.live().dropped++;
+            _instance->_log.logWarning(Logging::Origin::BusDevices,
+                                       "SDO to nodeId %d dropped, too many nodes",
+                                       request.nodeId);
+            return false;
+        }
+        node->nodeId = request.nodeId;
+    }
+
+    // newest request to the same object decides
+    for (uint8_t position = node->count; position > 0; --position)
+    {
+        SdoWriteRequest &queued = node->at(position - 1).request;
+        if (queued.odIndex != request.odIndex || queued.odSubIndex != request.odSubIndex)
+        {
+            continue;
+        }
+        if (queued.value == request.value && queued.size == request.size)
+        {
+            _instance->_statistics.live().coalesced++;
+            return true;
+        }
+        if (position > 1 || !node->inFlight)
+        {
+            queued = request;
+            _instance->_statistics.live().coalesced++;
+            return true;
+        }
+        break;
+    }
+
+    if (node->count == QueueDepth)
+    {
+        _instance->_statistics.live().dropped++;
+        _instance->_log.logWarning(Logging::Origin::BusDevices,
+                                   "SDO to nodeId %d dropped, queue full", request.nodeId);
+        return false;
+    }
+    node->at(node->count) = {request, CanFestivalTimers::getTime()};
+    node->count++;
+
+    if (!node->inFlight && node->retryAt == 0)
+    {
+        _instance->start(d, *node);
+    }
+    return true;
+}
+
+void SdoClientQueue::nodeOnline(CO_Data *d, uint8_t nodeId)
+{
+    specialAssert(_instance != nullptr);
+    NodeQueue *node = _instance->findNode(nodeId);
+    if (node == nullptr || node->retryAt == 0)
+    {
+        return;
+    }
+    node->retryAt = 0;
+    node->timeouts = 0;
+    _instance->start(d, *node);
+    _instance->armRetryAlarm(d);
+}
+
+uint8_t SdoClientQueue::getPending(uint8_t nodeId)
+{
+    specialAssert(_instance != nullptr);
+    const NodeQueue *node = _instance->findNode(nodeId);
+    return node != nullptr ? node->count : 0;
+}
+
+SdoClientQueue::Statistics SdoClientQueue::getStatistics()
+{
+    specialAssert(_instance != nullptr);
+    return _instance->_statistics.read();
+}
+
+void SdoClientQueue::resetStatistics()
+{
+    specialAssert(_instance != nullptr);
+    _instance->_statistics.reset();
+}
+
+#ifdef BUILDCONFIG_CANOPEN_ACTOR
+void SdoClientQueue::publishStatistics()
+{
+    specialAssert(_instance != nullptr);
+    _instance->_statistics.publish();
+}
+#endif
+
+SdoClientQueue::NodeQueue *SdoClientQueue::findNode(uint8_t nodeId)
+{
+    auto node = std::find_if(_nodes.begin(), _nodes.end(),
+                             [nodeId](const NodeQueue &n) -> bool { return n.nodeId == nodeId; });
+    return node != _nodes.end() ? &*node : nullptr;
+}
+
+void SdoClientQueue::start(CO_Data *d, NodeQueue &node)
+{
+    const SdoWriteRequest &request = node.at(0).request;
+
+    // a line still open to the node (not ours) has to finish first, as does a full line table
+    UNS32 abortCode = 0;
+    UNS8 err = 1;
+    if (getWriteResultNetworkDict(d, node.nodeId, &abortCode) == SDO_ABORTED_INTERNAL)
+    {
+        uint32_t value = request.value;
+        const UNS8 dataType = request.size == 1 ? uint8 : request.size == 2 ? uint16 : uint32;
+        err = writeNetworkDictCallBack(d, node.nodeId, request.odIndex, request.odSubIndex,
+                                       request.size, dataType, &value, &SdoClientQueue::cbSDO,
+                                       false);
+    }
+
+    if (err == 0)
+    {
+        node.inFlight = true;
+        return;
+    }
+    _log.logDebug(Logging::Origin::BusDevices, "No SDO line for nodeId %d, retrying later",
+                  node.nodeId);
+    node.retryAt = CanFestivalTimers::getTime() + MS_TO_TIMEVAL(RetryBackoffBase_ms);
+    armRetryAlarm(d);
+}
+
+void SdoClientQueue::pop(NodeQueue &node)
+{
+    node.head = (node.head + 1) % QueueDepth;
+    node.count--;
+    node.timeouts = 0;
+    if (node.count == 0)
+    {
+        node = NodeQueue();
+    }
+}
+
+void SdoClientQueue::armRetryAlarm(CO_Data *d)
+{
+    if (_retryAlarm != TIMER_NONE)
+    {
+        _retryAlarm = DelAlarm(_retryAlarm);
+    }
+
+    TIMEVAL earliest = 0;
+    for (const NodeQueue &node : _nodes)
+    {
+        if (node.retryAt != 0 && (earliest == 0 || node.retryAt < earliest))
+        {
+            earliest = node.retryAt;
+        }
+    }
+    if (earliest == 0)
+    {
+        return;
+    }
+    const TIMEVAL now = CanFestivalTimers::getTime();
+    _retryAlarm =
+        SetAlarm(d, 0, &SdoClientQueue::cbRetry, earliest > now ? earliest - now : 0, 0);
+}
+
+TIMEVAL SdoClientQueue::backoff(uint8_t timeouts)
+{
+    uint32_t backoff_ms = RetryBackoffBase_ms;
+    for (uint8_t i = 1; i < timeouts && backoff_ms < RetryBackoffMax_ms; ++i)
+    {
+        backoff_ms *= 2;
+    }
+    return MS_TO_TIMEVAL(static_cast<TIMEVAL>(std::min(backoff_ms, RetryBackoffMax_ms)));
+}
+
+const char *SdoClientQueue::abortCodeToString(uint32_t abortCode)
+{
+    switch (abortCode)
+    {
+       /* case OD_SUCCESSFUL:
+            return "OD_SUCCESSFUL";
+        case OD_READ_NOT_ALLOWED:
+            return "OD_READ_NOT_ALLOWED";
+        case OD_WRITE_NOT_ALLOWED:
+            return "OD_WRITE_NOT_ALLOWED";
+        case OD_NO_SUCH_OBJECT:
+            return "OD_NO_SUCH_OBJECT";
+        case OD_NOT_MAPPABLE:
+            return "OD_NOT_MAPPABLE";
+        case OD_ACCES_FAILED:
+            return "OD_ACCES_FAILED";
+        case OD_LENGTH_DATA_INVALID:
+            return "OD_LENGTH_DATA_INVALID";
+        case OD_NO_SUCH_SUBINDEX:
+            return "OD_NO_SUCH_SUBINDEX";
+        case OD_VALUE_RANGE_EXCEEDED:
+            return "OD_VALUE_RANGE_EXCEEDED";
+        case OD_VALUE_TOO_LOW:
+            return "OD_VALUE_TOO_LOW";
+        case OD_VALUE_TOO_HIGH:
+            return "OD_VALUE_TOO_HIGH";
+        case SDOABT_TOGGLE_NOT_ALTERNED:
+            return "SDOABT_TOGGLE_NOT_ALTERNED";
+        case SDOABT_TIMED_OUT:
+            return "SDOABT_TIMED_OUT";
+        case SDOABT_CS_NOT_VALID:
+            return "SDOABT_CS_NOT_VALID";
+        case SDOABT_INVALID_BLOCK_SIZE:
+            return "SDOABT_INVALID_BLOCK_SIZE";
+        case SDOABT_OUT_OF_MEMORY:
+            return "SDOABT_OUT_OF_MEMORY";
+        case SDOABT_GENERAL_ERROR:
+            return "SDOABT_GENERAL_ERROR";
+        case SDOABT_LOCAL_CTRL_ERROR:
+            return "SDOABT_LOCAL_CTRL_ERROR";*/
+        default:
+            return "Error Unknown";
+    }
+}
+
+void SdoClientQueue::cbSDO(CO_Data *d, UNS8 nodeId)
+{
+    NodeQueue *node = _instance != nullptr ? _instance->findNode(nodeId) : nullptr;
+    if (node == nullptr || !node->inFlight)
+    {
+        if (_instance != nullptr)
+        {
+            _instance->_log.logDebug(Logging::Origin::BusDevices,
+                                     "Unexpected SDO received from nodeId %d", nodeId);
+        }
+        return;
+    }
+
+    UNS32 abortCode = 0;
+    const UNS8 result = getWriteResultNetworkDict(d, nodeId, &abortCode);
+    // closing isn't necessary when the transfer is finished but this isn't always the case
+    closeSDOtransfer(d, nodeId, SDO_CLIENT);
+    node->inFlight = false;
+
+    Statistics &statistics = _instance->_statistics.live();
+    const TIMEVAL now = CanFestivalTimers::getTime();
+    if (result == SDO_FINISHED)
+    {
+        const auto latency_ms = static_cast<uint32_t>((now - node->at(0).queuedAt) / TicksPerMs);
+        statistics.completed++;
+        statistics.lastLatency_ms = latency_ms;
+        statistics.maxLatency_ms = std::max(statistics.maxLatency_ms, latency_ms);
+        statistics.totalLatency_ms += latency_ms;
+        _instance->pop(*node);
+    }
+    // abortCode is 0 for timeout which isn't correct
+    // but flow errors in the stack cause this to be 0
+    else if (abortCode == 0)
+    {
+        statistics.timeouts++;
+        if (node->timeouts < UINT8_MAX)
+        {
+            node->timeouts++;
+        }
+        node->retryAt = now + backoff(node->timeouts);
+        _instance->armRetryAlarm(d);
+        return;
+    }
+    else
+    {
+        // serious error, most likely ill configured node
+        // not attempting new transmission as these errors are more likely
+        // to come from an active node which answers quickly (like we do)
+        // causing risk of flooding
+        statistics.failed++;
+        _instance->_log.logWarning(Logging::Origin::BusDevices,
+                                   "SDO to nodeId %d failed (%s)", nodeId,
+                                   abortCodeToString(abortCode));
+        _instance->pop(*node);
+    }
+
+    if (node->count > 0)
+    {
+        _instance->start(d, *node);
+    }
+}
+
+void SdoClientQueue::cbRetry(CO_Data *d, UNS32 /*id*/)
+{
+    if (_instance == nullptr)
+    {
+        return;
+    }
+    _instance->_retryAlarm = TIMER_NONE;
+
+    const TIMEVAL now = CanFestivalTimers::getTime();
+    for (NodeQueue &node : _instance->_nodes)
+    {
+        if (node.retryAt != 0 && node.retryAt <= now)
+        {
+            node.retryAt = 0;
+            _instance->start(d, node);
+        }
+    }
+    _instance->armRetryAlarm(d);
+}
+
+} // namespace remote_control_device
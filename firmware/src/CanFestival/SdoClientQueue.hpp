@@ -0,0 +1,183 @@
+#pragma once
+#include "ActorPublished.hpp"
+#include <array>
+#include <cstdint>
+
+extern "C"
+{
+#include <canfestival/data.h>
+#include <canfestival/timer.h>
+}
+
+/**
+ * @brief Queued expedited SDO writes to other nodes
+ *
+ * Canfestival only runs one client transfer per node. Requests wait in a FIFO per node while
+ * transfers to different nodes run side by side (up to SDO_MAX_SIMULTANEOUS_TRANSFERS lines).
+ * A request to an object that is already waiting replaces the waiting value instead of queueing
+ * another transfer, one equal to the last value queued or in flight for the object is dropped.
+ *
+ * A transfer that times out is repeated after RetryBackoffBase_ms, doubling with every further
+ * timeout up to RetryBackoffMax_ms so a dead node isn't flooded. Requests are never given up on
+ * timeout, aborts by the server drop them. nodeOnline() ends the backoff right away.
+ *
+ * Everything but getStatistics has to be called with the OD locked / on the actor.
+ */
+namespace remote_control_device
+{
+class Logging;
+
+struct SdoWriteRequest
+{
+    uint8_t nodeId;
+    uint16_t odIndex;
+    uint8_t odSubIndex;
+    uint32_t value;
+    // bytes of value to write, 1 to 4
+    uint8_t size{4};
+};
+
+class SdoClientQueue
+{
+public:
+    /**
+     * @brief Nodes with queued requests at the same time
+     *
+     */
+    static constexpr uint8_t MaxNodes = 4;
+    static constexpr uint8_t QueueDepth = 4;
+    static constexpr uint32_t RetryBackoffBase_ms = 100;
+    static constexpr uint32_t RetryBackoffMax_ms = 3200;
+
+    explicit SdoClientQueue(Logging &log);
+    virtual ~SdoClientQueue();
+
+    SdoClientQueue(const SdoClientQueue &) = delete;
+    SdoClientQueue(SdoClientQueue &&) = delete;
+    SdoClientQueue &operator=(const SdoClientQueue &) = delete;
+    SdoClientQueue &operator=(SdoClientQueue &&) = delete;
+
+    /**
+     * @brief Queues a write and starts it if the node is idle
+     *
+     * @param d
+     * @param request
+     * @return false dropped, node's queue or node slots full
+     */
+    static bool write(CO_Data *d, const SdoWriteRequest &request);
+
+    /**
+     * @brief Ends a running backoff of the node, e.g. after it booted
+     *
+     * @param d
+     * @param nodeId
+     */
+    static void nodeOnline(CO_Data *d, uint8_t nodeId);
+
+    /**
+     * @brief Requests queued or in flight for the node
+     *
+     * @param nodeId
+     * @return uint8_t
+     */
+    static uint8_t getPending(uint8_t nodeId);
+
+    struct Statistics
+    {
+        uint32_t completed{0};
+        // aborted by the server
+        uint32_t failed{0};
+        uint32_t timeouts{0};
+        // replaced a waiting value or equal to the last one
+        uint32_t coalesced{0};
+        // queue full
+        uint32_t dropped{0};
+        // from write() to the confirmation, queueing and retries included
+        uint32_t lastLatency_ms{0};
+        uint32_t maxLatency_ms{0};
+        uint64_t totalLatency_ms{0};
+    };
+
+    /**
+     * @brief In actor mode other tasks get the copy the actor published last
+     *
+     * @return Statistics
+     */
+    static Statistics getStatistics();
+
+    /**
+     * @brief In actor mode on the actor only
+     *
+     */
+    static void resetStatistics();
+
+#ifdef BUILDCONFIG_CANOPEN_ACTOR
+    /**
+     * @brief Publishes the statistics for getStatistics on other tasks, actor only
+     *
+     */
+    static void publishStatistics();
+#endif
+
+private:
+    Logging &_log;
+    static SdoClientQueue *_instance;
+
+    struct Pending
+    {
+        SdoWriteRequest request;
+        TIMEVAL queuedAt;
+    };
+
+    struct NodeQueue
+    {
+        // 0 while the slot is unused
+        uint8_t nodeId{0};
+        std::array<Pending, QueueDepth> requests{};
+        uint8_t head{0};
+        uint8_t count{0};
+        // head is on the bus
+        bool inFlight{false};
+        // consecutive timeouts of head
+        uint8_t timeouts{0};
+        // head waits for the retry alarm, 0 when not backing off
+        TIMEVAL retryAt{0};
+
+        Pending &at(uint8_t position)
+        {
+            return requests[(head + position) % QueueDepth];
+        }
+    };
+
+    std::array<NodeQueue, MaxNodes> _nodes{};
+    TIMER_HANDLE _retryAlarm{TIMER_NONE};
+    ActorPublished<Statistics> _statistics;
+
+    NodeQueue *findNode(uint8_t nodeId);
+
+    /**
+     * @brief Sends the head of node, backs off when no SDO line is free
+     *
+     */
+    void start(CO_Data *d, NodeQueue &node);
+
+    /**
+     * @brief Drops the head, frees the slot when nothing is left
+     *
+     */
+    void pop(NodeQueue &node);
+
+    /**
+     * @brief Arms the retry alarm for the earliest retryAt
+     *
+     */
+    void armRetryAlarm(CO_Data *d);
+
+    static TIMEVAL backoff(uint8_t timeouts);
+    static const char *abortCodeToString(uint32_t abortCode);
+
+    /* Canfestival callbacks */
+    static void cbSDO(CO_Data *d, UNS8 nodeId);
+    static void cbRetry(CO_Data *d, UNS32 id);
+};
+} // namespace remote_control_device
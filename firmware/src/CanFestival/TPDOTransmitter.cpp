@@ -0,0 +1,234 @@
+#include "TPDOTransmitter.hpp"
+#include "CanFestivalLocker.hpp"
+#include "CanFestivalTimers.hpp"
+#include "CanopenActor.hpp"
+#include "SpecialAssert.hpp"
+#include <cstdlib>
+
+extern "C"
+{
+#include <canfestival/def.h>
+}
+
+namespace remote_control_device
+{
+namespace
+{
+constexpr UNS8 CobIdSubIndex = 1;
+constexpr UNS8 TransmissionTypeSubIndex = 2;
+constexpr UNS8 EventTimerSubIndex = 5;
+constexpr UNS32 CobIdInvalidBit = 1UL << 31;
+constexpr UNS32 MappingLengthMask = 0xFF;
+
+/**
+ * @brief Sign extended mapped value at bit offset of the little endian payload
+ *
+ */
+int64_t mappedValue(const Message &m, uint8_t offset, uint8_t bits)
+{
+    uint64_t raw = 0;
+    for (uint8_t i = 0; i < sizeof(m.data); ++i)
+    {
+        raw |= static_cast<uint64_t>(m.data[i]) << (i * 8);
+    }
+    raw >>= offset;
+    if (bits < 64)
+    {
+        const uint64_t sign = 1ULL << (bits - 1);
+        raw &= (1ULL << bits) - 1;
+        raw = (raw ^ sign) - sign;
+    }
+    return static_cast<int64_t>(raw);
+}
+} // namespace
+
+TPDOTransmitter *TPDOTransmitter::_instance = nullptr;
+
+TPDOTransmitter::TPDOTransmitter()
+{
+    specialAssert(_instance == nullptr);
+    _instance = this;
+}
+
+TPDOTransmitter::~TPDOTransmitter()
+{
+    CFLocker locker;
+    if (_inhibitAlarm != TIMER_NONE)
+    {
+        DelAlarm(_inhibitAlarm);
+    }
+    _instance = nullptr;
+}
+
+void TPDOTransmitter::setPolicy(CO_Data *d, uint8_t pdoNum, const TPDOPolicy &policy)
+{
+    specialAssert(_instance != nullptr);
+    specialAssert(pdoNum < MaxTPDOs);
+    specialAssert(!policy.onChange || policy.period_ms != 0);
+    _instance->_entries[pdoNum] = {policy, 0, false};
+
+    if (d->firstIndex->PDO_TRS + pdoNum > d->lastIndex->PDO_TRS)
+    {
+        return;
+    }
+    subindex *parameters = d->objdict[d->firstIndex->PDO_TRS + pdoNum].pSubindex; // NOLINT
+    if (*static_cast<const UNS8 *>(parameters[TransmissionTypeSubIndex].pObject) >=
+        TRANS_EVENT_SPECIFIC)
+    {
+        *static_cast<UNS16 *>(parameters[EventTimerSubIndex].pObject) = policy.period_ms;
+    }
+}
+
+TPDOPolicy TPDOTransmitter::getPolicy(uint8_t pdoNum)
+{
+    specialAssert(_instance != nullptr);
+    specialAssert(pdoNum < MaxTPDOs);
+    return _instance->_entries[pdoNum].policy;
+}
+
+void TPDOTransmitter::valuesWritten(CO_Data *d)
+{
+    specialAssert(_instance != nullptr);
+    const TIMEVAL now = CanFestivalTimers::getTime();
+    for (uint8_t i = 0; i < MaxTPDOs; ++i)
+    {
+        if (_instance->_entries[i].policy.onChange && !_instance->_entries[i].pending)
+        {
+            _instance->check(d, i, now);
+        }
+    }
+}
+
+bool TPDOTransmitter::differs(CO_Data *d, uint8_t pdoNum, const Message &a, const Message &b,
+                              uint16_t deadband)
+{
+    if (a.cob_id != b.cob_id || a.len != b.len)
+    {
+        return true;
+    }
+
+    const indextable &mapping = d->objdict[d->firstIndex->PDO_TRS_MAP + pdoNum]; // NOLINT
+    const UNS8 count = *static_cast<const UNS8 *>(mapping.pSubindex[0].pObject);
+    uint8_t offset = 0;
+    for (UNS8 sub = 1; sub <= count; ++sub)
+    {
+        const auto bits = static_cast<uint8_t>(
+            *static_cast<const UNS32 *>(mapping.pSubindex[sub].pObject) & MappingLengthMask);
+        if (bits == 0 || offset + bits > 64)
+        {
+            break;
+        }
+        if (std::llabs(mappedValue(a, offset, bits) - mappedValue(b, offset, bits)) > deadband)
+        {
+            return true;
+        }
+        offset += bits;
+    }
+    return false;
+}
+
+TPDOTransmitter::Statistics TPDOTransmitter::getStatistics()
+{
+    specialAssert(_instance != nullptr);
+    return _instance->_statistics.read();
+}
+
+void TPDOTransmitter::resetStatistics()
+{
+    specialAssert(_instance != nullptr);
+    _instance->_statistics.reset();
+}
+
+#ifdef BUILDCONFIG_CANOPEN_ACTOR
+void TPDOTransmitter::publishStatistics()
+{
+    specialAssert(_instance != nullptr);
+    _instance->_statistics.publish();
+}
+#endif
+
+void TPDOTransmitter::check(CO_Data *d, uint8_t pdoNum, TIMEVAL now)
+{
+    Entry &entry = _entries[pdoNum];
+    entry.pending = false;
+    if (!isEventDriven(d, pdoNum))
+    {
+        return;
+    }
+
+    Message current = Message_Initializer;
+    if (buildPDO(d, pdoNum, &current) != 0 ||
+        !differs(d, pdoNum, d->PDO_status[pdoNum].last_message, current, entry.policy.deadband))
+    {
+        return;
+    }
+
+    if (now < entry.nextChangeAt)
+    {
+        entry.pending = true;
+        _statistics.live().inhibited++;
+        armInhibitAlarm(d);
+        return;
+    }
+    entry.nextChangeAt = now + MS_TO_TIMEVAL(static_cast<TIMEVAL>(entry.policy.inhibit_ms));
+    _statistics.live().changeTriggered++;
+    // re-arms the event timer, the keep-alive starts over
+    sendOnePDOevent(d, pdoNum);
+}
+
+void TPDOTransmitter::armInhibitAlarm(CO_Data *d)
+{
+    if (_inhibitAlarm != TIMER_NONE)
+    {
+        _inhibitAlarm = DelAlarm(_inhibitAlarm);
+    }
+
+    TIMEVAL earliest = 0;
+    for (const Entry &entry : _entries)
+    {
+        if (entry.pending && (earliest == 0 || entry.nextChangeAt < earliest))
+        {
+            earliest = entry.nextChangeAt;
+        }
+    }
+    if (earliest == 0)
+    {
+        return;
+    }
+    const TIMEVAL now = CanFestivalTimers::getTime();
+    _inhibitAlarm =
+        SetAlarm(d, 0, &TPDOTransmitter::cbInhibit, earliest > now ? earliest - now : 0, 0);
+}
+
+bool TPDOTransmitter::isEventDriven(CO_Data *d, uint8_t pdoNum)
+{
+    if (d->firstIndex->PDO_TRS == 0 || d->firstIndex->PDO_TRS + pdoNum > d->lastIndex->PDO_TRS)
+    {
+        return false;
+    }
+    const subindex *parameters = d->objdict[d->firstIndex->PDO_TRS + pdoNum].pSubindex; // NOLINT
+    const UNS32 cobId = *static_cast<const UNS32 *>(parameters[CobIdSubIndex].pObject);
+    const UNS8 type = *static_cast<const UNS8 *>(parameters[TransmissionTypeSubIndex].pObject);
+    return (cobId & CobIdInvalidBit) == 0 && type >= TRANS_EVENT_SPECIFIC;
+}
+
+void TPDOTransmitter::cbInhibit(CO_Data *d, UNS32 /*id*/)
+{
+    if (_instance == nullptr)
+    {
+        return;
+    }
+    _instance->_inhibitAlarm = TIMER_NONE;
+
+    const TIMEVAL now = CanFestivalTimers::getTime();
+    for (uint8_t i = 0; i < MaxTPDOs; ++i)
+    {
+        if (_instance->_entries[i].pending && _instance->_entries[i].nextChangeAt <= now)
+        {
+            _instance->check(d, i, now);
+        }
+    }
+    _instance->armInhibitAlarm(d);
+}
+
+} // namespace remote_control_device
@@ -0,0 +1,156 @@
+#pragma once
+#include "ActorPublished.hpp"
+#include <array>
+#include <cstdint>
+
+extern "C"
+{
+#include <canfestival/data.h>
+#include <canfestival/timer.h>
+}
+
+/**
+ * @brief When the event driven TPDOs go out
+ *
+ * pdo.c is patched to never compare a PDO with the last one sent, so canfestival sends each event
+ * driven TPDO at its event timer's rate whether its values changed or not. Every TPDO gets a
+ * TPDOPolicy instead: a periodic one keeps exactly that, an on change one turns the event timer
+ * into a slower keep-alive and sends in between as soon as a mapped value moved by more than the
+ * deadband, change triggered transmissions at least inhibit_ms apart.
+ *
+ * canfestival's own inhibit time (180xh sub 3) stays 0, with the patch its alarm would resend the
+ * PDO. One alarm covers the changes held back by all TPDOs. TPDOs on a synchronous transmission
+ * type are left alone.
+ *
+ * Everything but getStatistics has to be called with the OD locked / on the actor.
+ */
+namespace remote_control_device
+{
+
+struct TPDOPolicy
+{
+    // event timer, the period when not on change, the keep-alive otherwise
+    uint16_t period_ms;
+    bool onChange;
+    // raw counts any mapped value has to move to count as changed, 0 for every change
+    uint16_t deadband;
+    // minimum time between two change triggered transmissions
+    uint16_t inhibit_ms;
+
+    /**
+     * @brief Shortest time between two transmissions, what the bus load model has to expect
+     *
+     */
+    constexpr uint16_t worstCasePeriod_ms() const
+    {
+        return onChange && inhibit_ms < period_ms ? inhibit_ms : period_ms;
+    }
+};
+
+class TPDOTransmitter
+{
+public:
+    static constexpr uint8_t MaxTPDOs = 8;
+
+    TPDOTransmitter();
+    virtual ~TPDOTransmitter();
+
+    TPDOTransmitter(const TPDOTransmitter &) = delete;
+    TPDOTransmitter(TPDOTransmitter &&) = delete;
+    TPDOTransmitter &operator=(const TPDOTransmitter &) = delete;
+    TPDOTransmitter &operator=(TPDOTransmitter &&) = delete;
+
+    /**
+     * @brief Writes the policy's period into the TPDO's event timer unless the TPDO is
+     * synchronous, it takes effect with the next transmission
+     *
+     * @param d
+     * @param pdoNum counting from 0
+     * @param policy
+     */
+    static void setPolicy(CO_Data *d, uint8_t pdoNum, const TPDOPolicy &policy);
+    static TPDOPolicy getPolicy(uint8_t pdoNum);
+
+    /**
+     * @brief Sends the enabled on change TPDOs whose mapped values moved beyond their deadband
+     * since they were last sent, call after writing mapped OD entries
+     *
+     * @param d
+     */
+    static void valuesWritten(CO_Data *d);
+
+    /**
+     * @brief Whether any mapped value of the TPDO differs by more than deadband between the
+     * two frames, other COB-IDs or lengths always do
+     *
+     */
+    static bool differs(CO_Data *d, uint8_t pdoNum, const Message &a, const Message &b,
+                        uint16_t deadband);
+
+    struct Statistics
+    {
+        // sent right away because a value changed
+        uint32_t changeTriggered{0};
+        // changes that had to wait for the inhibit time
+        uint32_t inhibited{0};
+    };
+
+    /**
+     * @brief In actor mode other tasks get the copy the actor published last
+     *
+     * @return Statistics
+     */
+    static Statistics getStatistics();
+
+    /**
+     * @brief In actor mode on the actor only
+     *
+     */
+    static void resetStatistics();
+
+#ifdef BUILDCONFIG_CANOPEN_ACTOR
+    /**
+     * @brief Publishes the statistics for getStatistics on other tasks, actor only
+     *
+     */
+    static void publishStatistics();
+#endif
+
+private:
+    static TPDOTransmitter *_instance;
+
+    struct Entry
+    {
+        TPDOPolicy policy{};
+        // earliest time for the next change triggered transmission
+        TIMEVAL nextChangeAt{0};
+        // a change waits for nextChangeAt
+        bool pending{false};
+    };
+
+    std::array<Entry, MaxTPDOs> _entries{};
+    TIMER_HANDLE _inhibitAlarm{TIMER_NONE};
+    ActorPublished<Statistics> _statistics;
+
+    /**
+     * @brief Sends the TPDO if it changed and the inhibit time is over, holds it back otherwise
+     *
+     */
+    void check(CO_Data *d, uint8_t pdoNum, TIMEVAL now);
+
+    /**
+     * @brief Arms the inhibit alarm for the earliest held back change
+     *
+     */
+    void armInhibitAlarm(CO_Data *d);
+
+    /**
+     * @brief Valid COB-ID and an event driven transmission type
+     *
+     */
+    static bool isEventDriven(CO_Data *d, uint8_t pdoNum);
+
+    /* Canfestival callbacks */
+    static void cbInhibit(CO_Data *d, UNS32 id);
+};
+} // namespace remote_control_device
@@ -0,0 +1,378 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+extern "C"
+{
+#include <canfestival/applicfg.h>
+#include <canfestival/timerscfg.h>
+}
+
+/**
+ * @brief Deadline bookkeeping for CanFestivalTimers
+ *
+ * Slots are referenced by handle (0 - Capacity-1) so handles stay valid for the
+ * C ABI no matter how the deadlines are ordered internally. A slot is allocated
+ * until release() and queued while it has a pending deadline. popExpired() only
+ * dequeues, which lets the owner decide whether to reschedule or release.
+ *
+ * Two implementations with identical interfaces:
+ *  - LinearTimerQueue scans all slots, O(n) for everything, minimal code
+ *  - HeapTimerQueue binary min-heap with position index and free list,
+ *    O(1) allocate / next deadline, O(log n) schedule / release / pop
+ *
+ * Select with BUILDCONFIG_CFTIMERS_LINEAR_QUEUE, see TimerQueue alias.
+ */
+namespace remote_control_device
+{
+
+template <size_t Capacity>
+class LinearTimerQueue
+{
+    static_assert(Capacity > 0 &&
+                  Capacity <= static_cast<size_t>(std::numeric_limits<int16_t>::max()));
+
+public:
+    using Handle = int16_t;
+    static constexpr Handle None = -1;
+    static constexpr TIMEVAL NoDeadline = std::numeric_limits<TIMEVAL>::max();
+
+    /**
+     * @brief Takes a free slot and queues it with deadline
+     *
+     * @param deadline
+     * @return Handle None when all slots are in use
+     */
+    Handle allocate(TIMEVAL deadline)
+    {
+        for (size_t i = 0; i < Capacity; ++i)
+        {
+            if (!_slots[i].allocated)
+            {
+                _slots[i] = {deadline, true, true};
+                _freeSlots--;
+                return static_cast<Handle>(i);
+            }
+        }
+        return None;
+    }
+
+    /**
+     * @brief Dequeues if necessary and frees the slot
+     *
+     */
+    void release(Handle handle)
+    {
+        if (isAllocated(handle))
+        {
+            _slots[handle] = Slot{};
+            _freeSlots++;
+        }
+    }
+
+    /**
+     * @brief (Re)queues an allocated slot with a new deadline
+     *
+     */
+    void schedule(Handle handle, TIMEVAL deadline)
+    {
+        if (isAllocated(handle))
+        {
+            _slots[handle].deadline = deadline;
+            _slots[handle].queued = true;
+        }
+    }
+
+    /**
+     * @brief Dequeues one slot whose deadline is <= now, slot stays allocated
+     *
+     * @param now
+     * @return Handle None when nothing expired
+     */
+    Handle popExpired(TIMEVAL now)
+    {
+        for (size_t i = 0; i < Capacity; ++i)
+        {
+            if (_slots[i].queued && _slots[i].deadline <= now)
+            {
+                _slots[i].queued = false;
+                return static_cast<Handle>(i);
+            }
+        }
+        return None;
+    }
+
+    /**
+     * @brief Earliest queued deadline, NoDeadline when empty
+     *
+     */
+    TIMEVAL nextDeadline() const
+    {
+        TIMEVAL nearest = NoDeadline;
+        for (const Slot &slot : _slots)
+        {
+            if (slot.queued && slot.deadline < nearest)
+            {
+                nearest = slot.deadline;
+            }
+        }
+        return nearest;
+    }
+
+    TIMEVAL getDeadline(Handle handle) const
+    {
+        return _slots[handle].deadline;
+    }
+
+    bool isAllocated(Handle handle) const
+    {
+        return handle >= 0 && static_cast<size_t>(handle) < Capacity && _slots[handle].allocated;
+    }
+
+    bool isQueued(Handle handle) const
+    {
+        return isAllocated(handle) && _slots[handle].queued;
+    }
+
+    size_t getFreeSlots() const
+    {
+        return _freeSlots;
+    }
+
+private:
+    struct Slot
+    {
+        TIMEVAL deadline{0};
+        bool allocated{false};
+        bool queued{false};
+    };
+
+    std::array<Slot, Capacity> _slots{};
+    size_t _freeSlots{Capacity};
+};
+
+template <size_t Capacity>
+class HeapTimerQueue
+{
+    static_assert(Capacity > 0 &&
+                  Capacity <= static_cast<size_t>(std::numeric_limits<int16_t>::max()));
+
+public:
+    using Handle = int16_t;
+    static constexpr Handle None = -1;
+    static constexpr TIMEVAL NoDeadline = std::numeric_limits<TIMEVAL>::max();
+
+    HeapTimerQueue()
+    {
+        // hand out low handles first, like the linear queue
+        for (size_t i = 0; i < Capacity; ++i)
+        {
+            _freeList[i] = static_cast<Handle>(Capacity - 1 - i);
+        }
+        _heapPos.fill(NotQueued);
+    }
+
+    /**
+     * @brief Takes a free slot and queues it with deadline
+     *
+     * @param deadline
+     * @return Handle None when all slots are in use
+     */
+    Handle allocate(TIMEVAL deadline)
+    {
+        if (_freeCount == 0)
+        {
+            return None;
+        }
+        const Handle handle = _freeList[--_freeCount];
+        _allocated[handle] = true;
+        _deadlines[handle] = deadline;
+        push(handle);
+        return handle;
+    }
+
+    /**
+     * @brief Dequeues if necessary and frees the slot
+     *
+     */
+    void release(Handle handle)
+    {
+        if (isAllocated(handle))
+        {
+            if (_heapPos[handle] != NotQueued)
+            {
+                remove(_heapPos[handle]);
+            }
+            _allocated[handle] = false;
+            _freeList[_freeCount++] = handle;
+        }
+    }
+
+    /**
+     * @brief (Re)queues an allocated slot with a new deadline
+     *
+     */
+    void schedule(Handle handle, TIMEVAL deadline)
+    {
+        if (!isAllocated(handle))
+        {
+            return;
+        }
+
+        if (_heapPos[handle] == NotQueued)
+        {
+            _deadlines[handle] = deadline;
+            push(handle);
+        }
+        else
+        {
+            const TIMEVAL previous = _deadlines[handle];
+            _deadlines[handle] = deadline;
+            if (deadline < previous)
+            {
+                siftUp(_heapPos[handle]);
+            }
+            else
+            {
+                siftDown(_heapPos[handle]);
+            }
+        }
+    }
+
+    /**
+     * @brief Dequeues one slot whose deadline is <= now, slot stays allocated
+     *
+     * @param now
+     * @return Handle None when nothing expired
+     */
+    Handle popExpired(TIMEVAL now)
+    {
+        if (_heapSize == 0 || _deadlines[_heap[0]] > now)
+        {
+            return None;
+        }
+        const Handle handle = _heap[0];
+        remove(0);
+        return handle;
+    }
+
+    /**
+     * @brief Earliest queued deadline, NoDeadline when empty
+     *
+     */
+    TIMEVAL nextDeadline() const
+    {
+        return _heapSize == 0 ? NoDeadline : _deadlines[_heap[0]];
+    }
+
+    TIMEVAL getDeadline(Handle handle) const
+    {
+        return _deadlines[handle];
+    }
+
+    bool isAllocated(Handle handle) const
+    {
+        return handle >= 0 && static_cast<size_t>(handle) < Capacity && _allocated[handle];
+    }
+
+    bool isQueued(Handle handle) const
+    {
+        return isAllocated(handle) && _heapPos[handle] != NotQueued;
+    }
+
+    size_t getFreeSlots() const
+    {
+        return _freeCount;
+    }
+
+private:
+    static constexpr size_t NotQueued = std::numeric_limits<size_t>::max();
+
+    void push(Handle handle)
+    {
+        _heap[_heapSize] = handle;
+        _heapPos[handle] = _heapSize;
+        siftUp(_heapSize++);
+    }
+
+    void remove(size_t pos)
+    {
+        _heapPos[_heap[pos]] = NotQueued;
+        if (--_heapSize == pos)
+        {
+            return;
+        }
+        // fill the hole with the last element and restore heap order in either direction
+        const Handle moved = _heap[_heapSize];
+        place(pos, moved);
+        siftUp(pos);
+        siftDown(_heapPos[moved]);
+    }
+
+    void place(size_t pos, Handle handle)
+    {
+        _heap[pos] = handle;
+        _heapPos[handle] = pos;
+    }
+
+    void siftUp(size_t pos)
+    {
+        const Handle handle = _heap[pos];
+        while (pos > 0)
+        {
+            const size_t parent = (pos - 1) / 2;
+            if (_deadlines[_heap[parent]] <= _deadlines[handle])
+            {
+                break;
+            }
+            place(pos, _heap[parent]);
+            pos = parent;
+        }
+        place(pos, handle);
+    }
+
+    void siftDown(size_t pos)
+    {
+        const Handle handle = _heap[pos];
+        for (;;)
+        {
+            size_t child = 2 * pos + 1;
+            if (child >= _heapSize)
+            {
+                break;
+            }
+            if (child + 1 < _heapSize && _deadlines[_heap[child + 1]] < _deadlines[_heap[child]])
+            {
+                child++;
+            }
+            if (_deadlines[handle] <= _deadlines[_heap[child]])
+            {
+                break;
+            }
+            place(pos, _heap[child]);
+            pos = child;
+        }
+        place(pos, handle);
+    }
+
+    std::array<TIMEVAL, Capacity> _deadlines{};
+    std::array<bool, Capacity> _allocated{};
+    // heap of handles ordered by deadline and the reverse index to find a handle in it
+    std::array<Handle, Capacity> _heap{};
+    std::array<size_t, Capacity> _heapPos{};
+    size_t _heapSize{0};
+    std::array<Handle, Capacity> _freeList{};
+    size_t _freeCount{Capacity};
+};
+
+#ifdef BUILDCONFIG_CFTIMERS_LINEAR_QUEUE
+template <size_t Capacity>
+using TimerQueue = LinearTimerQueue<Capacity>;
+#else
+template <size_t Capacity>
+using TimerQueue = HeapTimerQueue<Capacity>;
+#endif
+
+} // namespace remote_control_device
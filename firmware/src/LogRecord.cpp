@@ -0,0 +1,221 @@
+#include "LogRecord.hpp"
+#include "SpecialAssert.hpp"
+#include <cstring>
+
+namespace remote_control_device
+{
+namespace
+{
+constexpr uint8_t FlagTruncated = 1 << 0;
+
+bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+// CRC-8 with polynomial 0x07, a nibble at a time
+constexpr std::array<uint8_t, 16> Crc8Nibbles = {
+    0x00, 0x07, 0x0E, 0x09, 0x1C, 0x1B, 0x12, 0x15,
+    0x38, 0x3F, 0x36, 0x31, 0x24, 0x23, 0x2A, 0x2D};
+
+uint8_t crc8(const uint8_t *data, size_t size)
+{
+    uint8_t crc = 0;
+    for (size_t i = 0; i < size; ++i)
+    {
+        crc ^= data[i];
+        crc = static_cast<uint8_t>((crc << 4) ^ Crc8Nibbles[crc >> 4]);
+        crc = static_cast<uint8_t>((crc << 4) ^ Crc8Nibbles[crc >> 4]);
+    }
+    return crc;
+}
+
+class ArgsWriter
+{
+public:
+    explicit ArgsWriter(LogRecord &record) : _record(record)
+    {
+    }
+
+    template <typename T>
+    void put(T value)
+    {
+        if (!fits(sizeof(T)))
+        {
+            return;
+        }
+        memcpy(&_record.args[_record.argsSize], &value, sizeof(T));
+        _record.argsSize += sizeof(T);
+    }
+
+    void putString(const char *str)
+    {
+        const size_t len = str == nullptr ? 0 : strnlen(str, LogRecord::MaxStringSize);
+        if (!fits(1 + len))
+        {
+            return;
+        }
+        _record.args[_record.argsSize++] = static_cast<uint8_t>(len);
+        memcpy(&_record.args[_record.argsSize], str, len);
+        _record.argsSize += len;
+    }
+
+private:
+    LogRecord &_record;
+
+    bool fits(size_t size)
+    {
+        if (_record.truncated || _record.argsSize + size > LogRecord::MaxArgsSize)
+        {
+            _record.truncated = true;
+            return false;
+        }
+        return true;
+    }
+};
+
+void put32(uint8_t *&out, uint32_t value)
+{
+    for (uint8_t i = 0; i < 4; ++i)
+    {
+        *out++ = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+} // namespace
+
+void LogRecord::encodeArgs(const char *format, va_list list)
+{
+    ArgsWriter writer(*this);
+    argsSize = 0;
+    truncated = false;
+
+    for (const char *c = format; *c != 0; ++c)
+    {
+        if (*c != '%')
+        {
+            continue;
+        }
+        ++c;
+        // flags, width and precision, * takes an int
+        while (*c == '-' || *c == '+' || *c == ' ' || *c == '#' || *c == '0')
+        {
+            ++c;
+        }
+        for (; isDigit(*c) || *c == '.' || *c == '*'; ++c)
+        {
+            if (*c == '*')
+            {
+                writer.put<int32_t>(va_arg(list, int));
+            }
+        }
+        uint8_t longs = 0;
+        for (; *c == 'l' || *c == 'h' || *c == 'z' || *c == 'j' || *c == 't'; ++c)
+        {
+            longs += *c == 'l' ? 1 : 0;
+        }
+
+        switch (*c)
+        {
+            case 'd':
+            case 'i':
+                if (longs >= 2)
+                {
+                    writer.put<int64_t>(va_arg(list, long long));
+                }
+                else if (longs == 1)
+                {
+                    writer.put<int32_t>(static_cast<int32_t>(va_arg(list, long)));
+                }
+                else
+                {
+                    writer.put<int32_t>(va_arg(list, int));
+                }
+                break;
+            case 'u':
+            case 'x':
+            case 'X':
+            case 'o':
+            case 'c':
+                if (longs >= 2)
+                {
+                    writer.put<uint64_t>(va_arg(list, unsigned long long));
+                }
+                else if (longs == 1)
+                {
+                    writer.put<uint32_t>(static_cast<uint32_t>(va_arg(list, unsigned long)));
+                }
+                else
+                {
+                    writer.put<uint32_t>(va_arg(list, unsigned int));
+                }
+                break;
+            case 'f':
+            case 'F':
+            case 'e':
+            case 'E':
+            case 'g':
+            case 'G':
+                writer.put<double>(va_arg(list, double));
+                break;
+            case 'p':
+                writer.put<uint32_t>(logId(static_cast<const char *>(va_arg(list, void *))));
+                break;
+            case 's':
+                writer.putString(va_arg(list, const char *));
+                break;
+            case 0:
+                // dangling % at the end
+                return;
+            default:
+                // %% and unsupported conversions take no argument
+                break;
+        }
+    }
+}
+
+size_t encodeLogFrame(const LogRecord &record, std::span<uint8_t> frame)
+{
+    specialAssert(frame.size() >= LogFrameMaxSize);
+
+    std::array<uint8_t, LogFramePayloadSize> payload{};
+    uint8_t *next = payload.data();
+    *next++ = LogFrameMagic;
+    put32(next, record.timestamp_ms);
+    put32(next, record.id);
+    *next++ = record.origin;
+    *next++ = record.level;
+    *next++ = record.truncated ? FlagTruncated : 0;
+    memcpy(next, record.args.data(), record.argsSize);
+    next += record.argsSize;
+    const auto size = static_cast<size_t>(next - payload.data());
+    *next = crc8(payload.data(), size);
+
+    // COBS, every block starts with the distance to the next zero
+    uint8_t *const out = frame.data();
+    size_t written = 0;
+    out[written++] = 0;
+    size_t code = written++;
+    uint8_t distance = 1;
+    for (size_t i = 0; i <= size; ++i)
+    {
+        if (payload[i] == 0)
+        {
+            out[code] = distance;
+            code = written++;
+            distance = 1;
+            continue;
+        }
+        out[written++] = payload[i];
+        if (++distance == 0xFF)
+        {
+            out[code] = distance;
+            code = written++;
+            distance = 1;
+        }
+    }
+    out[code] = distance;
+    out[written++] = 0;
+    return written;
+}
+
+} // namespace remote_control_device
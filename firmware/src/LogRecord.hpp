@@ -0,0 +1,74 @@
+#pragma once
+#include "SpanCompatibility.hpp"
+#include <array>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Log calls as compact binary records, see BUILDCONFIG_BINARY_LOGGING in Logging
+ *
+ * A record doesn't contain the message but the address of its format string as ID. Format strings
+ * are literals in flash, their address is fixed when linking, so LogDecoder.py looks the text up
+ * in the firmware's ELF. The arguments the format string asks for are copied raw, strings by
+ * value as they may not outlive the call.
+ *
+ * Records go to the terminal as frames: COBS encoded, with a CRC-8 and delimited by zero bytes.
+ * Text written to the terminal (UI, bring-up) never contains a zero byte, so the decoder can tell
+ * both apart and passes the text through.
+ */
+namespace remote_control_device
+{
+struct LogRecord
+{
+    static constexpr uint8_t MaxArgsSize = 32;
+    // longer strings are cut off
+    static constexpr uint8_t MaxStringSize = 16;
+    // reports dropped records, the count is its argument
+    static constexpr uint32_t DroppedId = 0;
+
+    uint32_t timestamp_ms{0};
+    uint32_t id{0};
+    uint8_t origin{0};
+    uint8_t level{0};
+    // arguments that didn't fit are missing
+    bool truncated{false};
+    uint8_t argsSize{0};
+    std::array<uint8_t, MaxArgsSize> args{};
+
+    /**
+     * @brief Copies the arguments format asks for, without formatting them
+     *
+     * Integers take 4 bytes, long long and doubles 8, strings a length byte and their
+     * characters. Little endian like the target.
+     *
+     * @param format printf style
+     * @param list arguments to format
+     */
+    void encodeArgs(const char *format, va_list list);
+};
+
+/**
+ * @brief ID of a format string
+ *
+ */
+inline uint32_t logId(const char *format)
+{
+    return static_cast<uint32_t>(reinterpret_cast<uintptr_t>(format));
+}
+
+// magic, timestamp, id, origin, level, flags, arguments and the CRC
+constexpr size_t LogFramePayloadSize = 1 + 4 + 4 + 1 + 1 + 1 + LogRecord::MaxArgsSize + 1;
+// COBS overhead and a delimiter on either side
+constexpr size_t LogFrameMaxSize = LogFramePayloadSize + (LogFramePayloadSize / 254) + 1 + 2;
+constexpr uint8_t LogFrameMagic = 0xB1;
+
+/**
+ * @brief Encodes record as frame
+ *
+ * @param frame at least LogFrameMaxSize
+ * @return size_t bytes of frame used
+ */
+size_t encodeLogFrame(const LogRecord &record, std::span<uint8_t> frame);
+
+} // namespace remote_control_device
@@ -12,13 +12,9 @@ namespace remote_control_device
 
 Logging::Logging(TerminalIO &terminalIO, wrapper::HAL &hal) : _terminalIO(terminalIO), _hal(hal)
 {
-    _mtx = xSemaphoreCreateRecursiveMutex();
+#ifndef BUILDCONFIG_BINARY_LOGGING
     _lastLogTimestamp = hal.GetTick();
-}
-
-Logging::~Logging()
-{
-    vSemaphoreDelete(_mtx);
+#endif
 }
 
 void Logging::logDebug(Logging::Origin orig, const char *msg, ...)
@@ -68,100 +64,257 @@ void Logging::vlog(Origin orig, Level lvl, const char *format, va_list args)
         return;
     }
 
-    if (xSemaphoreTakeRecursive(_mtx, MAX_WAITTIME) == pdFAIL)
+#ifdef BUILDCONFIG_BINARY_LOGGING
+    // nothing formatted, the TerminalIO task frames the record
+    const bool queued = _records.emplace([&](LogRecord &record) {
+        record.timestamp_ms = _hal.GetTick();
+        record.id = logId(format);
+        record.origin = static_cast<uint8_t>(orig);
+        record.level = static_cast<uint8_t>(lvl);
+        record.encodeArgs(format, args);
+    });
+#else
+    // origin and level are added by the TerminalIO task
+    Message message; // NOLINT
+    message.origin = orig;
+    message.level = lvl;
+    message.length = vsnprintf(message.text.data(), MESSAGE_SIZE, format, args);
+
+    // repeats of the message queued last are only counted, a flood keeps the slots free for others
+    const uint32_t hash = messageHash(message);
+    uint32_t last = _lastQueued.load(std::memory_order_relaxed);
+    while ((last >> RepeatBits) == hash && (last & RepeatMask) < RepeatMask)
     {
-        return;
+        if (_lastQueued.compare_exchange_weak(last, last + 1, std::memory_order_relaxed))
+        {
+            // reports the repeats after the timeout
+            _terminalIO.notifyLog();
+            return;
+        }
     }
 
-    // format current message
-    const int sizeMsgStart{
-        snprintf(_printBuffer, BUFFER_SIZE, "%s%s ", levelToString(lvl), originToString(orig))};
-    if (sizeMsgStart < 0)
+    // also when the count ran full, the TerminalIO task then adds the counts of both copies up
+    const bool queued = _messages.emplace([&](Message &slot) {
+        slot = message;
+        slot.repeatsBefore = static_cast<uint16_t>(
+            _lastQueued.exchange(hash << RepeatBits, std::memory_order_relaxed) & RepeatMask);
+    });
+#endif
+    if (queued)
     {
-        _terminalIO.write(FORMING_ERROR_MSG);
-        return;
+        _terminalIO.notifyLog();
     }
+}
 
-    const int sizeMsgBody{
-        vsnprintf(_printBuffer + sizeMsgStart, BUFFER_SIZE - sizeMsgStart, format, args)};
-    if (sizeMsgBody < 0)
+void Logging::writeRepeatMessageAfterTimeout()
+{
+    writeRepeatMessageAfterTimeout(false);
+}
+
+void Logging::writeRepeatMessageAfterTimeout(bool force)
+{
+#ifndef BUILDCONFIG_BINARY_LOGGING
+    if (_disabled)
     {
-        _terminalIO.write(FORMING_ERROR_MSG);
         return;
     }
+    if (force)
+    {
+        _forceRepeatMessage = true;
+    }
+    _terminalIO.notifyLog();
+#endif
+}
+
+uint32_t Logging::getDropped() const
+{
+#ifdef BUILDCONFIG_BINARY_LOGGING
+    return _records.getDropped();
+#else
+    return _messages.getDropped();
+#endif
+}
+
+uint32_t Logging::takeDropped()
+{
+    const uint32_t dropped = getDropped();
+    const uint32_t count = dropped - _reportedDropped;
+    _reportedDropped = dropped;
+    return count;
+}
 
-    if (static_cast<size_t>(sizeMsgStart + sizeMsgBody + 3) > BUFFER_SIZE)
+#ifdef BUILDCONFIG_BINARY_LOGGING
+size_t Logging::takeOutput(std::span<char> out)
+{
+    specialAssert(out.size() >= OUTPUT_SIZE);
+    const std::span<uint8_t> frame(reinterpret_cast<uint8_t *>(out.data()), out.size());
+
+    // the UI owns the terminal
+    while (_disabled && _records.consume([](const LogRecord &) {}))
     {
-        _terminalIO.write("Message too large!\r\n\0");
-        return;
     }
-    else
+    if (_disabled)
+    {
+        takeDropped();
+        return 0;
+    }
+
+    size_t size = 0;
+    if (_records.consume([&](const LogRecord &record) { size = encodeLogFrame(record, frame); }))
+    {
+        return size;
+    }
+
+    // the dropped records came after everything that was queued
+    const uint32_t dropped = takeDropped();
+    if (dropped == 0)
     {
-        strncpy(_printBuffer + sizeMsgStart + sizeMsgBody, "\r\n\0", 3);
+        return 0;
     }
+    LogRecord record;
+    record.timestamp_ms = _hal.GetTick();
+    record.id = LogRecord::DroppedId;
+    memcpy(record.args.data(), &dropped, sizeof(dropped));
+    record.argsSize = sizeof(dropped);
+    return encodeLogFrame(record, frame);
+}
+#else
+size_t Logging::takeOutput(std::span<char> out)
+{
+    static constexpr uint32_t MS_TO_SEC = 1000;
+    specialAssert(out.size() >= OUTPUT_SIZE);
 
-    // check if duplicate
-    if (strncmp(_printBuffer, _lastLogText, BUFFER_SIZE) == 0)
+    // the UI owns the terminal
+    while (_disabled && _messages.consume([](const Message &) {}))
     {
-        _lastLogRepeats++;
     }
-    else
+    if (_disabled)
     {
-        // store this message as template for comparison, also save it
-        // from being overwritten by writeRepeatMessageAfterTimeout's buffer usage
-        strncpy(_lastLogText, _printBuffer, BUFFER_SIZE);
-        writeRepeatMessageAfterTimeout(true);
-        _lastLogRepeats = 0;
-        // if buffer is chosen so small that not even the message too large message fits
-        // no \0 is added by strncpy,  printf and derivates on the other hand will add \0
-        _lastLogText[BUFFER_SIZE - 1] = '\0';
+        takeDropped();
+        takeRepeats();
+        return 0;
+    }
 
-        const size_t len{std::min(strlen(_lastLogText), BUFFER_SIZE)};
-        _terminalIO.write(std::span(_lastLogText, len));
+    if (_lastLogPending)
+    {
+        _lastLogPending = false;
+        _lastLogTimestamp = _hal.GetTick();
+        const size_t len{strlen(_lastLogText)};
+        memcpy(out.data(), _lastLogText, len);
+        return len;
+    }
 
+    size_t size = 0;
+    while (_messages.consume([&](const Message &message) {
+        _lastLogRepeats += message.repeatsBefore;
+        size = formatMessage(message, out);
+    }))
+    {
+        // check if duplicate
+        if (strncmp(out.data(), _lastLogText, BUFFER_SIZE) == 0)
+        {
+            _lastLogRepeats++;
+            continue;
+        }
+
+        // store this message as template for comparison
+        memcpy(_lastLogText, out.data(), size + 1);
+        if (_lastLogRepeats > 0)
+        {
+            _lastLogPending = true;
+            return formatRepeatMessage(out);
+        }
         _lastLogTimestamp = _hal.GetTick();
+        return size;
     }
 
-    xSemaphoreGiveRecursive(_mtx);
+    // the dropped messages came after everything that was queued
+    const uint32_t dropped = takeDropped();
+    if (dropped > 0)
+    {
+        const int len{
+            snprintf(out.data(), out.size(), "... %lu log messages dropped\r\n", dropped)};
+        return len > 0 ? len : 0;
+    }
+
+    // repeats of the last message since
+    _lastLogRepeats += takeRepeats();
+    const bool force = _forceRepeatMessage.exchange(false);
+    if (_lastLogRepeats > 0 &&
+        (force || (_hal.GetTick() - _lastLogTimestamp >= REPEAT_MSG_TIMEOUT_SEC * MS_TO_SEC)))
+    {
+        return formatRepeatMessage(out);
+    }
+    return 0;
 }
 
-void Logging::writeRepeatMessageAfterTimeout()
+uint32_t Logging::messageHash(const Message &message)
 {
-    writeRepeatMessageAfterTimeout(false);
+    // FNV-1a, what the TerminalIO task compares: level, origin and text
+    static constexpr uint32_t Prime = 16777619U;
+    uint32_t hash = 2166136261U;
+    auto add = [&hash](uint8_t byte) { hash = (hash ^ byte) * Prime; };
+    add(static_cast<uint8_t>(message.level));
+    add(static_cast<uint8_t>(message.origin));
+    const auto length = static_cast<size_t>(
+        std::clamp<int32_t>(message.length, 0, static_cast<int32_t>(MESSAGE_SIZE) - 1));
+    for (size_t i = 0; i < length; ++i)
+    {
+        add(static_cast<uint8_t>(message.text[i]));
+    }
+    // 0 is no message queued yet
+    hash >>= RepeatBits;
+    return hash != 0 ? hash : 1;
 }
 
-void Logging::writeRepeatMessageAfterTimeout(bool force)
+uint32_t Logging::takeRepeats()
 {
-    if (_lastLogRepeats == 0 || _disabled)
+    uint32_t last = _lastQueued.load(std::memory_order_relaxed);
+    while ((last & RepeatMask) != 0 &&
+           !_lastQueued.compare_exchange_weak(last, last & ~RepeatMask, std::memory_order_relaxed))
     {
-        return;
     }
-    static constexpr uint32_t MS_TO_SEC = 1000;
+    return last & RepeatMask;
+}
 
-    if (force || (_hal.GetTick() - _lastLogTimestamp >= REPEAT_MSG_TIMEOUT_SEC * MS_TO_SEC))
+size_t Logging::formatMessage(const Message &message, std::span<char> out)
+{
+    // format current message
+    const int sizeMsgStart{snprintf(out.data(), BUFFER_SIZE, "%s%s ",
+                                    levelToString(message.level), originToString(message.origin))};
+    if (sizeMsgStart < 0 || message.length < 0)
     {
-        if (xSemaphoreTakeRecursive(_mtx, MAX_WAITTIME) == pdFAIL)
-        {
-            return;
-        }
+        strncpy(out.data(), FORMING_ERROR_MSG, BUFFER_SIZE);
+        return strlen(FORMING_ERROR_MSG);
+    }
 
-        const int size{snprintf(_printBuffer, BUFFER_SIZE,
-                                "... was repeated %d more times the last %d second(s)\r\n",
-                                _lastLogRepeats, REPEAT_MSG_TIMEOUT_SEC)};
-        if (size > 0)
-        {
-            _terminalIO.write(std::span(_printBuffer, size));
-        }
-        else
-        {
-            _terminalIO.write(FORMING_ERROR_MSG);
-        }
+    if (message.length >= static_cast<int32_t>(MESSAGE_SIZE) ||
+        static_cast<size_t>(sizeMsgStart + message.length + 3) > BUFFER_SIZE)
+    {
+        strncpy(out.data(), TOO_LARGE_MSG, BUFFER_SIZE);
+        return strlen(TOO_LARGE_MSG);
+    }
 
-        _lastLogTimestamp = _hal.GetTick();
-        _lastLogRepeats = 0;
-        xSemaphoreGiveRecursive(_mtx);
+    memcpy(out.data() + sizeMsgStart, message.text.data(), message.length);
+    strncpy(out.data() + sizeMsgStart + message.length, "\r\n", 3);
+    return sizeMsgStart + message.length + 2;
+}
+
+size_t Logging::formatRepeatMessage(std::span<char> out)
+{
+    const int size{snprintf(out.data(), BUFFER_SIZE,
+                            "... was repeated %lu more times the last %d second(s)\r\n",
+                            static_cast<unsigned long>(_lastLogRepeats), REPEAT_MSG_TIMEOUT_SEC)};
+    _lastLogTimestamp = _hal.GetTick();
+    _lastLogRepeats = 0;
+    if (size < 0)
+    {
+        strncpy(out.data(), FORMING_ERROR_MSG, BUFFER_SIZE);
+        return strlen(FORMING_ERROR_MSG);
     }
+    return size;
 }
+#endif
 
 const char *Logging::levelToString(Level lvl)
 {
@@ -1,8 +1,12 @@
 #pragma once
+#include "LogRecord.hpp"
+#include "SpanCompatibility.hpp"
+#include "Wrapper/MpscRing.hpp"
 #include <FreeRTOS.h>
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <cstdarg>
-#include <semphr.h>
 
 namespace wrapper
 {
@@ -23,7 +27,7 @@ public:
      * @param hal instalce
      */
     Logging(TerminalIO &terminalIO, wrapper::HAL &hal);
-    virtual ~Logging();
+    virtual ~Logging() = default;
 
     Logging(const Logging &) = delete;
     Logging(Logging &&) = delete;
@@ -53,7 +57,16 @@ public:
 
     /**
      * @brief Writes a log message to be sent via TerminalIO
-     * Has light flood protection against same messages. Do not call from ISR
+     * Has light flood protection against same messages.
+     *
+     * Callable from tasks and ISRs alike, never blocks: the message is formatted and queued in a
+     * lock free ring (wrapper::MpscRing) and the TerminalIO task sends it. A message equal to the
+     * one queued last is only counted, it doesn't take a slot, so a flood can't crowd out other
+     * messages. Messages finding the ring full are counted and reported as dropped once it ran
+     * empty. From ISRs avoid floats, newlib allocates to format them.
+     *
+     * With BUILDCONFIG_BINARY_LOGGING the message isn't formatted, a LogRecord is queued
+     * instead, see LogRecord.hpp. No flood protection then.
      *
      * @param orig Module log originates from
      * @param lvl Importance
@@ -68,7 +81,7 @@ public:
     virtual void vlog(Origin orig, Level lvl, const char *msg, va_list arg);
 
     /**
-     * @brief Call periodically to send the "Repeated n times..." message
+     * @brief Lets the TerminalIO task send the "Repeated n times..." message
      * Message is only printed every REPEAT_MSG_TIMEOUT time or
      * or new, different log is submitted
      *
@@ -88,6 +101,26 @@ public:
         _disabled = true;
     }
 
+    bool isDisabled() const
+    {
+        return _disabled;
+    }
+
+    /**
+     * @brief Takes the next line to transmit (a frame with BUILDCONFIG_BINARY_LOGGING), only
+     * from the TerminalIO task. Discards everything while logging is disabled
+     *
+     * @param out at least OUTPUT_SIZE
+     * @return size_t bytes of out used, 0 nothing to send
+     */
+    size_t takeOutput(std::span<char> out);
+
+    /**
+     * @brief Messages lost to a full ring since startup
+     *
+     */
+    uint32_t getDropped() const;
+
     /**
      * @brief Max allowed size per log
      *
@@ -95,10 +128,19 @@ public:
     static constexpr size_t BUFFER_SIZE = 100;
 
     /**
-     * @brief Max waittime for log mutex
+     * @brief Max size of the message without origin and level
+     *
+     */
+    static constexpr size_t MESSAGE_SIZE = 80;
+
+    /**
+     * @brief Messages waiting for the TerminalIO task, RAM is tight
      *
      */
-    static constexpr TickType_t MAX_WAITTIME = pdMS_TO_TICKS(10);
+    static constexpr size_t QUEUE_SIZE = 4;
+    static constexpr size_t RECORD_QUEUE_SIZE = 16;
+
+    static constexpr size_t OUTPUT_SIZE = std::max(BUFFER_SIZE, LogFrameMaxSize);
 
     /**
      * @brief See writeRepeatMessageAfterTimeout description
@@ -110,16 +152,53 @@ public:
     static const char *levelToString(Level lvl);
 
     static constexpr const char *FORMING_ERROR_MSG = "Forming message failed\r\n";
+    static constexpr const char *TOO_LARGE_MSG = "Message too large!\r\n";
 
 private:
-    char _printBuffer[BUFFER_SIZE] = {0}; // NOLINT
-    SemaphoreHandle_t _mtx;
+    struct Message
+    {
+        Origin origin;
+        Level level;
+        // of the message queued before, counted by the producers
+        uint16_t repeatsBefore;
+        // of vsnprintf, negative when forming failed
+        int32_t length;
+        std::array<char, MESSAGE_SIZE> text;
+    };
+
     TerminalIO &_terminalIO;
     wrapper::HAL &_hal;
     bool _disabled{false};
+    uint32_t _reportedDropped{0};
 
+#ifdef BUILDCONFIG_BINARY_LOGGING
+    wrapper::MpscRing<LogRecord, RECORD_QUEUE_SIZE> _records;
+#else
+    wrapper::MpscRing<Message, QUEUE_SIZE> _messages;
+
+    // hash of the message queued last and how often it was repeated since, see vlog
+    static constexpr uint32_t RepeatBits = 10;
+    static constexpr uint32_t RepeatMask = (1U << RepeatBits) - 1;
+    std::atomic<uint32_t> _lastQueued{0};
+
+    // only the TerminalIO task
     char _lastLogText[BUFFER_SIZE] = {0}; // NOLINT
-    uint16_t _lastLogRepeats = 0;
+    uint32_t _lastLogRepeats = 0;
     uint32_t _lastLogTimestamp;
+    // _lastLogText waits for the repeat message to be sent
+    bool _lastLogPending{false};
+    std::atomic<bool> _forceRepeatMessage{false};
+
+    static uint32_t messageHash(const Message &message);
+    uint32_t takeRepeats();
+    size_t formatMessage(const Message &message, std::span<char> out);
+    size_t formatRepeatMessage(std::span<char> out);
+#endif
+
+    /**
+     * @brief Dropped since the last call
+     *
+     */
+    uint32_t takeDropped();
 };
 } // namespace remote_control_device
\ No newline at end of file
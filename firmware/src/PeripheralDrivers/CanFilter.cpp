@@ -0,0 +1,197 @@
+#include "CanFilter.hpp"
+#include <algorithm>
+
+namespace remote_control_device
+{
+
+bool CanFilter::addId(uint16_t cobId)
+{
+    if (contains(cobId))
+    {
+        return true;
+    }
+    if (cobId > StdIdMask || _idCount >= _ids.size())
+    {
+        // an incomplete filter would drop frames we need
+        _rejectedId = true;
+        return false;
+    }
+    _ids[_idCount++] = cobId;
+    return true;
+}
+
+bool CanFilter::contains(uint16_t cobId) const
+{
+    return std::find(_ids.begin(), _ids.begin() + _idCount, cobId) != _ids.begin() + _idCount;
+}
+
+uint8_t CanFilter::build(Banks &banks) const
+{
+    if (_idCount == 0 || _rejectedId)
+    {
+        return 0;
+    }
+
+    std::array<uint16_t, MaxIds> ids = _ids;
+    std::sort(ids.begin(), ids.begin() + _idCount);
+    std::array<bool, MaxIds> covered{};
+    auto indexOf = [&ids, this](uint16_t cobId) -> int8_t {
+        const auto it = std::lower_bound(ids.begin(), ids.begin() + _idCount, cobId);
+        return (it == ids.begin() + _idCount || *it != cobId)
+                   ? -1
+                   : static_cast<int8_t>(it - ids.begin());
+    };
+
+    // Greedy search for groups of ids only differing in some "don't care" bits, largest first.
+    // A mask entry takes the space of two list entries so it has to replace at least three.
+    static constexpr uint8_t MaxDontCareBits = 3;
+    static constexpr uint8_t MinIdsPerMaskEntry = 3;
+    std::array<MaskEntry, BankCount * 2> masks{};
+    uint8_t maskCount = 0;
+    for (uint8_t dontCareBits = MaxDontCareBits; dontCareBits >= 2; --dontCareBits)
+    {
+        for (;;)
+        {
+            MaskEntry best{0, 0};
+            uint8_t bestUncovered = 0;
+            for (uint16_t dontCare = 1; dontCare <= StdIdMask; ++dontCare)
+            {
+                if (__builtin_popcount(dontCare) != dontCareBits)
+                {
+                    continue;
+                }
+                for (uint8_t i = 0; i < _idCount; ++i)
+                {
+                    if (covered[i])
+                    {
+                        continue;
+                    }
+                    // every id matching base / dontCare has to be consumed
+                    const uint16_t base = ids[i] & ~dontCare;
+                    uint8_t uncovered = 0;
+                    bool complete = true;
+                    for (uint16_t sub = dontCare;; sub = (sub - 1) & dontCare)
+                    {
+                        const int8_t idx = indexOf(base | sub);
+                        if (idx < 0)
+                        {
+                            complete = false;
+                            break;
+                        }
+                        uncovered += covered[idx] ? 0 : 1;
+                        if (sub == 0)
+                        {
+                            break;
+                        }
+                    }
+                    if (complete && uncovered > bestUncovered)
+                    {
+                        best = {base, static_cast<uint16_t>(StdIdMask & ~dontCare)};
+                        bestUncovered = uncovered;
+                    }
+                }
+            }
+
+            if (bestUncovered < MinIdsPerMaskEntry || maskCount >= masks.size())
+            {
+                break;
+            }
+            masks[maskCount++] = best;
+            for (uint8_t i = 0; i < _idCount; ++i)
+            {
+                covered[i] = covered[i] || (ids[i] & best.mask) == best.id;
+            }
+        }
+    }
+
+    std::array<uint16_t, MaxIds> singles{};
+    uint8_t singleCount = 0;
+    for (uint8_t i = 0; i < _idCount; ++i)
+    {
+        if (!covered[i])
+        {
+            singles[singleCount++] = ids[i];
+        }
+    }
+
+    // fill up the free half of a mask bank
+    if ((maskCount % 2) == 1 && singleCount > 0)
+    {
+        masks[maskCount++] = {singles[--singleCount], StdIdMask};
+    }
+
+    const uint8_t maskBanks = (maskCount + 1) / 2;
+    const uint8_t listBanks = (singleCount + 3) / 4;
+    if (maskBanks + listBanks > BankCount)
+    {
+        return 0;
+    }
+
+    uint8_t bank = 0;
+    auto initBank = [&banks, &bank](uint32_t mode) -> CAN_FilterTypeDef & {
+        CAN_FilterTypeDef &conf = banks[bank];
+        conf.FilterBank = bank++;
+        conf.FilterMode = mode;
+        conf.FilterScale = CAN_FILTERSCALE_16BIT;
+        conf.FilterFIFOAssignment = CAN_FILTER_FIFO0;
+        conf.FilterActivation = CAN_FILTER_ENABLE;
+        conf.SlaveStartFilterBank = BankCount;
+        return conf;
+    };
+
+    for (uint8_t i = 0; i < maskCount; i += 2)
+    {
+        // odd count only happens without singles, repeat the entry
+        const MaskEntry &first = masks[i];
+        const MaskEntry &second = masks[std::min<uint8_t>(i + 1, maskCount - 1)];
+        CAN_FilterTypeDef &conf = initBank(CAN_FILTERMODE_IDMASK);
+        conf.FilterIdLow = toReg16Id(first.id);
+        conf.FilterMaskIdLow = toReg16Mask(first.mask);
+        conf.FilterIdHigh = toReg16Id(second.id);
+        conf.FilterMaskIdHigh = toReg16Mask(second.mask);
+    }
+
+    for (uint8_t i = 0; i < singleCount; i += 4)
+    {
+        // unused slots repeat the last id
+        auto id = [&](uint8_t offset) {
+            return toReg16Id(singles[std::min<uint8_t>(i + offset, singleCount - 1)]);
+        };
+        CAN_FilterTypeDef &conf = initBank(CAN_FILTERMODE_IDLIST);
+        conf.FilterIdLow = id(0);
+        conf.FilterMaskIdLow = id(1);
+        conf.FilterIdHigh = id(2);
+        conf.FilterMaskIdHigh = id(3);
+    }
+
+    return bank;
+}
+
+CAN_FilterTypeDef CanFilter::acceptAll()
+{
+    CAN_FilterTypeDef conf;
+    conf.FilterIdHigh = 0;
+    conf.FilterIdLow = 0;
+    conf.FilterMaskIdHigh = 0;
+    conf.FilterMaskIdLow = 0;
+    conf.FilterFIFOAssignment = CAN_FILTER_FIFO0;
+    conf.FilterBank = 0;
+    conf.FilterMode = CAN_FILTERMODE_IDMASK;
+    conf.FilterScale = CAN_FILTERSCALE_32BIT;
+    conf.FilterActivation = CAN_FILTER_ENABLE;
+    conf.SlaveStartFilterBank = BankCount;
+    return conf;
+}
+
+uint16_t CanFilter::toReg16Id(uint16_t cobId)
+{
+    // RTR and IDE cleared: standard data frames
+    return static_cast<uint16_t>(cobId << Reg16_StdIdShift);
+}
+
+uint16_t CanFilter::toReg16Mask(uint16_t idMask)
+{
+    return static_cast<uint16_t>((idMask << Reg16_StdIdShift) | Reg16_RTR | Reg16_IDE);
+}
+
+} // namespace remote_control_device
@@ -0,0 +1,89 @@
+#pragma once
+#include <FreeRTOS.h>
+#include <array>
+#include <stm32f3xx_hal.h>
+
+/**
+ * @brief Packs the standard COB-IDs a node consumes into as few bxCAN filter banks as possible
+ *
+ * Only exact filters are generated, no foreign id passes. Every bank is used in 16 bit scale,
+ * either as list (4 ids) or as mask (2 id / mask pairs). Groups of ids that differ in only
+ * some bits (e.g. heartbeats 0x720, 0x721, 0x730, 0x731) are merged into a single mask
+ * entry when that saves list slots. Only data frames with standard ids are accepted.
+ */
+namespace remote_control_device
+{
+
+class CanFilter
+{
+public:
+    CanFilter() = default;
+    ~CanFilter() = default;
+
+    /**
+     * @brief Filter banks of the STM32F302's bxCAN
+     *
+     */
+    static constexpr uint8_t BankCount = 14;
+    static constexpr uint8_t MaxIds = 32;
+
+    /**
+     * @brief Adds a COB-ID to accept, duplicates are ignored
+     *
+     * @param cobId standard 11 bit id
+     * @return true added or already present
+     * @return false id invalid or no space left, build() will fail
+     */
+    bool addId(uint16_t cobId);
+
+    /**
+     * @brief Number of distinct ids added
+     *
+     */
+    uint8_t getIdCount() const
+    {
+        return _idCount;
+    }
+
+    using Banks = std::array<CAN_FilterTypeDef, BankCount>;
+
+    /**
+     * @brief Generates the bank configurations
+     *
+     * @param banks target, entries after the returned count are left untouched
+     * @return uint8_t number of used banks, 0 if an id was rejected, the ids don't fit or
+     * no id was added
+     */
+    uint8_t build(Banks &banks) const;
+
+    /**
+     * @brief Accepts everything, used until the consumed ids are known
+     *
+     * @return CAN_FilterTypeDef 32 bit mask filter for bank 0
+     */
+    static CAN_FilterTypeDef acceptAll();
+
+private:
+    static constexpr uint16_t StdIdMask = 0x7FF;
+    // 16 bit filter register layout: STID[10:0] RTR IDE EXID[17:15]
+    static constexpr uint8_t Reg16_StdIdShift = 5;
+    static constexpr uint16_t Reg16_RTR = 1 << 4;
+    static constexpr uint16_t Reg16_IDE = 1 << 3;
+
+    struct MaskEntry
+    {
+        uint16_t id;
+        uint16_t mask;
+    };
+
+    std::array<uint16_t, MaxIds> _ids{};
+    uint8_t _idCount{0};
+    bool _rejectedId{false};
+
+    bool contains(uint16_t cobId) const;
+
+    static uint16_t toReg16Id(uint16_t cobId);
+    static uint16_t toReg16Mask(uint16_t idMask);
+};
+
+} // namespace remote_control_device
@@ -1,10 +1,14 @@
 #include "CanIO.hpp"
+#include "ANSIEscapeCodes.hpp"
 #include "BuildConfiguration.hpp"
-#include "CanFestivalLocker.hpp"
+#include "CanFilter.hpp"
 #include "Logging.hpp"
 #include "SpecialAssert.hpp"
+#include "Statemachine/Canopen.hpp"
+#include "TerminalWriter.hpp"
 #include "Wrapper/Sync.hpp"
 #include <cmsis_os.h>
+#include <cstdio>
 #include <limits>
 #include <task.h>
 
@@ -12,8 +16,8 @@ namespace remote_control_device
 {
 CanIO *CanIO::_instance{nullptr};
 
-CanIO::CanIO(CAN_HandleTypeDef &can, Logging &log)
-    : _can(can), _log(log),
+CanIO::CanIO(CAN_HandleTypeDef &can, wrapper::HAL &hal, Logging &log)
+    : _can(can), _hal(hal), _log(log),
       _task(&CanIO::taskMain, "CanIO", StackSize, reinterpret_cast<void *>(this),
             osPriority_t::osPriorityHigh, wrapper::sync::CanIO_Ready)
 
@@ -21,15 +25,16 @@ CanIO::CanIO(CAN_HandleTypeDef &can, Logging &log)
     specialAssert(_instance == nullptr);
     _instance = this;
 
-    _txQueue = xQueueCreate(QUEUES_SIZE, sizeof(Message));
-    _rxQueue = xQueueCreate(QUEUES_SIZE, sizeof(Message));
     // Tx
     HAL_CAN_RegisterCallback(&_can, HAL_CAN_TX_MAILBOX0_COMPLETE_CB_ID,
-                             &CanIO::cbTxMailboxCompleteISR);
+                             &CanIO::cbTxMailbox0CompleteISR);
     HAL_CAN_RegisterCallback(&_can, HAL_CAN_TX_MAILBOX1_COMPLETE_CB_ID,
-                             &CanIO::cbTxMailboxCompleteISR);
+                             &CanIO::cbTxMailbox1CompleteISR);
     HAL_CAN_RegisterCallback(&_can, HAL_CAN_TX_MAILBOX2_COMPLETE_CB_ID,
-                             &CanIO::cbTxMailboxCompleteISR);
+                             &CanIO::cbTxMailbox2CompleteISR);
+    HAL_CAN_RegisterCallback(&_can, HAL_CAN_TX_MAILBOX0_ABORT_CB_ID, &CanIO::cbTxMailbox0AbortISR);
+    HAL_CAN_RegisterCallback(&_can, HAL_CAN_TX_MAILBOX1_ABORT_CB_ID, &CanIO::cbTxMailbox1AbortISR);
+    HAL_CAN_RegisterCallback(&_can, HAL_CAN_TX_MAILBOX2_ABORT_CB_ID, &CanIO::cbTxMailbox2AbortISR);
 
     // Rx
     HAL_CAN_RegisterCallback(&_can, HAL_CAN_RX_FIFO0_MSG_PENDING_CB_ID, &CanIO::cbRxMsgPending0ISR);
@@ -42,20 +47,13 @@ CanIO::CanIO(CAN_HandleTypeDef &can, Logging &log)
     HAL_CAN_RegisterCallback(&_can, HAL_CAN_RX_FIFO0_FULL_CB_ID, &CanIO::cbOverloadISR);
     HAL_CAN_RegisterCallback(&_can, HAL_CAN_RX_FIFO1_FULL_CB_ID, &CanIO::cbOverloadISR);
 
-    CAN_FilterTypeDef conf;
-    static constexpr uint8_t BankCount = 13;
-    for (uint8_t i = 0; i < BankCount; ++i)
+    // accept everything until canopen knows which ids it consumes
+    CAN_FilterTypeDef conf = CanFilter::acceptAll();
+    HAL_CAN_ConfigFilter(&_can, &conf);
+    for (uint8_t i = 1; i < CanFilter::BankCount; ++i)
     {
-        // mask filter that lets everythign through
-        conf.FilterIdHigh = 0;
-        conf.FilterIdLow = 0;
-        conf.FilterMaskIdHigh = 0;
-        conf.FilterMaskIdLow = 0;
-        conf.FilterFIFOAssignment = CAN_FILTER_FIFO0;
         conf.FilterBank = i;
-        conf.FilterMode = CAN_FILTERMODE_IDMASK;   // CAN_filter_mode
-        conf.FilterScale = CAN_FILTERSCALE_32BIT;  // CAN_filter_scale
-        conf.FilterActivation = CAN_FILTER_ENABLE; // CAN_filter_activation
+        conf.FilterActivation = CAN_FILTER_DISABLE;
         HAL_CAN_ConfigFilter(&_can, &conf);
     }
 
@@ -86,58 +84,13 @@ CanIO::~CanIO()
 
 void CanIO::dispatch(uint32_t flags)
 {
+    const uint32_t now = _hal.GetTick();
+    updateBusLoad(now);
+
     /* Sending queued frames */
     if ((flags & CanIO::NOTIFY_ATTEMPT_TX) > 0)
     {
-        volatile uint8_t freeMailboxes = HAL_CAN_GetTxMailboxesFreeLevel(&_can);
-        uint8_t filledMailboxes = 0;
-
-        for (uint8_t i = 0; i < freeMailboxes; ++i)
-        {
-            Message m;
-            BaseType_t ret = xQueueReceive(_txQueue, reinterpret_cast<void *>(&m), 0);
-            if (ret == errQUEUE_EMPTY)
-            {
-                break;
-            }
-
-            CAN_TxHeaderTypeDef header;
-            header.StdId = m.cob_id;
-            header.IDE = CAN_ID_STD;
-            if (m.rtr)
-            {
-                header.RTR = CAN_RTR_REMOTE;
-            }
-            else
-            {
-                header.RTR = CAN_RTR_DATA;
-            }
-            header.DLC = m.len;
-            header.TransmitGlobalTime = DISABLE;
-
-            uint32_t targetMailbox = 0;
-            volatile HAL_StatusTypeDef status =
-                HAL_CAN_AddTxMessage(&_can, &header, m.data, &targetMailbox);
-            if (status != HAL_StatusTypeDef::HAL_OK)
-            {
-                testing_TxFailed();
-                _task.notify(CanIO::NOTIFY_ATTEMPT_TX, eNotifyAction::eSetBits);
-                _log.logError(Logging::Origin::CanIO, "Unable to send frame with COBId %d",
-                              m.cob_id);
-            }
-            filledMailboxes++;
-        }
-
-        // isr fires continuously when there are free mailboxes
-        // no use in using up cpu with this when there is little traffic
-        if (filledMailboxes == 3)
-        {
-            HAL_CAN_ActivateNotification(&_can, CAN_IT_TX_MAILBOX_EMPTY);
-        }
-        else
-        {
-            HAL_CAN_DeactivateNotification(&_can, CAN_IT_TX_MAILBOX_EMPTY);
-        }
+        dispatchTX(now);
     }
 
     /* dispatch received frames to canfestival */
@@ -150,14 +103,8 @@ void CanIO::dispatch(uint32_t flags)
             _busOK = true;
             _log.logInfo(Logging::Origin::CanIO, "Bus connection recovered");
         }
-        {
-            CFLocker locker;
-            Message m;
-            while (xQueueReceive(_rxQueue, reinterpret_cast<void *>(&m), 0) != errQUEUE_EMPTY)
-            {
-                canDispatch(locker.getOD(), &m);
-            }
-        }
+        // comes back to dispatchRX, right away or from the actor task
+        _canopen->processRXFrames();
     }
 
     if ((flags & CanIO::NOTIFY_ERROR) > 0)
@@ -170,15 +117,276 @@ void CanIO::dispatch(uint32_t flags)
     if ((flags & CanIO::NOTIFY_OVERLOAD) > 0)
     {
         testing_Overload();
-        _log.logWarning(Logging::Origin::CanIO, "RX overload");
+        _log.logWarning(Logging::Origin::CanIO, "RX overload, %lu frames dropped so far",
+                        getRxDroppedCount());
+    }
+}
+
+void CanIO::dispatchRX(CO_Data *d)
+{
+    // only what is there now, frames arriving meanwhile come with their own notification
+    const size_t batch = _rxRing.size();
+    Message m;
+    for (size_t i = 0; i < batch && _rxRing.pop(m); ++i)
+    {
+        canDispatch(d, &m);
+    }
+}
+
+void CanIO::configureAcceptanceFilters(const CanFilter &filter)
+{
+    CanFilter::Banks banks;
+    const uint8_t usedBanks = filter.build(banks);
+    if (usedBanks == 0)
+    {
+        _log.logWarning(Logging::Origin::CanIO, "No acceptance filter for %d COB-IDs, accepting all",
+                        filter.getIdCount());
+        return;
+    }
+
+    // bank 0 is overwritten first so the pass all filter is gone from here on
+    for (uint8_t i = 0; i < usedBanks; ++i)
+    {
+        HAL_CAN_ConfigFilter(&_can, &banks[i]);
+    }
+    CAN_FilterTypeDef conf = CanFilter::acceptAll();
+    conf.FilterActivation = CAN_FILTER_DISABLE;
+    for (uint8_t i = usedBanks; i < CanFilter::BankCount; ++i)
+    {
+        conf.FilterBank = i;
+        HAL_CAN_ConfigFilter(&_can, &conf);
+    }
+    _log.logInfo(Logging::Origin::CanIO, "Accepting %d COB-IDs using %d filter banks",
+                 filter.getIdCount(), usedBanks);
+}
+
+CanTrafficSnapshot CanIO::getTrafficSnapshot()
+{
+    updateBusLoad(_hal.GetTick());
+    return _traffic.getSnapshot();
+}
+
+void CanIO::resetTrafficStatistics()
+{
+    _traffic.reset();
+}
+
+void CanIO::drawUITrafficPart(TerminalWriter &term)
+{
+    term.write(ANSIEscapeCodes::ColorSection_WhiteText_GrayBackground);
+    term.write("\r\nCAN Bus:\r\n");
+    term.write(ANSIEscapeCodes::ColorSection_End);
+
+    updateBusLoad(_hal.GetTick());
+    const CanTrafficTotals totals = _traffic.getTotals();
+
+    static constexpr size_t buffSize = 80;
+    char buff[buffSize] = {0};
+    snprintf(buff, buffSize, "Load: %u.%u%% (peak %u.%u%%)\r\n", totals.busLoad_permille / 10,
+             totals.busLoad_permille % 10, totals.peakBusLoad_permille / 10,
+             totals.peakBusLoad_permille % 10);
+    term.write(buff);
+    snprintf(buff, buffSize,
+             "Mailboxes full: %lu, dropped RX / TX: %lu / %lu, untracked: %lu\r\n",
+             totals.mailboxFullEvents, totals.rxDropped, totals.txDropped,
+             totals.untrackedFrames);
+    term.write(buff);
+
+    // slot by slot, a whole snapshot is a lot for the UI task's stack
+    term.write("COB-ID: RX, TX frames, TX residency avg / max (ms):\r\n");
+    for (uint8_t i = 0; i < CanTrafficSnapshot::MaxCobIds; ++i)
+    {
+        CanCobIdCounters counters;
+        if (!_traffic.getCobIdCounters(i, counters))
+        {
+            continue;
+        }
+        const uint32_t avgResidency =
+            counters.txFrames > 0 ? counters.totalTxResidency_ms / counters.txFrames : 0;
+        snprintf(buff, buffSize, "\t0x%03x: %lu, %lu, %lu / %u\r\n", counters.cobId,
+                 counters.rxFrames, counters.txFrames, avgResidency, counters.maxTxResidency_ms);
+        term.write(buff);
+        if (counters.syncFrames > 0)
+        {
+            snprintf(buff, buffSize, "\t       after SYNC %lu - %lu us, jitter %lu us\r\n",
+                     counters.minSyncOffset_us, counters.maxSyncOffset_us,
+                     counters.maxSyncOffset_us - counters.minSyncOffset_us);
+            term.write(buff);
+        }
+    }
+}
+
+void CanIO::updateBusLoad(uint32_t now)
+{
+    // called by the CanIO and the UI task
+    taskENTER_CRITICAL();
+    _traffic.updateBusLoad(now);
+    taskEXIT_CRITICAL();
+}
+
+void CanIO::dispatchTX(uint32_t now)
+{
+    // a SYNC first, the frames that completed along with it are timed against it
+    for (uint8_t i = 0; i < TX_MAILBOX_COUNT; ++i)
+    {
+        if (_txMailboxes[i].entry.msg.cob_id == Canopen::SyncCobId)
+        {
+            reclaimTxMailbox(i, now);
+        }
+    }
+    for (uint8_t i = 0; i < TX_MAILBOX_COUNT; ++i)
+    {
+        reclaimTxMailbox(i, now);
+    }
+
+    volatile uint8_t freeMailboxes = HAL_CAN_GetTxMailboxesFreeLevel(&_can);
+    uint8_t filled = 0;
+    for (; filled < freeMailboxes; ++filled)
+    {
+        CanTxEntry entry;
+        taskENTER_CRITICAL();
+        const bool available = _txQueue.pop(entry, now);
+        taskEXIT_CRITICAL();
+        if (!available)
+        {
+            break;
+        }
+
+        CAN_TxHeaderTypeDef header;
+        header.StdId = entry.msg.cob_id;
+        header.IDE = CAN_ID_STD;
+        if (entry.msg.rtr)
+        {
+            header.RTR = CAN_RTR_REMOTE;
+        }
+        else
+        {
+            header.RTR = CAN_RTR_DATA;
+        }
+        header.DLC = entry.msg.len;
+        header.TransmitGlobalTime = DISABLE;
+
+        uint32_t targetMailbox = 0;
+        volatile HAL_StatusTypeDef status =
+            HAL_CAN_AddTxMessage(&_can, &header, entry.msg.data, &targetMailbox);
+        if (status != HAL_StatusTypeDef::HAL_OK)
+        {
+            // retried with the next completed mailbox
+            testing_TxFailed();
+            taskENTER_CRITICAL();
+            _txQueue.requeue(entry, now);
+            taskEXIT_CRITICAL();
+            _log.logError(Logging::Origin::CanIO, "Unable to send frame with COBId %d",
+                          entry.msg.cob_id);
+            break;
+        }
+
+        for (uint8_t mailbox = 0; mailbox < TX_MAILBOX_COUNT; ++mailbox)
+        {
+            if (targetMailbox == (CAN_TX_MAILBOX0 << mailbox))
+            {
+                // a mailbox finishing right before being reused has its ISR done already
+                reclaimTxMailbox(mailbox, now);
+                _txMailboxes[mailbox] = {entry, true, false};
+            }
+        }
+    }
+
+    // mailboxes are sent in request order (TransmitFifoPriority), so everything loaded
+    // earlier blocks more important frames that came in since
+    CanTxEntry waiting;
+    taskENTER_CRITICAL();
+    const bool isWaiting = _txQueue.peek(waiting, now);
+    taskEXIT_CRITICAL();
+    if (!isWaiting)
+    {
+        return;
+    }
+    if (filled == freeMailboxes)
+    {
+        _traffic.countMailboxFull();
+    }
+    uint32_t abortMailboxes = 0;
+    for (uint8_t mailbox = 0; mailbox < TX_MAILBOX_COUNT; ++mailbox)
+    {
+        TxMailbox &mb = _txMailboxes[mailbox];
+        // aged frames are never pushed back again, that would starve them
+        if (mb.busy && !mb.abortRequested && !_txQueue.isAged(mb.entry, now) &&
+            _txQueue.hasPriority(waiting, mb.entry, now))
+        {
+            mb.abortRequested = true;
+            abortMailboxes |= CAN_TX_MAILBOX0 << mailbox;
+        }
+    }
+    if (abortMailboxes != 0)
+    {
+        testing_TxAbort();
+        HAL_CAN_AbortTxRequest(&_can, abortMailboxes);
+    }
+}
+
+void CanIO::reclaimTxMailbox(uint8_t mailbox, uint32_t now)
+{
+    const uint32_t bit = CAN_TX_MAILBOX0 << mailbox;
+    const bool aborted = (_txAborted.fetch_and(~bit) & bit) != 0;
+    const bool completed = (_txCompleted.fetch_and(~bit) & bit) != 0;
+    TxMailbox &mb = _txMailboxes[mailbox];
+    if (!mb.busy || !(aborted || completed))
+    {
+        return;
+    }
+    mb.busy = false;
+    if (aborted)
+    {
+        taskENTER_CRITICAL();
+        const bool queued = _txQueue.requeue(mb.entry, now);
+        taskEXIT_CRITICAL();
+        if (!queued)
+        {
+            _traffic.countTxDropped();
+            _log.logWarning(Logging::Origin::CanIO, "TX queue full, frame dropped");
+        }
+    }
+    else
+    {
+        const Message &m = mb.entry.msg;
+        _traffic.countTx(m.cob_id, m.rtr ? 0 : m.len, now - mb.entry.queuedAt);
+        timeAgainstSync(m.cob_id, _txCompletedAt[mailbox]);
     }
 }
 
+void CanIO::timeAgainstSync(uint16_t cobId, uint32_t completedAt)
+{
+    if (cobId == Canopen::SyncCobId)
+    {
+        _lastSyncAt = completedAt;
+        _syncSeen = true;
+        return;
+    }
+    if (!_syncSeen)
+    {
+        return;
+    }
+    // negative when a SYNC got reclaimed first but went out later
+    const auto offset = static_cast<int32_t>(completedAt - _lastSyncAt);
+    const auto offset_us = static_cast<uint32_t>(offset) / wrapper::HAL::CyclesPerMicrosecond;
+    if (offset < 0 || offset_us >= Canopen::SyncPeriod_ms * 1000)
+    {
+        return;
+    }
+    _traffic.countSyncOffset(cobId, offset_us);
+}
+
 void CanIO::canSend(Message *m)
 {
 #ifndef BUILDCONFIG_FUZZING_BUILD
-    if (xQueueSendToBack(_txQueue, m, QUEUE_WAITTIME) != pdPASS)
+    const uint32_t now = _hal.GetTick();
+    taskENTER_CRITICAL();
+    const bool queued = _txQueue.push(*m, now);
+    taskEXIT_CRITICAL();
+    if (!queued)
     {
+        _traffic.countTxDropped();
         _log.logWarning(Logging::Origin::CanIO, "TX queue full, frame dropped");
     }
     _task.notify(CanIO::NOTIFY_ATTEMPT_TX, eNotifyAction::eSetBits);
@@ -194,54 +402,135 @@ void CanIO::_canSend(Message *m)
 
 void CanIO::addRXMessage(Message &m)
 {
-    if (xQueueSendToBack(_rxQueue, &m, QUEUE_WAITTIME) != pdPASS)
+    // second producer next to the ISRs, keep them out while pushing
+    taskENTER_CRITICAL();
+    const bool queued = _rxRing.push(m);
+    taskEXIT_CRITICAL();
+    if (!queued)
     {
+        _traffic.countRxDropped();
         _log.logWarning(Logging::Origin::CanIO, "RX queue full, frame dropped");
     }
     _task.notify(CanIO::NOTIFY_RX_PENDING, eNotifyAction::eSetBits);
 }
 
-void CanIO::retrieveMessageFromISR(CanIO &canio, CAN_HandleTypeDef *hcan, uint32_t mailboxNmbr)
+uint32_t CanIO::drainRxFifoFromISR(CanIO &canio, CAN_HandleTypeDef *hcan, uint32_t fifo)
 {
-    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-
+    uint32_t flags = 0;
     CAN_RxHeaderTypeDef header;
     Message m = Message_Initializer;
-    if (HAL_CAN_GetRxMessage(hcan, mailboxNmbr, &header, m.data) == HAL_OK) // NOLINT
+
+    // frames have to be read out even when the ring is full, the interrupt fires until the
+    // fifo is empty
+    while (HAL_CAN_GetRxFifoFillLevel(hcan, fifo) > 0)
     {
+        if (HAL_CAN_GetRxMessage(hcan, fifo, &header, m.data) != HAL_OK) // NOLINT
+        {
+            break;
+        }
         if (header.IDE != CAN_ID_STD)
         {
-            return;
+            continue;
         }
         m.cob_id = header.StdId;
         m.rtr = header.RTR == CAN_RTR_REMOTE;
         m.len = header.DLC;
-        xQueueSendToBackFromISR(canio._rxQueue, &m, &xHigherPriorityTaskWoken);
+        canio._traffic.countRx(m.cob_id, m.rtr ? 0 : m.len);
+        if (m.cob_id == Canopen::SyncCobId)
+        {
+            canio._lastSyncAt = canio._hal.GetCycleCount();
+            canio._syncSeen = true;
+        }
+        if (canio._rxRing.push(m))
+        {
+            flags |= CanIO::NOTIFY_RX_PENDING;
+        }
+        else
+        {
+            canio._traffic.countRxDropped();
+            flags |= CanIO::NOTIFY_OVERLOAD;
+        }
     }
+    return flags;
+}
+
+void CanIO::cbTxMailbox0CompleteISR(CAN_HandleTypeDef *hcan)
+{
+    _instance->_txCompletedAt[0] = _instance->_hal.GetCycleCount();
+    _instance->_txCompleted.fetch_or(CAN_TX_MAILBOX0);
+    finishCallback(CanIO::NOTIFY_ATTEMPT_TX);
 }
 
-void CanIO::cbTxMailboxCompleteISR(CAN_HandleTypeDef *hcan)
+void CanIO::cbTxMailbox1CompleteISR(CAN_HandleTypeDef *hcan)
 {
+    _instance->_txCompletedAt[1] = _instance->_hal.GetCycleCount();
+    _instance->_txCompleted.fetch_or(CAN_TX_MAILBOX1);
+    finishCallback(CanIO::NOTIFY_ATTEMPT_TX);
+}
+
+void CanIO::cbTxMailbox2CompleteISR(CAN_HandleTypeDef *hcan)
+{
+    _instance->_txCompletedAt[2] = _instance->_hal.GetCycleCount();
+    _instance->_txCompleted.fetch_or(CAN_TX_MAILBOX2);
+    finishCallback(CanIO::NOTIFY_ATTEMPT_TX);
+}
+
+void CanIO::cbTxMailbox0AbortISR(CAN_HandleTypeDef *hcan)
+{
+    _instance->_txAborted.fetch_or(CAN_TX_MAILBOX0);
+    finishCallback(CanIO::NOTIFY_ATTEMPT_TX);
+}
+
+void CanIO::cbTxMailbox1AbortISR(CAN_HandleTypeDef *hcan)
+{
+    _instance->_txAborted.fetch_or(CAN_TX_MAILBOX1);
+    finishCallback(CanIO::NOTIFY_ATTEMPT_TX);
+}
+
+void CanIO::cbTxMailbox2AbortISR(CAN_HandleTypeDef *hcan)
+{
+    _instance->_txAborted.fetch_or(CAN_TX_MAILBOX2);
     finishCallback(CanIO::NOTIFY_ATTEMPT_TX);
 }
 
 void CanIO::cbRxMsgPending1ISR(CAN_HandleTypeDef *hcan)
 {
     CanIO &inst = *CanIO::_instance;
-    retrieveMessageFromISR(inst, hcan, CAN_RX_FIFO1);
-    finishCallback(CanIO::NOTIFY_RX_PENDING);
+    finishCallback(drainRxFifoFromISR(inst, hcan, CAN_RX_FIFO1));
 }
 
 void CanIO::cbRxMsgPending0ISR(CAN_HandleTypeDef *hcan)
 {
     CanIO &inst = *CanIO::_instance;
-    retrieveMessageFromISR(inst, hcan, CAN_RX_FIFO0);
-    finishCallback(CanIO::NOTIFY_RX_PENDING);
+    finishCallback(drainRxFifoFromISR(inst, hcan, CAN_RX_FIFO0));
 }
 
 void CanIO::cbErrorISR(CAN_HandleTypeDef *hcan)
 {
-    finishCallback(CanIO::NOTIFY_ERROR);
+    // an aborted mailbox whose last attempt lost arbitration or failed is reported as error
+    // by the HAL instead of as abort, only possible for aborts with auto retransmission
+    static constexpr std::array<uint32_t, TX_MAILBOX_COUNT> TxAbortErrors = {
+        HAL_CAN_ERROR_TX_ALST0 | HAL_CAN_ERROR_TX_TERR0,
+        HAL_CAN_ERROR_TX_ALST1 | HAL_CAN_ERROR_TX_TERR1,
+        HAL_CAN_ERROR_TX_ALST2 | HAL_CAN_ERROR_TX_TERR2};
+    uint32_t error = HAL_CAN_GetError(hcan);
+    HAL_CAN_ResetError(hcan);
+
+    uint32_t flags = 0;
+    for (uint8_t mailbox = 0; mailbox < TX_MAILBOX_COUNT; ++mailbox)
+    {
+        if ((error & TxAbortErrors[mailbox]) > 0)
+        {
+            _instance->_txAborted.fetch_or(CAN_TX_MAILBOX0 << mailbox);
+            error &= ~TxAbortErrors[mailbox];
+            flags |= CanIO::NOTIFY_ATTEMPT_TX;
+        }
+    }
+    if (error != HAL_CAN_ERROR_NONE || flags == 0)
+    {
+        flags |= CanIO::NOTIFY_ERROR;
+    }
+    finishCallback(flags);
 }
 
 void CanIO::cbOverloadISR(CAN_HandleTypeDef *hcan)
@@ -251,6 +540,10 @@ void CanIO::cbOverloadISR(CAN_HandleTypeDef *hcan)
 
 void CanIO::finishCallback(uint32_t flag)
 {
+    if (flag == 0)
+    {
+        return;
+    }
     BaseType_t xHigherPriorityTaskWoken = pdFALSE;
     CanIO &inst = *CanIO::_instance;
     inst._task.notifyFromISR(flag, eNotifyAction::eSetBits, &xHigherPriorityTaskWoken);
@@ -1,10 +1,16 @@
 #pragma once
+#include "CanTrafficStats.hpp"
+#include "CanTxQueue.hpp"
+#include "Wrapper/HAL.hpp"
+#include "Wrapper/SpscRing.hpp"
 #include "Wrapper/Task.hpp"
+#include <atomic>
 #include <queue.h>
 
 extern "C"
 {
 #include <canfestival/can.h>
+#include <canfestival/data.h>
 }
 
 #include <stm32f3xx_hal.h>
@@ -19,6 +25,8 @@ namespace remote_control_device
 {
 class Logging;
 class Canopen;
+class CanFilter;
+class TerminalWriter;
 
 class CanIO
 {
@@ -28,9 +36,10 @@ public:
      *
      * @param task Task handle to use for internal processes
      * @param hCan can perihperal handle for internal processes
+     * @param hal time source for TX queue aging
      */
     static constexpr uint16_t StackSize = 300;
-    CanIO(CAN_HandleTypeDef &hCan, Logging &log);
+    CanIO(CAN_HandleTypeDef &hCan, wrapper::HAL &hal, Logging &log);
     virtual ~CanIO();
 
     /**
@@ -59,7 +68,56 @@ public:
     static constexpr uint8_t NOTIFY_RX_PENDING = 1 << 1;
     static constexpr uint8_t NOTIFY_ERROR = 1 << 2;
     static constexpr uint8_t NOTIFY_OVERLOAD = 1 << 3;
-    static void retrieveMessageFromISR(CanIO &canio, CAN_HandleTypeDef *hcan, uint32_t mailboxNmbr);
+
+    /**
+     * @brief Hands the frames in the RX ring to canfestival, the only consumer of the ring
+     * Called through Canopen::processRXFrames with the OD locked or on the CanopenActor task
+     *
+     * @param d object dictionary
+     */
+    void dispatchRX(CO_Data *d);
+
+    /**
+     * @brief Moves every frame pending in a RX fifo into the RX ring
+     *
+     * @param canio
+     * @param hcan
+     * @param fifo CAN_RX_FIFO0 or CAN_RX_FIFO1
+     * @return uint32_t NOTIFY_ flags for the task, 0 if nothing was received
+     */
+    static uint32_t drainRxFifoFromISR(CanIO &canio, CAN_HandleTypeDef *hcan, uint32_t fifo);
+
+    /**
+     * @brief Replaces the startup pass all filter with exact filters for the given ids
+     * Keeps accepting everything when the ids can't be packed into the filter banks
+     *
+     * @param filter COB-IDs the node consumes
+     */
+    virtual void configureAcceptanceFilters(const CanFilter &filter);
+
+    /**
+     * @brief Frames dropped because the RX ring was full
+     *
+     */
+    virtual uint32_t getRxDroppedCount() const
+    {
+        return _traffic.getRxDropped();
+    }
+
+    /**
+     * @brief Frame counters per COB-ID, drops and the estimated bus load
+     *
+     * @return CanTrafficSnapshot
+     */
+    virtual CanTrafficSnapshot getTrafficSnapshot();
+    virtual void resetTrafficStatistics();
+
+    /**
+     * @brief Bus load and per COB-ID counters for the UI
+     *
+     * @param term
+     */
+    virtual void drawUITrafficPart(TerminalWriter &term);
 
     /**
      * @brief Retturns true if bus communication works as intendet
@@ -70,7 +128,9 @@ public:
     virtual bool isBusOK();
 
     /**
-     * @brief Adds a can frame to the TX queue
+     * @brief Adds a can frame to the TX queue, never blocks
+     * Frames are put into the TX mailboxes lowest COB-ID first, see CanTxQueue.
+     * When the queue is full the frame with the lowest priority is dropped.
      *
      */
     virtual void canSend(Message *);
@@ -85,37 +145,111 @@ public:
     virtual void addRXMessage(Message &m);
 
     /**
-     * @brief Queue size for TX and RX queue
+     * @brief Queue size for TX queue
      * increase when overload errors start appearing
      *
      */
     static constexpr UBaseType_t QUEUES_SIZE = 16;
 
     /**
-     * @brief How long a canSend call should wait for a slot in the TX queue
-     * increase for high bus load
+     * @brief Frames the RX ring holds until the task dispatches them, power of two
+     * 1 Mbit/s is ~17 frames per ms, covers bursts while canfestival is busy
      *
      */
-    static constexpr TickType_t QUEUE_WAITTIME = pdMS_TO_TICKS(10);
+    static constexpr size_t RX_RING_SIZE = 64;
+
+    /**
+     * @brief Frames waiting this long in the TX queue are sent before everything else
+     * Well above the 20ms actuator PDO period so those aren't disturbed in normal operation
+     *
+     */
+    static constexpr uint32_t TX_AGING_TIME_ms = 50;
+
+    /**
+     * @brief Number of TX mailboxes of the bxCAN
+     *
+     */
+    static constexpr uint8_t TX_MAILBOX_COUNT = 3;
+
+    /**
+     * @brief Bus bit rate, 32 MHz APB1 / (prescaler 4 * 16 time quanta), see can.c
+     *
+     */
+    static constexpr uint32_t CAN_BITRATE = 500000;
 
     // Some functions to mock in tests
     static void testing_TxFailed() {};
+    static void testing_TxAbort() {};
     static void testing_RxAttempt() {};
     static void testing_Overload() {};
     static void testing_Error() {};
 
 private:
     CAN_HandleTypeDef &_can;
+    wrapper::HAL &_hal;
     Logging &_log;
     wrapper::Task _task;
     Canopen* _canopen{nullptr};
 
     static CanIO *_instance;
-    QueueHandle_t _rxQueue, _txQueue;
+    // shared by all tasks calling canSend, guarded by critical sections
+    CanTxQueue<QUEUES_SIZE> _txQueue{TX_AGING_TIME_ms};
+
+    // TX mailbox contents, only touched by the CanIO task
+    struct TxMailbox
+    {
+        CanTxEntry entry;
+        bool busy;
+        bool abortRequested;
+    };
+    std::array<TxMailbox, TX_MAILBOX_COUNT> _txMailboxes{};
+    // mailbox bits set by the TX ISRs, consumed by the CanIO task
+    std::atomic<uint32_t> _txCompleted{0};
+    std::atomic<uint32_t> _txAborted{0};
+    // cycle counter at the TX complete interrupt of each mailbox
+    std::array<std::atomic<uint32_t>, TX_MAILBOX_COUNT> _txCompletedAt{};
+    // cycle counter when the last SYNC was sent or received, valid once _syncSeen
+    std::atomic<uint32_t> _lastSyncAt{0};
+    std::atomic<bool> _syncSeen{false};
+    // filled by the RX ISRs, which share a priority and never preempt each other
+    wrapper::SpscRing<Message, RX_RING_SIZE> _rxRing;
+    CanTrafficStats _traffic{CAN_BITRATE};
     bool _busOK = true;
 
+    /**
+     * @brief Refills free TX mailboxes in priority order and aborts mailboxes holding less
+     * important frames than the ones waiting
+     *
+     * @param now ms
+     */
+    void dispatchTX(uint32_t now);
+
+    void updateBusLoad(uint32_t now);
+
+    /**
+     * @brief Frees the mailbox if it finished, aborted frames go back into the TX queue
+     *
+     * @param mailbox index
+     * @param now ms
+     */
+    void reclaimTxMailbox(uint8_t mailbox, uint32_t now);
+
+    /**
+     * @brief Takes a sent SYNC as reference or counts how long after the last one a frame
+     * went out, frames more than a SYNC period later are left out
+     *
+     * @param cobId of the sent frame
+     * @param completedAt cycle counter at its TX complete interrupt
+     */
+    void timeAgainstSync(uint16_t cobId, uint32_t completedAt);
+
     /* Hooks and support functions */
-    static void cbTxMailboxCompleteISR(CAN_HandleTypeDef *hcan);
+    static void cbTxMailbox0CompleteISR(CAN_HandleTypeDef *hcan);
+    static void cbTxMailbox1CompleteISR(CAN_HandleTypeDef *hcan);
+    static void cbTxMailbox2CompleteISR(CAN_HandleTypeDef *hcan);
+    static void cbTxMailbox0AbortISR(CAN_HandleTypeDef *hcan);
+    static void cbTxMailbox1AbortISR(CAN_HandleTypeDef *hcan);
+    static void cbTxMailbox2AbortISR(CAN_HandleTypeDef *hcan);
     static void cbRxMsgPending0ISR(CAN_HandleTypeDef *hcan);
     static void cbRxMsgPending1ISR(CAN_HandleTypeDef *hcan);
     static void cbErrorISR(CAN_HandleTypeDef *hcan);
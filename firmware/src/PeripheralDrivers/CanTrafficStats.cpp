@@ -0,0 +1,193 @@
+#include "CanTrafficStats.hpp"
+#include <algorithm>
+
+namespace remote_control_device
+{
+
+void CanTrafficStats::countRx(uint16_t cobId, uint8_t dlc)
+{
+    _windowBits.fetch_add(canFrameBitsWorstCase(std::min<uint8_t>(dlc, 8)),
+                          std::memory_order_relaxed);
+    Slot *slot = findSlot(cobId);
+    if (slot == nullptr)
+    {
+        _untrackedFrames.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    slot->rxFrames.fetch_add(1, std::memory_order_relaxed);
+}
+
+void CanTrafficStats::countTx(uint16_t cobId, uint8_t dlc, uint32_t residency_ms)
+{
+    _windowBits.fetch_add(canFrameBitsWorstCase(std::min<uint8_t>(dlc, 8)),
+                          std::memory_order_relaxed);
+    Slot *slot = findSlot(cobId);
+    if (slot == nullptr)
+    {
+        _untrackedFrames.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    slot->txFrames.fetch_add(1, std::memory_order_relaxed);
+    slot->totalTxResidency_ms.fetch_add(residency_ms, std::memory_order_relaxed);
+
+    const uint16_t residency = std::min<uint32_t>(residency_ms, UINT16_MAX);
+    uint16_t max = slot->maxTxResidency_ms.load(std::memory_order_relaxed);
+    while (residency > max &&
+           !slot->maxTxResidency_ms.compare_exchange_weak(max, residency,
+                                                          std::memory_order_relaxed))
+    {
+    }
+}
+
+void CanTrafficStats::countSyncOffset(uint16_t cobId, uint32_t offset_us)
+{
+    // the frame was counted by countTx already
+    Slot *slot = findSlot(cobId);
+    if (slot == nullptr)
+    {
+        return;
+    }
+    slot->syncFrames.fetch_add(1, std::memory_order_relaxed);
+
+    uint32_t min = slot->minSyncOffset_us.load(std::memory_order_relaxed);
+    while (offset_us < min &&
+           !slot->minSyncOffset_us.compare_exchange_weak(min, offset_us,
+                                                         std::memory_order_relaxed))
+    {
+    }
+    uint32_t max = slot->maxSyncOffset_us.load(std::memory_order_relaxed);
+    while (offset_us > max &&
+           !slot->maxSyncOffset_us.compare_exchange_weak(max, offset_us,
+                                                         std::memory_order_relaxed))
+    {
+    }
+}
+
+void CanTrafficStats::countRxDropped()
+{
+    _rxDropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+void CanTrafficStats::countTxDropped()
+{
+    _txDropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+void CanTrafficStats::countMailboxFull()
+{
+    _mailboxFullEvents.fetch_add(1, std::memory_order_relaxed);
+}
+
+void CanTrafficStats::updateBusLoad(uint32_t now_ms)
+{
+    const uint32_t elapsed_ms = now_ms - _windowStart_ms;
+    if (elapsed_ms < LoadWindow_ms)
+    {
+        return;
+    }
+    _windowStart_ms = now_ms;
+
+    const uint64_t bits = _windowBits.exchange(0, std::memory_order_relaxed);
+    const uint64_t capacity = static_cast<uint64_t>(_bitRate) * elapsed_ms;
+    const auto load =
+        static_cast<uint16_t>(std::min<uint64_t>((bits * 1000 * 1000) / capacity, 1000));
+    _busLoad_permille.store(load, std::memory_order_relaxed);
+    if (load > _peakBusLoad_permille.load(std::memory_order_relaxed))
+    {
+        _peakBusLoad_permille.store(load, std::memory_order_relaxed);
+    }
+}
+
+bool CanTrafficStats::getCobIdCounters(uint8_t slot, CanCobIdCounters &target) const
+{
+    const Slot &s = _slots.at(slot);
+    const uint16_t cobId = s.cobId.load(std::memory_order_acquire);
+    if (cobId == FreeSlot)
+    {
+        return false;
+    }
+    target.cobId = cobId;
+    target.maxTxResidency_ms = s.maxTxResidency_ms.load(std::memory_order_relaxed);
+    target.rxFrames = s.rxFrames.load(std::memory_order_relaxed);
+    target.txFrames = s.txFrames.load(std::memory_order_relaxed);
+    target.totalTxResidency_ms = s.totalTxResidency_ms.load(std::memory_order_relaxed);
+    target.syncFrames = s.syncFrames.load(std::memory_order_relaxed);
+    target.minSyncOffset_us =
+        target.syncFrames > 0 ? s.minSyncOffset_us.load(std::memory_order_relaxed) : 0;
+    target.maxSyncOffset_us = s.maxSyncOffset_us.load(std::memory_order_relaxed);
+    return true;
+}
+
+CanTrafficSnapshot CanTrafficStats::getSnapshot() const
+{
+    CanTrafficSnapshot snapshot;
+    for (uint8_t i = 0; i < _slots.size(); ++i)
+    {
+        if (getCobIdCounters(i, snapshot.cobIds[snapshot.cobIdCount]))
+        {
+            snapshot.cobIdCount++;
+        }
+    }
+    // slots are claimed in hash order
+    std::sort(snapshot.cobIds.begin(), snapshot.cobIds.begin() + snapshot.cobIdCount,
+              [](const CanCobIdCounters &a, const CanCobIdCounters &b) {
+                  return a.cobId < b.cobId;
+              });
+    snapshot.totals = getTotals();
+    return snapshot;
+}
+
+CanTrafficTotals CanTrafficStats::getTotals() const
+{
+    CanTrafficTotals totals;
+    totals.untrackedFrames = _untrackedFrames.load(std::memory_order_relaxed);
+    totals.rxDropped = _rxDropped.load(std::memory_order_relaxed);
+    totals.txDropped = _txDropped.load(std::memory_order_relaxed);
+    totals.mailboxFullEvents = _mailboxFullEvents.load(std::memory_order_relaxed);
+    totals.busLoad_permille = _busLoad_permille.load(std::memory_order_relaxed);
+    totals.peakBusLoad_permille = _peakBusLoad_permille.load(std::memory_order_relaxed);
+    return totals;
+}
+
+void CanTrafficStats::reset()
+{
+    for (auto &slot : _slots)
+    {
+        slot.maxTxResidency_ms.store(0, std::memory_order_relaxed);
+        slot.rxFrames.store(0, std::memory_order_relaxed);
+        slot.txFrames.store(0, std::memory_order_relaxed);
+        slot.totalTxResidency_ms.store(0, std::memory_order_relaxed);
+        slot.syncFrames.store(0, std::memory_order_relaxed);
+        slot.minSyncOffset_us.store(UINT32_MAX, std::memory_order_relaxed);
+        slot.maxSyncOffset_us.store(0, std::memory_order_relaxed);
+    }
+    _untrackedFrames.store(0, std::memory_order_relaxed);
+    _rxDropped.store(0, std::memory_order_relaxed);
+    _txDropped.store(0, std::memory_order_relaxed);
+    _mailboxFullEvents.store(0, std::memory_order_relaxed);
+    _peakBusLoad_permille.store(_busLoad_permille.load(std::memory_order_relaxed),
+                                std::memory_order_relaxed);
+}
+
+CanTrafficStats::Slot *CanTrafficStats::findSlot(uint16_t cobId)
+{
+    // open addressing, node ids are the low bits so consecutive ids get consecutive slots
+    for (uint8_t probe = 0; probe < _slots.size(); ++probe)
+    {
+        Slot &slot = _slots[(cobId + probe) % _slots.size()];
+        uint16_t current = slot.cobId.load(std::memory_order_acquire);
+        // fails when a preempting ISR claimed the slot meanwhile, current holds its COB-ID then
+        if (current == FreeSlot &&
+            slot.cobId.compare_exchange_strong(current, cobId, std::memory_order_acq_rel))
+        {
+            return &slot;
+        }
+        if (current == cobId)
+        {
+            return &slot;
+        }
+    }
+    return nullptr;
+}
+
+} // namespace remote_control_device
@@ -0,0 +1,163 @@
+#pragma once
+#include <FreeRTOS.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @brief Per COB-ID frame counters and a bus load estimate for CanIO
+ *
+ * Counting is lock free so the RX ISRs can do it: a COB-ID claims a table slot with a compare
+ * and swap the first time it shows up, after that there are only relaxed atomic increments.
+ * COB-IDs finding the table full are counted as untracked. reset() clears the counters but
+ * keeps the slots, so a concurrent increment never lands in a slot of another COB-ID.
+ *
+ * The bus load only sees frames passing the acceptance filter and our own, so it is a lower
+ * bound. Frame lengths assume worst case bit stuffing.
+ */
+namespace remote_control_device
+{
+
+/**
+ * @brief Worst case bits a standard frame occupies the bus, including stuff bits, end of
+ * frame and interframe space
+ *
+ * @param dlc data bytes, 0 for remote frames
+ */
+constexpr uint32_t canFrameBitsWorstCase(uint8_t dlc)
+{
+    // SOF up to the CRC (34 bits + data) is stuffed, one stuff bit per 4 bits after the first 5
+    return 47 + (8 * dlc) + ((34 + (8 * dlc) - 1) / 4);
+}
+
+struct CanCobIdCounters
+{
+    uint16_t cobId{0};
+    uint16_t maxTxResidency_ms{0};
+    uint32_t rxFrames{0};
+    uint32_t txFrames{0};
+    // enqueued to transmission complete, summed over txFrames
+    uint32_t totalTxResidency_ms{0};
+    // transmissions completed after a SYNC, timed against it
+    uint32_t syncFrames{0};
+    // SYNC to transmission complete, max - min is the jitter
+    uint32_t minSyncOffset_us{0};
+    uint32_t maxSyncOffset_us{0};
+};
+
+struct CanTrafficTotals
+{
+    // frames of COB-IDs that found the table full
+    uint32_t untrackedFrames{0};
+    uint32_t rxDropped{0};
+    uint32_t txDropped{0};
+    // TX attempts finding frames waiting and every mailbox busy
+    uint32_t mailboxFullEvents{0};
+    // of the bit rate, last complete window and highest window since reset
+    uint16_t busLoad_permille{0};
+    uint16_t peakBusLoad_permille{0};
+};
+
+struct CanTrafficSnapshot
+{
+    static constexpr uint8_t MaxCobIds = 24;
+    CanTrafficTotals totals;
+    // sorted by COB-ID
+    std::array<CanCobIdCounters, MaxCobIds> cobIds{};
+    uint8_t cobIdCount{0};
+};
+
+class CanTrafficStats
+{
+public:
+    static constexpr uint32_t LoadWindow_ms = 250;
+
+    /**
+     * @param bitRate bit/s of the bus
+     */
+    explicit CanTrafficStats(uint32_t bitRate) : _bitRate(bitRate)
+    {
+    }
+    ~CanTrafficStats() = default;
+
+    CanTrafficStats(const CanTrafficStats &) = delete;
+    CanTrafficStats(CanTrafficStats &&) = delete;
+    CanTrafficStats &operator=(const CanTrafficStats &) = delete;
+    CanTrafficStats &operator=(CanTrafficStats &&) = delete;
+
+    /* ISR safe */
+    void countRx(uint16_t cobId, uint8_t dlc);
+    void countTx(uint16_t cobId, uint8_t dlc, uint32_t residency_ms);
+    void countSyncOffset(uint16_t cobId, uint32_t offset_us);
+    void countRxDropped();
+    void countTxDropped();
+    void countMailboxFull();
+
+    uint32_t getRxDropped() const
+    {
+        return _rxDropped.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Closes the bus load window once it is LoadWindow_ms or longer
+     * Calls have to be serialized by the caller
+     *
+     * @param now_ms
+     */
+    void updateBusLoad(uint32_t now_ms);
+
+    CanTrafficTotals getTotals() const;
+
+    /**
+     * @brief Copies a single slot, cheaper than a whole snapshot
+     *
+     * @param slot < CanTrafficSnapshot::MaxCobIds
+     * @param target
+     * @return false slot unused
+     */
+    bool getCobIdCounters(uint8_t slot, CanCobIdCounters &target) const;
+
+    /**
+     * @brief Counters keep changing while being copied, each one is consistent on its own
+     *
+     */
+    CanTrafficSnapshot getSnapshot() const;
+
+    void reset();
+
+private:
+    static constexpr uint16_t FreeSlot = 0xFFFF;
+
+    struct Slot
+    {
+        std::atomic<uint16_t> cobId{FreeSlot};
+        std::atomic<uint16_t> maxTxResidency_ms{0};
+        std::atomic<uint32_t> rxFrames{0};
+        std::atomic<uint32_t> txFrames{0};
+        std::atomic<uint32_t> totalTxResidency_ms{0};
+        std::atomic<uint32_t> syncFrames{0};
+        std::atomic<uint32_t> minSyncOffset_us{UINT32_MAX};
+        std::atomic<uint32_t> maxSyncOffset_us{0};
+    };
+
+    const uint32_t _bitRate;
+    std::array<Slot, CanTrafficSnapshot::MaxCobIds> _slots{};
+    std::atomic<uint32_t> _untrackedFrames{0};
+    std::atomic<uint32_t> _rxDropped{0};
+    std::atomic<uint32_t> _txDropped{0};
+    std::atomic<uint32_t> _mailboxFullEvents{0};
+
+    std::atomic<uint32_t> _windowBits{0};
+    uint32_t _windowStart_ms{0};
+    std::atomic<uint16_t> _busLoad_permille{0};
+    std::atomic<uint16_t> _peakBusLoad_permille{0};
+
+    /**
+     * @brief Finds or claims the slot of a COB-ID
+     *
+     * @return nullptr table full
+     */
+    Slot *findSlot(uint16_t cobId);
+};
+
+} // namespace remote_control_device
@@ -0,0 +1,174 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+extern "C"
+{
+#include <canfestival/can.h>
+}
+
+/**
+ * @brief Frames waiting for a TX mailbox, handed out in bus arbitration order
+ *
+ * The lowest COB-ID goes first, frames with the same COB-ID keep their order. A frame
+ * waiting for agingTime or longer is aged: aged frames go before all others, oldest
+ * first, so a steady stream of low COB-IDs can't starve the rest. Since aging follows
+ * queueing order, frames with the same COB-ID never overtake each other.
+ *
+ * Linear search over at most Capacity entries, Capacity is small. Not thread safe.
+ */
+namespace remote_control_device
+{
+
+struct CanTxEntry
+{
+    Message msg;
+    // ms, HAL tick
+    uint32_t queuedAt;
+    // queueing order, wraps around
+    uint32_t seq;
+};
+
+template <size_t Capacity>
+class CanTxQueue
+{
+    static_assert(Capacity > 0);
+
+public:
+    explicit CanTxQueue(uint32_t agingTime_ms) : _agingTime_ms(agingTime_ms)
+    {
+    }
+
+    /**
+     * @brief Adds a new frame
+     *
+     * @param msg
+     * @param now ms
+     * @return true queued
+     * @return false queue was full, the frame with the lowest priority got dropped, which
+     * can be msg itself
+     */
+    bool push(const Message &msg, uint32_t now)
+    {
+        return requeue({msg, now, _nextSeq++}, now);
+    }
+
+    /**
+     * @brief Puts a previously popped entry back, it keeps its original place
+     *
+     * @param entry
+     * @param now ms
+     * @return false see push()
+     */
+    bool requeue(const CanTxEntry &entry, uint32_t now)
+    {
+        if (_count < Capacity)
+        {
+            _entries[_count++] = entry;
+            return true;
+        }
+        const size_t worst = findWorst(now);
+        if (hasPriority(entry, _entries[worst], now))
+        {
+            _entries[worst] = entry;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Removes the entry with the highest priority
+     *
+     * @param target
+     * @param now ms
+     * @return false queue empty
+     */
+    bool pop(CanTxEntry &target, uint32_t now)
+    {
+        if (_count == 0)
+        {
+            return false;
+        }
+        const size_t best = findBest(now);
+        target = _entries[best];
+        _entries[best] = _entries[--_count];
+        return true;
+    }
+
+    /**
+     * @brief Copies the entry pop() would return without removing it
+     *
+     * @return false queue empty
+     */
+    bool peek(CanTxEntry &target, uint32_t now) const
+    {
+        if (_count == 0)
+        {
+            return false;
+        }
+        target = _entries[findBest(now)];
+        return true;
+    }
+
+    bool isAged(const CanTxEntry &entry, uint32_t now) const
+    {
+        return now - entry.queuedAt >= _agingTime_ms;
+    }
+
+    /**
+     * @brief True if a has to be sent before b
+     *
+     */
+    bool hasPriority(const CanTxEntry &a, const CanTxEntry &b, uint32_t now) const
+    {
+        const bool agedA = isAged(a, now);
+        if (agedA != isAged(b, now))
+        {
+            return agedA;
+        }
+        if (!agedA && a.msg.cob_id != b.msg.cob_id)
+        {
+            return a.msg.cob_id < b.msg.cob_id;
+        }
+        return static_cast<int32_t>(a.seq - b.seq) < 0;
+    }
+
+    size_t size() const
+    {
+        return _count;
+    }
+
+private:
+    size_t findBest(uint32_t now) const
+    {
+        size_t best = 0;
+        for (size_t i = 1; i < _count; ++i)
+        {
+            if (hasPriority(_entries[i], _entries[best], now))
+            {
+                best = i;
+            }
+        }
+        return best;
+    }
+
+    size_t findWorst(uint32_t now) const
+    {
+        size_t worst = 0;
+        for (size_t i = 1; i < _count; ++i)
+        {
+            if (hasPriority(_entries[worst], _entries[i], now))
+            {
+                worst = i;
+            }
+        }
+        return worst;
+    }
+
+    const uint32_t _agingTime_ms;
+    std::array<CanTxEntry, Capacity> _entries{};
+    size_t _count{0};
+    uint32_t _nextSeq{0};
+};
+
+} // namespace remote_control_device
@@ -13,8 +13,8 @@ namespace remote_control_device
 ReceiverModule *ReceiverModule::_instance{nullptr};
 
 ReceiverModule::ReceiverModule(UART_HandleTypeDef &uart, TIM_HandleTypeDef &tim, wrapper::HAL &hal,
-                               Logging &log)
-    : _uart(uart), _tim(tim), _hal(hal), _log(log),
+                               Logging &log, RxMode mode)
+    : _uart(uart), _tim(tim), _hal(hal), _log(log), _mode(mode),
       _task(&ReceiverModule::taskMain, "ReceiverModule", StackSize, reinterpret_cast<void *>(this),
             osPriority_t::osPriorityAboveNormal, wrapper::sync::ReceiverModule_Ready)
 {
@@ -29,17 +29,33 @@ ReceiverModule::ReceiverModule(UART_HandleTypeDef &uart, TIM_HandleTypeDef &tim,
     HAL_TIM_RegisterCallback(&_tim, HAL_TIM_PERIOD_ELAPSED_CB_ID,
                              &ReceiverModule::cbPeriodElapsedISR);
 
-    _frameSemphr = xSemaphoreCreateMutex();
+    if (_mode == RxMode::CircularDMA)
+    {
+        HAL_UART_RegisterRxEventCallback(&_uart, &ReceiverModule::cbRxEventISR);
+        // uart errors abort the dma in circular mode as well, restart reception
+        HAL_UART_RegisterCallback(&_uart, HAL_UART_ERROR_CB_ID, &ReceiverModule::cbRxAbortISR);
+
+#ifdef BUILDCONFIG_EMBEDDED_BUILD
+        // cubemx configures the rx dma channel for one shot transfers
+        _uart.hdmarx->Init.Mode = DMA_CIRCULAR;
+        HAL_DMA_Init(_uart.hdmarx);
+#endif
+    }
 }
 
 ReceiverModule::~ReceiverModule()
 {
     _instance = nullptr;
-    vSemaphoreDelete(_frameSemphr);
 }
 
 void ReceiverModule::dispatch(uint32_t flags)
 {
+    if (_mode == RxMode::CircularDMA)
+    {
+        dispatchCircular(flags);
+        return;
+    }
+
     // Reception timing out or abort due to error
     // force restart
     if ((flags & NOTIFY_ERROR) > 0)
@@ -50,36 +66,18 @@ void ReceiverModule::dispatch(uint32_t flags)
             HAL_UART_AbortReceive(&_uart);
         }
         _synchronized = false;
+        addResyncs(1);
         flags = NOTIFY_RX_START;
     }
 
     // process received data
     if ((flags & NOTIFY_RX_SUCCESSFUL) > 0)
     {
-        if (xSemaphoreTake(_frameSemphr, MUTEX_TIMEOUT) == pdPASS)
+        if (!processFrame(_rxBuffer))
         {
-            const auto ret = SBUS::Decoder::decode(_rxBuffer);
-            if (ret.first == SBUS::DecodeError::NoError)
-            {
-                testing_SuccessfulDecode();
-                _decodedFrame = ret.second;
-                _decodedFrame.lastUpdate = _hal.GetTick();
-            }
-            else
-            {
-                testing_ErrorDecode();
-                // Decoding errors will show up as timeouts for state machine
-                _log.logWarning(Logging::Origin::RadioControl, "Unable to decode");
-
-                // force resync as we might have started mid frame
-                _synchronized = false;
-            }
-            xSemaphoreGive(_frameSemphr);
-        }
-        else
-        {
-            _log.logError(Logging::Origin::RadioControl,
-                          "Unable to aquire mutex to convert sbus frame");
+            // force resync as we might have started mid frame
+            _synchronized = false;
+            addResyncs(1);
         }
         flags = NOTIFY_RX_START;
     }
@@ -116,6 +114,139 @@ void ReceiverModule::dispatch(uint32_t flags)
     }
 }
 
+void ReceiverModule::dispatchCircular(uint32_t flags)
+{
+    // uart error aborted the dma, buffered bytes might be incomplete
+    if ((flags & NOTIFY_ERROR) > 0)
+    {
+        if (_uart.RxState != HAL_UART_STATE_READY)
+        {
+            HAL_UART_AbortReceive(&_uart);
+        }
+        flags |= NOTIFY_RX_START;
+    }
+
+    if ((flags & NOTIFY_RX_START) > 0)
+    {
+        startCircularReception();
+        return;
+    }
+
+    if ((flags & NOTIFY_RX_DATA) > 0)
+    {
+        consumeRxRing();
+    }
+}
+
+void ReceiverModule::startCircularReception()
+{
+    _synchronizer.reset();
+    _rxReadPos = 0;
+    _rxWritePos = 0;
+    _rxGapPending = false;
+    _rxDmaPos = 0;
+
+    if (HAL_UARTEx_ReceiveToIdle_DMA(&_uart, _rxRing.data(), _rxRing.size()) != HAL_OK)
+    {
+        testing_RxRestart();
+        _log.logError(Logging::Origin::RadioControl, "Starting RX DMA failed");
+        _task.notify(NOTIFY_RX_START, eNotifyAction::eSetBits);
+        return;
+    }
+
+#ifdef BUILDCONFIG_EMBEDDED_BUILD
+    // only wrap around and idle line are of interest
+    __HAL_DMA_DISABLE_IT(_uart.hdmarx, DMA_IT_HT);
+#endif
+}
+
+void ReceiverModule::consumeRxRing()
+{
+    // gap has to be read together with the write position it belongs to
+    taskENTER_CRITICAL();
+    bool gap = _rxGapPending;
+    const uint32_t gapPos = _rxGapPos;
+    const uint32_t writePos = _rxWritePos;
+    _rxGapPending = false;
+    taskEXIT_CRITICAL();
+
+    // the dma overwrote bytes not read yet, the rest of the ring can't be trusted either
+    if (writePos - _rxReadPos > RxRingSize)
+    {
+        _rxReadPos = writePos;
+        _synchronizer.reset();
+        _rxOverruns++;
+    }
+
+    for (;;)
+    {
+        // a wrap around after the idle line may have brought the next frame's first bytes already
+        if (gap && _rxReadPos == gapPos)
+        {
+            _synchronizer.signalGap();
+            gap = false;
+        }
+        if (_rxReadPos == writePos)
+        {
+            break;
+        }
+
+        const uint8_t byte = _rxRing[_rxReadPos % RxRingSize];
+        _rxReadPos++;
+        if (_synchronizer.pushByte(byte))
+        {
+            processFrame(_synchronizer.getFrame());
+        }
+    }
+
+    const uint32_t resyncs = getResyncCount();
+    if (resyncs != _reportedResyncs)
+    {
+        addResyncs(resyncs - _reportedResyncs);
+        _reportedResyncs = resyncs;
+    }
+}
+
+bool ReceiverModule::processFrame(const SBUS::Protocol::FrameData &data)
+{
+    const uint32_t now = _hal.GetTick();
+    const uint32_t cycles = _hal.GetCycleCount();
+    const uint32_t interArrival_us =
+        _lastFrameCyclesValid ? (cycles - _lastFrameCycles) / wrapper::HAL::CyclesPerMicrosecond
+                              : 0;
+    _lastFrameCycles = cycles;
+    _lastFrameCyclesValid = true;
+
+    auto ret = SBUS::Decoder::decode(data);
+    const bool success = ret.first == SBUS::DecodeError::NoError;
+    if (success)
+    {
+        testing_SuccessfulDecode();
+        ret.second.lastUpdate = now;
+        _decodedFrame.write(ret.second);
+        if (_frameCallback != nullptr)
+        {
+            _frameCallback(_frameCallbackContext, ret.second);
+        }
+    }
+    else
+    {
+        testing_ErrorDecode();
+        // Decoding errors will show up as timeouts for state machine
+        _log.logWarning(Logging::Origin::RadioControl, "Unable to decode");
+    }
+
+    _linkMonitor.frameReceived(ret.first, ret.second, now, interArrival_us);
+    _linkStatistics.write(_linkMonitor.getStatistics());
+    return success;
+}
+
+void ReceiverModule::addResyncs(uint32_t count)
+{
+    _linkMonitor.addResyncs(count);
+    _linkStatistics.write(_linkMonitor.getStatistics());
+}
+
 void ReceiverModule::restartTimer()
 {
 #ifdef BUILDCONFIG_EMBEDDED_BUILD
@@ -132,13 +263,23 @@ void ReceiverModule::cbPeriodElapsedISR(TIM_HandleTypeDef *htim)
 
 bool ReceiverModule::getSBUSFrame(SBUS::Frame &frame)
 {
-    if (xSemaphoreTake(_frameSemphr, MUTEX_TIMEOUT) == pdPASS)
+    return _decodedFrame.read(frame);
+}
+
+bool ReceiverModule::getLinkStatistics(SBUS::LinkStatistics &stats)
+{
+    if (!_linkStatistics.read(stats))
     {
-        frame = _decodedFrame;
-        xSemaphoreGive(_frameSemphr);
-        return true;
+        return false;
     }
-    return false;
+    stats.framesPerSecond = SBUS::LinkMonitor::getFramesPerSecond(stats, _hal.GetTick());
+    return true;
+}
+
+void ReceiverModule::setFrameCallback(FrameCallback callback, void *context)
+{
+    _frameCallbackContext = context;
+    _frameCallback = callback;
 }
 
 void ReceiverModule::finishISR(uint32_t flags)
@@ -160,6 +301,26 @@ void ReceiverModule::cbRxCompleteISR(UART_HandleTypeDef *huart)
     finishISR(NOTIFY_RX_SUCCESSFUL);
 }
 
+void ReceiverModule::cbRxEventISR(UART_HandleTypeDef *huart, uint16_t pos)
+{
+    ReceiverModule &instance = *ReceiverModule::_instance;
+
+    // pos is RxRingSize on a wrap around, a whole lap when nothing came in between
+    const uint16_t received = pos == RxRingSize
+                                  ? RxRingSize - instance._rxDmaPos
+                                  : (pos + RxRingSize - instance._rxDmaPos) % RxRingSize;
+    instance._rxDmaPos = pos % RxRingSize;
+    instance._rxWritePos = instance._rxWritePos + received;
+
+    // half transfer is disabled, everything but a wrap around is an idle line
+    if (pos != RxRingSize)
+    {
+        instance._rxGapPos = instance._rxWritePos;
+        instance._rxGapPending = true;
+    }
+    finishISR(NOTIFY_RX_DATA);
+}
+
 void ReceiverModule::taskMain(void *inst)
 {
     // initial dma startup
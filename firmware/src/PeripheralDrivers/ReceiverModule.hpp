@@ -1,7 +1,9 @@
 #pragma once
 #include "SBUSDecoder.hpp"
+#include "SBUSFrameSynchronizer.hpp"
+#include "SBUSLinkMonitor.hpp"
+#include "Wrapper/SeqLock.hpp"
 #include "Wrapper/Task.hpp"
-#include <semphr.h>
 #include <stm32f3xx_hal.h>
 
 /**
@@ -17,6 +19,10 @@
  * As this task can start any time within a frame and the DMA requires
  * the exact size of the data to receive; the receive timeout functionality
  * is used to abort half complete receptions and retry.
+ *
+ * Alternatively in RxMode::CircularDMA the DMA runs continuously into a ring buffer
+ * and frame boundaries are found in software by SBUS::FrameSynchronizer.
+ * Reception is never stopped and doesn't need resynchronizing after errors.
  */
 
 namespace wrapper
@@ -45,8 +51,14 @@ class ReceiverModule
 public:
     static constexpr uint16_t StackSize = 220;
 
+    enum class RxMode : uint8_t
+    {
+        OneShotDMA,
+        CircularDMA
+    };
+
     ReceiverModule(UART_HandleTypeDef &huart, TIM_HandleTypeDef &tim, wrapper::HAL &hal,
-                   Logging &log);
+                   Logging &log, RxMode mode = RxMode::OneShotDMA);
     virtual ~ReceiverModule();
 
     ReceiverModule(const ReceiverModule &) = delete;
@@ -63,16 +75,33 @@ public:
     static constexpr uint32_t NOTIFY_RX_START = 1 << 0;
     static constexpr uint32_t NOTIFY_RX_SUCCESSFUL = 1 << 1;
     static constexpr uint32_t NOTIFY_ERROR = 1 << 2;
+    static constexpr uint32_t NOTIFY_RX_DATA = 1 << 3;
 
     /**
-     * @brief Retrieves the latest s.bus frame. Blocks for max. MUTEX_TIMEOUT
+     * @brief Retrieves the latest s.bus frame. Never blocks
      *
      * @param frame target to write to
      * @return true frame sucessfully copied
-     * @return false mutex timeout
+     * @return false frame was updated too often while copying
      */
     virtual bool getSBUSFrame(SBUS::Frame &frame);
-    static constexpr TickType_t MUTEX_TIMEOUT = pdMS_TO_TICKS(50);
+
+    /**
+     * @brief Retrieves radio link statistics. Never blocks
+     *
+     * @param stats target to write to
+     * @return true statistics sucessfully copied
+     * @return false statistics were updated too often while copying
+     */
+    virtual bool getLinkStatistics(SBUS::LinkStatistics &stats);
+
+    /**
+     * @brief Called on the ReceiverModule's task with every decoded frame after it is stored, so
+     * the application can react to inputs without polling. Set it before the tasks start
+     *
+     */
+    using FrameCallback = void (*)(void *context, const SBUS::Frame &frame);
+    void setFrameCallback(FrameCallback callback, void *context);
 
     /**
      * @brief Used in Receive timeout detection
@@ -83,6 +112,25 @@ public:
     static constexpr uint16_t TimerPeriod_Timeout =
         getTimerPeriod<FrameTime_us + InterFrameDelay_us + 1000>();
 
+    /**
+     * @brief Size of the DMA ring buffer in RxMode::CircularDMA
+     * Must hold more than two frames as the task is notified on idle line and on wrap around
+     *
+     */
+    static constexpr uint16_t RxRingSize = 64;
+    static_assert(RxRingSize > 2 * SBUS::Protocol::RAW_FRAME_SIZE);
+    static_assert((RxRingSize & (RxRingSize - 1)) == 0, "Positions are free running");
+
+    /**
+     * @brief Number of times the byte stream had to be realigned to frame boundaries, including
+     * the DMA overwriting bytes the task didn't read yet. Only counts in RxMode::CircularDMA
+     *
+     */
+    uint32_t getResyncCount() const
+    {
+        return _synchronizer.getResyncCount() + _rxOverruns;
+    }
+
     /**
      * @brief Hippomocks hooks for testing
      *
@@ -96,20 +144,51 @@ private:
     TIM_HandleTypeDef &_tim;
     wrapper::HAL &_hal;
     Logging &_log;
+    const RxMode _mode;
     wrapper::Task _task;
     static ReceiverModule* _instance;
 
     SBUS::Protocol::FrameData _rxBuffer;
-    SBUS::Frame _decodedFrame;
-    SemaphoreHandle_t _frameSemphr;
+    wrapper::SeqLock<SBUS::Frame> _decodedFrame;
+    FrameCallback _frameCallback{nullptr};
+    void *_frameCallbackContext{nullptr};
+
+    SBUS::LinkMonitor _linkMonitor;
+    wrapper::SeqLock<SBUS::LinkStatistics> _linkStatistics;
+    uint32_t _lastFrameCycles = 0;
+    bool _lastFrameCyclesValid = false;
+    uint32_t _reportedResyncs = 0;
     volatile bool _synchronized = false;
 
+    std::array<uint8_t, RxRingSize> _rxRing{};
+    // positions in the byte stream, free running, the ring index is pos % RxRingSize
+    uint32_t _rxReadPos = 0;
+    volatile uint32_t _rxWritePos = 0;
+    // idle line after the byte before _rxGapPos, the latest one only
+    volatile uint32_t _rxGapPos = 0;
+    volatile bool _rxGapPending = false;
+    // dma position of the last event, only the ISR
+    uint16_t _rxDmaPos = 0;
+    uint32_t _rxOverruns = 0;
+    SBUS::FrameSynchronizer _synchronizer;
+
+    void dispatchCircular(uint32_t flags);
+    void startCircularReception();
+    void consumeRxRing();
+    /**
+     * @brief Decodes data and stores the frame
+     *
+     * @return false data couldn't be decoded
+     */
+    bool processFrame(const SBUS::Protocol::FrameData &data);
+    void addResyncs(uint32_t count);
     void restartTimer();
 
     static void cbRxCompleteISR(UART_HandleTypeDef *huart);
     static void cbRxAbortISR(UART_HandleTypeDef *huart);
     static void finishISR(uint32_t flags);
     static void cbPeriodElapsedISR(TIM_HandleTypeDef *htim);
+    static void cbRxEventISR(UART_HandleTypeDef *huart, uint16_t pos);
 
     static void taskMain(void* parameter);
 };
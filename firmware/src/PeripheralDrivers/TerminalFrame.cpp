@@ -0,0 +1,166 @@
+#include "TerminalFrame.hpp"
+#include "ANSIEscapeCodes.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace remote_control_device
+{
+namespace
+{
+constexpr uint32_t FNVOffsetBasis = 2166136261U;
+constexpr uint32_t FNVPrime = 16777619U;
+constexpr size_t CursorBuffSize = 12;
+
+bool isColor(std::span<const char> str)
+{
+    return str.size() >= 3 && str[0] == '\x1b' && str[1] == '[' && str.back() == 'm';
+}
+} // namespace
+
+TerminalFrame::TerminalFrame(TerminalWriter &term) : _term(term)
+{
+}
+
+void TerminalFrame::begin()
+{
+    _statistics.frames++;
+    if (++_framesSinceRedraw >= FullRedrawFrames)
+    {
+        _redraw = true;
+    }
+    if (_redraw)
+    {
+        _framesSinceRedraw = 0;
+        forward(std::span(ANSIEscapeCodes::ClearTerminal, strlen(ANSIEscapeCodes::ClearTerminal)));
+        forward(std::span(ANSIEscapeCodes::MoveCursorToHome,
+                          strlen(ANSIEscapeCodes::MoveCursorToHome)));
+        _previousLines = 0;
+    }
+    _lines = 0;
+    _color.fill(0);
+    startLine();
+}
+
+void TerminalFrame::end()
+{
+    if (_lineStarted)
+    {
+        endLine();
+    }
+    if (_lines < _previousLines)
+    {
+        char buff[CursorBuffSize] = {0};
+        const int len = snprintf(buff, sizeof(buff), ANSIEscapeCodes::MoveCursorToRowFormat,
+                                 static_cast<unsigned>(_lines + 1));
+        forward(std::span(buff, static_cast<size_t>(len)));
+        forward(std::span(ANSIEscapeCodes::ClearToEndOfScreen,
+                          strlen(ANSIEscapeCodes::ClearToEndOfScreen)));
+    }
+    _previousLines = _lines;
+    _redraw = false;
+}
+
+void TerminalFrame::write(const char *str)
+{
+    write(std::span(str, strlen(str)));
+}
+
+void TerminalFrame::write(std::span<const char> str)
+{
+    if (isColor(str))
+    {
+        _color.fill(0);
+        // the reset leaves the default color
+        if (str.size() > 3)
+        {
+            memcpy(_color.data(), str.data(), std::min<size_t>(str.size(), ColorSize - 1));
+        }
+    }
+
+    for (const char c : str)
+    {
+        if (c == '\r')
+        {
+            continue;
+        }
+        if (c == '\n')
+        {
+            endLine();
+            continue;
+        }
+        _lineStarted = true;
+        _lineHash = hash(_lineHash, c);
+        if (_lineLength < LineSize)
+        {
+            _line[_lineLength++] = c;
+        }
+    }
+}
+
+void TerminalFrame::startLine()
+{
+    _lineColor = _color;
+    _lineLength = 0;
+    _lineStarted = false;
+    _lineHash = FNVOffsetBasis;
+    for (const char c : _lineColor)
+    {
+        _lineHash = hash(_lineHash, c);
+    }
+}
+
+void TerminalFrame::endLine()
+{
+    const bool tracked = _lines < MaxLines;
+    if (!_redraw && tracked && _lines < _previousLines && _hashes[_lines] == _lineHash)
+    {
+        _statistics.linesSkipped++;
+    }
+    else
+    {
+        char buff[CursorBuffSize] = {0};
+        const int len = snprintf(buff, sizeof(buff), ANSIEscapeCodes::MoveCursorToRowFormat,
+                                 static_cast<unsigned>(_lines + 1));
+        forward(std::span(buff, static_cast<size_t>(len)));
+
+        const char *color =
+            _lineColor[0] != 0 ? _lineColor.data() : ANSIEscapeCodes::ColorSection_End;
+        forward(std::span(color, strlen(color)));
+        _line[_lineLength] = 0;
+        forward(std::span(_line.data(), _lineLength));
+        // clearing with the default background
+        forward(std::span(ANSIEscapeCodes::ColorSection_End,
+                          strlen(ANSIEscapeCodes::ColorSection_End)));
+        forward(std::span(ANSIEscapeCodes::ClearToEndOfLine,
+                          strlen(ANSIEscapeCodes::ClearToEndOfLine)));
+        _statistics.linesWritten++;
+    }
+
+    if (tracked)
+    {
+        _hashes[_lines] = _lineHash;
+    }
+    if (_lines < UINT8_MAX)
+    {
+        _lines++;
+    }
+    startLine();
+}
+
+void TerminalFrame::forward(std::span<const char> str)
+{
+    if (str.empty())
+    {
+        return;
+    }
+    _term.write(str);
+    _statistics.bytesWritten += str.size();
+}
+
+uint32_t TerminalFrame::hash(uint32_t hash, char c)
+{
+    return (hash ^ static_cast<uint8_t>(c)) * FNVPrime;
+}
+
+} // namespace remote_control_device
@@ -0,0 +1,97 @@
+#pragma once
+#include "SpanCompatibility.hpp"
+#include "TerminalWriter.hpp"
+#include <array>
+#include <cstdint>
+
+/**
+ * @brief Redraws only the lines of the UI that changed since the previous frame
+ *
+ * The UI is written into the frame line by line like into the TerminalIO. Instead of the text a
+ * hash is kept per line, a line goes out to the terminal only when its hash differs from the
+ * one of the previous frame: the cursor is moved to its row, the line is written and the rest
+ * of the row cleared. Rows the previous frame had beyond the current one are cleared.
+ *
+ * Colors set by the text stay in effect across lines, so every line starts with the color
+ * active at its beginning. Color codes must be written on their own, see ANSIEscapeCodes.
+ *
+ * The first frame and every FullRedrawFrames one clear the terminal and draw all lines, a
+ * terminal connected later catches up with that.
+ */
+namespace remote_control_device
+{
+class TerminalFrame : public TerminalWriter
+{
+public:
+    static constexpr uint8_t MaxLines = 64;
+    // longer lines are cut off, their changes still get noticed
+    static constexpr uint8_t LineSize = 128;
+    static constexpr uint8_t ColorSize = 12;
+    static constexpr uint8_t FullRedrawFrames = 30;
+
+    struct Statistics
+    {
+        uint32_t frames{0};
+        uint32_t linesWritten{0};
+        uint32_t linesSkipped{0};
+        // written to the terminal, escape codes included
+        uint32_t bytesWritten{0};
+    };
+
+    explicit TerminalFrame(TerminalWriter &term);
+
+    /**
+     * @brief Starts a frame
+     *
+     */
+    void begin();
+
+    /**
+     * @brief Completes the last line and clears what's left of the previous frame
+     *
+     */
+    void end();
+
+    /**
+     * @brief The next frame clears the terminal and draws all lines
+     *
+     */
+    void invalidate()
+    {
+        _redraw = true;
+    }
+
+    void write(const char *) override;
+    void write(std::span<const char>) override;
+
+    const Statistics &getStatistics() const
+    {
+        return _statistics;
+    }
+
+private:
+    TerminalWriter &_term;
+    Statistics _statistics;
+    bool _redraw{true};
+    uint8_t _framesSinceRedraw{0};
+
+    std::array<uint32_t, MaxLines> _hashes{};
+    uint8_t _lines{0};
+    uint8_t _previousLines{0};
+
+    // line currently written, terminated when forwarded
+    std::array<char, LineSize + 1> _line{};
+    uint8_t _lineLength{0};
+    bool _lineStarted{false};
+    uint32_t _lineHash{0};
+    std::array<char, ColorSize> _lineColor{};
+
+    // color in effect at the end of everything written so far, empty for the default
+    std::array<char, ColorSize> _color{};
+
+    void startLine();
+    void endLine();
+    void forward(std::span<const char> str);
+    static uint32_t hash(uint32_t hash, char c);
+};
+} // namespace remote_control_device
@@ -5,11 +5,12 @@
 #include <cmsis_os2.h>
 #include <cstring>
 
-// DO NOT USE LOGGING IN THIS TASK AS IT WILL CAUSE SLOWDOWN
+// DO NOT CALL write() IN THIS TASK AS IT WILL CAUSE SLOWDOWN
 // Due to ram constraints the TX stream is very small
-// log will cause a call to write() which when the stream is full
+// write() when the stream is full
 // will block until timeout or data is transmitted
 // this task is the only one transmitting so timeout will always occur
+// The log only ever goes in as far as there is space, see streamLog()
 
 namespace remote_control_device
 {
@@ -45,6 +46,12 @@ void TerminalIO::dispatch(uint32_t flags)
         flags |= NOTIFY_TX_START;
     }
 
+    // a transfer completing made space for the log
+    if ((flags & (NOTIFY_LOG | NOTIFY_TX_START)) > 0 && streamLog())
+    {
+        flags |= NOTIFY_TX_START;
+    }
+
     // transmit data via dma
     if ((flags & NOTIFY_TX_START) > 0)
     {
@@ -112,6 +119,51 @@ void TerminalIO::write(std::span<const char> str)
     }
 }
 
+void TerminalIO::notifyLog()
+{
+    if (wrapper::HAL::IsInISR())
+    {
+        BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+        _task.notifyFromISR(NOTIFY_LOG, eNotifyAction::eSetBits, &xHigherPriorityTaskWoken);
+        portYIELD_FROM_ISR(xHigherPriorityTaskWoken); // NOLINT
+        return;
+    }
+    _task.notify(NOTIFY_LOG, eNotifyAction::eSetBits);
+}
+
+bool TerminalIO::streamLog()
+{
+    // the UI owns the terminal, rest of the line is dropped
+    if (_log.isDisabled())
+    {
+        _logOutputSent = _logOutputSize;
+    }
+
+    bool streamed = false;
+    for (;;)
+    {
+        if (_logOutputSent == _logOutputSize)
+        {
+            _logOutputSize = _log.takeOutput(_logOutput);
+            _logOutputSent = 0;
+            if (_logOutputSize == 0)
+            {
+                break;
+            }
+        }
+        // lines may be longer than the stream, they are continued after the next transfer
+        const size_t sent = xStreamBufferSend(_txStream, &_logOutput[_logOutputSent],
+                                              _logOutputSize - _logOutputSent, 0);
+        _logOutputSent += sent;
+        streamed = streamed || sent > 0;
+        if (_logOutputSent < _logOutputSize)
+        {
+            break;
+        }
+    }
+    return streamed;
+}
+
 void TerminalIO::finishISR(uint32_t flags)
 {
     BaseType_t xHigherPriorityTaskWoken = pdFALSE;
@@ -1,6 +1,7 @@
 #pragma once
 #include "Logging.hpp"
 #include "SpanCompatibility.hpp"
+#include "TerminalWriter.hpp"
 #include "Wrapper/HAL.hpp"
 #include "Wrapper/Task.hpp"
 #include <stream_buffer.h>
@@ -19,7 +20,7 @@
 namespace remote_control_device
 {
 
-class TerminalIO
+class TerminalIO : public TerminalWriter
 {
 public:
     static constexpr uint16_t StackSize = 150;
@@ -38,6 +39,7 @@ public:
      */
     virtual void dispatch(uint32_t flags);
     static constexpr uint32_t NOTIFY_TX_START = 1 << 0;
+    static constexpr uint32_t NOTIFY_LOG = 1 << 1;
     static constexpr uint32_t NOTIFY_ERROR = 1 << 3;
 
     /**
@@ -77,10 +79,16 @@ public:
     /**
      * @brief Adds data to be transmitted later,
      * SteamBuffers may only be written / read from one task
-     * Logging provides mutex against mutual access
+     * The task itself streams the log while it is enabled, afterwards only the UI writes
      */
-    virtual void write(const char *); // only use with literals
-    virtual void write(std::span<const char>);
+    void write(const char *) override; // only use with literals
+    void write(std::span<const char>) override;
+
+    /**
+     * @brief Lets the task send what the Logging queued, from tasks and ISRs
+     *
+     */
+    void notifyLog();
 
     /* Hooks for testing */
     static void testHook_ErrorHALTXStart(){};
@@ -101,6 +109,18 @@ private:
     uint8_t _txAttempts = 0;
     uint8_t _txTransferBuffer[TX_TRANSFER_BUFFER_SIZE] = {0}; // NOLINT
 
+    // taken from the Logging, waiting for space in the stream
+    std::array<char, Logging::OUTPUT_SIZE> _logOutput{};
+    size_t _logOutputSize = 0;
+    size_t _logOutputSent = 0;
+
+    /**
+     * @brief Moves as much of the log as fits into the stream, never blocks
+     *
+     * @return true anything moved
+     */
+    bool streamLog();
+
     static void cbTxCompleteISR(UART_HandleTypeDef *huart);
     static void cbErrorISR(UART_HandleTypeDef *huart);
     static void finishISR(uint32_t flags);
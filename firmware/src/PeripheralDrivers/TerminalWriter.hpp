@@ -0,0 +1,24 @@
+#pragma once
+#include "SpanCompatibility.hpp"
+
+namespace remote_control_device
+{
+/**
+ * @brief Anything the UI parts can write their text to, the TerminalIO or a TerminalFrame
+ *
+ */
+class TerminalWriter
+{
+public:
+    TerminalWriter() = default;
+    virtual ~TerminalWriter() = default;
+
+    TerminalWriter(const TerminalWriter &) = delete;
+    TerminalWriter(TerminalWriter &&) = delete;
+    TerminalWriter &operator=(const TerminalWriter &) = delete;
+    TerminalWriter &operator=(TerminalWriter &&) = delete;
+
+    virtual void write(const char *) = 0; // only use with literals
+    virtual void write(std::span<const char>) = 0;
+};
+} // namespace remote_control_device
@@ -3,7 +3,107 @@
 namespace remote_control_device::SBUS
 {
 
+namespace
+{
+/**
+ * @brief Where the n-th channel of a group starts (byte offset, bit shift)
+ * relative to the group's first byte
+ *
+ */
+struct ChannelLocation
+{
+    uint8_t byteOffset;
+    uint8_t shift;
+};
+
+constexpr std::array<ChannelLocation, Protocol::ChannelGroup_ChannelCount> makeLocationTable()
+{
+    std::array<ChannelLocation, Protocol::ChannelGroup_ChannelCount> table{};
+    for (uint8_t i = 0; i < Protocol::ChannelGroup_ChannelCount; ++i)
+    {
+        const uint8_t bitOffset = i * Protocol::Analog_Channel_Bit_Width;
+        table[i].byteOffset = bitOffset / 8;
+        table[i].shift = bitOffset % 8;
+    }
+    return table;
+}
+
+constexpr auto ChannelLocations = makeLocationTable();
+constexpr uint16_t ChannelMask = (1 << Protocol::Analog_Channel_Bit_Width) - 1;
+
+// a channel spans up to three bytes (shift > 5), reading the third byte of the last channel
+// in a group touches the next group / the flag byte which is masked out anyways
+static_assert(1 + Protocol::ChannelGroup_Count * Protocol::ChannelGroup_ByteCount + 1 <
+              Protocol::RAW_FRAME_SIZE);
+} // namespace
+
 std::pair<DecodeError, Frame> Decoder::decode(const Protocol::FrameData &data)
+{
+    if constexpr (UseGroupedEngine)
+    {
+        return decodeGrouped(data);
+    }
+    else
+    {
+        return decodeBitwise(data);
+    }
+}
+
+std::pair<DecodeError, Frame> Decoder::decodeGrouped(const Protocol::FrameData &data)
+{
+    // check start, endbyte
+    if (data[0] != Protocol::StartByte || data[Protocol::RAW_FRAME_SIZE - 1] != Protocol::EndByte)
+    {
+        return std::make_pair(DecodeError::StartOrEndbyte, Frame());
+    }
+
+    const uint8_t flags = data[Protocol::RAW_FRAME_SIZE - 2];
+
+    // check flag byte empty portion
+    if ((flags & Protocol::Mask_FlagByte_Empty) != 0)
+    {
+        return std::make_pair(DecodeError::IllegalFlagByte, Frame());
+    }
+
+    Frame target;
+
+    if ((flags & Protocol::Mask_FlagByte_Failsafe) > 0)
+    {
+        // see decodeBitwise, frame stays at its failsafe defaults
+        return std::make_pair(DecodeError::NoError, target);
+    }
+
+    target.digitalCh17 = (flags & Protocol::Mask_FlagByte_Ch17) > 0;
+    target.digitalCh18 = (flags & Protocol::Mask_FlagByte_Ch18) > 0;
+    target.frameLost = (flags & Protocol::Mask_FlagByte_FrameLost) > 0;
+    target.failsafe = false;
+
+    // extract, check and scale analog channels in one go
+    uint16_t *channel = target.analogChannels.data();
+    for (uint8_t group = 0; group < Protocol::ChannelGroup_Count; ++group)
+    {
+        const uint8_t *groupData = &data[1 + group * Protocol::ChannelGroup_ByteCount];
+        for (const ChannelLocation &loc : ChannelLocations)
+        {
+            const uint8_t *src = groupData + loc.byteOffset;
+            const uint32_t word = static_cast<uint32_t>(src[0]) |
+                                  (static_cast<uint32_t>(src[1]) << 8) |
+                                  (static_cast<uint32_t>(src[2]) << 16);
+            const uint16_t val = static_cast<uint16_t>(word >> loc.shift) & ChannelMask;
+
+            if (val < Protocol::Analog_Channel_RawSanityRange_Min ||
+                val > Protocol::Analog_Channel_RawSanityRange_Max)
+            {
+                return std::make_pair(DecodeError::AnalogChannelSanityCheckRange, Frame());
+            }
+            *channel++ = scaleRawValue(val);
+        }
+    }
+
+    return std::make_pair(DecodeError::NoError, target);
+}
+
+std::pair<DecodeError, Frame> Decoder::decodeBitwise(const Protocol::FrameData &data)
 {
     // check start, endbyte
     if (data[0] != Protocol::StartByte || data[Protocol::RAW_FRAME_SIZE - 1] != Protocol::EndByte)
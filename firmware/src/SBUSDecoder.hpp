@@ -36,6 +36,8 @@ enum class DecodeError : uint8_t {
     AnalogChannelIndexOOB,
     AnalogChannelSanityCheckRange
 };
+static constexpr uint8_t DecodeErrorCount =
+    static_cast<uint8_t>(DecodeError::AnalogChannelSanityCheckRange) + 1;
 
 class Decoder
 {
@@ -66,12 +68,38 @@ public:
     /**
      * @brief Decodes an sbus frame
      * On errro will return a zeroed out frame
+     * Uses the engine selected with UseGroupedEngine
      * 
      * @param data raw data 
      * @return std::pair<DecodeErrors, Frame> 
      */
     static std::pair<DecodeError, Frame> decode(const Protocol::FrameData &data);
 
+    /**
+     * @brief Reference engine. Unpacks the analog channels bit by bit,
+     * range checks and scales them in separate passes.
+     *
+     * @param data raw data
+     * @return std::pair<DecodeError, Frame>
+     */
+    static std::pair<DecodeError, Frame> decodeBitwise(const Protocol::FrameData &data);
+
+    /**
+     * @brief Table driven engine. Unpacks 8 channels at a time from 11 bytes
+     * using precomputed byte offsets / shifts and range checks and scales
+     * every channel in the same pass. Results are bit exact to decodeBitwise.
+     *
+     * @param data raw data
+     * @return std::pair<DecodeError, Frame>
+     */
+    static std::pair<DecodeError, Frame> decodeGrouped(const Protocol::FrameData &data);
+
+    /**
+     * @brief Selects the engine decode() uses
+     *
+     */
+    static constexpr bool UseGroupedEngine = true;
+
     /**
      * @brief Scales raw values from FrameData to ANALOG_CHANNEL_MIN - ANALOG_CHANNEL_MAX
      * 
@@ -0,0 +1,61 @@
+#include "SBUSFrameSynchronizer.hpp"
+#include <algorithm>
+
+namespace remote_control_device::SBUS
+{
+
+bool FrameSynchronizer::pushByte(uint8_t byte)
+{
+    if (_fill == 0 && byte != Protocol::StartByte)
+    {
+        // not within a frame, skip until the next start byte shows up
+        return false;
+    }
+
+    _window[_fill++] = byte;
+    if (_fill < Protocol::RAW_FRAME_SIZE)
+    {
+        return false;
+    }
+
+    if (isFramePlausible())
+    {
+        _fill = 0;
+        return true;
+    }
+
+    // we started on a start byte value within the payload
+    slideToNextStartByte();
+    return false;
+}
+
+void FrameSynchronizer::signalGap()
+{
+    if (_fill > 0)
+    {
+        _resyncCount++;
+        _fill = 0;
+    }
+}
+
+void FrameSynchronizer::reset()
+{
+    _fill = 0;
+}
+
+bool FrameSynchronizer::isFramePlausible() const
+{
+    return _window.front() == Protocol::StartByte && _window.back() == Protocol::EndByte &&
+           (_window[Protocol::RAW_FRAME_SIZE - 2] & Protocol::Mask_FlagByte_Empty) == 0;
+}
+
+void FrameSynchronizer::slideToNextStartByte()
+{
+    _resyncCount++;
+
+    const auto next = std::find(_window.begin() + 1, _window.end(), Protocol::StartByte);
+    std::copy(next, _window.end(), _window.begin());
+    _fill = std::distance(next, _window.end());
+}
+
+} // namespace remote_control_device::SBUS
@@ -0,0 +1,72 @@
+#pragma once
+#include "SBUSProtocol.hpp"
+#include <FreeRTOS.h>
+#include <array>
+
+namespace remote_control_device::SBUS
+{
+
+/**
+ * @brief Finds S.BUS frame boundaries within a continuous byte stream
+ *
+ * Bytes are collected into a window of RAW_FRAME_SIZE starting at a start byte.
+ * A full window is only handed out when its end byte and flag byte are plausible,
+ * otherwise the window slides to the next start byte within it. This way
+ * a single corrupted or lost byte costs at most the frame it belongs to.
+ *
+ * The receiver pauses between frames, signalGap() uses this to drop partial
+ * frames and to realign on the next start byte.
+ */
+class FrameSynchronizer
+{
+public:
+    /**
+     * @brief Feeds one byte into the synchronizer
+     *
+     * @param byte
+     * @return true a complete frame is available via getFrame()
+     * @return false more data is needed
+     */
+    bool pushByte(uint8_t byte);
+
+    /**
+     * @brief Signals an inter frame gap (idle line)
+     * Any partially received frame is discarded
+     *
+     */
+    void signalGap();
+
+    /**
+     * @brief Drops all buffered data, resync counter is kept
+     *
+     */
+    void reset();
+
+    /**
+     * @brief Last complete frame, valid after pushByte() returned true
+     *
+     */
+    const Protocol::FrameData &getFrame() const
+    {
+        return _window;
+    }
+
+    /**
+     * @brief Number of times data had to be dropped to realign on a frame boundary
+     *
+     */
+    uint32_t getResyncCount() const
+    {
+        return _resyncCount;
+    }
+
+private:
+    Protocol::FrameData _window{};
+    uint8_t _fill = 0;
+    uint32_t _resyncCount = 0;
+
+    bool isFramePlausible() const;
+    void slideToNextStartByte();
+};
+
+} // namespace remote_control_device::SBUS
@@ -0,0 +1,67 @@
+#include "SBUSLinkMonitor.hpp"
+#include <algorithm>
+
+namespace remote_control_device::SBUS
+{
+
+void LinkMonitor::frameReceived(DecodeError error, const Frame &frame, uint32_t now_ms,
+                                uint32_t interArrival_us)
+{
+    _stats.decodeResults[static_cast<uint8_t>(error)]++;
+
+    if (interArrival_us > 0)
+    {
+        _stats.maxInterArrival_us = std::max(_stats.maxInterArrival_us, interArrival_us);
+        if (_lastInterArrival_us > 0)
+        {
+            const uint32_t jitter = interArrival_us > _lastInterArrival_us
+                                        ? interArrival_us - _lastInterArrival_us
+                                        : _lastInterArrival_us - interArrival_us;
+            _stats.jitterHistogram[getJitterBucket(jitter)]++;
+        }
+        _lastInterArrival_us = interArrival_us;
+    }
+
+    if (error == DecodeError::NoError)
+    {
+        _framesInWindow++;
+        if (frame.frameLost)
+        {
+            _stats.frameLostCount++;
+        }
+        if (frame.failsafe)
+        {
+            _stats.failsafeCount++;
+        }
+    }
+
+    if (now_ms - _stats.windowStart >= Window_Ms)
+    {
+        // scale in case reception stalled for longer than a window
+        _stats.framesPerSecond = (_framesInWindow * Window_Ms) / (now_ms - _stats.windowStart);
+        _stats.windowStart = now_ms;
+        _framesInWindow = 0;
+    }
+}
+
+void LinkMonitor::addResyncs(uint32_t count)
+{
+    _stats.resyncCount += count;
+}
+
+uint16_t LinkMonitor::getFramesPerSecond(const LinkStatistics &stats, uint32_t now_ms)
+{
+    if (now_ms - stats.windowStart > 2 * Window_Ms)
+    {
+        return 0;
+    }
+    return stats.framesPerSecond;
+}
+
+uint8_t LinkMonitor::getJitterBucket(uint32_t jitter_us)
+{
+    const auto &limits = LinkStatistics::JitterBucketLimits_us;
+    return std::distance(limits.begin(), std::lower_bound(limits.begin(), limits.end(), jitter_us));
+}
+
+} // namespace remote_control_device::SBUS
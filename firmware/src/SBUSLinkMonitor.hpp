@@ -0,0 +1,79 @@
+#pragma once
+#include "SBUSDecoder.hpp"
+#include <FreeRTOS.h>
+#include <array>
+
+namespace remote_control_device::SBUS
+{
+
+/**
+ * @brief Snapshot of the radio link quality
+ *
+ * Jitter is the difference between two consecutive inter arrival times, so it doesn't depend
+ * on the frame rate the receiver is configured to. frameLost / failsafe are set by the receiver
+ * and point to RF problems, long inter arrival times and resyncs without them point to us.
+ */
+struct LinkStatistics
+{
+    // upper bounds of the jitter histogram buckets, last bucket takes everything above
+    static constexpr std::array<uint32_t, 6> JitterBucketLimits_us = {100,  250,  500,
+                                                                      1000, 2500, 5000};
+    static constexpr uint8_t JitterBucketCount = JitterBucketLimits_us.size() + 1;
+
+    uint16_t framesPerSecond = 0;
+    uint32_t maxInterArrival_us = 0;
+    std::array<uint32_t, JitterBucketCount> jitterHistogram{};
+
+    // indexed by DecodeError, NoError counts decoded frames
+    std::array<uint32_t, DecodeErrorCount> decodeResults{};
+    uint32_t frameLostCount = 0;
+    uint32_t failsafeCount = 0;
+    uint32_t resyncCount = 0;
+
+    // start of the measurement window framesPerSecond belongs to
+    uint32_t windowStart = 0;
+};
+
+/**
+ * @brief Accumulates LinkStatistics from the frames ReceiverModule hands over
+ *
+ */
+class LinkMonitor
+{
+public:
+    static constexpr uint32_t Window_Ms = 1000;
+
+    /**
+     * @brief Records a received frame
+     *
+     * @param error decode result
+     * @param frame decoded frame, only looked at when error is NoError
+     * @param now_ms tick of reception
+     * @param interArrival_us time since the previous frame, 0 for the first frame
+     */
+    void frameReceived(DecodeError error, const Frame &frame, uint32_t now_ms,
+                       uint32_t interArrival_us);
+
+    void addResyncs(uint32_t count);
+
+    const LinkStatistics &getStatistics() const
+    {
+        return _stats;
+    }
+
+    /**
+     * @brief framesPerSecond of a snapshot is only updated on reception,
+     * returns 0 when the link has been dead for more than a window
+     *
+     */
+    static uint16_t getFramesPerSecond(const LinkStatistics &stats, uint32_t now_ms);
+
+    static uint8_t getJitterBucket(uint32_t jitter_us);
+
+private:
+    LinkStatistics _stats;
+    uint16_t _framesInWindow = 0;
+    uint32_t _lastInterArrival_us = 0;
+};
+
+} // namespace remote_control_device::SBUS
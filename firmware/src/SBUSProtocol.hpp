@@ -31,6 +31,13 @@ static constexpr uint16_t Analog_Channel_RawSanityRange_Max = 1950;
 
 static constexpr uint8_t ANALOG_CHANNEL_COUNT = 16;
 
+// Channels are packed LSB first without padding, 8 channels fit exactly into 11 bytes
+static constexpr uint8_t ChannelGroup_ChannelCount = 8;
+static constexpr uint8_t ChannelGroup_ByteCount = 11;
+static constexpr uint8_t ChannelGroup_Count = ANALOG_CHANNEL_COUNT / ChannelGroup_ChannelCount;
+static_assert(ChannelGroup_ChannelCount * Analog_Channel_Bit_Width == ChannelGroup_ByteCount * 8);
+static_assert(ChannelGroup_Count * ChannelGroup_ChannelCount == ANALOG_CHANNEL_COUNT);
+
 static constexpr uint16_t RAW_FRAME_SIZE = 25;
 using FrameData = std::array<uint8_t, RAW_FRAME_SIZE>;
 
@@ -0,0 +1,254 @@
+#pragma once
+#include "StateSources.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Every CANopen node the RCD knows about, in one table
+ *
+ * Canopen builds its monitored / state controlled device and coupling records, the node id lookup
+ * table, the heartbeat consumer entries (1016h) it writes into the object dictionary and the
+ * device names of the UI from it. Adding a device only takes a line here. The .od has to provide
+ * as many heartbeat consumer entries as there are monitored devices, their values get replaced.
+ */
+namespace remote_control_device
+{
+
+/**
+ * @brief List of all available bus devices. Not all devices listed here are monitored / state
+ * controlled
+ *
+ */
+enum class BusDevices : uint8_t
+{
+    RemoteControlDevice = 0x01,
+    RealTimeDevice = 0x02,
+    DriveMotorController = 0x10,
+    WheelSpeedSensor = 0x11,
+    BrakeActuator = 0x20,
+    BrakePressureSensor = 0x21,
+    SteeringActuator = 0x30,
+    SteeringAngleSensor = 0x31,
+    NO_DEVICE = 0xff
+};
+
+namespace bus_devices
+{
+
+static constexpr uint16_t HeartbeatConsumerTimeout_ms = 500;
+static constexpr uint8_t MaxNodeId = 127;
+
+/**
+ * @brief SDO write switching a coupling, odIndex 0 for devices without one
+ *
+ */
+struct CouplingDescription
+{
+    uint16_t odIndex;
+    uint8_t odSubIndex;
+    uint32_t engagedValue;
+    uint32_t disengagedValue;
+};
+static constexpr CouplingDescription NoCoupling = {0, 0, 0, 0};
+
+struct DeviceDescription
+{
+    BusDevices device;
+    const char *name;
+    // heartbeat consumer timeout, 0 for devices that aren't monitored
+    uint16_t heartbeatTimeout_ms;
+    // target state after startup, Unknown for devices the RCD doesn't switch
+    CanDeviceState stateControl;
+    CouplingDescription coupling;
+
+    constexpr bool isMonitored() const
+    {
+        return heartbeatTimeout_ms != 0;
+    }
+    constexpr bool isStateControlled() const
+    {
+        return stateControl != CanDeviceState::Unknown;
+    }
+    constexpr bool hasCoupling() const
+    {
+        return coupling.odIndex != 0;
+    }
+};
+
+// clang-format off
+static constexpr std::array<DeviceDescription, 8> Devices = {{
+    {BusDevices::RemoteControlDevice, "Remote Control Device (1h)", 0, CanDeviceState::Unknown,
+     NoCoupling},
+    // monitored through the RTD_State RPDO's timeout instead of a heartbeat
+    {BusDevices::RealTimeDevice, "Real Time Device (2h)", 0, CanDeviceState::Unknown, NoCoupling},
+    {BusDevices::DriveMotorController, "Drive Motor Controller (10h)", HeartbeatConsumerTimeout_ms,
+     CanDeviceState::Operational, NoCoupling},
+    {BusDevices::WheelSpeedSensor, "Wheel Speed Sensor (11h)", 0, CanDeviceState::Unknown,
+     NoCoupling},
+    {BusDevices::BrakeActuator, "Brake Actuator (20h)", HeartbeatConsumerTimeout_ms,
+     CanDeviceState::Operational, {0x60FE, 0x1, 0x00010000, 0x0}},
+    {BusDevices::BrakePressureSensor, "Brake Pressure Sensor (21h)", HeartbeatConsumerTimeout_ms,
+     CanDeviceState::Operational, NoCoupling},
+    {BusDevices::SteeringActuator, "Steering Actuator (30h)", HeartbeatConsumerTimeout_ms,
+     CanDeviceState::Operational, {0x60FE, 0x1, 0x00010000, 0x0}},
+    {BusDevices::SteeringAngleSensor, "Steering Angle Sensor (31h)", HeartbeatConsumerTimeout_ms,
+     CanDeviceState::Unknown, NoCoupling},
+}};
+// clang-format on
+
+template <typename Predicate>
+constexpr size_t count(Predicate predicate)
+{
+    size_t n = 0;
+    for (const DeviceDescription &description : Devices)
+    {
+        n += predicate(description) ? 1 : 0;
+    }
+    return n;
+}
+
+/**
+ * @brief Devices matching predicate in table order
+ *
+ */
+template <size_t N, typename Predicate>
+constexpr std::array<BusDevices, N> select(Predicate predicate)
+{
+    std::array<BusDevices, N> devices{};
+    size_t n = 0;
+    for (const DeviceDescription &description : Devices)
+    {
+        if (predicate(description))
+        {
+            devices[n++] = description.device;
+        }
+    }
+    return devices;
+}
+
+constexpr bool isMonitored(const DeviceDescription &description)
+{
+    return description.isMonitored();
+}
+constexpr bool isStateControlled(const DeviceDescription &description)
+{
+    return description.isStateControlled();
+}
+constexpr bool hasCoupling(const DeviceDescription &description)
+{
+    return description.hasCoupling();
+}
+
+static constexpr size_t MonitoredCount = count(isMonitored);
+static constexpr size_t StateControlledCount = count(isStateControlled);
+static constexpr size_t CouplingCount = count(hasCoupling);
+
+static constexpr std::array<BusDevices, MonitoredCount> Monitored =
+    select<MonitoredCount>(isMonitored);
+static constexpr std::array<BusDevices, StateControlledCount> StateControlled =
+    select<StateControlledCount>(isStateControlled);
+static constexpr std::array<BusDevices, CouplingCount> Couplings =
+    select<CouplingCount>(hasCoupling);
+
+/**
+ * @brief Where the records of a node are, NoSlot if it has none of that kind
+ *
+ */
+struct NodeSlots
+{
+    uint8_t description;
+    uint8_t monitored;
+    uint8_t stateControlled;
+    uint8_t coupling;
+};
+static constexpr uint8_t NoSlot = 0xff;
+
+constexpr std::array<NodeSlots, MaxNodeId + 1> makeNodeTable()
+{
+    std::array<NodeSlots, MaxNodeId + 1> table{};
+    for (NodeSlots &slots : table)
+    {
+        slots = {NoSlot, NoSlot, NoSlot, NoSlot};
+    }
+    uint8_t monitored = 0;
+    uint8_t stateControlled = 0;
+    uint8_t coupling = 0;
+    for (uint8_t i = 0; i < Devices.size(); ++i)
+    {
+        NodeSlots &slots = table[static_cast<uint8_t>(Devices[i].device)];
+        slots.description = i;
+        slots.monitored = Devices[i].isMonitored() ? monitored++ : NoSlot;
+        slots.stateControlled = Devices[i].isStateControlled() ? stateControlled++ : NoSlot;
+        slots.coupling = Devices[i].hasCoupling() ? coupling++ : NoSlot;
+    }
+    return table;
+}
+
+/**
+ * @brief Node id indexed, callbacks look their device up without searching
+ *
+ */
+static constexpr std::array<NodeSlots, MaxNodeId + 1> NodeTable = makeNodeTable();
+
+constexpr NodeSlots getNodeSlots(BusDevices device)
+{
+    const auto nodeId = static_cast<uint8_t>(device);
+    return nodeId <= MaxNodeId ? NodeTable[nodeId] : NodeSlots{NoSlot, NoSlot, NoSlot, NoSlot};
+}
+
+/**
+ * @brief Only for devices in the table
+ *
+ */
+constexpr const DeviceDescription &getDescription(BusDevices device)
+{
+    return Devices[getNodeSlots(device).description];
+}
+
+/**
+ * @brief 1016h values: node id in bits 16-22, timeout in ms below
+ *
+ */
+constexpr std::array<uint32_t, MonitoredCount> makeHeartbeatConsumerEntries()
+{
+    std::array<uint32_t, MonitoredCount> entries{};
+    for (size_t i = 0; i < MonitoredCount; ++i)
+    {
+        entries[i] = (static_cast<uint32_t>(Monitored[i]) << 16) |
+                     getDescription(Monitored[i]).heartbeatTimeout_ms;
+    }
+    return entries;
+}
+static constexpr std::array<uint32_t, MonitoredCount> HeartbeatConsumerEntries =
+    makeHeartbeatConsumerEntries();
+
+constexpr bool nodeIdsValid()
+{
+    for (size_t i = 0; i < Devices.size(); ++i)
+    {
+        const auto nodeId = static_cast<uint8_t>(Devices[i].device);
+        if (nodeId == 0 || nodeId > MaxNodeId || getNodeSlots(Devices[i].device).description != i)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+static_assert(nodeIdsValid(), "Node ids have to be unique and within 1 to 127");
+
+constexpr bool couplingsMonitored()
+{
+    for (const DeviceDescription &description : Devices)
+    {
+        if (description.hasCoupling() && !description.isMonitored())
+        {
+            return false;
+        }
+    }
+    return true;
+}
+static_assert(couplingsMonitored(), "Coupling SDOs need to know whether their device is online");
+
+} // namespace bus_devices
+} // namespace remote_control_device
@@ -0,0 +1,157 @@
+#pragma once
+#include "Canopen.hpp"
+#include "PeripheralDrivers/CanIO.hpp"
+#include "PeripheralDrivers/CanTrafficStats.hpp"
+#include <array>
+
+/**
+ * @brief Worst case bus load of the periodic traffic around the RCD, checked at compile time
+ *
+ * Every periodic frame is counted with its worst case stuffed length and its period: our TPDOs
+ * (on change ones at their inhibit time) and heartbeat, the SYNC of the synchronous PDO
+ * schedules, the RTD's RPDO and the heartbeats of the monitored devices of the device table.
+ * Sporadic traffic (SDO, NMT, emergencies) and the other nodes' PDOs aren't known here, the
+ * ceiling has to leave room for them. Change it with BUILDCONFIG_CAN_BUSLOAD_CEILING_PERMILLE.
+ *
+ * Raising a PDO rate beyond the ceiling fails the build. CanBusLoadTest checks the table against
+ * the object dictionary and prints it as report.
+ */
+
+#ifndef BUILDCONFIG_CAN_BUSLOAD_CEILING_PERMILLE
+#define BUILDCONFIG_CAN_BUSLOAD_CEILING_PERMILLE 300
+#endif
+
+namespace remote_control_device::bus_load
+{
+
+struct PeriodicFrame
+{
+    const char *name;
+    uint16_t cobId;
+    uint8_t length;
+    uint16_t period_ms;
+};
+
+static constexpr uint16_t Ceiling_permille = BUILDCONFIG_CAN_BUSLOAD_CEILING_PERMILLE;
+
+/**
+ * @brief Heartbeat producer time configured on the monitored devices
+ *
+ */
+static constexpr uint16_t RemoteHeartbeatTime_ms = 100;
+constexpr bool heartbeatsWithinTimeouts()
+{
+    for (const bus_devices::DeviceDescription &description : bus_devices::Devices)
+    {
+        if (description.isMonitored() && description.heartbeatTimeout_ms <= RemoteHeartbeatTime_ms)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+static_assert(heartbeatsWithinTimeouts(), "Monitored devices would time out");
+
+static constexpr uint8_t HeartbeatLength = 1;
+
+constexpr uint16_t heartbeatCobId(Canopen::BusDevices device)
+{
+    return (NODE_GUARD << 7) + static_cast<uint16_t>(device);
+}
+
+constexpr uint16_t tpdoPeriod_ms(Canopen::TPDOIndex index)
+{
+    return Canopen::DefaultTPDOPolicies.at(static_cast<uint8_t>(index)).worstCasePeriod_ms();
+}
+
+constexpr bool tpdosBounded()
+{
+    for (const TPDOPolicy &policy : Canopen::DefaultTPDOPolicies)
+    {
+        if (policy.worstCasePeriod_ms() == 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+static_assert(tpdosBounded(), "On change TPDOs need an inhibit time to be modeled");
+
+/**
+ * @brief Frames not coming from the device table
+ *
+ */
+static constexpr std::array<PeriodicFrame, 8> OwnFrames = {{
+    {"SYNC", Canopen::SyncCobId, 0, Canopen::SyncPeriod_ms},
+    {"TPDO SelfState",
+     Canopen::TPDO1_BaseCobId + static_cast<uint16_t>(Canopen::BusDevices::RemoteControlDevice),
+     Canopen::TPDO1_Length, tpdoPeriod_ms(Canopen::TPDOIndex::SelfState)},
+    {"TPDO BrakeForce", Canopen::TPDO2_BrakeCobId, Canopen::TPDO2_Length,
+     tpdoPeriod_ms(Canopen::TPDOIndex::BrakeForce)},
+    {"TPDO SteeringAngle", Canopen::TPDO3_SteeringCobId, Canopen::TPDO3_Length,
+     tpdoPeriod_ms(Canopen::TPDOIndex::SteeringAngle)},
+    {"TPDO MotorTorque", Canopen::TPDO4_WheelTorqueCobId, Canopen::TPDO4_Length,
+     tpdoPeriod_ms(Canopen::TPDOIndex::MotorTorque)},
+    {"TPDO TargetValues", Canopen::TPDO5_TargetValues, Canopen::TPDO5_Length,
+     tpdoPeriod_ms(Canopen::TPDOIndex::TargetValues)},
+    {"RPDO RTD_State", Canopen::RPDO1_RTD_State, Canopen::RPDO1_Length,
+     Canopen::RTD_RPDOEventTime_ms},
+    {"Heartbeat RCD", heartbeatCobId(Canopen::BusDevices::RemoteControlDevice), HeartbeatLength,
+     Canopen::HeartbeatProducerTime_ms},
+}};
+
+/**
+ * @brief Appends a heartbeat named after the device for every monitored device of the device
+ * table
+ *
+ */
+template <size_t N>
+constexpr std::array<PeriodicFrame, N + bus_devices::MonitoredCount> withMonitoredHeartbeats(
+    const std::array<PeriodicFrame, N> &frames)
+{
+    std::array<PeriodicFrame, N + bus_devices::MonitoredCount> all{};
+    for (size_t i = 0; i < N; ++i)
+    {
+        all[i] = frames[i];
+    }
+    for (size_t i = 0; i < bus_devices::MonitoredCount; ++i)
+    {
+        const BusDevices device = bus_devices::Monitored[i];
+        all[N + i] = {bus_devices::getDescription(device).name, heartbeatCobId(device),
+                      HeartbeatLength, RemoteHeartbeatTime_ms};
+    }
+    return all;
+}
+
+static constexpr auto PeriodicFrames = withMonitoredHeartbeats(OwnFrames);
+
+/**
+ * @brief Rounded up so the model never underestimates
+ *
+ */
+constexpr uint32_t bitsPerSecond(const PeriodicFrame &frame)
+{
+    return ((canFrameBitsWorstCase(frame.length) * 1000) + frame.period_ms - 1) / frame.period_ms;
+}
+
+constexpr uint32_t totalBitsPerSecond()
+{
+    uint32_t total = 0;
+    for (const PeriodicFrame &frame : PeriodicFrames)
+    {
+        total += bitsPerSecond(frame);
+    }
+    return total;
+}
+
+constexpr uint16_t load_permille(uint32_t bitsPerSecond)
+{
+    return static_cast<uint16_t>(((bitsPerSecond * 1000ULL) + CanIO::CAN_BITRATE - 1) /
+                                 CanIO::CAN_BITRATE);
+}
+
+static constexpr uint16_t PeriodicLoad_permille = load_permille(totalBitsPerSecond());
+static_assert(PeriodicLoad_permille <= Ceiling_permille,
+              "Periodic CAN traffic exceeds the bus load ceiling, see CanBusLoad.hpp");
+
+} // namespace remote_control_device::bus_load
@@ -1,10 +1,14 @@
 #include "Canopen.hpp"
 #include "ANSIEscapeCodes.hpp"
+#include "CanBusLoad.hpp"
 #include "CanFestivalLocker.hpp"
+#include "CanFestivalTimers.hpp"
 #include "Logging.hpp"
+#include "PeripheralDrivers/CanFilter.hpp"
 #include "PeripheralDrivers/CanIO.hpp"
-#include "PeripheralDrivers/TerminalIO.hpp"
+#include "PeripheralDrivers/TerminalWriter.hpp"
 #include <algorithm>
+#include <cstdio>
 
 
 namespace remote_control_device
@@ -21,22 +25,13 @@ Message Canopen::RTD_StateEmcyMessage = {Canopen::RPDO1_RTD_State,
                                          {Canopen::RTD_State_Emergency, 0, 0, 0, 0, 0, 0, 0}};
 Canopen::Canopen(CanIO &canio, Logging &log, bool bypass)
     : _canIO(canio),
-      _log(log), _monitoredDevices{{MonitoredDevice(BusDevices::DriveMotorController),
-                                    MonitoredDevice(BusDevices::BrakeActuator),
-                                    MonitoredDevice(BusDevices::BrakePressureSensor),
-                                    MonitoredDevice(BusDevices::SteeringActuator),
-                                    MonitoredDevice(BusDevices::SteeringAngleSensor)}},
-      _stateControlledDevices{
-          {StateControlledDevice(BusDevices::DriveMotorController, CanDeviceState::Operational),
-           StateControlledDevice(BusDevices::BrakeActuator, CanDeviceState::Operational),
-           StateControlledDevice(BusDevices::SteeringActuator, CanDeviceState::Operational),
-           StateControlledDevice(BusDevices::BrakePressureSensor, CanDeviceState::Operational)}},
-      _couplings{{Coupling(BusDevices::BrakeActuator, BrakeActuatorCoupling_IndexOD,
-                           BrakeActuatorCoupling_SubIndexOD, BrakeActuatorCoupling_EngagedValue,
-                           BrakeActuatorCoupling_DisEngagedValue),
-                  Coupling(BusDevices::SteeringActuator, SteeringActuatorCoupling_IndexOD,
-                           SteerinActuatorCoupling_SubIndexOD, SteerinActuatorCoupling_EngagedValue,
-                           SteerinActuatorCoupling_DisEngagedValue)}}
+      _log(log), _monitoredDevices{makeRecords<MonitoredDevice>(
+                     bus_devices::Monitored, std::make_index_sequence<MonitoredDeviceCount>())},
+      _stateControlledDevices{makeRecords<StateControlledDevice>(
+          bus_devices::StateControlled, std::make_index_sequence<StateControlledDeviceCount>())},
+      _couplings{makeRecords<Coupling>(bus_devices::Couplings,
+                                       std::make_index_sequence<CouplingCount>())},
+      _sdoQueue(log)
 {
     specialAssert(_instance == nullptr);
     _instance = this;
@@ -44,6 +39,10 @@ Canopen::Canopen(CanIO &canio, Logging &log, bool bypass)
     {
         return;
     }
+#ifdef BUILDCONFIG_CANOPEN_ACTOR
+    // constructed on the actor's task, everything below runs right away
+    CanopenActor::setHandlers(&Canopen::executeFromActor, &Canopen::publishFromActor);
+#endif
     {
         CFLocker locker;
         setNodeId(locker.getOD(), static_cast<UNS8>(BusDevices::RemoteControlDevice));
@@ -56,6 +55,13 @@ Canopen::Canopen(CanIO &canio, Logging &log, bool bypass)
             e = Unknown_state;
         }
 
+        // heartbeat consumers come from the device table, the .od only provides the entries
+        CO_Data *d = locker.getOD();
+        specialAssert(*d->ConsumerHeartbeatCount == bus_devices::HeartbeatConsumerEntries.size());
+        std::copy_n(bus_devices::HeartbeatConsumerEntries.begin(),
+                    std::min<size_t>(*d->ConsumerHeartbeatCount, MonitoredDeviceCount),
+                    d->ConsumerHeartbeatEntries);
+
         // set zero values to not have canfestival send pure zeros 0
         // which could cause damage
         setBrakeForce(0.0);
@@ -78,6 +84,9 @@ Canopen::Canopen(CanIO &canio, Logging &log, bool bypass)
 
         setState(locker.getOD(), Initialisation);
         setState(locker.getOD(), Operational);
+        setTPDOPolicies(DefaultTPDOPolicies);
+        setActuatorPDOSchedule(static_cast<PDOSchedule>(BUILDCONFIG_ACTUATOR_PDO_SCHEDULE));
+        setupAcceptanceFilters(locker.getOD());
 
         // RX timeout requires a timer table that can't be generated and is initialized with NULL
         // every time adding our own
@@ -94,6 +103,7 @@ Canopen::Canopen(CanIO &canio, Logging &log, bool bypass)
             d->RxPDO_EventTimers[timerId] = TIMER_NONE; // NOLINT
             testHook_signalRTDTimeout();
             _instance->signalRTDTimeout();
+            _instance->wakeStatemachine();
         };
 
         // when a rpdo is received, the OD entry where RTD_State resides is updated, every entry
@@ -102,6 +112,11 @@ Canopen::Canopen(CanIO &canio, Logging &log, bool bypass)
                                    [](CO_Data *d, const indextable *, UNS8 bSubindex) -> UNS32 {
                                        testHook_signalRTDRecovery();
                                        _instance->signalRTDRecovery();
+                                       if (RTD_State != _instance->_lastRTDState)
+                                       {
+                                           _instance->_lastRTDState = RTD_State;
+                                           _instance->wakeStatemachine();
+                                       }
                                        return OD_SUCCESSFUL;
                                    });
 
@@ -109,29 +124,64 @@ Canopen::Canopen(CanIO &canio, Logging &log, bool bypass)
         // canfestival is also not capable to start the rpdo timeout unless at least
         // one message was received, so dispatch one fake message to get the timer going
         _canIO.addRXMessage(RTD_StateBootupMessage);
+        _status.write(getStatus());
     }
 }
 
 Canopen::~Canopen()
 {
+    CanopenActor::setHandlers(nullptr, nullptr);
     _instance = nullptr;
     CFLocker locker;
     locker.getOD()->RxPDO_EventTimers = nullptr;
 }
 
-bool Canopen::isDeviceOnline(const BusDevices device) const
+void Canopen::setupAcceptanceFilters(CO_Data *d)
 {
-    for (auto &dev : _monitoredDevices)
+    static constexpr uint16_t FunctionCodeShift = 7;
+    static constexpr uint32_t CobIdInvalid = 1UL << 31;
+    static constexpr uint32_t CobIdMask = 0x7FF;
+    CanFilter filter;
+
+    // canfestival only treats 0x80 as SYNC no matter what 0x1005 says
+    filter.addId(NMT << FunctionCodeShift);
+    filter.addId(SYNC << FunctionCodeShift);
+
+    for (UNS8 i = 0; i < *d->ConsumerHeartbeatCount; ++i)
     {
-        if (dev.device == device)
+        const UNS8 nodeId = (d->ConsumerHeartbeatEntries[i] >> 16) & 0x7F; // NOLINT
+        if (nodeId != 0)
         {
-            return !dev.disconnected;
+            filter.addId((NODE_GUARD << FunctionCodeShift) + nodeId);
         }
     }
-    return false;
+
+    // communication parameters of rpdos and sdo channels, first index 0 means none present
+    auto addFromOD = [&](UNS16 first, UNS16 last, UNS8 subIndex) {
+        for (UNS16 offset = first; first != 0 && offset <= last; ++offset)
+        {
+            const subindex &entry = d->objdict[offset].pSubindex[subIndex]; // NOLINT
+            const UNS32 cobId = *static_cast<const UNS32 *>(entry.pObject);
+            if ((cobId & CobIdInvalid) == 0)
+            {
+                filter.addId(cobId & CobIdMask);
+            }
+        }
+    };
+    addFromOD(d->firstIndex->PDO_RCV, d->lastIndex->PDO_RCV, 1);
+    addFromOD(d->firstIndex->SDO_SVR, d->lastIndex->SDO_SVR, 1);
+    addFromOD(d->firstIndex->SDO_CLT, d->lastIndex->SDO_CLT, 2);
+
+    _canIO.configureAcceptanceFilters(filter);
+}
+
+bool Canopen::isDeviceOnline(const BusDevices device) const
+{
+    const uint8_t slot = bus_devices::getNodeSlots(device).monitored;
+    return slot != bus_devices::NoSlot && !_monitoredDevices[slot].disconnected;
 }
 
-void Canopen::drawUIDevicesPart(TerminalIO &term)
+void Canopen::drawUIDevicesPart(TerminalWriter &term)
 {
     term.write(ANSIEscapeCodes::ColorSection_WhiteText_GrayBackground);
     term.write("\r\nMonitored Devices:\r\n");
@@ -191,6 +241,33 @@ void Canopen::drawUIDevicesPart(TerminalIO &term)
         }
         term.write("\r\n");
     }
+
+    static constexpr size_t buffSize = 100;
+    char buff[buffSize] = {0};
+    static constexpr std::array<const char *, 3> ScheduleNames = {
+        "event timers", "after own SYNC", "after SYNC of other node"};
+    snprintf(buff, buffSize, "\r\nActuator PDOs: %s\r\n",
+             ScheduleNames.at(static_cast<uint8_t>(_pdoSchedule)));
+    term.write(buff);
+    const TPDOTransmitter::Statistics tpdo = TPDOTransmitter::getStatistics();
+    snprintf(buff, buffSize, "TPDOs sent on change: %lu, held back by inhibit time: %lu\r\n",
+             tpdo.changeTriggered, tpdo.inhibited);
+    term.write(buff);
+
+    term.write(ANSIEscapeCodes::ColorSection_WhiteText_GrayBackground);
+    term.write("\r\nSDO Client:\r\n");
+    term.write(ANSIEscapeCodes::ColorSection_End);
+
+    const SdoClientQueue::Statistics sdo = SdoClientQueue::getStatistics();
+    snprintf(buff, buffSize,
+             "Completed: %lu, timeouts: %lu, failed: %lu, coalesced: %lu, dropped: %lu\r\n",
+             sdo.completed, sdo.timeouts, sdo.failed, sdo.coalesced, sdo.dropped);
+    term.write(buff);
+    snprintf(buff, buffSize, "Latency last / avg / max: %lu / %lu / %lu ms\r\n",
+             sdo.lastLatency_ms,
+             static_cast<uint32_t>(sdo.totalLatency_ms / std::max<uint32_t>(sdo.completed, 1)),
+             sdo.maxLatency_ms);
+    term.write(buff);
 }
 
 void Canopen::kickstartPDOTranmission()
@@ -218,95 +295,355 @@ void Canopen::kickstartPDOTranmission()
     // So to avoid all this b.s. pdo.c was modified in line 539 to not compare at all.
     CFLocker lock;
     sendPDOevent(lock.getOD());
+
+    // synchronous ones are skipped by sendPDOevent but enabling still has to send them once,
+    // the states rely on that to get zero targets out before disabling them again
+    if (_pdoSchedule != PDOSchedule::Event)
+    {
+        for (TPDOIndex index : ActuatorTPDOs)
+        {
+            sendOnePDOevent(lock.getOD(), static_cast<uint8_t>(index));
+        }
+    }
+
+    // all event timers got armed just now, give each its own slot within the period.
+    // They keep it as the stack re-arms them from within their callbacks
+    for (uint8_t i = 0; i < static_cast<uint8_t>(TPDOIndex::COUNT); ++i)
+    {
+        CanFestivalTimers::shiftAlarm(lock.getOD()->PDO_status[i].event_timer,
+                                      US_TO_TIMEVAL(i * TPDOPhaseOffset_us));
+    }
 }
 
-void Canopen::setSelfState(const StateId state)
+void Canopen::publishActuatorPDOs(CO_Data *d)
 {
+    for (TPDOIndex index : ActuatorTPDOs)
     {
-        CFLocker locker;
-        SelfState = static_cast<UNS8>(state);
+        const auto i = static_cast<uint8_t>(index);
+        // re-arms the event timer one period from now
+        sendOnePDOevent(d, i);
+        CanFestivalTimers::shiftAlarm(d->PDO_status[i].event_timer,
+                                      US_TO_TIMEVAL(i * TPDOPhaseOffset_us));
     }
 }
 
-void Canopen::setBrakeForce(float force)
+void Canopen::applyPDOSchedule(CO_Data *d, PDOSchedule schedule)
 {
+    static constexpr UNS8 TransmissionTypeSubIndex = 2;
+    static constexpr UNS8 EventTimerSubIndex = 5;
+    static constexpr UNS32 SyncProducerBit = 1UL << 30;
+    const bool synchronous = schedule != PDOSchedule::Event;
+    _pdoSchedule = schedule;
+
+    for (TPDOIndex index : ActuatorTPDOs)
     {
-        CFLocker locker;
-        BrakeTargetForce =
-            mapValue<float, INTEGER16>(0.0f, 1.0f, BrakeForceRaw_Min, BrakeForceRaw_Max, force);
+        const auto i = static_cast<uint8_t>(index);
+        // timers armed for the old schedule would keep sending
+        d->PDO_status[i].event_timer = DelAlarm(d->PDO_status[i].event_timer);
+        d->PDO_status[i].inhibit_timer = DelAlarm(d->PDO_status[i].inhibit_timer);
+        // SYNCs seen since the last transmission on the synchronous types
+        d->PDO_status[i].transmit_type_parameter = 0;
+
+        subindex *parameters = d->objdict[d->firstIndex->PDO_TRS + i].pSubindex; // NOLINT
+        *static_cast<UNS8 *>(parameters[TransmissionTypeSubIndex].pObject) =
+            synchronous ? TRANS_EVERY_N_SYNC(1) : TRANS_EVENT_SPECIFIC;
+        *static_cast<UNS16 *>(parameters[EventTimerSubIndex].pObject) =
+            synchronous ? 0 : TPDOTransmitter::getPolicy(i).period_ms;
+    }
+
+    // 1005h / 1006h aren't in the .od, canfestival still keeps them in CO_Data
+    const bool producer = schedule == PDOSchedule::SyncProducer;
+    *d->COB_ID_Sync = SyncCobId | (producer ? SyncProducerBit : 0);
+    *d->Sync_Cycle_Period = producer ? SyncPeriod_ms * 1000 : 0;
+    // (re)arms the SYNC alarm from the two above, only stops it when not producing
+    startSYNC(d);
+
+    if (_actuatorPDOsEnabled)
+    {
+        kickstartPDOTranmission();
     }
 }
 
+void Canopen::setSelfState(const StateId state)
+{
+    execute({CanopenCommand::Type::SelfState, 0, static_cast<int32_t>(state)});
+}
+
+void Canopen::setBrakeForce(float force)
+{
+    execute({CanopenCommand::Type::Setpoint, static_cast<uint8_t>(Setpoint::BrakeForce),
+             rawBrakeForce(force)});
+}
+
 void Canopen::setWheelDriveTorque(float torque)
 {
-    {
-        CFLocker locker;
-        WheelTargetTorque = mapValue<float, INTEGER16>(-1.0f, 1.0f, WheelDriveTorqueRaw_Min,
-                                                       WheelDriveTorqueRaw_Max, torque);
-    }
+    execute({CanopenCommand::Type::Setpoint, static_cast<uint8_t>(Setpoint::WheelDriveTorque),
+             rawWheelDriveTorque(torque)});
 }
 
 void Canopen::setSteeringAngle(float angle)
+{
+    execute({CanopenCommand::Type::Setpoint, static_cast<uint8_t>(Setpoint::SteeringAngle),
+             rawSteeringAngle(angle)});
+}
+
+void Canopen::setActuatorSetpoints(const ActuatorSetpoints &setpoints, bool publishNow)
+{
+    // goes through the SeqLock as a command can't carry all three values
+    _setpoints.write({rawWheelDriveTorque(setpoints.wheelDriveTorque),
+                      rawBrakeForce(setpoints.brakeForce),
+                      rawSteeringAngle(setpoints.steeringAngle)});
+    execute({CanopenCommand::Type::Setpoints, 0, publishNow});
+}
+
+INTEGER16 Canopen::rawWheelDriveTorque(float torque)
+{
+    return mapValue<float, INTEGER16>(-1.0f, 1.0f, WheelDriveTorqueRaw_Min,
+                                      WheelDriveTorqueRaw_Max, torque);
+}
+
+INTEGER16 Canopen::rawBrakeForce(float force)
+{
+    return mapValue<float, INTEGER16>(0.0f, 1.0f, BrakeForceRaw_Min, BrakeForceRaw_Max, force);
+}
+
+INTEGER32 Canopen::rawSteeringAngle(float angle)
 {
     // inverted due to hardware gearing
-    angle *= -1.0f;
+    return mapValue<float, INTEGER32>(-1.0f, 1.0f, SteeringAngleRaw_Min, SteeringAngleRaw_Max,
+                                      -angle);
+}
+
+void Canopen::setCouplingStates(bool brake, bool steering)
+{
+    // swapped on purpose: the baseline drives the brake coupling from the steering argument and
+    // the steering coupling from the brake argument, this keeps the behavior
+    execute({CanopenCommand::Type::Couplings, 0,
+             static_cast<int32_t>((steering ? 1 : 0) | (brake ? 2 : 0))});
+}
+
+void Canopen::setTPDO(const TPDOIndex index, bool enable)
+{
+    execute({CanopenCommand::Type::TPDO, static_cast<uint8_t>(index), enable});
+}
+
+void Canopen::setActuatorPDOs(bool enable)
+{
+    execute({CanopenCommand::Type::ActuatorPDOs, 0, enable});
+}
+
+void Canopen::setActuatorPDOSchedule(PDOSchedule schedule)
+{
+    execute({CanopenCommand::Type::PDOSchedule, 0, static_cast<int32_t>(schedule)});
+}
+
+void Canopen::setTPDOPolicies(const TPDOPolicies &policies)
+{
+    // goes through the SeqLock like the setpoints
+    _tpdoPolicies.write(policies);
+    execute({CanopenCommand::Type::TPDOPolicies});
+}
+
+void Canopen::processRXFrames()
+{
+#ifdef BUILDCONFIG_CANOPEN_ACTOR
+    // the actor drains the whole ring, one request in the queue is enough
+    if (_rxFramesPending.exchange(true))
     {
-        CFLocker locker;
-        SteeringTargetAngle = mapValue<float, INTEGER32>(-1.0f, 1.0f, SteeringAngleRaw_Min,
-                                                         SteeringAngleRaw_Max, angle);
+        return;
+    }
+#endif
+    if (!execute({CanopenCommand::Type::RxFrames}))
+    {
+        _rxFramesPending = false;
     }
 }
 
-void Canopen::setCouplingStates(bool brake, bool steering)
+void Canopen::update(BusDevicesState &target)
 {
+    BusStatus status;
+#ifdef BUILDCONFIG_CANOPEN_ACTOR
+    if (!_status.read(status))
+    {
+        // actor publishing back to back, keep the last cycle's view
+        return;
+    }
+#else
     {
         CFLocker locker;
-        _setCouplingState(_couplings[CouplingIndex_Brake], steering);
-        _setCouplingState(_couplings[CouplingIndex_Steering], brake);
+        status = getStatus();
+    }
+#endif
+    target.rtdEmergency = status.rtdState == RTD_State_Emergency;
+    target.rtdBootedUp = status.rtdState != RTD_State_Bootup;
+    target.timeout = status.rtdTimeout;
+    for (bool disconnected : status.disconnected)
+    {
+        target.timeout = target.timeout || disconnected;
     }
 }
 
-void Canopen::setTPDO(const TPDOIndex index, bool enable)
+bool Canopen::execute(const CanopenCommand &command)
 {
+#ifdef BUILDCONFIG_CANOPEN_ACTOR
+    if (!CanopenActor::isOwnerContext())
     {
-        CFLocker locker;
-        if (enable)
+        if (!CanopenActor::post(command))
         {
-            PDOEnable(locker.getOD(), static_cast<UNS8>(index));
-        }
-        else
-        {
-            PDODisable(locker.getOD(), static_cast<UNS8>(index));
+            _log.logWarning(Logging::Origin::BusDevices, "Canopen command %d dropped, queue full",
+                            static_cast<int>(command.type));
+            return false;
         }
+        return true;
     }
+#endif
+    CFLocker locker;
+    apply(locker.getOD(), command);
+    return true;
 }
 
-void Canopen::setActuatorPDOs(bool enable)
+void Canopen::apply(CO_Data *d, const CanopenCommand &command)
 {
-    setTPDO(TPDOIndex::BrakeForce, enable);
-    setTPDO(TPDOIndex::SteeringAngle, enable);
-    setTPDO(TPDOIndex::MotorTorque, enable);
-    setTPDO(TPDOIndex::TargetValues, enable);
-
-    if (enable)
+    switch (command.type)
     {
-        kickstartPDOTranmission();
+        case CanopenCommand::Type::Setpoint:
+            switch (static_cast<Setpoint>(command.target))
+            {
+                case Setpoint::WheelDriveTorque:
+                    WheelTargetTorque = static_cast<INTEGER16>(command.value);
+                    break;
+                case Setpoint::BrakeForce:
+                    BrakeTargetForce = static_cast<INTEGER16>(command.value);
+                    break;
+                case Setpoint::SteeringAngle:
+                    SteeringTargetAngle = static_cast<INTEGER32>(command.value);
+                    break;
+                default:
+                    break;
+            }
+            TPDOTransmitter::valuesWritten(d);
+            break;
+        case CanopenCommand::Type::SelfState:
+            SelfState = static_cast<UNS8>(command.value);
+            TPDOTransmitter::valuesWritten(d);
+            break;
+        case CanopenCommand::Type::TPDO:
+            if (command.value != 0)
+            {
+                PDOEnable(d, command.target);
+            }
+            else
+            {
+                PDODisable(d, command.target);
+            }
+            break;
+        case CanopenCommand::Type::Setpoints:
+        {
+            RawSetpoints raw;
+            if (!_setpoints.read(raw))
+            {
+                // caller is writing again, its next command picks the values up
+                break;
+            }
+            WheelTargetTorque = raw.wheelDriveTorque;
+            BrakeTargetForce = raw.brakeForce;
+            SteeringTargetAngle = raw.steeringAngle;
+            // on the SYNC schedules the next SYNC picks them up
+            if (command.value != 0 && _actuatorPDOsEnabled && _pdoSchedule == PDOSchedule::Event)
+            {
+                publishActuatorPDOs(d);
+            }
+            TPDOTransmitter::valuesWritten(d);
+            break;
+        }
+        case CanopenCommand::Type::ActuatorPDOs:
+            for (TPDOIndex index : ActuatorTPDOs)
+            {
+                apply(d, {CanopenCommand::Type::TPDO, static_cast<uint8_t>(index), command.value});
+            }
+            _actuatorPDOsEnabled = command.value != 0;
+            if (command.value != 0)
+            {
+                kickstartPDOTranmission();
+            }
+            break;
+        case CanopenCommand::Type::PDOSchedule:
+            applyPDOSchedule(d, static_cast<PDOSchedule>(command.value));
+            break;
+        case CanopenCommand::Type::TPDOPolicies:
+        {
+            TPDOPolicies policies;
+            if (!_tpdoPolicies.read(policies))
+            {
+                // caller is writing again, its next command picks them up
+                break;
+            }
+            for (uint8_t i = 0; i < policies.size(); ++i)
+            {
+                TPDOTransmitter::setPolicy(d, i, policies[i]);
+            }
+            break;
+        }
+        case CanopenCommand::Type::DeviceState:
+            sendDeviceState(d, static_cast<BusDevices>(command.target),
+                            static_cast<CanDeviceState>(command.value));
+            break;
+        case CanopenCommand::Type::Couplings:
+            _setCouplingState(d, _couplings[CouplingIndex_Brake], (command.value & 1) != 0);
+            _setCouplingState(d, _couplings[CouplingIndex_Steering], (command.value & 2) != 0);
+            break;
+        case CanopenCommand::Type::RxFrames:
+            _rxFramesPending = false;
+            _canIO.dispatchRX(d);
+            break;
+        default:
+            break;
     }
 }
 
-void Canopen::update(BusDevicesState &target)
+Canopen::BusStatus Canopen::getStatus() const
 {
+    BusStatus status;
+    status.rtdState = RTD_State;
+    status.rtdTimeout = _rtdTimeout;
+    for (uint8_t i = 0; i < _monitoredDevices.size(); ++i)
     {
-        CFLocker locker;
-        target.rtdEmergency = RTD_State == RTD_State_Emergency;
-        target.rtdBootedUp = RTD_State != RTD_State_Bootup;
+        status.disconnected[i] = _monitoredDevices[i].disconnected;
     }
-    target.timeout = false;
-    for (auto &e : _monitoredDevices)
+    return status;
+}
+
+void Canopen::executeFromActor(const CanopenCommand &command)
+{
+    specialAssert(_instance != nullptr);
+    CFLocker locker;
+    _instance->apply(locker.getOD(), command);
+}
+
+void Canopen::publishFromActor()
+{
+    specialAssert(_instance != nullptr);
+    CFLocker locker;
+    _instance->_status.write(_instance->getStatus());
+#ifdef BUILDCONFIG_CANOPEN_ACTOR
+    SdoClientQueue::publishStatistics();
+    TPDOTransmitter::publishStatistics();
+#endif
+    if (_instance->_wakeStatemachine)
     {
-        target.timeout = target.timeout || e.disconnected;
+        _instance->_wakeStatemachine = false;
+        Statemachine::wakeUp(Statemachine::NOTIFY_BUS_EVENT);
     }
-    target.timeout = target.timeout || _rtdTimeout;
+}
+
+void Canopen::wakeStatemachine()
+{
+#ifdef BUILDCONFIG_CANOPEN_ACTOR
+    // the Statemachine reads the published status, wake it once that is written
+    _wakeStatemachine = true;
+#else
+    Statemachine::wakeUp(Statemachine::NOTIFY_BUS_EVENT);
+#endif
 }
 
 void Canopen::cbSlaveStateChange(CO_Data *d, UNS8 heartbeatID, e_nodeState state)
@@ -358,14 +695,13 @@ void Canopen::cbSlaveStateChange(CO_Data *d, UNS8 heartbeatID, e_nodeState state
     }
 
     // reset disconnected state
-    for (MonitoredDevice &e : _instance->_monitoredDevices)
+    const uint8_t slot = bus_devices::getNodeSlots(dev).monitored;
+    if (slot != bus_devices::NoSlot && _instance->_monitoredDevices[slot].disconnected)
     {
-        if (e.device == dev && e.disconnected)
-        {
-            _instance->_log.logInfo(Logging::Origin::BusDevices, "%s is online", getBusDeviceName(dev));
-            e.disconnected = false;
-            return;
-        }
+        _instance->_log.logInfo(Logging::Origin::BusDevices, "%s is online", getBusDeviceName(dev));
+        _instance->_monitoredDevices[slot].disconnected = false;
+        // don't let a coupling wait for the rest of the backoff
+        SdoClientQueue::nodeOnline(d, heartbeatID);
     }
 }
 
@@ -386,13 +722,12 @@ void Canopen::cbHeartbeatError(CO_Data *d, UNS8 heartbeatID)
         _instance->_stateControlledDevices[index].currentState = CanDeviceState::Unknown;
     }
 
-    for (MonitoredDevice &e : _instance->_monitoredDevices)
+    const uint8_t slot = bus_devices::getNodeSlots(dev).monitored;
+    if (slot != bus_devices::NoSlot)
     {
-        if (e.device == dev)
-        {
-            e.disconnected = true;
-            return;
-        }
+        _instance->_monitoredDevices[slot].disconnected = true;
+        _instance->wakeStatemachine();
+        return;
     }
     _instance->_log.logWarning(Logging::Origin::BusDevices,
                "Received heartbeat error callback for nodeId %d but it isn't registered as a "
@@ -400,129 +735,27 @@ void Canopen::cbHeartbeatError(CO_Data *d, UNS8 heartbeatID)
                heartbeatID);
 }
 
-void Canopen::cbSDO(CO_Data *d, UNS8 nodeId)
+int8_t Canopen::findInStateControlledList(const BusDevices device)
 {
-    // search for coupling with nodeid
-    Coupling *coupling = nullptr;
-    for (Coupling &e : _instance->_couplings)
-    {
-        if (e.device == static_cast<BusDevices>(nodeId))
-        {
-            coupling = &e;
-            break;
-        }
-    }
-
-    if (coupling == nullptr)
-    {
-        _instance->_log.logDebug(Logging::Origin::BusDevices, "Unexpected SDO received from nodeId %d", nodeId);
-        return;
-    }
-
-    bool restart = false;
-    uint32_t abortCode = 0;
-    if (getWriteResultNetworkDict(d, nodeId, &abortCode) != SDO_FINISHED)
-    {
-        // transfer failed
-        // abortCode is 0 for timeout which isn't correct
-        // but flow errors in the stack cause this to be 0
-        if (abortCode == 0)
-        {
-            // timeout, try again
-            restart = true;
-        }
-        else
-        {
-            // serious error, most likely ill configured node
-            // not attempting new transmission as these errors are more likely
-            // to come from an active node which answers quickly (like we do)
-            // causing risk of flooding
-            _instance->_log.logWarning(Logging::Origin::BusDevices, "SDO to nodeId %d failed (%s)", nodeId,
-                       abortCodeToString(abortCode));
-            restart = false;
-        }
-    }
-    else
-    {
-        // sucess but check if target changed mid request processing
-        if (coupling->stateForThisRequest != coupling->targetState)
-        {
-            _instance->_log.logDebug(Logging::Origin::BusDevices,
-                     "SDO finished successfully but state changed mid transmission");
-            restart = true;
-        }
-        else
-        {
-            _instance->_log.logDebug(Logging::Origin::BusDevices, "SDO finished successfully");
-        }
-    }
-    // closing isn't necessary when the transfer is finished but this isn't always the case
-    closeSDOtransfer(d, nodeId, SDO_CLIENT);
-
-    if (restart)
-    {
-        // logDebug(Logging::Origin::BusDevices, "Repeating transmission");
-        _instance->_setCouplingState(*coupling, coupling->targetState);
-    }
+    const uint8_t slot = bus_devices::getNodeSlots(device).stateControlled;
+    return slot == bus_devices::NoSlot ? -1 : static_cast<int8_t>(slot);
 }
 
-const char *Canopen::abortCodeToString(uint32_t abortCode)
+uint8_t Canopen::convertDeviceState(CanDeviceState state)
 {
-    switch (abortCode)
+    switch (state)
     {
-       /* case OD_SUCCESSFUL:
-            return "OD_SUCCESSFUL";
-        case OD_READ_NOT_ALLOWED:
-            return "OD_READ_NOT_ALLOWED";
-        case OD_WRITE_NOT_ALLOWED:
-            return "OD_WRITE_NOT_ALLOWED";
-        case OD_NO_SUCH_OBJECT:
-            return "OD_NO_SUCH_OBJECT";
-        case OD_NOT_MAPPABLE:
-            return "OD_NOT_MAPPABLE";
-        case OD_ACCES_FAILED:
-            return "OD_ACCES_FAILED";
-        case OD_LENGTH_DATA_INVALID:
-            return "OD_LENGTH_DATA_INVALID";
-        case OD_NO_SUCH_SUBINDEX:
-            return "OD_NO_SUCH_SUBINDEX";
-        case OD_VALUE_RANGE_EXCEEDED:
-            return "OD_VALUE_RANGE_EXCEEDED";
-        case OD_VALUE_TOO_LOW:
-            return "OD_VALUE_TOO_LOW";
-        case OD_VALUE_TOO_HIGH:
-            return "OD_VALUE_TOO_HIGH";
-        case SDOABT_TOGGLE_NOT_ALTERNED:
-            return "SDOABT_TOGGLE_NOT_ALTERNED";
-        case SDOABT_TIMED_OUT:
-            return "SDOABT_TIMED_OUT";
-        case SDOABT_CS_NOT_VALID:
-            return "SDOABT_CS_NOT_VALID";
-        case SDOABT_INVALID_BLOCK_SIZE:
-            return "SDOABT_INVALID_BLOCK_SIZE";
-        case SDOABT_OUT_OF_MEMORY:
-            return "SDOABT_OUT_OF_MEMORY";
-        case SDOABT_GENERAL_ERROR:
-            return "SDOABT_GENERAL_ERROR";
-        case SDOABT_LOCAL_CTRL_ERROR:
-            return "SDOABT_LOCAL_CTRL_ERROR";*/
+        case CanDeviceState::Operational:
+            return NMT_Start_Node;
+        case CanDeviceState::Preoperational:
+            return NMT_Enter_PreOperational;
+        case CanDeviceState::Unknown:
+        /* fall through */
         default:
-            return "Error Unknown";
+            return 0;
     }
 }
 
-int8_t Canopen::findInStateControlledList(const BusDevices device)
-{
-    for (uint8_t i = 0; i < _stateControlledDevices.size(); ++i)
-    {
-        if (_stateControlledDevices[i].device == device)
-        {
-            return i;
-        }
-    }
-    return -1;
-}
-
 void Canopen::setDeviceState(const BusDevices device, CanDeviceState state)
 {
     // check if allowed to change state
@@ -535,117 +768,61 @@ void Canopen::setDeviceState(const BusDevices device, CanDeviceState state)
         return;
     }
 
-    uint8_t nmtCommand = 0;
-    switch (state)
+    if (convertDeviceState(state) == 0)
     {
-        case CanDeviceState::Operational:
-            nmtCommand = NMT_Start_Node;
-            break;
-        case CanDeviceState::Preoperational:
-            nmtCommand = NMT_Enter_PreOperational;
-            break;
-        case CanDeviceState::Unknown:
-        /* fall through */
-        default:
-            return;
+        return;
     }
 
+    execute({CanopenCommand::Type::DeviceState, static_cast<uint8_t>(device),
+             static_cast<int32_t>(state)});
+}
+
+void Canopen::sendDeviceState(CO_Data *d, const BusDevices device, CanDeviceState state)
+{
+    const int8_t index = findInStateControlledList(device);
     _instance->_log.logInfo(Logging::Origin::BusDevices, "Requesting %s to change status to %s",
             getBusDeviceName(device), getCanDeviceStateName(state));
     _stateControlledDevices[index].targetState = state;
-    {
-        CFLocker locker;
-        masterSendNMTstateChange(locker.getOD(),
-                                 static_cast<uint8_t>(_stateControlledDevices[index].device),
-                                 nmtCommand);
-        // masterSendNMTstateChange is just blindly transmitting the state change request
-        // when a node doesn't switch it isn't noticed as proceedNODE_GUARD which processes incoming
-        // heartbeats compares the old state with the unchanged newly received one and finds no
-        // difference
-        // invalidating the local state of a node will force the change state callback to be fired
-        // which allows confirming the state change or retrying
-        locker.getOD()->NMTable[static_cast<UNS8>(_stateControlledDevices[index].device)] =
-            Disconnected;
-    }
+
+    masterSendNMTstateChange(d, static_cast<uint8_t>(device), convertDeviceState(state));
+    // masterSendNMTstateChange is just blindly transmitting the state change request
+    // when a node doesn't switch it isn't noticed as proceedNODE_GUARD which processes incoming
+    // heartbeats compares the old state with the unchanged newly received one and finds no
+    // difference
+    // invalidating the local state of a node will force the change state callback to be fired
+    // which allows confirming the state change or retrying
+    d->NMTable[static_cast<UNS8>(device)] = Disconnected;
 }
 
 const char *Canopen::getBusDeviceName(const BusDevices dev)
 {
-    switch (dev)
-    {
-        case BusDevices::DriveMotorController:
-            return "Drive Motor Controller (10h)";
-        case BusDevices::BrakeActuator:
-            return "Brake Actuator (20h)";
-        case BusDevices::SteeringActuator:
-            return "Steering Actuator (30h)";
-        case BusDevices::RemoteControlDevice:
-            return "Remote Control Device (1h)";
-        case BusDevices::RealTimeDevice:
-            return "Real Time Device (2h)";
-        case BusDevices::WheelSpeedSensor:
-            return "Wheel Speed Sensor (11h)";
-        case BusDevices::BrakePressureSensor:
-            return "Brake Pressure Sensor (21h)";
-        case BusDevices::SteeringAngleSensor:
-            return "Steering Angle Sensor (31h)";
-        default:
-            return "Unamed device";
-    }
+    const uint8_t slot = bus_devices::getNodeSlots(dev).description;
+    return slot != bus_devices::NoSlot ? bus_devices::Devices[slot].name : "Unamed device";
 }
 
-Canopen::Coupling::Coupling(BusDevices device, uint16_t odIndex, uint8_t odSubIndex,
-                            uint32_t engagedValue, uint32_t disengagedValue)
-    : device(device), odIndex(odIndex), odSubIndex(odSubIndex), engagedValue(engagedValue),
-      disengagedValue(disengagedValue)
+Canopen::Coupling::Coupling(BusDevices device)
+    : device(device), odIndex(bus_devices::getDescription(device).coupling.odIndex),
+      odSubIndex(bus_devices::getDescription(device).coupling.odSubIndex),
+      engagedValue(bus_devices::getDescription(device).coupling.engagedValue),
+      disengagedValue(bus_devices::getDescription(device).coupling.disengagedValue)
 {
 }
 
-void Canopen::_setCouplingState(Coupling &coupling, bool state)
+void Canopen::_setCouplingState(CO_Data *d, const Coupling &coupling, bool state)
 {
-    coupling.targetState = state;
-
-    // check if sdo is still in porgress
-    {
-        CFLocker locker;
-        UNS32 abortCode = 0;
-        if (getWriteResultNetworkDict(locker.getOD(), static_cast<UNS8>(coupling.device),
-                                      &abortCode) == SDO_ABORTED_INTERNAL)
-        {
-            // nothing in progress, start write request
-            coupling.stateForThisRequest = coupling.targetState;
-            uint32_t couplingState =
-                coupling.stateForThisRequest ? coupling.engagedValue : coupling.disengagedValue;
-            writeNetworkDictCallBack(locker.getOD(), static_cast<UNS8>(coupling.device),
-                                     coupling.odIndex, coupling.odSubIndex, 4, uint32,
-                                     &couplingState, &Canopen::cbSDO, false);
-        }
-        else
-        {
-            _instance->_log.logInfo(Logging::Origin::BusDevices,
-                    "SDO transfer already in progress, repeating after this one finished");
-        }
-    }
+    SdoClientQueue::write(d, {static_cast<uint8_t>(coupling.device), coupling.odIndex,
+                              coupling.odSubIndex,
+                              state ? coupling.engagedValue : coupling.disengagedValue});
 }
 
 std::array<Canopen::BusDevices, Canopen::MonitoredDeviceCount> Canopen::getMonitoredDevices() const
 {
-    std::array<Canopen::BusDevices, Canopen::MonitoredDeviceCount> list;
-    for (uint8_t i = 0; i < _monitoredDevices.size(); ++i)
-    {
-        list[i] = _monitoredDevices[i].device;
-    }
-    return list;
+    return bus_devices::Monitored;
 }
 
 std::array<Canopen::BusDevices, Canopen::StateControlledDeviceCount>
 Canopen::getStateControlledDevices() const
 {
-    std::array<Canopen::BusDevices, Canopen::StateControlledDeviceCount> list;
-    for (uint8_t i = 0; i < _stateControlledDevices.size(); ++i)
-    {
-        list[i] = _stateControlledDevices[i].device;
-    }
-    return list;
+    return bus_devices::StateControlled;
 }
 } // namespace remote_control_device
\ No newline at end of file
@@ -1,12 +1,19 @@
 #pragma once
+#include "BusDeviceTable.hpp"
+#include "CanopenActor.hpp"
+#include "SdoClientQueue.hpp"
 #include "SpecialAssert.hpp"
 #include "State.hpp"
 #include "StateSources.hpp"
 #include "Statemachine.hpp"
+#include "TPDOTransmitter.hpp"
+#include "Wrapper/SeqLock.hpp"
 #include <FreeRTOS.h>
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <memory>
+#include <utility>
 #include <semphr.h>
 
 extern "C"
@@ -15,16 +22,28 @@ extern "C"
 #include <canfestival/def.h>
 }
 
+/**
+ * @brief Schedule of the actuator PDOs after startup, a Canopen::PDOSchedule value
+ *
+ */
+#ifndef BUILDCONFIG_ACTUATOR_PDO_SCHEDULE
+#define BUILDCONFIG_ACTUATOR_PDO_SCHEDULE 0
+#endif
+
 /**
  * @brief Abstracts canfestival / canopen processes for usage in state machine
  *
+ * Everything touching the object dictionary goes through execute(): in the default build under
+ * CFLocker right away, with BUILDCONFIG_CANOPEN_ACTOR as CanopenCommand to the CanFestivalTimers
+ * task. The "Blocking." setters then return without waiting and update() reads what the actor
+ * published after its last run.
  */
 
 namespace remote_control_device
 {
 class CanIO;
 class Logging;
-class TerminalIO;
+class TerminalWriter;
 
 class Canopen
 {
@@ -56,12 +75,23 @@ public:
     static constexpr uint16_t TPDO4_WheelTorqueCobId = 0x210;
     static constexpr uint16_t TPDO5_TargetValues = 0x200;
     static constexpr uint16_t RPDO1_RTD_State = 0x182;
-
-    static constexpr uint16_t HeartbeatConsumerTimeout_ms = 500;
+    static constexpr uint16_t SyncCobId = 0x80;
+
+    // mapped bytes, 0x1A00 - 0x1A04 and 0x1600
+    static constexpr uint8_t TPDO1_Length = 1;
+    static constexpr uint8_t TPDO2_Length = 2;
+    static constexpr uint8_t TPDO3_Length = 4;
+    static constexpr uint8_t TPDO4_Length = 2;
+    static constexpr uint8_t TPDO5_Length = 8;
+    static constexpr uint8_t RPDO1_Length = 1;
+
+    static constexpr uint16_t HeartbeatConsumerTimeout_ms =
+        bus_devices::HeartbeatConsumerTimeout_ms;
     static constexpr uint16_t HeartbeatProducerTime_ms = 100;
     static constexpr uint16_t ActuatorPDOEventTime_ms = 20;
     static constexpr uint16_t RTD_RPDOEventTime_ms = 125;
     static constexpr uint16_t SelfState_TPDOEventTime_ms = 100;
+    static constexpr uint16_t SyncPeriod_ms = ActuatorPDOEventTime_ms;
 
     static constexpr uint8_t MaxRPDOEventTimers = 2;
 
@@ -80,6 +110,68 @@ public:
         COUNT
     };
 
+    /**
+     * @brief Spacing of the TPDOs' event timer phases, spreads them evenly over the actuator
+     * period instead of queueing all of them for the tx mailboxes at once
+     *
+     */
+    static constexpr uint16_t TPDOPhaseOffset_us =
+        (ActuatorPDOEventTime_ms * 1000) / static_cast<uint8_t>(TPDOIndex::COUNT);
+
+    using TPDOPolicies = std::array<TPDOPolicy, static_cast<uint8_t>(TPDOIndex::COUNT)>;
+
+    /**
+     * @brief Every TPDO at its full rate, the behaviour of the patched pdo.c
+     *
+     */
+    static constexpr TPDOPolicies PeriodicTPDOPolicies = {{
+        {SelfState_TPDOEventTime_ms, false, 0, 0},
+        {ActuatorPDOEventTime_ms, false, 0, 0},
+        {ActuatorPDOEventTime_ms, false, 0, 0},
+        {ActuatorPDOEventTime_ms, false, 0, 0},
+        {ActuatorPDOEventTime_ms, false, 0, 0},
+    }};
+
+    /**
+     * @brief Keep-alive of the actuator PDOs on change, below the actuators' setpoint watchdogs
+     *
+     */
+    static constexpr uint16_t ActuatorKeepAlive_ms = 100;
+
+    /**
+     * @brief Raw counts the float derived setpoints have to move, one to four SBUS steps
+     * depending on the actuator's range
+     *
+     */
+    static constexpr uint16_t ActuatorDeadband = 8;
+
+    /**
+     * @brief Changes right away, at most at the periodic rate, and a keep-alive in between
+     *
+     */
+    static constexpr TPDOPolicies OnChangeTPDOPolicies = {{
+        {SelfState_TPDOEventTime_ms, true, 0, ActuatorPDOEventTime_ms},
+        {ActuatorKeepAlive_ms, true, ActuatorDeadband, ActuatorPDOEventTime_ms},
+        {ActuatorKeepAlive_ms, true, ActuatorDeadband, ActuatorPDOEventTime_ms},
+        {ActuatorKeepAlive_ms, true, ActuatorDeadband, ActuatorPDOEventTime_ms},
+        {ActuatorKeepAlive_ms, true, ActuatorDeadband, ActuatorPDOEventTime_ms},
+    }};
+
+    // policies after startup
+#ifdef BUILDCONFIG_TPDO_ON_CHANGE
+    static constexpr TPDOPolicies DefaultTPDOPolicies = OnChangeTPDOPolicies;
+#else
+    static constexpr TPDOPolicies DefaultTPDOPolicies = PeriodicTPDOPolicies;
+#endif
+
+    /**
+     * @brief Blocking. Changes when the event driven TPDOs go out, see TPDOTransmitter.hpp.
+     * The actuator PDOs only follow it on PDOSchedule::Event
+     *
+     * @param policies one per TPDOIndex
+     */
+    virtual void setTPDOPolicies(const TPDOPolicies &policies);
+
     enum class RPDOIndex : uint8_t
     {
         // specification counts from 1,  canfestival from 0
@@ -104,23 +196,35 @@ public:
     virtual void setActuatorPDOs(bool enable);
 
     /**
-     * @brief List of all available bus devices. Not all devices listed here are monitored / state
-     * controlled
+     * @brief When the actuator PDOs go out
      *
      */
-    enum class BusDevices : uint8_t
+    enum class PDOSchedule : uint8_t
     {
-        RemoteControlDevice = 0x01,
-        RealTimeDevice = 0x02,
-        DriveMotorController = 0x10,
-        WheelSpeedSensor = 0x11,
-        BrakeActuator = 0x20,
-        BrakePressureSensor = 0x21,
-        SteeringActuator = 0x30,
-        SteeringAngleSensor = 0x31,
-        NO_DEVICE = 0xff
+        // each on its own event timer, ActuatorPDOEventTime_ms apart
+        Event = 0,
+        // synchronous, RCD sends the SYNC every SyncPeriod_ms
+        SyncProducer = 1,
+        // synchronous, SYNC comes from another node (RTD)
+        SyncConsumer = 2
     };
 
+    /**
+     * @brief Blocking. Switches the actuator PDOs between their own event timers and being sent
+     * right after every SYNC. Either way they carry what the last setpoint writes left in the OD,
+     * with setActuatorSetpoints that is one Statemachine cycle's snapshot. Starting with
+     * BUILDCONFIG_ACTUATOR_PDO_SCHEDULE
+     *
+     * @param schedule
+     */
+    virtual void setActuatorPDOSchedule(PDOSchedule schedule);
+
+    /**
+     * @brief All available bus devices, described in BusDeviceTable.hpp
+     *
+     */
+    using BusDevices = remote_control_device::BusDevices;
+
     /**
      * @brief Internal representation of a (timeout) monitored device
      *
@@ -152,8 +256,13 @@ public:
         CanDeviceState targetState;
         CanDeviceState currentState;
 
-        StateControlledDevice(const BusDevices dev, CanDeviceState target)
-            : device(dev), targetState(target), currentState(CanDeviceState::Unknown)
+        /**
+         * @brief Starts out with the device table's target state
+         *
+         */
+        explicit StateControlledDevice(const BusDevices dev)
+            : device(dev), targetState(bus_devices::getDescription(dev).stateControl),
+              currentState(CanDeviceState::Unknown)
         {
         }
     };
@@ -185,26 +294,37 @@ public:
         BusDevices device;
         uint16_t odIndex;
         uint8_t odSubIndex;
-        bool targetState = false;
-        bool stateForThisRequest = false;
         uint32_t engagedValue;
         uint32_t disengagedValue;
 
-        Coupling(BusDevices device, uint16_t odIndex, uint8_t odSubIndex, uint32_t engagedValue,
-                 uint32_t disengagedValue);
+        /**
+         * @brief Takes the SDO parameters from the device table
+         *
+         */
+        explicit Coupling(BusDevices device);
     };
-    static constexpr uint16_t BrakeActuatorCoupling_IndexOD = 0x60FE;
-    static constexpr uint8_t BrakeActuatorCoupling_SubIndexOD = 0x1;
-    static constexpr uint32_t BrakeActuatorCoupling_EngagedValue = 0x00010000;
-    static constexpr uint32_t BrakeActuatorCoupling_DisEngagedValue = 0x0;
-
-    static constexpr uint16_t SteeringActuatorCoupling_IndexOD = 0x60FE;
-    static constexpr uint8_t SteerinActuatorCoupling_SubIndexOD = 0x1;
-    static constexpr uint32_t SteerinActuatorCoupling_EngagedValue = 0x00010000;
-    static constexpr uint32_t SteerinActuatorCoupling_DisEngagedValue = 0x0;
+    static constexpr bus_devices::CouplingDescription BrakeActuatorCoupling =
+        bus_devices::getDescription(BusDevices::BrakeActuator).coupling;
+    static constexpr uint16_t BrakeActuatorCoupling_IndexOD = BrakeActuatorCoupling.odIndex;
+    static constexpr uint8_t BrakeActuatorCoupling_SubIndexOD = BrakeActuatorCoupling.odSubIndex;
+    static constexpr uint32_t BrakeActuatorCoupling_EngagedValue =
+        BrakeActuatorCoupling.engagedValue;
+    static constexpr uint32_t BrakeActuatorCoupling_DisEngagedValue =
+        BrakeActuatorCoupling.disengagedValue;
+
+    static constexpr bus_devices::CouplingDescription SteeringActuatorCoupling =
+        bus_devices::getDescription(BusDevices::SteeringActuator).coupling;
+    static constexpr uint16_t SteeringActuatorCoupling_IndexOD = SteeringActuatorCoupling.odIndex;
+    static constexpr uint8_t SteerinActuatorCoupling_SubIndexOD =
+        SteeringActuatorCoupling.odSubIndex;
+    static constexpr uint32_t SteerinActuatorCoupling_EngagedValue =
+        SteeringActuatorCoupling.engagedValue;
+    static constexpr uint32_t SteerinActuatorCoupling_DisEngagedValue =
+        SteeringActuatorCoupling.disengagedValue;
 
     /**
      * @brief Blocking. Sets the state of both couplings.
+     * Like the baseline the brake coupling follows steering and the steering coupling brake
      *
      * @param brake
      * @param steering
@@ -230,7 +350,7 @@ public:
      *
      * @param term terminalIO instance
      */
-    virtual void drawUIDevicesPart(TerminalIO &term);
+    virtual void drawUIDevicesPart(TerminalWriter &term);
 
     /**
      * @brief Quick values used in emergency states
@@ -239,6 +359,17 @@ public:
     static constexpr float NoWheelDriveTorque = 0;
     static constexpr float MaxBrakePressure = 1;
 
+    /**
+     * @brief OD variables behind the actuator PDOs, CanopenCommand::Setpoint targets
+     *
+     */
+    enum class Setpoint : uint8_t
+    {
+        WheelDriveTorque,
+        BrakeForce,
+        SteeringAngle
+    };
+
     /**
      * @brief Blocking. Sets drive controllers torque.
      * Input is clipped to available range
@@ -279,6 +410,35 @@ public:
     static constexpr INTEGER32 SteeringAngleRaw_Min = 0x9AB;  // 2475;
     static constexpr INTEGER32 SteeringAngleRaw_Max = 0x1700; // 5888;
 
+    /**
+     * @brief Targets of all actuators, same ranges as the single setters
+     *
+     */
+    struct ActuatorSetpoints
+    {
+        float wheelDriveTorque;
+        float brakeForce;
+        float steeringAngle;
+    };
+
+    /**
+     * @brief Blocking. Writes all actuator targets at once. The single setters give the PDO
+     * timers a chance to send TPDO5 with some values of the previous cycle in between.
+     * Statemachine task only
+     *
+     * @param setpoints
+     * @param publishNow send the enabled actuator PDOs right away instead of waiting for their
+     * event timers, which then restart from now. Ignored on the SYNC schedules
+     */
+    virtual void setActuatorSetpoints(const ActuatorSetpoints &setpoints, bool publishNow);
+
+    /**
+     * @brief Blocking. Hands the frames waiting in CanIO's RX ring to canfestival, called by the
+     * CanIO task. In actor mode a pending request covers all frames arriving until it runs
+     *
+     */
+    virtual void processRXFrames();
+
     /**
      * @brief Signals that RTD has timed out, used in callback of canfestival
      *
@@ -337,8 +497,9 @@ public:
     static void testHook_signalRTDRecovery(){};
     static void testHook_signalRTDTimeout(){};
 
-    static constexpr size_t MonitoredDeviceCount = 5;
-    static constexpr size_t StateControlledDeviceCount = 4;
+    static constexpr size_t MonitoredDeviceCount = bus_devices::MonitoredCount;
+    static constexpr size_t StateControlledDeviceCount = bus_devices::StateControlledCount;
+    static constexpr size_t CouplingCount = bus_devices::CouplingCount;
 
     virtual std::array<BusDevices, MonitoredDeviceCount> getMonitoredDevices() const final;
     virtual std::array<BusDevices, StateControlledDeviceCount>
@@ -355,31 +516,150 @@ private:
 
     std::array<MonitoredDevice, MonitoredDeviceCount> _monitoredDevices;
     std::array<StateControlledDevice, StateControlledDeviceCount> _stateControlledDevices;
-    std::array<Coupling, 2> _couplings;
+    std::array<Coupling, CouplingCount> _couplings;
+    SdoClientQueue _sdoQueue;
+    TPDOTransmitter _tpdoTransmitter;
     bool _rtdTimeout = true;
     bool _firstRTDRecoveryCall = true;
     std::array<TIMER_HANDLE, MaxRPDOEventTimers> _rpdoTimers;
 
+    /**
+     * @brief What update() needs, published by the actor after every run
+     *
+     */
+    struct BusStatus
+    {
+        UNS8 rtdState{RTD_State_Bootup};
+        bool rtdTimeout{true};
+        std::array<bool, MonitoredDeviceCount> disconnected{};
+    };
+    wrapper::SeqLock<BusStatus> _status;
+    // RTD state the Statemachine was last woken up for
+    UNS8 _lastRTDState{RTD_State_Bootup};
+    // actor mode, wake the Statemachine after the next publish
+    bool _wakeStatemachine{false};
+    // RxFrames command queued and not yet executed
+    std::atomic<bool> _rxFramesPending{false};
+
+    struct RawSetpoints
+    {
+        INTEGER16 wheelDriveTorque;
+        INTEGER16 brakeForce;
+        INTEGER32 steeringAngle;
+    };
+    // latest setActuatorSetpoints, picked up by the Setpoints command
+    wrapper::SeqLock<RawSetpoints> _setpoints;
+    // latest setTPDOPolicies, picked up by the TPDOPolicies command
+    wrapper::SeqLock<TPDOPolicies> _tpdoPolicies;
+    bool _actuatorPDOsEnabled = false;
+    PDOSchedule _pdoSchedule = PDOSchedule::Event;
+
+    static constexpr std::array<TPDOIndex, 4> ActuatorTPDOs = {
+        TPDOIndex::BrakeForce, TPDOIndex::SteeringAngle, TPDOIndex::MotorTorque,
+        TPDOIndex::TargetValues};
+
+    static INTEGER16 rawWheelDriveTorque(float torque);
+    static INTEGER16 rawBrakeForce(float force);
+    static INTEGER32 rawSteeringAngle(float angle);
+
+    /**
+     * @brief Sends the actuator PDOs now and puts their event timers back into their phase
+     *
+     * @param d
+     */
+    void publishActuatorPDOs(CO_Data *d);
+
+    /**
+     * @brief Sets transmission type and event timer of the actuator TPDOs and the SYNC
+     * producer for schedule
+     *
+     * @param d
+     * @param schedule
+     */
+    void applyPDOSchedule(CO_Data *d, PDOSchedule schedule);
+
     // designated initializers are very frowned upon by the
     // compiler so keep this in sync with the definition
     static constexpr uint8_t CouplingIndex_Brake = 0;
     static constexpr uint8_t CouplingIndex_Steering = 1;
 
+    /**
+     * @brief Runs the command on the object dictionary, see class description
+     *
+     * @param command
+     * @return false dropped, actor queue full
+     */
+    bool execute(const CanopenCommand &command);
+
+    /**
+     * @brief Does the work of a command, OD has to be locked / called on the actor
+     *
+     * @param d
+     * @param command
+     */
+    void apply(CO_Data *d, const CanopenCommand &command);
+
+    /**
+     * @brief Collects what update() needs. OD has to be locked / called on the actor
+     *
+     */
+    BusStatus getStatus() const;
+
+    /**
+     * @brief Lets the Statemachine react to a bus event before its next cycle, in actor mode once
+     * the status is published
+     *
+     */
+    void wakeStatemachine();
+
+    /* CanopenActor handlers */
+    static void executeFromActor(const CanopenCommand &command);
+    static void publishFromActor();
+
     /* Canfestival callbacks */
     static void cbSlaveStateChange(CO_Data *d, UNS8 heartbeatID, e_nodeState state);
     static void cbHeartbeatError(CO_Data *d, UNS8 heartbeatID);
-    static void cbSDO(CO_Data *d, UNS8 nodeId);
+
+    /**
+     * @brief One record per device of the list, constructed with device and args
+     *
+     */
+    template <typename Record, size_t N, size_t... I, typename... Args>
+    static std::array<Record, N> makeRecords(const std::array<BusDevices, N> &devices,
+                                             std::index_sequence<I...> /*unused*/, Args... args)
+    {
+        return {{Record(devices[I], args...)...}};
+    }
 
     /* Support functions for state controlling */
     int8_t findInStateControlledList(const BusDevices device);
 
-    uint8_t convertDeviceState(CanDeviceState);
+    /**
+     * @brief NMT command switching a node into state
+     *
+     * @return uint8_t 0 when there is none
+     */
+    static uint8_t convertDeviceState(CanDeviceState);
+
+    /**
+     * @brief Sends the NMT command of a validated setDeviceState request
+     *
+     */
+    void sendDeviceState(CO_Data *d, const BusDevices device, CanDeviceState state);
+
+    /* Support for coupling setting, queued on _sdoQueue */
+    void _setCouplingState(CO_Data *d, const Coupling &, bool state);
 
-    /* Support for coupling setting */
-    void _setCouplingState(Coupling &, bool state);
+    /**
+     * @brief Collects every COB-ID canfestival consumes from the object dictionary and hands
+     * them to CanIO as hardware acceptance filter: NMT, SYNC, consumer heartbeats, RPDOs and
+     * SDO server / client receive ids
+     *
+     * @param d
+     */
+    void setupAcceptanceFilters(CO_Data *d);
 
     static const char *getBusDeviceName(const BusDevices dev);
-    static const char *abortCodeToString(uint32_t abortCode);
 
     /**
      * @brief Due to oversights in the canopen stack there needs to be
@@ -390,4 +670,8 @@ private:
     virtual void kickstartPDOTranmission();
 };
 
+static_assert(bus_devices::getNodeSlots(BusDevices::BrakeActuator).coupling == 0 &&
+                  bus_devices::getNodeSlots(BusDevices::SteeringActuator).coupling == 1,
+              "Coupling order has to match CouplingIndex_Brake / CouplingIndex_Steering");
+
 } // namespace remote_control_device
\ No newline at end of file
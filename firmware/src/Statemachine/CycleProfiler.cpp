@@ -0,0 +1,122 @@
+#include "CycleProfiler.hpp"
+#include "ANSIEscapeCodes.hpp"
+#include "PeripheralDrivers/TerminalWriter.hpp"
+#include "Wrapper/HAL.hpp"
+#include <algorithm>
+#include <cstdio>
+
+namespace remote_control_device
+{
+const char *getCyclePhaseName(const CyclePhase phase)
+{
+    switch (phase)
+    {
+        case CyclePhase::Canopen:
+            return "Canopen";
+        case CyclePhase::RemoteControl:
+            return "RemoteControl";
+        case CyclePhase::HardwareSwitches:
+            return "HardwareSwitches";
+        case CyclePhase::Selection:
+            return "Selection";
+        case CyclePhase::StateSwitch:
+            return "StateSwitch";
+        case CyclePhase::Process:
+            return "Process";
+        case CyclePhase::LEDs:
+            return "LEDs";
+        case CyclePhase::COUNT:
+            break;
+    }
+    return "Unknown Phase";
+}
+
+void CycleProfiler::Timing::add(uint32_t us)
+{
+    count++;
+    total_us += us;
+    min_us = std::min(min_us, us);
+    max_us = std::max(max_us, us);
+
+    const auto bucket =
+        std::upper_bound(BucketLimits_us.begin(), BucketLimits_us.end(), us) -
+        BucketLimits_us.begin();
+    histogram[bucket]++;
+}
+
+uint32_t CycleProfiler::Timing::avg_us() const
+{
+    return count == 0 ? 0 : static_cast<uint32_t>(total_us / count);
+}
+
+void CycleProfiler::start(uint32_t cycles, bool cycle)
+{
+    _current = Dispatch();
+    _cycle = cycle;
+    _startCycles = cycles;
+    _lastCycles = cycles;
+}
+
+void CycleProfiler::phaseDone(CyclePhase phase, uint32_t cycles)
+{
+    const auto index = static_cast<uint8_t>(phase);
+    const uint32_t us = (cycles - _lastCycles) / wrapper::HAL::CyclesPerMicrosecond;
+    _lastCycles = cycles;
+    _current.phases_us[index] = us;
+    if (_cycle)
+    {
+        _statistics.phases[index].add(us);
+    }
+}
+
+void CycleProfiler::finish()
+{
+    _current.total_us = (_lastCycles - _startCycles) / wrapper::HAL::CyclesPerMicrosecond;
+    if (!_cycle)
+    {
+        _statistics.wakeUp.add(_current.total_us);
+        return;
+    }
+    _statistics.dispatch.add(_current.total_us);
+    if (_current.total_us >= _statistics.worst.total_us)
+    {
+        _statistics.worst = _current;
+    }
+}
+
+void CycleProfiler::drawUIPart(TerminalWriter &term, const Statistics &statistics)
+{
+    term.write(ANSIEscapeCodes::ColorSection_WhiteText_GrayBackground);
+    term.write("\r\nStatemachine cycle:\r\n");
+    term.write(ANSIEscapeCodes::ColorSection_End);
+
+    static constexpr size_t buffSize = 100;
+    char buff[buffSize] = {0};
+    term.write("Phase: count, min / avg / max (us), worst dispatch (us), <10 <50 <100 <500 <1k "
+               "<5k <20k >=20k\r\n");
+
+    const auto drawTiming = [&](const char *name, const Timing &timing, uint32_t worst_us) {
+        snprintf(buff, buffSize, "\t%s: %lu, %lu / %lu / %lu, %lu,", name, timing.count,
+                 timing.count == 0 ? 0 : timing.min_us, timing.avg_us(), timing.max_us,
+                 worst_us);
+        term.write(buff);
+        for (uint32_t bucket : timing.histogram)
+        {
+            snprintf(buff, buffSize, " %lu", bucket);
+            term.write(buff);
+        }
+        term.write("\r\n");
+    };
+    for (uint8_t i = 0; i < PhaseCount; ++i)
+    {
+        drawTiming(getCyclePhaseName(static_cast<CyclePhase>(i)), statistics.phases[i],
+                   statistics.worst.phases_us[i]);
+    }
+    drawTiming("Dispatch", statistics.dispatch, statistics.worst.total_us);
+    drawTiming("Wake up", statistics.wakeUp, statistics.wakeUp.max_us);
+
+    snprintf(buff, buffSize, "Missed deadlines: %lu\r\n", statistics.missedDeadlines);
+    term.write(buff);
+}
+
+} // namespace remote_control_device
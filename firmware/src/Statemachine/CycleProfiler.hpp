@@ -0,0 +1,127 @@
+#pragma once
+#include <array>
+#include <cstdint>
+
+/**
+ * @brief Time the Statemachine's dispatch spends per phase
+ *
+ * Fed with the cycle counter by the Statemachine task, times are stored in microseconds. Each
+ * phase keeps count, min / avg / max and a histogram, the whole dispatch as well. The slowest
+ * dispatch is kept with its breakdown. Dispatches woken up between cycles only go into their own
+ * timing, they skip most phases and would skew the cycle's figures. Deadlines the task missed are
+ * counted by the task.
+ *
+ * Not thread safe, read it from the task feeding it. Other tasks get a copy of the statistics
+ * made by that task on request.
+ */
+namespace remote_control_device
+{
+class TerminalWriter;
+
+enum class CyclePhase : uint8_t
+{
+    Canopen,
+    RemoteControl,
+    HardwareSwitches,
+    Selection,
+    StateSwitch,
+    Process,
+    LEDs,
+    COUNT
+};
+const char *getCyclePhaseName(const CyclePhase phase);
+
+class CycleProfiler
+{
+public:
+    static constexpr uint8_t PhaseCount = static_cast<uint8_t>(CyclePhase::COUNT);
+
+    /**
+     * @brief Upper limits of the histogram buckets, the last one takes everything above
+     *
+     */
+    static constexpr std::array<uint32_t, 7> BucketLimits_us = {10,   50,   100,  500,
+                                                                1000, 5000, 20000};
+    static constexpr uint8_t Buckets = BucketLimits_us.size() + 1;
+
+    struct Timing
+    {
+        uint32_t count{0};
+        uint32_t min_us{UINT32_MAX};
+        uint32_t max_us{0};
+        uint64_t total_us{0};
+        std::array<uint32_t, Buckets> histogram{};
+
+        void add(uint32_t us);
+        uint32_t avg_us() const;
+    };
+
+    struct Dispatch
+    {
+        uint32_t total_us{0};
+        // 0 for phases that didn't run
+        std::array<uint32_t, PhaseCount> phases_us{};
+    };
+
+    struct Statistics
+    {
+        std::array<Timing, PhaseCount> phases{};
+        Timing dispatch;
+        Dispatch worst;
+        // whole dispatches woken up between cycles
+        Timing wakeUp;
+        // cycles that started after their deadline, each one run late while catching up counts
+        uint32_t missedDeadlines{0};
+    };
+
+    /**
+     * @brief Starts timing a dispatch
+     *
+     * @param cycles cycle counter
+     * @param cycle false for a dispatch woken up between cycles
+     */
+    void start(uint32_t cycles, bool cycle = true);
+
+    /**
+     * @brief Ends the phase running since start or the previous phase
+     *
+     */
+    void phaseDone(CyclePhase phase, uint32_t cycles);
+
+    /**
+     * @brief Ends the dispatch, cycles of the last phaseDone
+     *
+     */
+    void finish();
+
+    void deadlineMissed()
+    {
+        _statistics.missedDeadlines++;
+    }
+
+    const Statistics &getStatistics() const
+    {
+        return _statistics;
+    }
+
+    void reset()
+    {
+        _statistics = Statistics();
+    }
+
+    /**
+     * @brief Writes a profile as UI section
+     *
+     * @param term
+     * @param statistics copy of getStatistics()
+     */
+    static void drawUIPart(TerminalWriter &term, const Statistics &statistics);
+
+private:
+    Statistics _statistics;
+    Dispatch _current;
+    uint32_t _startCycles{0};
+    uint32_t _lastCycles{0};
+    bool _cycle{true};
+};
+} // namespace remote_control_device
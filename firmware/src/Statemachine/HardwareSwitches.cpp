@@ -2,9 +2,12 @@
 #include <main.h>
 #include <stm32f3xx_hal.h>
 #include "StateSources.hpp"
+#include "Statemachine.hpp"
 
 namespace remote_control_device
 {
+uint32_t HardwareSwitches::_lastEdgeWakeUp_ms{0};
+bool HardwareSwitches::_edgeWokeUp{false};
 
 void HardwareSwitches::update(HardwareSwitchesState &state) const
 {
@@ -15,4 +18,31 @@ void HardwareSwitches::update(HardwareSwitchesState &state) const
     state.BikeEmergency = HAL_GPIO_ReadPin(hardwareSwitch2_GPIO_Port, hardwareSwitch2_Pin) == GPIO_PinState::GPIO_PIN_SET;
 }
 
-} // namespace remote_control_device
\ No newline at end of file
+bool HardwareSwitches::edgeWakesUp(uint32_t now_ms)
+{
+    if (_edgeWokeUp && now_ms - _lastEdgeWakeUp_ms < EdgeHoldOff_ms)
+    {
+        return false;
+    }
+    _edgeWokeUp = true;
+    _lastEdgeWakeUp_ms = now_ms;
+    return true;
+}
+
+} // namespace remote_control_device
+
+/**
+ * @brief EXTI of both switch pins, on either edge. Only the first edge of a bouncing contact
+ * wakes the Statemachine
+ *
+ */
+extern "C" void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
+{
+    using remote_control_device::HardwareSwitches;
+    using remote_control_device::Statemachine;
+    if ((GPIO_Pin == hardwareSwitch1_Pin || GPIO_Pin == hardwareSwitch2_Pin) &&
+        HardwareSwitches::edgeWakesUp(HAL_GetTick()))
+    {
+        Statemachine::wakeUpFromISR(Statemachine::NOTIFY_SWITCH_EDGE);
+    }
+}
\ No newline at end of file
@@ -17,6 +17,25 @@ public:
     HardwareSwitches& operator=(HardwareSwitches&&) = default;
 
     virtual void update(HardwareSwitchesState &state) const;
+
+    /**
+     * @brief Edges this long after one that woke the Statemachine are taken for contact bounce
+     * and ignored, the next cycle reads the settled switches
+     *
+     */
+    static constexpr uint32_t EdgeHoldOff_ms = 5;
+
+    /**
+     * @brief Internal. Called by the switches' EXTI, whether an edge wakes the Statemachine
+     *
+     * @param now_ms tick of the edge
+     */
+    static bool edgeWakesUp(uint32_t now_ms);
+
+private:
+    // only the EXTI, both lines share a priority and don't preempt each other
+    static uint32_t _lastEdgeWakeUp_ms;
+    static bool _edgeWokeUp;
 };
 
 } // namespace remote_control_device
\ No newline at end of file
@@ -1,7 +1,11 @@
 #include "RemoteControl.hpp"
+#include "ANSIEscapeCodes.hpp"
 #include "Logging.hpp"
 #include "PeripheralDrivers/ReceiverModule.hpp"
+#include "PeripheralDrivers/TerminalWriter.hpp"
 #include "StateSources.hpp"
+#include "Statemachine.hpp"
+#include <cstdio>
 #include <stm32f3xx_hal.h>
 
 namespace remote_control_device
@@ -10,6 +14,7 @@ namespace remote_control_device
 RemoteControl::RemoteControl(wrapper::HAL &hal, Logging &log, ReceiverModule &recv)
     : _hal(hal), _log(log), _receiverModule(recv)
 {
+    _receiverModule.setFrameCallback(&RemoteControl::cbFrameDecoded, this);
 }
 
 void RemoteControl::update(RemoteControlState &target) const
@@ -18,7 +23,7 @@ void RemoteControl::update(RemoteControlState &target) const
     if (!_receiverModule.getSBUSFrame(frame))
     {
         _log.logWarning(Logging::Origin::StateMachine,
-                   "Unable to aquire mutex in RemoteControl::update");
+                   "Unable to read sbus frame in RemoteControl::update");
         target.timeout = true;
         return;
     }
@@ -54,6 +59,32 @@ void RemoteControl::_update(const Frame &frame, RemoteControlState &target) cons
     target.timeout = (_hal.GetTick() - frame.lastUpdate) > Timeout_Ms || frame.failsafe;
 }
 
+bool RemoteControl::urgentInputsChanged(const Frame &frame)
+{
+    UrgentInputs inputs;
+    inputs.buttonEmergency = channelToBool(frame.analogChannels[ChannelMap::ButtonEmcy]);
+    inputs.switchUnlock = channelToBool(frame.analogChannels[ChannelMap::SwitchUnlock]);
+    inputs.failsafe = frame.failsafe;
+
+    // a frame after a gap ends the timeout the Statemachine has seen meanwhile
+    const bool timedOut = (frame.lastUpdate - _lastFrameUpdate) > Timeout_Ms;
+    const bool changed = timedOut || inputs.buttonEmergency != _urgentInputs.buttonEmergency ||
+                         inputs.switchUnlock != _urgentInputs.switchUnlock ||
+                         inputs.failsafe != _urgentInputs.failsafe;
+    _urgentInputs = inputs;
+    _lastFrameUpdate = frame.lastUpdate;
+    return changed;
+}
+
+void RemoteControl::cbFrameDecoded(void *context, const Frame &frame)
+{
+    auto rc = reinterpret_cast<RemoteControl *>(context);
+    if (rc->urgentInputsChanged(frame))
+    {
+        Statemachine::wakeUp(Statemachine::NOTIFY_RC_INPUT);
+    }
+}
+
 float RemoteControl::channelToFloat(const uint16_t value, const bool bidirectional) const
 {
     static constexpr uint16_t AnalogMiddle = Decoder::ANALOG_CHANNEL_MAX / 2;
@@ -79,4 +110,61 @@ bool RemoteControl::channelToBool(const uint16_t value) const
     return value > SwitchOn_MinValue;
 }
 
+void RemoteControl::drawUILinkPart(TerminalWriter &term) const
+{
+    term.write(ANSIEscapeCodes::ColorSection_WhiteText_GrayBackground);
+    term.write("\r\nRadio Link:\r\n");
+    term.write(ANSIEscapeCodes::ColorSection_End);
+
+    LinkStatistics stats;
+    if (!_receiverModule.getLinkStatistics(stats))
+    {
+        term.write("Unavailable\r\n");
+        return;
+    }
+
+    static constexpr size_t buffSize = 64;
+    char buff[buffSize] = {0};
+    const uint32_t decoded =
+        stats.decodeResults[static_cast<uint8_t>(DecodeError::NoError)];
+
+    snprintf(buff, buffSize, "%u fps, %lu frames, max gap %lu us\r\n", stats.framesPerSecond,
+             decoded, stats.maxInterArrival_us);
+    term.write(buff);
+
+    // rates in permille of decoded frames
+    const uint32_t divisor = decoded > 0 ? decoded : 1;
+    snprintf(buff, buffSize, "Frame lost: %lu (%lu%%o), Failsafe: %lu (%lu%%o)\r\n",
+             stats.frameLostCount, (stats.frameLostCount * 1000) / divisor, stats.failsafeCount,
+             (stats.failsafeCount * 1000) / divisor);
+    term.write(buff);
+
+    snprintf(buff, buffSize, "Resyncs: %lu\r\n", stats.resyncCount);
+    term.write(buff);
+
+    term.write("Decode errors (start/end, flags, index, range): ");
+    for (uint8_t i = static_cast<uint8_t>(DecodeError::NoError) + 1; i < DecodeErrorCount; ++i)
+    {
+        snprintf(buff, buffSize, "%lu ", stats.decodeResults[i]);
+        term.write(buff);
+    }
+    term.write("\r\n");
+
+    term.write("Jitter histogram (us):\r\n");
+    for (uint8_t i = 0; i < LinkStatistics::JitterBucketCount; ++i)
+    {
+        if (i < LinkStatistics::JitterBucketLimits_us.size())
+        {
+            snprintf(buff, buffSize, "\t<=%lu: %lu\r\n", LinkStatistics::JitterBucketLimits_us[i],
+                     stats.jitterHistogram[i]);
+        }
+        else
+        {
+            snprintf(buff, buffSize, "\t >%lu: %lu\r\n",
+                     LinkStatistics::JitterBucketLimits_us.back(), stats.jitterHistogram[i]);
+        }
+        term.write(buff);
+    }
+}
+
 } // namespace remote_control_device
@@ -15,6 +15,7 @@ using namespace SBUS; // NOLINT
 class RemoteControlState;
 class Logging;
 class ReceiverModule;
+class TerminalWriter;
 
 class RemoteControl
 {
@@ -35,6 +36,22 @@ public:
     virtual void update(RemoteControlState &target) const;
     virtual void _update(const Frame &frame, RemoteControlState &target) const;
 
+    /**
+     * @brief Prints radio link statistics of ReceiverModule
+     *
+     * @param term
+     */
+    virtual void drawUILinkPart(TerminalWriter &term) const;
+
+    /**
+     * @brief Whether a decoded frame changed an input that can force a state change right away:
+     * the emergency button, the unlock switch or the timeout. The ReceiverModule calls it for
+     * every frame through cbFrameDecoded, sticks and the other switches wait for the next cycle
+     *
+     * @param frame frame just decoded
+     */
+    bool urgentInputsChanged(const Frame &frame);
+
     struct ChannelMap
     {
         static constexpr uint8_t Throttle = 2;
@@ -55,6 +72,26 @@ private:
     Logging &_log;
     ReceiverModule &_receiverModule;
 
+    /**
+     * @brief Inputs of the last frame that urgentInputsChanged compares against, starts out
+     * timed out
+     *
+     */
+    struct UrgentInputs
+    {
+        bool buttonEmergency{false};
+        bool switchUnlock{false};
+        bool failsafe{true};
+    };
+    UrgentInputs _urgentInputs;
+    uint32_t _lastFrameUpdate{0};
+
+    /**
+     * @brief ReceiverModule's frame callback, wakes the Statemachine on urgent input changes
+     *
+     */
+    static void cbFrameDecoded(void *context, const Frame &frame);
+
     float channelToFloat(const uint16_t, const bool bidirectional = false) const;
     bool channelToBool(const uint16_t) const;
 };
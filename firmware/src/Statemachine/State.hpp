@@ -1,9 +1,6 @@
 #pragma once
-#include "SpecialAssert.hpp"
 #include "StateSources.hpp"
 #include <FreeRTOS.h>
-#include <memory>
-#include <utility>
 
 namespace remote_control_device
 {
@@ -27,46 +24,19 @@ enum class StateId : uint8_t
 };
 const char *getStateIdName(const StateId id);
 
-class States;
-
-class StateCallbacks
+/**
+ * @brief Contains the "brain" of a state. What it does and when
+ *
+ */
+struct StateCallbacks
 {
-public:
     using ProcessFunc = auto (*)(StateChaningSources &) -> void;
     using CheckConditionsFunc = auto (*)(StateChaningSources &) -> bool;
     using OneTimeSetupFunc = auto (*)(StateChaningSources &) -> void;
 
-    StateCallbacks(ProcessFunc pro, CheckConditionsFunc chk, OneTimeSetupFunc ots)
-        : _process(pro), _checkConditions(chk), _oneTimeSetup(ots)
-    {
-        specialAssert(pro != nullptr && chk != nullptr && ots != nullptr);
-    }
-    virtual ~StateCallbacks() = default;
-
-    StateCallbacks(const StateCallbacks &) = default;
-    StateCallbacks(StateCallbacks &&) = default;
-    StateCallbacks &operator=(const StateCallbacks &) = default;
-    StateCallbacks &operator=(StateCallbacks &&) = default;
-
-    virtual void process(StateChaningSources &src) const
-    {
-        _process(src);
-    }
-    virtual bool checkConditions(StateChaningSources &src) const
-    {
-        return _checkConditions(src);
-    }
-    virtual void oneTimeSetup(StateChaningSources &src) const
-    {
-        _oneTimeSetup(src);
-    }
-
-private:
-    ProcessFunc _process;
-    CheckConditionsFunc _checkConditions;
-    OneTimeSetupFunc _oneTimeSetup;
-
-    friend States;
+    ProcessFunc process;
+    CheckConditionsFunc checkConditions;
+    OneTimeSetupFunc oneTimeSetup;
 };
 
 struct State
@@ -84,7 +54,7 @@ struct State
 
     const bool requiresUnlock;
 
-    std::unique_ptr<StateCallbacks> callbacks;
+    const StateCallbacks callbacks;
 
     /**
      * @brief Construct a new State
@@ -99,12 +69,12 @@ struct State
      * @param stateDriveMotor Target Canopen state of drive motor
      * @param requiresUnlock If to get to this state Remote Control's unlock switch must be
      * active
-     * @param StateCallbacks Heap allocated instance. Ownership will be taken. Contains
-     * the "brain" of a state. What it does and when
+     * @param cb What the state does and when
      */
-    State(StateId id, uint8_t priority, CouplingState couplingBrake, CouplingState couplingSteering,
-          bool sendTargets, CanDeviceState stateSteering, CanDeviceState stateBrake,
-          CanDeviceState stateDriveMotor, bool requiresUnlock, StateCallbacks *cb)
+    constexpr State(StateId id, uint8_t priority, CouplingState couplingBrake,
+                    CouplingState couplingSteering, bool sendTargets,
+                    CanDeviceState stateSteering, CanDeviceState stateBrake,
+                    CanDeviceState stateDriveMotor, bool requiresUnlock, StateCallbacks cb)
         : id(id), priority(priority), couplingBrake(couplingBrake),
           couplingSteering(couplingSteering), sendTargets(sendTargets),
           stateSteering(stateSteering), stateBrake(stateBrake), stateDriveMotor(stateDriveMotor),
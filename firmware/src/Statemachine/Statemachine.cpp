@@ -1,22 +1,17 @@
 #include "Statemachine.hpp"
-#include "ANSIEscapeCodes.hpp"
-#include "CanFestival/CanFestivalTimers.hpp"
 #include "Canopen.hpp"
 #include "HardwareSwitches.hpp"
 #include "LEDUpdater.hpp"
 #include "Logging.hpp"
-#include "PeripheralDrivers/CanIO.hpp"
 #include "PeripheralDrivers/TerminalIO.hpp"
 #include "RemoteControl.hpp"
 #include "SpecialAssert.hpp"
 #include "States.hpp"
 #include "Wrapper/Sync.hpp"
-#include <base/build_information.hpp>
 #include <cmsis_os2.h>
-#include <cstdio>
 #include <functional>
+#include <limits>
 #include <memory>
-#include "FirmwareHasher.hpp"
 
 namespace remote_control_device
 {
@@ -38,35 +33,80 @@ bool StateChaningSources::isStartedUp() const
     return _startedUp;
 }
 
+Statemachine *Statemachine::_instance = nullptr;
+
 Statemachine::Statemachine(Canopen &co, RemoteControl &rc, HardwareSwitches &hws, LEDUpdater &ledU,
-                           TerminalIO &term, wrapper::HAL &hal, IWDG_HandleTypeDef &iwdg,
-                           CanFestivalTimers &cft)
+                           TerminalIO &term, IWDG_HandleTypeDef &iwdg)
     : _task(&Statemachine::taskMain, "Statemachine", StackSize, reinterpret_cast<void *>(this),
             osPriority_t::osPriorityNormal, wrapper::sync::Statemachine_Ready),
       _canopen(co), _remoteControl(rc), _hwSwitches(hws), _ledUpdater(ledU), _terminalIO(term),
-      _hal(hal), _iwdg(iwdg), _cft(cft),
+      _iwdg(iwdg),
       _stateChaningSources(_currentState, _canopen, _startedUp, _busDevicesState,
                            _remoteControlState, _hardwareSwitchesState)
 {
+    specialAssert(_instance == nullptr);
+    _instance = this;
+}
+
+Statemachine::~Statemachine()
+{
+    _instance = nullptr;
+}
+
+void Statemachine::wakeUp(uint32_t reason)
+{
+    if (_instance == nullptr)
+    {
+        return;
+    }
+    TaskHandle_t task = _instance->_waitingTask;
+    if (task != nullptr)
+    {
+        xTaskNotify(task, reason, eSetBits);
+    }
+}
+
+void Statemachine::wakeUpFromISR(uint32_t reason)
+{
+    if (_instance == nullptr)
+    {
+        return;
+    }
+    TaskHandle_t task = _instance->_waitingTask;
+    if (task != nullptr)
+    {
+        BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+        xTaskNotifyFromISR(task, reason, eSetBits, &xHigherPriorityTaskWoken);
+        portYIELD_FROM_ISR(xHigherPriorityTaskWoken); // NOLINT
+    }
 }
 
-void Statemachine::dispatch()
+void Statemachine::dispatch(bool cycle)
 {
-    _dispatch(std::span(_states.get().data(), _states.get().size()), _states.getIdleState());
+    _dispatch(std::span(States::get().data(), States::get().size()), States::getIdleState(),
+              cycle);
 }
 
-void Statemachine::_dispatch(const std::span<const State> &states, const State &idle)
+void Statemachine::_dispatch(const std::span<const State> &states, const State &idle, bool cycle)
 {
+    const auto phaseDone = [this](CyclePhase phase) -> void {
+        _profiler.phaseDone(phase, wrapper::HAL::ReadCycleCounter());
+    };
+    _profiler.start(wrapper::HAL::ReadCycleCounter(), cycle);
+
     // update state changing sources
     _canopen.update(_busDevicesState);
+    phaseDone(CyclePhase::Canopen);
     _remoteControl.update(_remoteControlState);
+    phaseDone(CyclePhase::RemoteControl);
     _hwSwitches.update(_hardwareSwitchesState);
+    phaseDone(CyclePhase::HardwareSwitches);
 
     // to through states and select highest that has its conditions fulfilled
     auto refSelectedState = std::cref(idle);
     for (const auto &state : states)
     {
-        auto condition = state.callbacks->checkConditions(_stateChaningSources);
+        auto condition = state.callbacks.checkConditions(_stateChaningSources);
 
         if (condition && state.priority >= refSelectedState.get().priority &&
             ((state.requiresUnlock && _stateChaningSources.remoteControl.switchUnlock) ||
@@ -77,11 +117,13 @@ void Statemachine::_dispatch(const std::span<const State> &states, const State &
     }
 
     const auto &selectedState = refSelectedState.get();
+    const bool switched = selectedState.id != _currentState;
+    phaseDone(CyclePhase::Selection);
 
     // state switch
-    if (selectedState.id != _currentState)
+    if (switched)
     {
-        selectedState.callbacks->oneTimeSetup(_stateChaningSources);
+        selectedState.callbacks.oneTimeSetup(_stateChaningSources);
 
         _terminalIO.getLogging().logInfo(
             Logging::Origin::StateMachine, "Switched to task %s from %s",
@@ -98,150 +140,78 @@ void Statemachine::_dispatch(const std::span<const State> &states, const State &
                                 CanDeviceState::Operational);
         _canopen.setCouplingStates(selectedState.couplingBrake == CouplingState::Engaged,
                                    selectedState.couplingSteering == CouplingState::Engaged);
+        phaseDone(CyclePhase::StateSwitch);
     }
 
-    // execute
-    selectedState.callbacks->process(_stateChaningSources);
-    _ledUpdater.update(_stateChaningSources);
-}
-
-void Statemachine::drawUI()
-{
-    TerminalIO &term = _terminalIO;
-    term.getLogging().disableLogging();
-
-    term.write(ANSIEscapeCodes::ClearTerminal);
-    term.write(ANSIEscapeCodes::MoveCursorToHome);
-
-    // Header
-    term.write(ANSIEscapeCodes::ColorSection_WhiteText_MagentaBackground);
-    term.write("Remote-Control-Device (RCD)\r\n\r\n");
-    term.write(ANSIEscapeCodes::ColorSection_End);
-
-    // Buildinfo
-    term.write(ANSIEscapeCodes::ColorSection_WhiteText_GrayBackground);
-    term.write("Build information:\r\n");
-    term.write(ANSIEscapeCodes::ColorSection_End);
-    term.write("Git Hash: ");
-    term.write(build_info::CommitHashLong);
-    term.write("\r\nBranch: ");
-    term.write(build_info::BranchName);
-
-    term.write("\r\nDebug build: ");
-    if (build_info::IsDebugBuild)
+    // execute, woken up only to get a new state's outputs out right away
+    if (cycle || switched)
     {
-        term.write("Yes\r\n");
+        selectedState.callbacks.process(_stateChaningSources);
+        phaseDone(CyclePhase::Process);
     }
-    else
+    if (cycle)
     {
-        term.write("No\r\n");
+        _ledUpdater.update(_stateChaningSources);
+        phaseDone(CyclePhase::LEDs);
     }
-    term.write("Compiled with uncommited changes: ");
-    if (build_info::IsDirty)
-    {
-        term.write("Yes\r\n");
-    }
-    else
-    {
-        term.write("No\r\n");
-    }
-
-    // Statemachine
-    term.write(ANSIEscapeCodes::ColorSection_WhiteText_GrayBackground);
-    term.write("\r\nStatemachine:\r\n");
-    term.write(ANSIEscapeCodes::ColorSection_End);
-
-    term.write("Current State:");
-    term.write(getStateIdName(_currentState));
-    term.write("\r\n");
-
-    term.write("Remote Control Connection: ");
-    if (_remoteControlState.timeout)
-    {
-        term.write(ANSIEscapeCodes::ColorSection_WhiteText_RedBackground);
-        term.write("Timeout\r\n");
-        term.write(ANSIEscapeCodes::ColorSection_End);
-    }
-    else
-    {
-        term.write("Online\r\n");
-    }
-
-    term.write("Manual Switch: ");
-    if (_hardwareSwitchesState.ManualSwitch)
-    {
-        term.write(ANSIEscapeCodes::ColorSection_BlackText_GreenBackground);
-        term.write("Active\r\n");
-        term.write(ANSIEscapeCodes::ColorSection_End);
-    }
-    else
-    {
-        term.write("Inactive\r\n");
-    }
-
-    term.write("Bike Emergency Switch: ");
-    if (_hardwareSwitchesState.BikeEmergency)
-    {
-        term.write(ANSIEscapeCodes::ColorSection_BlackText_YellowBackground);
-        term.write("Active\r\n");
-        term.write(ANSIEscapeCodes::ColorSection_End);
-    }
-    else
-    {
-        term.write("Inactive\r\n");
-    }
-
-    // Statemachine
-    term.write(ANSIEscapeCodes::ColorSection_WhiteText_GrayBackground);
-    term.write("\r\nSystem:\r\n");
-    term.write(ANSIEscapeCodes::ColorSection_End);
-
-    static constexpr size_t buffSize = 20;
-    char buff[buffSize] = {0};
-    uint8_t timersRemain = _cft.getTimersRemaining();
-    snprintf(buff, buffSize, "%d", timersRemain);
-    term.write("Remaining Timer Slots: ");
-    term.write(buff);
-    term.write("\r\n");
-
-    snprintf(buff, buffSize, "%lu", (_hal.GetTick() / 1000));
-    term.write("Ontime: ");
-    term.write(buff);
-    term.write("(s)\r\n");
+    _profiler.finish();
+}
 
-    uint16_t ramRemain = xPortGetFreeHeapSize();
-    snprintf(buff, buffSize, "%d", ramRemain);
-    term.write("Free Memory ");
-    term.write(buff);
-    term.write(" bytes\r\n");
+void Statemachine::runCycle(TickType_t &nextCycle)
+{
+    static constexpr uint32_t ClearAllBits = std::numeric_limits<uint32_t>::max();
+    _waitingTask = xTaskGetCurrentTaskHandle();
+    // whatever woke the task meanwhile is covered by this cycle's dispatch
+    xTaskNotifyWait(0, ClearAllBits, nullptr, 0);
 
-    term.write("Tasks at max stack; words (4 bytes) still free:\r\n");
+    HAL_IWDG_Refresh(&_iwdg);
+    dispatch(true);
 
-    const auto &tasks = wrapper::Task::getAllTaskHandles();
-    for (const auto &t : tasks)
+    nextCycle += pdMS_TO_TICKS(CyclePeriod_ms);
+    for (;;)
     {
-        if (t == nullptr)
+        // nextCycle stays on the period's grid, late cycles run back to back without waiting
+        // until they caught up, same as vTaskDelayUntil, each of them is a missed deadline
+        const auto remaining = static_cast<int32_t>(nextCycle - xTaskGetTickCount());
+        if (remaining < 0)
         {
-            continue;
+            _profiler.deadlineMissed();
+        }
+        if (remaining <= 0)
+        {
+            publishStatus();
+            return;
+        }
+        uint32_t reasons = 0;
+        if (xTaskNotifyWait(0, ClearAllBits, &reasons, static_cast<TickType_t>(remaining)) ==
+            pdTRUE)
+        {
+            for (size_t i = 0; i < _wakeUps.size(); ++i)
+            {
+                _wakeUps[i] += (reasons >> i) & 1U;
+            }
+            dispatch(false);
         }
-        term.write("\t");
-        term.write(pcTaskGetName(t));
-        term.write(": ");
-
-        UBaseType_t words = uxTaskGetStackHighWaterMark(t);
-        snprintf(buff, buffSize, "%lu", words);
-        term.write(buff);
-        term.write("\r\n");
     }
+}
 
-    term.write("Successful firmware hashes: ");    
-    snprintf(buff, buffSize, "%lu", FirmwareHasher::successfulHashes);
-    term.write(buff);
-    term.write("\r\n");
-
-
-    // Monitored Devices, state controlled devices
-    _canopen.drawUIDevicesPart(term);
+void Statemachine::publishStatus()
+{
+    Status status;
+    status.currentState = _currentState;
+    status.remoteControlTimeout = _remoteControlState.timeout;
+    status.manualSwitch = _hardwareSwitchesState.ManualSwitch;
+    status.bikeEmergency = _hardwareSwitchesState.BikeEmergency;
+    status.wakeUps = _wakeUps;
+    status.missedDeadlines = _profiler.getStatistics().missedDeadlines;
+    _status.write(status);
+
+    // the reader doesn't touch the copy until the flag is cleared
+    if (_cycleStatisticsRequested.load(std::memory_order_acquire))
+    {
+        _cycleStatistics = _profiler.getStatistics();
+        _cycleStatisticsRequested.store(false, std::memory_order_release);
+    }
 }
 
 void Statemachine::taskMain(void *instance)
@@ -249,21 +219,10 @@ void Statemachine::taskMain(void *instance)
     specialAssert(instance != nullptr);
     auto sm = reinterpret_cast<Statemachine *>(instance);
 
-    TickType_t xLastWakeTime = xTaskGetTickCount();
-    uint32_t lastDraw = 0;
+    TickType_t nextCycle = xTaskGetTickCount();
     for (;;)
     {
-        HAL_IWDG_Refresh(&(sm->_iwdg));
-
-        sm->dispatch();
-        vTaskDelayUntil(&xLastWakeTime, pdMS_TO_TICKS(20));
-        // stackPrinter.print();
-        // TerminalIO::instance().log().writeRepeatMessageAfterTimeout();
-        if (sm->_hal.GetTick() - lastDraw > Statemachine::UI_UPDATE_TIME_MS)
-        {
-            lastDraw = sm->_hal.GetTick();
-            sm->drawUI();
-        }
+        sm->runCycle(nextCycle);
     }
 }
 
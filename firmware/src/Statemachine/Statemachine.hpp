@@ -1,11 +1,14 @@
 #pragma once
+#include "CycleProfiler.hpp"
 #include "SpanCompatibility.hpp"
 #include "StateSources.hpp"
 #include "States.hpp"
 #include "Wrapper/HAL.hpp"
+#include "Wrapper/SeqLock.hpp"
 #include "Wrapper/Task.hpp"
 #include <FreeRTOS.h>
 #include <array>
+#include <atomic>
 #include <stm32f3xx_hal_iwdg.h>
 
 namespace remote_control_device
@@ -16,7 +19,6 @@ class RemoteControl;
 class HardwareSwitches;
 class LEDUpdater;
 class TerminalIO;
-class CanFestivalTimers;
 
 /**
  * @brief Sources that are processed to decide the device's state
@@ -50,9 +52,32 @@ class Statemachine
 {
 public:
     static constexpr uint16_t StackSize = 300;
+    static constexpr uint32_t CyclePeriod_ms{20};
+
+    // reasons to wake the task before its next cycle, an input that may demand another state
+    static constexpr uint32_t NOTIFY_RC_INPUT = 1 << 0;
+    static constexpr uint32_t NOTIFY_BUS_EVENT = 1 << 1;
+    static constexpr uint32_t NOTIFY_SWITCH_EDGE = 1 << 2;
+    static constexpr size_t WakeUpReasonCount = 3;
+
+    /**
+     * @brief What the UI shows of the Statemachine, published at the end of every cycle. Kept
+     * small, the cycle statistics are copied on request only
+     *
+     */
+    struct Status
+    {
+        StateId currentState{StateId::NO_STATE};
+        bool remoteControlTimeout{true};
+        bool manualSwitch{false};
+        bool bikeEmergency{false};
+        std::array<uint32_t, WakeUpReasonCount> wakeUps{};
+        uint32_t missedDeadlines{0};
+    };
+
     Statemachine(Canopen &co, RemoteControl &rc, HardwareSwitches &hws, LEDUpdater &ledU,
-                 TerminalIO &term, wrapper::HAL &hal, IWDG_HandleTypeDef &iwdg, CanFestivalTimers& cft);
-    virtual ~Statemachine() = default;
+                 TerminalIO &term, IWDG_HandleTypeDef &iwdg);
+    virtual ~Statemachine();
 
     Statemachine(const Statemachine &) = delete;
     Statemachine(Statemachine &&) = delete;
@@ -67,29 +92,83 @@ public:
     static const char *getStateName(const CanDeviceState);
 
     /**
-     * @brief Internal. Called periodically by the associated task.
+     * @brief Only consistent on the Statemachine's task
      *
      */
-    virtual void dispatch();
-    virtual void _dispatch(const std::span<const State> &, const State &idle);
+    const CycleProfiler &getCycleProfiler() const
+    {
+        return _profiler;
+    }
 
     /**
-     * @brief Replaces all logging with UI that shows device information and states
+     * @brief Copy of the latest status for other tasks, never blocks the Statemachine
      *
+     * @return false published too often while copying, status may contain garbage
      */
-    virtual void drawUI() final;
-    static constexpr uint32_t UI_UPDATE_TIME_MS{2000};
+    bool readStatus(Status &status) const
+    {
+        return _status.read(status);
+    }
+
+    /**
+     * @brief The task copies its cycle statistics at the end of the next cycle. Only one reader
+     * at a time, the UI
+     *
+     */
+    void requestCycleStatistics()
+    {
+        _cycleStatisticsRequested.store(true, std::memory_order_release);
+    }
+
+    /**
+     * @brief Copy of the cycle statistics made for the last requestCycleStatistics
+     *
+     * @return nullptr while the copy is pending
+     */
+    const CycleProfiler::Statistics *getCycleStatistics() const
+    {
+        if (_cycleStatisticsRequested.load(std::memory_order_acquire))
+        {
+            return nullptr;
+        }
+        return &_cycleStatistics;
+    }
+
+    /**
+     * @brief Lets the task select the state right away instead of at its next cycle. Does
+     * nothing without a Statemachine or before its task runs
+     *
+     * @param reason NOTIFY_ flags
+     */
+    static void wakeUp(uint32_t reason);
+    static void wakeUpFromISR(uint32_t reason);
+
+    /**
+     * @brief Internal. Updates the sources and selects the state. A cycle runs the state's
+     * process function and updates the LEDs, a dispatch for a wake up only when the state changed
+     *
+     */
+    virtual void dispatch(bool cycle = true);
+    virtual void _dispatch(const std::span<const State> &, const State &idle, bool cycle = true);
+
+    /**
+     * @brief Internal. One cycle on the calling task: a dispatch, then one for every wake up until
+     * nextCycle. Advances nextCycle by CyclePeriod_ms like vTaskDelayUntil, then publishes the
+     * status
+     *
+     */
+    virtual void runCycle(TickType_t &nextCycle);
 
 private:
+    static Statemachine *_instance;
+
     wrapper::Task _task;
     Canopen &_canopen;
     RemoteControl &_remoteControl;
     HardwareSwitches &_hwSwitches;
     LEDUpdater &_ledUpdater;
     TerminalIO& _terminalIO;
-    wrapper::HAL& _hal;
     IWDG_HandleTypeDef &_iwdg;
-    CanFestivalTimers& _cft;
 
     BusDevicesState _busDevicesState;
     RemoteControlState _remoteControlState;
@@ -97,7 +176,16 @@ private:
     StateChaningSources _stateChaningSources;
     bool _startedUp = false;
     StateId _currentState = StateId::NO_STATE;
-    States _states;
+    // task waiting in runCycle, the one wakeUp notifies
+    std::atomic<TaskHandle_t> _waitingTask{nullptr};
+    std::array<uint32_t, WakeUpReasonCount> _wakeUps{};
+    CycleProfiler _profiler;
+    wrapper::SeqLock<Status> _status;
+    // about 500 bytes, a SeqLock would keep it twice and copy it every cycle
+    std::atomic<bool> _cycleStatisticsRequested{false};
+    CycleProfiler::Statistics _cycleStatistics;
+
+    void publishStatus();
 
     static void taskMain(void* instance);
 };
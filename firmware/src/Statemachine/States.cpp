@@ -6,9 +6,10 @@
 namespace remote_control_device
 {
 
-States::States()
-    : // clang-format off
-_states{{ 
+namespace
+{
+// clang-format off
+constexpr StatesArray Table = {{
         /* Start */
         State(
             /* id */ StateId::Start,
@@ -24,7 +25,7 @@ _states{{
 
             /* requires unlock */ false,
 
-            new StateCallbacks(
+            StateCallbacks{
                 /* process function*/
                 [](StateChaningSources &src) -> void {
                     // not starting up until all devices are online and 
@@ -41,13 +42,13 @@ _states{{
                 /* one time setup */ 
                 [](StateChaningSources &src) -> void { 
                 }
-            )
+            }
         ),
 
         /* Idle */
         State(
             /* id */ StateId::Idle,
-            /* priority */ IDLE_STATE_PRIORITY,
+            /* priority */ States::IDLE_STATE_PRIORITY,
 
             /* brake coupling */ CouplingState::Disengaged,
             /* steering coupling */ CouplingState::Disengaged,
@@ -59,14 +60,14 @@ _states{{
             
             /* requires unlock */ false,
 
-            new StateCallbacks(
+            StateCallbacks{
                 /* process function*/
                 [](StateChaningSources &src) -> void {
                     return;
                 },
                 /* check conditions */
                 [](StateChaningSources &src) -> bool { 
-                    return true; // gets replaced anyways
+                    return true; // selected anyways when nothing else is
                 },
                 /* one time setup */ 
                 [](StateChaningSources &src) -> void {
@@ -77,7 +78,7 @@ _states{{
                     src.canopen.setActuatorPDOs(true);
                     src.canopen.setActuatorPDOs(false);
                 }
-            )
+            }
         ),
 
         /* RemoteControl */
@@ -95,12 +96,14 @@ _states{{
 
             /* requires unlock */ true,
 
-            new StateCallbacks(
+            StateCallbacks{
                 /* process function*/
                 [](StateChaningSources &src) -> void {
-                    src.canopen.setBrakeForce(src.remoteControl.brake);
-                    src.canopen.setWheelDriveTorque(src.remoteControl.throttle);
-                    src.canopen.setSteeringAngle(src.remoteControl.steering);
+                    // one transaction so TPDO5 never mixes two remote control frames
+                    src.canopen.setActuatorSetpoints({src.remoteControl.throttle,
+                                                      src.remoteControl.brake,
+                                                      src.remoteControl.steering},
+                                                     false);
                     return;
                 },
                 /* check conditions */
@@ -110,7 +113,7 @@ _states{{
                 /* one time setup */ 
                 [](StateChaningSources &src) -> void { 
                 }
-            )
+            }
         ),
 
         /* Autonomous */
@@ -128,7 +131,7 @@ _states{{
 
             /* requires unlock */ true,
 
-            new StateCallbacks(
+            StateCallbacks{
                 /* process function*/
                 [](StateChaningSources &src) -> void {
                     return;
@@ -140,7 +143,7 @@ _states{{
                 /* one time setup */ 
                 [](StateChaningSources &src) -> void { 
                 }
-            )
+            }
         ),
 
         /* SoftEmergency */
@@ -158,7 +161,7 @@ _states{{
 
             /* requires unlock */ false,
 
-            new StateCallbacks(
+            StateCallbacks{
                 /* process function*/
                 [](StateChaningSources &src) -> void {
                     src.canopen.setBrakeForce(Canopen::MaxBrakePressure);
@@ -183,7 +186,7 @@ _states{{
                 /* one time setup */ 
                 [](StateChaningSources &src) -> void { 
                 }
-            )
+            }
         ),
 
         /* Manual */
@@ -201,7 +204,7 @@ _states{{
 
             /* requires unlock */ false,
 
-             new StateCallbacks(
+            StateCallbacks{
                 /* process function*/   
                 [](StateChaningSources &src) -> void {
                     return;
@@ -219,7 +222,7 @@ _states{{
                     src.canopen.setActuatorPDOs(true);
                     src.canopen.setActuatorPDOs(false);
                 }
-            )
+            }
         ),
 
         /* Emergency */
@@ -237,7 +240,7 @@ _states{{
 
             /* requires unlock */ false,
 
-            new StateCallbacks(
+            StateCallbacks{
                 /* process function*/
                 [](StateChaningSources &src) -> void {
                     src.canopen.setBrakeForce(Canopen::MaxBrakePressure);
@@ -251,49 +254,72 @@ _states{{
                 /* one time setup */ 
                 [](StateChaningSources &src) -> void { 
                 }
-            )
+            }
         )
-    }},
-      // clang-format on
-      _idleState(_lookupIdleState())
+    }};
+// clang-format on
+
+/**
+ * @brief No two states equal by State::operator==
+ *
+ */
+constexpr bool uniqueIdsAndPriorities(const StatesArray &states)
 {
-    // checking for duplicate priorities
-    // kind of cheap but it ensures that only one state can ever run
-    for (const auto &e : _states)
+    for (size_t i = 0; i < states.size(); ++i)
     {
-        for (const auto &i : _states)
+        for (size_t j = i + 1; j < states.size(); ++j)
         {
-            if (std::addressof(e) != std::addressof(i) && e.priority == i.priority)
+            if (states[i] == states[j])
             {
-                specialAssert(false);
-                return;
+                return false;
             }
         }
     }
+    return true;
+}
 
-    // check that there is a priority zero state that can run when nothing else
-    // is able to
-    // also force it to always be able to run
-    for (auto &e : _states)
+constexpr bool callbacksComplete(const StatesArray &states)
+{
+    for (const State &state : states)
     {
-        if (e.priority == IDLE_STATE_PRIORITY)
+        if (state.callbacks.process == nullptr || state.callbacks.checkConditions == nullptr ||
+            state.callbacks.oneTimeSetup == nullptr)
         {
-            e.callbacks->_checkConditions = [](StateChaningSources &) -> bool { return true; };
+            return false;
         }
     }
+    return true;
 }
 
-const State &States::_lookupIdleState() const
+/**
+ * @brief The state that runs when no other is able to, states.size() without one
+ *
+ */
+constexpr size_t idleStateIndex(const StatesArray &states)
 {
-    for (const auto &e : _states)
+    for (size_t i = 0; i < states.size(); ++i)
     {
-        if (e.priority == IDLE_STATE_PRIORITY)
+        if (states[i].priority == States::IDLE_STATE_PRIORITY)
         {
-            return e;
+            return i;
         }
     }
-    specialAssert(false); // no idle state
-    return _states[0];    // never reached, satisfies compiler
+    return states.size();
+}
+
+static_assert(uniqueIdsAndPriorities(Table), "states need unique ids and priorities");
+static_assert(callbacksComplete(Table), "every state needs all callbacks");
+static_assert(idleStateIndex(Table) < Table.size(), "no idle state");
+} // namespace
+
+const StatesArray &States::get()
+{
+    return Table;
+}
+
+const State &States::getIdleState()
+{
+    return Table[idleStateIndex(Table)];
 }
 
-} // namespace remote_control_device
\ No newline at end of file
+} // namespace remote_control_device
@@ -6,7 +6,8 @@ namespace remote_control_device
 {
 
 /**
- * @brief See States.cpp for state behaviour
+ * @brief See States.cpp for state behaviour. The table is constant, checked at compile time and
+ * lives in flash
  *
  */
 
@@ -14,28 +15,11 @@ using StatesArray = std::array<State, 7>;
 class States
 {
 public:
-    /**
-     * @brief Performes various checks
-     *
-     */
-    States();
+    static const StatesArray &get();
 
-    const StatesArray &get() const
-    {
-        return _states;
-    }
-
-    const State& getIdleState() const {
-        return _idleState;
-    };
+    static const State &getIdleState();
 
     static constexpr uint8_t IDLE_STATE_PRIORITY = 0;
-private:
-    StatesArray _states;
-    const State& _idleState;
-
-    
-    const State& _lookupIdleState() const;
 };
 
-} // namespace remote_control_device
\ No newline at end of file
+} // namespace remote_control_device
@@ -0,0 +1,235 @@
+#include "UIRenderer.hpp"
+#include "ANSIEscapeCodes.hpp"
+#include "CanFestival/CFLockerProfiler.hpp"
+#include "CanFestival/CanFestivalTimers.hpp"
+#include "Canopen.hpp"
+#include "FirmwareHasher.hpp"
+#include "Logging.hpp"
+#include "PeripheralDrivers/CanIO.hpp"
+#include "PeripheralDrivers/TerminalIO.hpp"
+#include "RemoteControl.hpp"
+#include "SpecialAssert.hpp"
+#include "Wrapper/Sync.hpp"
+#include <base/build_information.hpp>
+#include <cmsis_os2.h>
+#include <cstdio>
+
+namespace remote_control_device
+{
+
+UIRenderer::UIRenderer(Statemachine &sm, RemoteControl &rc, Canopen &co, CanIO &canio,
+                       CanFestivalTimers &cft, TerminalIO &term, wrapper::HAL &hal)
+    : _task(&UIRenderer::taskMain, "UI", StackSize, reinterpret_cast<void *>(this),
+            osPriority_t::osPriorityBelowNormal, wrapper::sync::UIRenderer_Ready),
+      _statemachine(sm), _remoteControl(rc), _canopen(co), _canIO(canio), _cft(cft),
+      _terminalIO(term), _hal(hal), _frame(term)
+{
+}
+
+void UIRenderer::render()
+{
+    _terminalIO.getLogging().disableLogging();
+    (void)_statemachine.readStatus(_status);
+
+    _frame.begin();
+    draw(_frame);
+    _frame.end();
+    // for the next frame, copied by the Statemachine meanwhile
+    _statemachine.requestCycleStatistics();
+}
+
+void UIRenderer::draw(TerminalWriter &term)
+{
+    // Header
+    term.write(ANSIEscapeCodes::ColorSection_WhiteText_MagentaBackground);
+    term.write("Remote-Control-Device (RCD)\r\n\r\n");
+    term.write(ANSIEscapeCodes::ColorSection_End);
+
+    // Buildinfo
+    term.write(ANSIEscapeCodes::ColorSection_WhiteText_GrayBackground);
+    term.write("Build information:\r\n");
+    term.write(ANSIEscapeCodes::ColorSection_End);
+    term.write("Git Hash: ");
+    term.write(build_info::CommitHashLong);
+    term.write("\r\nBranch: ");
+    term.write(build_info::BranchName);
+
+    term.write("\r\nDebug build: ");
+    if (build_info::IsDebugBuild)
+    {
+        term.write("Yes\r\n");
+    }
+    else
+    {
+        term.write("No\r\n");
+    }
+    term.write("Compiled with uncommited changes: ");
+    if (build_info::IsDirty)
+    {
+        term.write("Yes\r\n");
+    }
+    else
+    {
+        term.write("No\r\n");
+    }
+
+    // Statemachine
+    term.write(ANSIEscapeCodes::ColorSection_WhiteText_GrayBackground);
+    term.write("\r\nStatemachine:\r\n");
+    term.write(ANSIEscapeCodes::ColorSection_End);
+
+    term.write("Current State:");
+    term.write(getStateIdName(_status.currentState));
+    term.write("\r\n");
+
+    term.write("Remote Control Connection: ");
+    if (_status.remoteControlTimeout)
+    {
+        term.write(ANSIEscapeCodes::ColorSection_WhiteText_RedBackground);
+        term.write("Timeout\r\n");
+        term.write(ANSIEscapeCodes::ColorSection_End);
+    }
+    else
+    {
+        term.write("Online\r\n");
+    }
+
+    term.write("Manual Switch: ");
+    if (_status.manualSwitch)
+    {
+        term.write(ANSIEscapeCodes::ColorSection_BlackText_GreenBackground);
+        term.write("Active\r\n");
+        term.write(ANSIEscapeCodes::ColorSection_End);
+    }
+    else
+    {
+        term.write("Inactive\r\n");
+    }
+
+    term.write("Bike Emergency Switch: ");
+    if (_status.bikeEmergency)
+    {
+        term.write(ANSIEscapeCodes::ColorSection_BlackText_YellowBackground);
+        term.write("Active\r\n");
+        term.write(ANSIEscapeCodes::ColorSection_End);
+    }
+    else
+    {
+        term.write("Inactive\r\n");
+    }
+
+    static constexpr size_t wakeUpBuffSize = 80;
+    char wakeUpBuff[wakeUpBuffSize] = {0};
+    snprintf(wakeUpBuff, wakeUpBuffSize,
+             "Woken up by RC inputs: %lu, bus events: %lu, switch edges: %lu\r\n",
+             _status.wakeUps[0], _status.wakeUps[1], _status.wakeUps[2]);
+    term.write(wakeUpBuff);
+
+    // Radio link quality
+    _remoteControl.drawUILinkPart(term);
+
+    // Statemachine
+    term.write(ANSIEscapeCodes::ColorSection_WhiteText_GrayBackground);
+    term.write("\r\nSystem:\r\n");
+    term.write(ANSIEscapeCodes::ColorSection_End);
+
+    static constexpr size_t buffSize = 20;
+    char buff[buffSize] = {0};
+    uint8_t timersRemain = _cft.getTimersRemaining();
+    snprintf(buff, buffSize, "%d", timersRemain);
+    term.write("Remaining Timer Slots: ");
+    term.write(buff);
+    term.write("\r\n");
+
+    const auto lateness = _cft.getLatenessStatistics();
+    term.write("Timer Lateness max / last: ");
+    snprintf(buff, buffSize, "%lu", lateness.maxLateness_us);
+    term.write(buff);
+    term.write(" / ");
+    snprintf(buff, buffSize, "%lu", lateness.lastLateness_us);
+    term.write(buff);
+    term.write("(us), late ");
+    snprintf(buff, buffSize, "%lu", lateness.lateCount);
+    term.write(buff);
+    term.write(" of ");
+    snprintf(buff, buffSize, "%lu", lateness.firedCount);
+    term.write(buff);
+    term.write(", missed periods ");
+    snprintf(buff, buffSize, "%lu", lateness.missedPeriods);
+    term.write(buff);
+    term.write("\r\n");
+
+    snprintf(buff, buffSize, "%lu", (_hal.GetTick() / 1000));
+    term.write("Ontime: ");
+    term.write(buff);
+    term.write("(s)\r\n");
+
+    uint16_t ramRemain = xPortGetFreeHeapSize();
+    snprintf(buff, buffSize, "%d", ramRemain);
+    term.write("Free Memory ");
+    term.write(buff);
+    term.write(" bytes\r\n");
+
+    term.write("Tasks at max stack; words (4 bytes) still free:\r\n");
+
+    const auto &tasks = wrapper::Task::getAllTaskHandles();
+    for (const auto &t : tasks)
+    {
+        if (t == nullptr)
+        {
+            continue;
+        }
+        term.write("\t");
+        term.write(pcTaskGetName(t));
+        term.write(": ");
+
+        UBaseType_t words = uxTaskGetStackHighWaterMark(t);
+        snprintf(buff, buffSize, "%lu", words);
+        term.write(buff);
+        term.write("\r\n");
+    }
+
+    term.write("Successful firmware hashes: ");    
+    snprintf(buff, buffSize, "%lu", FirmwareHasher::successfulHashes);
+    term.write(buff);
+    term.write("\r\n");
+
+    const TerminalFrame::Statistics &frame = _frame.getStatistics();
+    term.write("UI lines written / unchanged: ");
+    snprintf(buff, buffSize, "%lu", frame.linesWritten);
+    term.write(buff);
+    term.write(" / ");
+    snprintf(buff, buffSize, "%lu", frame.linesSkipped);
+    term.write(buff);
+    term.write("\r\n");
+
+    // Bus load, frames per COB-ID
+    _canIO.drawUITrafficPart(term);
+
+    // Monitored Devices, state controlled devices
+    _canopen.drawUIDevicesPart(term);
+
+    if (const CycleProfiler::Statistics *cycle = _statemachine.getCycleStatistics())
+    {
+        CycleProfiler::drawUIPart(term, *cycle);
+    }
+
+#ifdef BUILDCONFIG_CFLOCKER_PROFILING
+    CFLockerProfiler::drawUIPart(term);
+#endif
+}
+
+void UIRenderer::taskMain(void *instance)
+{
+    specialAssert(instance != nullptr);
+    auto ui = reinterpret_cast<UIRenderer *>(instance);
+
+    TickType_t lastFrame = xTaskGetTickCount();
+    for (;;)
+    {
+        vTaskDelayUntil(&lastFrame, pdMS_TO_TICKS(UI_UPDATE_TIME_MS));
+        ui->render();
+    }
+}
+
+} // namespace remote_control_device
@@ -0,0 +1,77 @@
+#pragma once
+#include "PeripheralDrivers/TerminalFrame.hpp"
+#include "Statemachine.hpp"
+#include "Wrapper/HAL.hpp"
+#include "Wrapper/Task.hpp"
+#include <FreeRTOS.h>
+
+/**
+ * @brief Draws the UI that shows device information and states on its own low priority task
+ *
+ * Writing the UI blocks whenever the TerminalIO's buffer is full, in the Statemachine's task this
+ * delayed the cycle by the UI's transmission time. The Statemachine only publishes its Status,
+ * the other modules' UI parts are safe to draw from any task. Frames go through a TerminalFrame
+ * so only the lines that changed get transmitted.
+ */
+namespace remote_control_device
+{
+class Canopen;
+class RemoteControl;
+class TerminalIO;
+class CanFestivalTimers;
+class CanIO;
+
+class UIRenderer
+{
+public:
+    static constexpr uint16_t StackSize = 250;
+    static constexpr uint32_t UI_UPDATE_TIME_MS{2000};
+
+    UIRenderer(Statemachine &sm, RemoteControl &rc, Canopen &co, CanIO &canio,
+               CanFestivalTimers &cft, TerminalIO &term, wrapper::HAL &hal);
+    virtual ~UIRenderer() = default;
+
+    UIRenderer(const UIRenderer &) = delete;
+    UIRenderer(UIRenderer &&) = delete;
+    UIRenderer &operator=(const UIRenderer &) = delete;
+    UIRenderer &operator=(UIRenderer &&) = delete;
+
+    /**
+     * @brief Internal. Replaces all logging with the UI, draws one frame on the calling task
+     *
+     */
+    virtual void render();
+
+    /**
+     * @brief The next frame clears the terminal and draws all lines
+     *
+     */
+    void invalidate()
+    {
+        _frame.invalidate();
+    }
+
+    const TerminalFrame &getFrame() const
+    {
+        return _frame;
+    }
+
+private:
+    wrapper::Task _task;
+    Statemachine &_statemachine;
+    RemoteControl &_remoteControl;
+    Canopen &_canopen;
+    CanIO &_canIO;
+    CanFestivalTimers &_cft;
+    TerminalIO &_terminalIO;
+    wrapper::HAL &_hal;
+
+    TerminalFrame _frame;
+    // a torn copy only lasts until the next frame
+    Statemachine::Status _status;
+
+    void draw(TerminalWriter &term);
+
+    static void taskMain(void *instance);
+};
+} // namespace remote_control_device
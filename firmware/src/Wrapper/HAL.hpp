@@ -1,7 +1,12 @@
 #pragma once
+#include "BuildConfiguration.hpp"
 #include <FreeRTOS.h>
 #include <stm32f3xx_hal.h>
 
+#ifndef BUILDCONFIG_EMBEDDED_BUILD
+#include <time.h>
+#endif
+
 /**
  * @brief Encapsulates common hal functions into a class for mocking it with gmock
  * I've not realized gMocks clear advantages vs HippoMocks until I was almost done
@@ -16,7 +21,15 @@ namespace wrapper
 class HAL
 {
 public:
-    HAL() = default;
+    HAL()
+    {
+#ifdef BUILDCONFIG_EMBEDDED_BUILD
+        // cycle counter is used for sub millisecond time measurements
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CYCCNT = 0;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+    }
     virtual ~HAL() = default;
 
     HAL(const HAL &) = delete;
@@ -28,6 +41,50 @@ public:
     {
         return HAL_GetTick();
     }
+
+#ifdef BUILDCONFIG_EMBEDDED_BUILD
+    static constexpr uint32_t CyclesPerMicrosecond = 64;
+#else
+    static constexpr uint32_t CyclesPerMicrosecond = 1;
+#endif
+
+    /**
+     * @brief Free running cycle counter, wraps around. Only use differences
+     * On host it counts microseconds
+     *
+     */
+    virtual uint32_t GetCycleCount() const
+    {
+        return ReadCycleCounter();
+    }
+
+    /**
+     * @brief GetCycleCount for code without a HAL instance, can't be mocked
+     *
+     */
+    static uint32_t ReadCycleCounter()
+    {
+#ifdef BUILDCONFIG_EMBEDDED_BUILD
+        return DWT->CYCCNT;
+#else
+        timespec ts{};
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec * 1'000'000 + ts.tv_nsec / 1000;
+#endif
+    }
+
+    /**
+     * @brief Whether the caller runs in an exception handler, tests never do
+     *
+     */
+    static bool IsInISR()
+    {
+#ifdef BUILDCONFIG_EMBEDDED_BUILD
+        return __get_IPSR() != 0U;
+#else
+        return false;
+#endif
+    }
 };
 
 } // namespace wrapper
\ No newline at end of file
@@ -0,0 +1,149 @@
+#pragma once
+#include <FreeRTOS.h>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+
+/**
+ * @brief Lock free ring buffer for any number of producers, tasks and ISRs alike, and one
+ * consumer
+ *
+ * A producer reserves a slot by advancing head with a compare exchange (LDREX / STREX on the
+ * Cortex-M4), fills it in place and commits it by publishing the slot's sequence number. Every
+ * slot carries its own sequence: equal to the position while free, position + 1 once committed
+ * and position + Capacity after the consumer released it. So producers never wait for each
+ * other and nobody disables interrupts. The consumer stops at the first slot that is reserved
+ * but not committed yet, e.g. a task preempted by an ISR that logs, and continues once it is.
+ *
+ * Elements finding the ring full are dropped and counted.
+ */
+namespace wrapper
+{
+
+template <typename T, size_t Capacity>
+class MpscRing
+{
+    static_assert(std::is_trivially_copyable_v<T>, "Copies must not have side effects");
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                  "Capacity must be a power of two");
+
+public:
+    MpscRing()
+    {
+        for (uint32_t i = 0; i < Capacity; ++i)
+        {
+            _slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+    ~MpscRing() = default;
+
+    MpscRing(const MpscRing &) = delete;
+    MpscRing(MpscRing &&) = delete;
+    MpscRing &operator=(const MpscRing &) = delete;
+    MpscRing &operator=(MpscRing &&) = delete;
+
+    /**
+     * @brief Producer side, any task or ISR, never blocks
+     *
+     * @param fill called with the reserved element, fills it in place
+     * @return true committed
+     * @return false ring full, counted as dropped
+     */
+    template <typename Fill>
+    bool emplace(Fill &&fill)
+    {
+        uint32_t head = _head.load(std::memory_order_relaxed);
+        Slot *slot = nullptr;
+        for (;;)
+        {
+            slot = &_slots[head & IndexMask];
+            const auto lag =
+                static_cast<int32_t>(slot->sequence.load(std::memory_order_acquire) - head);
+            if (lag == 0)
+            {
+                // head is reloaded when another producer was faster
+                if (_head.compare_exchange_weak(head, head + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (lag < 0)
+            {
+                // still holds the element from one lap ago
+                _dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            else
+            {
+                head = _head.load(std::memory_order_relaxed);
+            }
+        }
+
+        fill(slot->item);
+        slot->sequence.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool push(const T &item)
+    {
+        return emplace([&item](T &slot) { slot = item; });
+    }
+
+    /**
+     * @brief Consumer side, never blocks
+     *
+     * @param read called with the oldest committed element before its slot is released
+     * @return true element read and removed
+     * @return false ring empty or the oldest element isn't committed yet
+     */
+    template <typename Read>
+    bool consume(Read &&read)
+    {
+        Slot &slot = _slots[_tail & IndexMask];
+        if (slot.sequence.load(std::memory_order_acquire) != _tail + 1)
+        {
+            return false;
+        }
+        read(static_cast<const T &>(slot.item));
+        slot.sequence.store(_tail + Capacity, std::memory_order_release);
+        _tail++;
+        return true;
+    }
+
+    bool pop(T &target)
+    {
+        return consume([&target](const T &item) { target = item; });
+    }
+
+    /**
+     * @brief Elements dropped since startup, free running
+     *
+     */
+    uint32_t getDropped() const
+    {
+        return _dropped.load(std::memory_order_relaxed);
+    }
+
+    static constexpr size_t capacity()
+    {
+        return Capacity;
+    }
+
+private:
+    static constexpr uint32_t IndexMask = Capacity - 1;
+
+    struct Slot
+    {
+        std::atomic<uint32_t> sequence{0};
+        T item{};
+    };
+
+    std::atomic<uint32_t> _head{0};
+    // only the consumer
+    uint32_t _tail{0};
+    std::atomic<uint32_t> _dropped{0};
+    std::array<Slot, Capacity> _slots;
+};
+
+} // namespace wrapper
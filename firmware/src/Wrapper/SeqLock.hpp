@@ -0,0 +1,102 @@
+#pragma once
+#include <FreeRTOS.h>
+#include <array>
+#include <atomic>
+#include <type_traits>
+
+/**
+ * @brief Single writer / multi reader publication of a value without mutexes
+ *
+ * The value is kept twice. The writer bumps the sequence counter before updating
+ * each copy so the lowest bit always points readers to the copy currently not
+ * being written. Readers never wait for the writer, they only retry when the writer
+ * finished an update while they were copying. On our single core this means a reader
+ * retries at most once per writer activation, no matter the task priorities.
+ *
+ * Only one task may call write().
+ */
+namespace wrapper
+{
+
+template <typename T>
+class SeqLock
+{
+    static_assert(std::is_trivially_copyable_v<T>, "Copies must not have side effects");
+
+public:
+    SeqLock() = default;
+    explicit SeqLock(const T &initial) : _copies{initial, initial}
+    {
+    }
+    ~SeqLock() = default;
+
+    SeqLock(const SeqLock &) = delete;
+    SeqLock(SeqLock &&) = delete;
+    SeqLock &operator=(const SeqLock &) = delete;
+    SeqLock &operator=(SeqLock &&) = delete;
+
+    /**
+     * @brief Retries until read() gives up, 2 would suffice unless the writer
+     * gets activated back to back during a single copy
+     *
+     */
+    static constexpr uint8_t MaxReadAttempts = 4;
+
+    /**
+     * @brief Publishes value, never blocks
+     *
+     * @param value
+     */
+    void write(const T &value)
+    {
+        uint32_t seq = _sequence.load(std::memory_order_relaxed);
+
+        // readers switch to copy 1 while copy 0 gets written and vice versa
+        for (T &copy : _copies)
+        {
+            _sequence.store(++seq, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            copy = value;
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    /**
+     * @brief Copies the latest value, never blocks
+     *
+     * @param target
+     * @return true consistent copy written to target
+     * @return false writer was too busy, target may contain garbage
+     */
+    bool read(T &target) const
+    {
+        for (uint8_t attempt = 0; attempt < MaxReadAttempts; ++attempt)
+        {
+            const uint32_t seq = _sequence.load(std::memory_order_acquire);
+            target = _copies[seq & 1];
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (_sequence.load(std::memory_order_relaxed) == seq)
+            {
+                return true;
+            }
+            _retries.fetch_add(1, std::memory_order_relaxed);
+        }
+        return false;
+    }
+
+    /**
+     * @brief Number of times readers had to copy again, for diagnostics
+     *
+     */
+    uint32_t getRetryCount() const
+    {
+        return _retries.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<uint32_t> _sequence{0};
+    mutable std::atomic<uint32_t> _retries{0};
+    std::array<T, 2> _copies{};
+};
+
+} // namespace wrapper
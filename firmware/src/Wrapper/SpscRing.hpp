@@ -0,0 +1,97 @@
+#pragma once
+#include <FreeRTOS.h>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+
+/**
+ * @brief Lock free ring buffer for exactly one producer and one consumer, e.g. ISR -> task
+ *
+ * Head and tail are free running counters, only the producer writes head and only the
+ * consumer writes tail. An element is copied before head is published, so the consumer
+ * never sees a half written element and neither side ever disables interrupts.
+ *
+ * A second producer (or consumer) must be serialized with the first one by the caller.
+ */
+namespace wrapper
+{
+
+template <typename T, size_t Capacity>
+class SpscRing
+{
+    static_assert(std::is_trivially_copyable_v<T>, "Copies must not have side effects");
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                  "Capacity must be a power of two");
+
+public:
+    SpscRing() = default;
+    ~SpscRing() = default;
+
+    SpscRing(const SpscRing &) = delete;
+    SpscRing(SpscRing &&) = delete;
+    SpscRing &operator=(const SpscRing &) = delete;
+    SpscRing &operator=(SpscRing &&) = delete;
+
+    /**
+     * @brief Producer side, never blocks
+     *
+     * @param item
+     * @return true queued
+     * @return false ring full, item dropped
+     */
+    bool push(const T &item)
+    {
+        const uint32_t head = _head.load(std::memory_order_relaxed);
+        if (head - _tail.load(std::memory_order_acquire) >= Capacity)
+        {
+            return false;
+        }
+        _items[head & IndexMask] = item;
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Consumer side, never blocks
+     *
+     * @param target
+     * @return true oldest item copied to target and removed
+     * @return false ring empty
+     */
+    bool pop(T &target)
+    {
+        const uint32_t tail = _tail.load(std::memory_order_relaxed);
+        if (_head.load(std::memory_order_acquire) == tail)
+        {
+            return false;
+        }
+        target = _items[tail & IndexMask];
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Number of queued items, a lower bound for the consumer and an upper one for the
+     * producer when the other side is active
+     *
+     */
+    size_t size() const
+    {
+        return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire);
+    }
+
+    static constexpr size_t capacity()
+    {
+        return Capacity;
+    }
+
+private:
+    static constexpr uint32_t IndexMask = Capacity - 1;
+
+    std::atomic<uint32_t> _head{0};
+    std::atomic<uint32_t> _tail{0};
+    std::array<T, Capacity> _items{};
+};
+
+} // namespace wrapper
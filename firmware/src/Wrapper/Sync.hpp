@@ -11,6 +11,7 @@ constexpr EventBits_t TerminalIO_Ready = 1 << 2;
 constexpr EventBits_t Statemachine_Ready = 1 << 3;
 constexpr EventBits_t CanfestivalTimers_Ready = 1 << 4;
 constexpr EventBits_t FirmwareHasher_Ready = 1 << 5;
+constexpr EventBits_t UIRenderer_Ready = 1 << 6;
 
 
 constexpr EventBits_t Application_Ready = 1 << 5;
@@ -30,7 +30,7 @@ public:
                              BaseType_t *pxHigherPriorityTaskWoken);
 
 
-    static constexpr uint8_t MAX_TASKS = 6;
+    static constexpr uint8_t MAX_TASKS = 7;
     static std::array<TaskHandle_t, MAX_TASKS>& getAllTaskHandles() {
         return _taskList;
     }
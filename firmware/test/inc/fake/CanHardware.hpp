@@ -0,0 +1,82 @@
+#pragma once
+#include <cstdint>
+#include <stm32f3xx_hal.h>
+
+/**
+ * @brief Emulated bxCAN state behind the HAL CAN stub
+ * Filter banks programmed through HAL_CAN_ConfigFilter, evaluated like the bxCAN does for
+ * standard id frames, the two 3 deep RX fifos and the 3 TX mailboxes (transmit fifo priority
+ * mode), including their registered callbacks
+ *
+ */
+namespace fake::can
+{
+
+/**
+ * @brief Deactivates all banks, the peripheral's reset state
+ *
+ */
+void resetFilters();
+
+/**
+ * @brief Number of active filter banks
+ *
+ */
+uint8_t getActiveBanks();
+
+/**
+ * @brief Checks if any active bank lets a standard id frame into a fifo
+ *
+ * @param stdId
+ * @param rtr remote frame
+ * @return true frame would be received
+ */
+bool acceptsFrame(uint16_t stdId, bool rtr = false);
+
+/**
+ * @brief Empties both RX fifos
+ *
+ */
+void resetRx();
+
+/**
+ * @brief Puts a frame into a RX fifo like the peripheral does on reception
+ *
+ * @param fifo CAN_RX_FIFO0 or CAN_RX_FIFO1
+ * @param header
+ * @param data 8 bytes
+ * @return false fifo overrun, frame lost
+ */
+bool receiveFrame(uint32_t fifo, const CAN_RxHeaderTypeDef &header, const uint8_t *data);
+
+/**
+ * @brief Calls the registered message pending callback if the fifo isn't empty
+ *
+ * @param fifo CAN_RX_FIFO0 or CAN_RX_FIFO1
+ */
+void raiseRxInterrupt(uint32_t fifo);
+
+/**
+ * @brief Empties all TX mailboxes
+ *
+ */
+void resetTx();
+
+/**
+ * @brief Transmits the oldest pending TX mailbox and calls its complete callback
+ *
+ * @param header of the sent frame
+ * @param data 8 bytes of the sent frame, optional
+ * @return false nothing pending
+ */
+bool transmitNext(CAN_TxHeaderTypeDef &header, uint8_t *data = nullptr);
+
+/**
+ * @brief Next call of transmitNext() will transmit the mailbox, an abort request
+ * for it then only takes effect if it loses arbitration, like on the bus
+ *
+ * @return false nothing pending
+ */
+bool startTransmission();
+
+} // namespace fake::can
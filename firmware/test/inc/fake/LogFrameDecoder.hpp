@@ -0,0 +1,133 @@
+#pragma once
+#include "LogRecord.hpp"
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Host side of BUILDCONFIG_BINARY_LOGGING like LogDecoder.py, splits what went to the
+ * terminal into frames, COBS decodes them and checks magic and CRC-8
+ *
+ */
+namespace fake::log
+{
+
+struct Frame
+{
+    // magic and CRC match, the fields below are only valid then
+    bool valid{false};
+    uint32_t timestamp_ms{0};
+    uint32_t id{0};
+    uint8_t origin{0};
+    uint8_t level{0};
+    uint8_t flags{0};
+    std::vector<uint8_t> args;
+
+    template <typename T>
+    T arg(size_t offset) const
+    {
+        T value{};
+        if (offset + sizeof(T) <= args.size())
+        {
+            memcpy(&value, &args[offset], sizeof(T));
+        }
+        return value;
+    }
+
+    // strings are stored as a length byte and their characters
+    std::string stringArg(size_t offset) const
+    {
+        if (offset >= args.size() || offset + 1 + args[offset] > args.size())
+        {
+            return {};
+        }
+        return std::string(reinterpret_cast<const char *>(&args[offset + 1]), args[offset]);
+    }
+};
+
+inline std::vector<uint8_t> cobsDecode(const uint8_t *data, size_t size)
+{
+    std::vector<uint8_t> out;
+    size_t i = 0;
+    while (i < size)
+    {
+        const uint8_t code = data[i];
+        if (code == 0 || i + code > size)
+        {
+            // not COBS, the CRC check fails on what is there
+            break;
+        }
+        out.insert(out.end(), data + i + 1, data + i + code);
+        i += code;
+        if (code < 0xFF && i < size)
+        {
+            out.push_back(0);
+        }
+    }
+    return out;
+}
+
+inline uint8_t crc8(const std::vector<uint8_t> &data)
+{
+    uint8_t crc = 0;
+    for (uint8_t byte : data)
+    {
+        crc ^= byte;
+        for (uint8_t bit = 0; bit < 8; ++bit)
+        {
+            crc = static_cast<uint8_t>((crc & 0x80) != 0 ? (crc << 1) ^ 0x07 : crc << 1);
+        }
+    }
+    return crc;
+}
+
+/**
+ * @brief Decodes a single frame without its delimiters
+ *
+ */
+inline Frame decodeFrame(const uint8_t *data, size_t size)
+{
+    static constexpr size_t HeaderSize = 12;
+    Frame frame;
+    const std::vector<uint8_t> payload = cobsDecode(data, size);
+    // CRC-8 over everything including the appended CRC is 0
+    if (payload.size() < HeaderSize + 1 || payload[0] != remote_control_device::LogFrameMagic ||
+        crc8(payload) != 0)
+    {
+        return frame;
+    }
+    frame.valid = true;
+    memcpy(&frame.timestamp_ms, &payload[1], 4);
+    memcpy(&frame.id, &payload[5], 4);
+    frame.origin = payload[9];
+    frame.level = payload[10];
+    frame.flags = payload[11];
+    frame.args.assign(payload.begin() + HeaderSize, payload.end() - 1);
+    return frame;
+}
+
+/**
+ * @brief Splits output at the zero delimiters, anything between two frames counts as frame
+ *
+ */
+inline std::vector<Frame> decodeFrames(const std::string &output)
+{
+    std::vector<Frame> frames;
+    const auto *data = reinterpret_cast<const uint8_t *>(output.data());
+    size_t start = 0;
+    for (size_t i = 0; i <= output.size(); ++i)
+    {
+        if (i == output.size() || data[i] == 0)
+        {
+            if (i > start)
+            {
+                frames.push_back(decodeFrame(data + start, i - start));
+            }
+            start = i + 1;
+        }
+    }
+    return frames;
+}
+
+} // namespace fake::log
@@ -15,5 +15,8 @@ public:
     }
     MOCK_METHOD(TickType_t, dispatch, (), (override));
     MOCK_METHOD(void, taskMain, (), (override));
+    MOCK_METHOD(void, runOnce, (TickType_t), (override));
     MOCK_METHOD(uint8_t, getTimersRemaining, (), (override));
+    MOCK_METHOD(LatenessStatistics, getLatenessStatistics, (), (override));
+    MOCK_METHOD(void, resetLatenessStatistics, (), (override));
 };
@@ -1,5 +1,6 @@
 #pragma once
 #include "gmock/gmock.h"
+#include <PeripheralDrivers/CanFilter.hpp>
 #include <PeripheralDrivers/CanIO.hpp>
 #include <task.h>
 #include <CanFestival/CanFestivalLocker.hpp>
@@ -16,13 +17,17 @@ using namespace remote_control_device;
 class CanIOMock : public CanIO
 {
 public:
-    CanIOMock(wrapper::HAL &hal, Logging &log) : CanIO(can, log)
+    CanIOMock(wrapper::HAL &hal, Logging &log) : CanIO(can, hal, log)
     {
     }
     MOCK_METHOD(void, setCanopenInstance, (Canopen&), (override));
     MOCK_METHOD(void, dispatch, (uint32_t), (override));
     MOCK_METHOD(bool, isBusOK, (), (override));
     MOCK_METHOD(void, canSend, (Message *), (override));
+    MOCK_METHOD(void, configureAcceptanceFilters, (const CanFilter &), (override));
+    MOCK_METHOD(CanTrafficSnapshot, getTrafficSnapshot, (), (override));
+    MOCK_METHOD(void, resetTrafficStatistics, (), (override));
+    MOCK_METHOD(void, drawUITrafficPart, (TerminalWriter &), (override));
 
     virtual void addRXMessage(Message & msg) override final {
         CFLocker lock;
@@ -22,6 +22,8 @@ public:
     MOCK_METHOD(void, setWheelDriveTorque, (float), (override));
     MOCK_METHOD(void, setBrakeForce, (float), (override));
     MOCK_METHOD(void, setSteeringAngle, (float), (override));
+    MOCK_METHOD(void, setActuatorSetpoints, (const Canopen::ActuatorSetpoints &, bool),
+                (override));
     MOCK_METHOD(void, signalRTDTimeout, (), (override));
     MOCK_METHOD(void, signalRTDRecovery, (), (override));
     MOCK_METHOD(bool, getRTDTimeout, (), (override));
@@ -8,4 +8,5 @@ class HALMock : public HAL
 {
 public:
     MOCK_METHOD(uint32_t, GetTick, (), (override, const));
+    MOCK_METHOD(uint32_t, GetCycleCount, (), (override, const));
 };
\ No newline at end of file
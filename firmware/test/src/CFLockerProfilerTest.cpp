@@ -0,0 +1,197 @@
+#include "CanFestival/CFLockerProfiler.hpp"
+#include "CanFestival/CanFestivalLocker.hpp"
+#include "Wrapper/HAL.hpp"
+#include "gtest/gtest.h"
+#include <FreeRTOS.h>
+#include <atomic>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <task.h>
+
+using namespace remote_control_device;
+
+namespace
+{
+void printCallSite(const CFLockerCallSite &site)
+{
+    const uint32_t count = std::max<uint32_t>(site.acquisitions, 1);
+    std::cout << "[  REPORT  ] " << std::left << std::setw(40)
+              << (std::string(site.file) + ":" + std::to_string(site.line)) << std::right
+              << std::setw(8) << site.acquisitions << " x, wait avg " << std::setw(5)
+              << site.totalWait_us / count << " max " << std::setw(6) << site.maxWait_us
+              << " us, hold avg " << std::setw(5) << site.totalHold_us / count << " max "
+              << std::setw(6) << site.maxHold_us << " us, waits";
+    for (uint32_t bucket : site.waitHistogram)
+    {
+        std::cout << " " << bucket;
+    }
+    std::cout << "\n";
+}
+
+/**
+ * @brief Finds the call site recorded for a CFLocker in this file
+ *
+ */
+bool findCallSite(uint16_t line, CFLockerCallSite &target)
+{
+    for (uint8_t i = 0; CFLockerProfiler::getCallSite(i, target); ++i)
+    {
+        if (target.line == line && std::strstr(target.file, "CFLockerProfilerTest") != nullptr)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+#ifdef BUILDCONFIG_CFLOCKER_PROFILING
+/**
+ * @brief Prints what all tests together did with the CFLocker
+ *
+ */
+class ProfileDump : public ::testing::Environment
+{
+public:
+    void TearDown() override
+    {
+        CFLocker locker;
+        std::cout << "[  REPORT  ] CFLocker call sites, wait buckets <1 <4 <16 <64 <256 <1k <4k "
+                     ">=4k us\n";
+        CFLockerCallSite site;
+        for (uint8_t i = 0; CFLockerProfiler::getCallSite(i, site); ++i)
+        {
+            printCallSite(site);
+        }
+        std::cout << "[  REPORT  ] Untracked acquisitions "
+                  << CFLockerProfiler::getUntrackedAcquisitions() << "\n";
+    }
+};
+// NOLINTNEXTLINE(cert-err58-cpp) registered before RUN_ALL_TESTS, gtest owns it
+::testing::Environment *const profileDump =
+    ::testing::AddGlobalTestEnvironment(new ProfileDump);
+#endif
+} // namespace
+
+TEST(CFLockerProfilerTest, callSitesAndHistogram)
+{
+#ifdef BUILDCONFIG_CFLOCKER_PROFILING
+    GTEST_SKIP() << "Would wipe the profile of the whole run";
+#endif
+    static constexpr uint32_t Cycles_us = wrapper::HAL::CyclesPerMicrosecond;
+    static const char *const fileA = "src/a.cpp";
+    static const char *const fileB = "src/b.cpp";
+    CFLockerProfiler::reset();
+
+    const uint8_t a = CFLockerProfiler::acquired(fileA, 10, 0);
+    CFLockerProfiler::released(a, 100 * Cycles_us);
+    EXPECT_EQ(CFLockerProfiler::acquired(fileA, 10, 3 * Cycles_us), a);
+    CFLockerProfiler::released(a, 50 * Cycles_us);
+    EXPECT_EQ(CFLockerProfiler::acquired(fileA, 10, 5000 * Cycles_us), a);
+    CFLockerProfiler::released(a, 0);
+
+    // same file, other line
+    const uint8_t b = CFLockerProfiler::acquired(fileA, 20, 16 * Cycles_us);
+    EXPECT_NE(b, a);
+    CFLockerProfiler::released(b, 0);
+
+    CFLockerCallSite site;
+    ASSERT_TRUE(CFLockerProfiler::getCallSite(a, site));
+    EXPECT_EQ(site.file, fileA);
+    EXPECT_EQ(site.line, 10);
+    EXPECT_EQ(site.acquisitions, 3);
+    EXPECT_EQ(site.totalWait_us, 5003);
+    EXPECT_EQ(site.maxWait_us, 5000);
+    EXPECT_EQ(site.totalHold_us, 150);
+    EXPECT_EQ(site.maxHold_us, 100);
+    const std::array<uint32_t, CFLockerCallSite::WaitBuckets> expectedA = {1, 1, 0, 0,
+                                                                          0, 0, 0, 1};
+    EXPECT_EQ(site.waitHistogram, expectedA);
+
+    ASSERT_TRUE(CFLockerProfiler::getCallSite(b, site));
+    // limits are exclusive
+    EXPECT_EQ(site.waitHistogram[3], 1);
+
+    // fill the table, the rest is only counted
+    for (uint16_t line = 0; line < CFLockerProfiler::MaxCallSites; ++line)
+    {
+        CFLockerProfiler::released(CFLockerProfiler::acquired(fileB, line, 0), 0);
+    }
+    EXPECT_EQ(CFLockerProfiler::getUntrackedAcquisitions(), 2);
+    EXPECT_EQ(CFLockerProfiler::acquired(fileB, 1000, 0), CFLockerProfiler::NoCallSite);
+    CFLockerProfiler::released(CFLockerProfiler::NoCallSite, 0);
+    EXPECT_EQ(CFLockerProfiler::getUntrackedAcquisitions(), 3);
+
+    CFLockerProfiler::reset();
+    EXPECT_FALSE(CFLockerProfiler::getCallSite(0, site));
+    EXPECT_EQ(CFLockerProfiler::getUntrackedAcquisitions(), 0);
+}
+
+TEST(CFLockerProfilerTest, waitBehindOtherTask)
+{
+#if !defined(BUILDCONFIG_CFLOCKER_PROFILING) || defined(BUILDCONFIG_CANOPEN_ACTOR)
+    GTEST_SKIP() << "Needs BUILDCONFIG_CFLOCKER_PROFILING and the mutex";
+#endif
+    static constexpr uint32_t HoldTime_us = 300;
+    static constexpr uint32_t Rounds = 50;
+
+    struct Context
+    {
+        std::atomic<bool> stop;
+        std::atomic<bool> done;
+        std::atomic<uint16_t> line;
+    } ctx{false, false, 0};
+
+    // like CanIO dispatching batch after batch. Yields while holding the lock so the test task
+    // runs into it
+    xTaskCreate(
+        [](void *param) -> void {
+            auto &c = *reinterpret_cast<Context *>(param);
+            while (!c.stop)
+            {
+                {
+                    // clang-format off
+                    CFLocker locker; c.line = __LINE__;
+                    // clang-format on
+                    const uint32_t start = wrapper::HAL::ReadCycleCounter();
+                    while (wrapper::HAL::ReadCycleCounter() - start <
+                           HoldTime_us * wrapper::HAL::CyclesPerMicrosecond)
+                    {
+                        taskYIELD();
+                    }
+                }
+                taskYIELD();
+            }
+            c.done = true;
+            vTaskDelete(nullptr);
+        },
+        "holder", configMINIMAL_STACK_SIZE * 4, &ctx, uxTaskPriorityGet(nullptr), nullptr);
+
+    uint16_t line = 0;
+    for (uint32_t i = 0; i < Rounds; ++i)
+    {
+        {
+            // clang-format off
+            CFLocker locker; line = __LINE__;
+            // clang-format on
+        }
+        vTaskDelay(1);
+    }
+    ctx.stop = true;
+    while (!ctx.done)
+    {
+        vTaskDelay(1);
+    }
+
+    CFLocker locker;
+    CFLockerCallSite site;
+    ASSERT_TRUE(findCallSite(line, site));
+    printCallSite(site);
+    EXPECT_EQ(site.acquisitions, Rounds);
+    // always ran into the holder
+    EXPECT_GT(site.maxWait_us, 0);
+
+    ASSERT_TRUE(findCallSite(ctx.line, site));
+    printCallSite(site);
+    EXPECT_GE(site.maxHold_us, HoldTime_us);
+}
@@ -206,4 +206,263 @@ TEST_F(CanFestivalTimersTest, bug32BitCurrentTimeOverflow)
         ASSERT_EQ(cntr, i+1); // check if really fired
         // with the bug in place this will fail at iteration 600 - the missing minute to 71
     }
-}
\ No newline at end of file
+}
+
+TEST_F(CanFestivalTimersTest, callbackDeletesOwnPeriodicAlarm)
+{
+    // canfestival stops SDO / heartbeat timers from within their own callbacks
+    static TIMER_HANDLE ownHandle;
+    int calledCount = 0;
+    EXPECT_CALL(halMock, GetTick).WillRepeatedly(Return(0));
+
+    ownHandle = cft.setAlarm(
+        reinterpret_cast<CO_Data *>(&calledCount), ID,
+        [](CO_Data *d, UNS32 id) {
+            ++(*reinterpret_cast<int *>(d));
+            CanFestivalTimers::delAlarm(ownHandle);
+        },
+        MS_TO_TIMEVAL(10), MS_TO_TIMEVAL(10));
+    ASSERT_NE(ownHandle, TIMER_NONE);
+
+    EXPECT_CALL(halMock, GetTick).WillRepeatedly(Return(10));
+    ASSERT_EQ(cft.dispatch(), 1);
+    ASSERT_EQ(calledCount, 1);
+    ASSERT_EQ(cft.getTimersRemaining(), CanFestivalTimers::MAX_TIMERS);
+
+    // must not have been rearmed
+    EXPECT_CALL(halMock, GetTick).WillRepeatedly(Return(100));
+    cft.dispatch();
+    ASSERT_EQ(calledCount, 1);
+}
+
+TEST_F(CanFestivalTimersTest, dispatchWaitsUntilNearestDeadline)
+{
+    EXPECT_CALL(halMock, GetTick).WillRepeatedly(Return(0));
+
+    // nothing armed, sleep until setAlarm wakes the task
+    ASSERT_EQ(cft.dispatch(), portMAX_DELAY);
+
+    int cntr = 0;
+    auto increaserCallback = [](CO_Data *d, UNS32 id) { ++(*reinterpret_cast<int *>(d)); };
+    ASSERT_NE(cft.setAlarm(reinterpret_cast<CO_Data *>(&cntr), ID, increaserCallback,
+                           US_TO_TIMEVAL(10'500), MS_TO_TIMEVAL(0)),
+              TIMER_NONE);
+
+    // rounded up, waking at 10ms would only go back to sleep
+    ASSERT_EQ(cft.dispatch(), pdMS_TO_TICKS(11));
+    ASSERT_EQ(cntr, 0);
+}
+
+TEST_F(CanFestivalTimersTest, setAndDelAlarmWakeTaskOnlyWhenNearestChanges)
+{
+    int cntr = 0;
+    auto increaserCallback = [](CO_Data *d, UNS32 id) { ++(*reinterpret_cast<int *>(d)); };
+    EXPECT_CALL(halMock, GetTick).WillRepeatedly(Return(0));
+
+    TIMER_HANDLE far = cft.setAlarm(reinterpret_cast<CO_Data *>(&cntr), ID, increaserCallback,
+                                    MS_TO_TIMEVAL(100), MS_TO_TIMEVAL(0));
+    ASSERT_EQ(cft.dispatch(), pdMS_TO_TICKS(100));
+
+    {
+        // later than the planned wakeup
+        MockRepository mocks;
+        mocks.NeverCallFunc(CanFestivalTimers::testHook_WakeTask);
+        cft.setAlarm(reinterpret_cast<CO_Data *>(&cntr), ID, increaserCallback,
+                     MS_TO_TIMEVAL(200), MS_TO_TIMEVAL(0));
+    }
+
+    TIMER_HANDLE near;
+    {
+        // earlier than the planned wakeup
+        MockRepository mocks;
+        mocks.ExpectCallFunc(CanFestivalTimers::testHook_WakeTask);
+        near = cft.setAlarm(reinterpret_cast<CO_Data *>(&cntr), ID, increaserCallback,
+                            MS_TO_TIMEVAL(10), MS_TO_TIMEVAL(0));
+    }
+    ASSERT_EQ(cft.dispatch(), pdMS_TO_TICKS(10));
+
+    {
+        // deleting an alarm the task doesn't wait for changes nothing
+        MockRepository mocks;
+        mocks.NeverCallFunc(CanFestivalTimers::testHook_WakeTask);
+        cft.delAlarm(far);
+    }
+
+    {
+        // deleting the nearest one lets the task sleep longer
+        MockRepository mocks;
+        mocks.ExpectCallFunc(CanFestivalTimers::testHook_WakeTask);
+        cft.delAlarm(near);
+    }
+    ASSERT_EQ(cft.dispatch(), pdMS_TO_TICKS(200));
+    ASSERT_EQ(cntr, 0);
+}
+
+TEST_F(CanFestivalTimersTest, latenessStatistics)
+{
+    int cntr = 0;
+    auto increaserCallback = [](CO_Data *d, UNS32 id) { ++(*reinterpret_cast<int *>(d)); };
+    EXPECT_CALL(halMock, GetTick).WillRepeatedly(Return(0));
+    cft.setAlarm(reinterpret_cast<CO_Data *>(&cntr), ID, increaserCallback, MS_TO_TIMEVAL(10),
+                 MS_TO_TIMEVAL(10));
+
+    // on time
+    EXPECT_CALL(halMock, GetTick).WillRepeatedly(Return(10));
+    cft.dispatch();
+    // one tick late is expected with ms resolution
+    EXPECT_CALL(halMock, GetTick).WillRepeatedly(Return(21));
+    cft.dispatch();
+    // late, deadline is still 30 as periods keep their phase
+    EXPECT_CALL(halMock, GetTick).WillRepeatedly(Return(36));
+    cft.dispatch();
+    ASSERT_EQ(cntr, 3);
+
+    auto stats = cft.getLatenessStatistics();
+    EXPECT_EQ(stats.firedCount, 3);
+    EXPECT_EQ(stats.lateCount, 1);
+    EXPECT_EQ(stats.lastLateness_us, MS_TO_TIMEVAL(6));
+    EXPECT_EQ(stats.maxLateness_us, MS_TO_TIMEVAL(6));
+
+    cft.resetLatenessStatistics();
+    stats = cft.getLatenessStatistics();
+    EXPECT_EQ(stats.firedCount, 0);
+    EXPECT_EQ(stats.maxLateness_us, 0);
+}
+
+namespace
+{
+void cftTaskMain(void *param)
+{
+    reinterpret_cast<CanFestivalTimers *>(param)->taskMain();
+}
+} // namespace
+
+TEST_F(CanFestivalTimersTest, taskMainWakesOnSetAlarm)
+{
+#ifdef BUILDCONFIG_CANOPEN_ACTOR
+    GTEST_SKIP() << "Only the task constructing CanFestivalTimers may run its taskMain";
+#endif
+    ON_CALL(halMock, GetTick).WillByDefault([]() { return xTaskGetTickCount(); });
+    EXPECT_CALL(halMock, GetTick).Times(::testing::AnyNumber());
+
+    // timer task preempts the test task like the Application task does
+    TaskHandle_t task;
+    xTaskCreate(&cftTaskMain, "cft", configMINIMAL_STACK_SIZE * 4, &cft,
+                uxTaskPriorityGet(nullptr) + 1, &task);
+
+    // task is idle now, waiting without timeout
+    vTaskDelay(pdMS_TO_TICKS(20));
+
+    static TickType_t firedAt;
+    firedAt = 0;
+    const TickType_t armedAt = xTaskGetTickCount();
+    cft.setAlarm(
+        reinterpret_cast<CO_Data *>(&cft), ID,
+        [](CO_Data *d, UNS32 id) { firedAt = xTaskGetTickCount(); }, MS_TO_TIMEVAL(5),
+        MS_TO_TIMEVAL(0));
+
+    vTaskDelay(pdMS_TO_TICKS(50));
+    vTaskDelete(task);
+
+    ASSERT_NE(firedAt, 0);
+    EXPECT_GE(firedAt - armedAt, pdMS_TO_TICKS(5));
+    EXPECT_LE(firedAt - armedAt, pdMS_TO_TICKS(5) + 1);
+    EXPECT_LE(cft.getLatenessStatistics().maxLateness_us, MS_TO_TIMEVAL(portTICK_PERIOD_MS));
+}
+
+TEST_F(CanFestivalTimersTest, periodicAlarmKeepsPhase)
+{
+    int cntr = 0;
+    auto increaserCallback = [](CO_Data *d, UNS32 id) { ++(*reinterpret_cast<int *>(d)); };
+    EXPECT_CALL(halMock, GetTick).WillRepeatedly(Return(0));
+    cft.setAlarm(reinterpret_cast<CO_Data *>(&cntr), ID, increaserCallback, MS_TO_TIMEVAL(10),
+                 MS_TO_TIMEVAL(10));
+
+    // late dispatch doesn't move the next deadline
+    EXPECT_CALL(halMock, GetTick).WillRepeatedly(Return(13));
+    ASSERT_EQ(cft.dispatch(), 1);
+    ASSERT_EQ(cft.dispatch(), pdMS_TO_TICKS(7));
+
+    // two whole periods missed, fired once and counted
+    EXPECT_CALL(halMock, GetTick).WillRepeatedly(Return(45));
+    ASSERT_EQ(cft.dispatch(), 1);
+    ASSERT_EQ(cft.dispatch(), pdMS_TO_TICKS(5));
+    ASSERT_EQ(cntr, 2);
+    EXPECT_EQ(cft.getLatenessStatistics().missedPeriods, 2);
+
+    // next deadline exactly now is skipped too, no back to back firing
+    EXPECT_CALL(halMock, GetTick).WillRepeatedly(Return(60));
+    ASSERT_EQ(cft.dispatch(), 1);
+    ASSERT_EQ(cft.dispatch(), pdMS_TO_TICKS(10));
+    ASSERT_EQ(cntr, 3);
+    EXPECT_EQ(cft.getLatenessStatistics().missedPeriods, 3);
+}
+
+TEST_F(CanFestivalTimersTest, selfRearmingAlarmKeepsPhase)
+{
+    // like canfestival's pdo event timers: one shot alarm arming itself again
+    struct Context
+    {
+        int cntr = 0;
+        bool armOther = false;
+    };
+    static TimerCallback_t rearmingCallback;
+    rearmingCallback = [](CO_Data *d, UNS32 id) {
+        auto ctx = reinterpret_cast<Context *>(d);
+        ctx->cntr++;
+        CanFestivalTimers::setAlarm(d, id, rearmingCallback, MS_TO_TIMEVAL(20), 0);
+        if (ctx->armOther)
+        {
+            CanFestivalTimers::setAlarm(
+                d, id, [](CO_Data *d, UNS32 id) {}, MS_TO_TIMEVAL(10), 0);
+        }
+    };
+
+    Context ctx;
+    EXPECT_CALL(halMock, GetTick).WillRepeatedly(Return(0));
+    cft.setAlarm(reinterpret_cast<CO_Data *>(&ctx), ID, rearmingCallback, MS_TO_TIMEVAL(20), 0);
+
+    EXPECT_CALL(halMock, GetTick).WillRepeatedly(Return(23));
+    ASSERT_EQ(cft.dispatch(), 1);
+    ASSERT_EQ(ctx.cntr, 1);
+    // 40, not 43
+    ASSERT_EQ(cft.dispatch(), pdMS_TO_TICKS(17));
+
+    // other alarms armed from the callback still count from now
+    ctx.armOther = true;
+    EXPECT_CALL(halMock, GetTick).WillRepeatedly(Return(42));
+    ASSERT_EQ(cft.dispatch(), 1);
+    ASSERT_EQ(ctx.cntr, 2);
+    ASSERT_EQ(cft.dispatch(), pdMS_TO_TICKS(10));
+
+    EXPECT_CALL(halMock, GetTick).WillRepeatedly(Return(52));
+    ASSERT_EQ(cft.dispatch(), 1);
+    ASSERT_EQ(cft.dispatch(), pdMS_TO_TICKS(8));
+}
+
+TEST_F(CanFestivalTimersTest, shiftAlarm)
+{
+    MockRepository mocks;
+    int cntr = 0;
+    auto increaserCallback = [](CO_Data *d, UNS32 id) { ++(*reinterpret_cast<int *>(d)); };
+    EXPECT_CALL(halMock, GetTick).WillRepeatedly(Return(0));
+    TIMER_HANDLE handle = cft.setAlarm(reinterpret_cast<CO_Data *>(&cntr), ID, increaserCallback,
+                                       MS_TO_TIMEVAL(20), MS_TO_TIMEVAL(20));
+
+    ASSERT_EQ(CanFestivalTimers::shiftAlarm(handle, MS_TO_TIMEVAL(5)), handle);
+    ASSERT_EQ(cft.dispatch(), pdMS_TO_TICKS(25));
+
+    // period keeps the offset
+    EXPECT_CALL(halMock, GetTick).WillRepeatedly(Return(25));
+    ASSERT_EQ(cft.dispatch(), 1);
+    ASSERT_EQ(cft.dispatch(), pdMS_TO_TICKS(20));
+
+    // nothing to shift
+    ASSERT_EQ(CanFestivalTimers::shiftAlarm(TIMER_NONE, MS_TO_TIMEVAL(5)), TIMER_NONE);
+    cft.delAlarm(handle);
+    ASSERT_EQ(CanFestivalTimers::shiftAlarm(handle, MS_TO_TIMEVAL(5)), TIMER_NONE);
+
+    mocks.ExpectCallFunc(CanFestivalTimers::testHook_ErrorShiftAlarm);
+    ASSERT_EQ(CanFestivalTimers::shiftAlarm(CanFestivalTimers::MAX_TIMERS, MS_TO_TIMEVAL(5)),
+              TIMER_NONE);
+}
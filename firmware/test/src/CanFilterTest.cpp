@@ -0,0 +1,144 @@
+#include "PeripheralDrivers/CanFilter.hpp"
+#include "fake/CanHardware.hpp"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <stm32f3xx_hal.h>
+#include <stm32f3xx_hal_can.h>
+#include <vector>
+
+using namespace remote_control_device;
+
+namespace
+{
+/**
+ * @brief Builds the banks and programs them through the HAL stub
+ *
+ * @return uint8_t used banks
+ */
+uint8_t program(const CanFilter &filter, CanFilter::Banks &banks)
+{
+    CAN_HandleTypeDef can;
+    fake::can::resetFilters();
+    const uint8_t usedBanks = filter.build(banks);
+    for (uint8_t i = 0; i < usedBanks; ++i)
+    {
+        HAL_CAN_ConfigFilter(&can, &banks[i]);
+    }
+    return usedBanks;
+}
+
+void expectOnlyAccepts(const std::vector<uint16_t> &ids)
+{
+    for (uint16_t id = 0; id <= 0x7FF; ++id)
+    {
+        const bool required = std::find(ids.begin(), ids.end(), id) != ids.end();
+        EXPECT_EQ(fake::can::acceptsFrame(id), required) << "COB-ID " << std::hex << id;
+        EXPECT_FALSE(fake::can::acceptsFrame(id, true)) << "RTR COB-ID " << std::hex << id;
+    }
+}
+
+CanFilter makeFilter(const std::vector<uint16_t> &ids)
+{
+    CanFilter filter;
+    for (uint16_t id : ids)
+    {
+        EXPECT_TRUE(filter.addId(id));
+    }
+    return filter;
+}
+} // namespace
+
+TEST(CanFilterTest, acceptAll)
+{
+    CAN_HandleTypeDef can;
+    CAN_FilterTypeDef conf = CanFilter::acceptAll();
+    fake::can::resetFilters();
+    HAL_CAN_ConfigFilter(&can, &conf);
+    for (uint16_t id = 0; id <= 0x7FF; ++id)
+    {
+        ASSERT_TRUE(fake::can::acceptsFrame(id));
+        ASSERT_TRUE(fake::can::acceptsFrame(id, true));
+    }
+}
+
+TEST(CanFilterTest, listPacking)
+{
+    const std::vector<uint16_t> ids = {0x000, 0x080, 0x182, 0x5A0, 0x5B0};
+    CanFilter::Banks banks;
+    const CanFilter filter = makeFilter(ids);
+    EXPECT_EQ(filter.getIdCount(), ids.size());
+
+    // no ids to merge, four per list bank
+    ASSERT_EQ(program(filter, banks), 2);
+    EXPECT_EQ(banks[0].FilterMode, CAN_FILTERMODE_IDLIST);
+    EXPECT_EQ(banks[1].FilterMode, CAN_FILTERMODE_IDLIST);
+    EXPECT_EQ(banks[0].FilterScale, CAN_FILTERSCALE_16BIT);
+    EXPECT_EQ(fake::can::getActiveBanks(), 2);
+    expectOnlyAccepts(ids);
+}
+
+TEST(CanFilterTest, heartbeatsMerged)
+{
+    // differ in bit 0 and 4 only
+    const std::vector<uint16_t> ids = {0x720, 0x721, 0x730, 0x731};
+    CanFilter::Banks banks;
+    const CanFilter filter = makeFilter(ids);
+
+    ASSERT_EQ(program(filter, banks), 1);
+    EXPECT_EQ(banks[0].FilterMode, CAN_FILTERMODE_IDMASK);
+    expectOnlyAccepts(ids);
+}
+
+TEST(CanFilterTest, mixedIdSet)
+{
+    const std::vector<uint16_t> ids = {0x000, 0x080, 0x182, 0x5A0, 0x5B0,
+                                       0x710, 0x720, 0x721, 0x730, 0x731};
+    CanFilter::Banks banks;
+    const CanFilter filter = makeFilter(ids);
+
+    // one mask bank holding the heartbeat group and one id, two list banks for the rest
+    ASSERT_EQ(program(filter, banks), 3);
+    expectOnlyAccepts(ids);
+}
+
+TEST(CanFilterTest, maximumIdCount)
+{
+    std::vector<uint16_t> ids;
+    for (uint16_t i = 0; i < CanFilter::MaxIds; ++i)
+    {
+        ids.push_back(0x100 + i * 37);
+    }
+    CanFilter::Banks banks;
+    const CanFilter filter = makeFilter(ids);
+
+    const uint8_t usedBanks = program(filter, banks);
+    EXPECT_GT(usedBanks, 0);
+    EXPECT_LE(usedBanks, CanFilter::MaxIds / 4);
+    expectOnlyAccepts(ids);
+}
+
+TEST(CanFilterTest, rejectedIds)
+{
+    CanFilter::Banks banks;
+    CanFilter filter;
+    EXPECT_EQ(filter.build(banks), 0);
+
+    // duplicates don't take space
+    EXPECT_TRUE(filter.addId(0x182));
+    EXPECT_TRUE(filter.addId(0x182));
+    EXPECT_EQ(filter.getIdCount(), 1);
+    EXPECT_EQ(filter.build(banks), 1);
+
+    // an incomplete filter must not be used
+    EXPECT_FALSE(filter.addId(0x800));
+    EXPECT_EQ(filter.build(banks), 0);
+
+    CanFilter full;
+    for (uint16_t i = 0; i < CanFilter::MaxIds; ++i)
+    {
+        EXPECT_TRUE(full.addId(i));
+    }
+    EXPECT_GT(full.build(banks), 0);
+    EXPECT_FALSE(full.addId(CanFilter::MaxIds));
+    EXPECT_EQ(full.build(banks), 0);
+}
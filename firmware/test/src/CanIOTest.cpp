@@ -1,10 +1,22 @@
+#include "CanFestival/CanFestivalLocker.hpp"
+#include "PeripheralDrivers/CanFilter.hpp"
 #include "PeripheralDrivers/CanIO.hpp"
+#include "fake/CanHardware.hpp"
+#include "fake/Task.hpp"
 #include "gtest/gtest.h"
 #include "mock/LoggingMock.hpp"
 #include "mock/CanopenMock.hpp"
 #include <FreeRTOS.h>
+#include <algorithm>
 #include <array>
+#include <chrono>
+#include <cstring>
+#include <deque>
 #include <exception>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <vector>
 #include <hippomocks.h>
 #include <stm32f3xx_hal.h>
 #include <stm32f3xx_hal_can.h>
@@ -19,12 +31,16 @@ using namespace remote_control_device;
 class CanIOTest : public ::testing::Test
 {
 protected:
-    CanIOTest() :term(halMock), log(term, halMock), canio(can, log), co(canio, log)
+    CanIOTest() :term(halMock), log(term, halMock), canio(can, halMock, log), co(canio, log)
     {
     }
 
     void SetUp() override {
         canio.setCanopenInstance(co);
+        fake::can::resetRx();
+        fake::can::resetTx();
+        EXPECT_CALL(halMock, GetTick).WillRepeatedly(::testing::Return(0));
+        EXPECT_CALL(halMock, GetCycleCount).WillRepeatedly(::testing::Return(0));
     }
 
     HALMock halMock;
@@ -150,17 +166,17 @@ TEST_F(CanIOTest, canDispatch_RejectExtendedId)
     static constexpr UNS8 data[8] = {1, 2, 3, 4, 5, 6, 7, 0};
 
     // test extended can id rejection
-    mocks.ExpectCallFunc(HAL_CAN_GetRxMessage)
-        .Do([](CAN_HandleTypeDef *hcan, uint32_t RxFifo, CAN_RxHeaderTypeDef *pHeader,
-               uint8_t aData[]) -> HAL_StatusTypeDef {
-            pHeader->IDE = CAN_ID_EXT;
-            pHeader->ExtId = 0x8ff;
-            pHeader->RTR = CAN_RTR_REMOTE;
-            pHeader->DLC = 8;
-            return HAL_OK;
-        });
-    mocks.NeverCallFunc(xQueueGenericSend);
-    CanIO::retrieveMessageFromISR(canio, nullptr, 0);
+    CAN_RxHeaderTypeDef header{};
+    header.IDE = CAN_ID_EXT;
+    header.ExtId = 0x8ff;
+    header.RTR = CAN_RTR_REMOTE;
+    header.DLC = 8;
+    fake::can::receiveFrame(CAN_RX_FIFO0, header, data);
+    ASSERT_EQ(CanIO::drainRxFifoFromISR(canio, &can, CAN_RX_FIFO0), 0);
+    ASSERT_EQ(HAL_CAN_GetRxFifoFillLevel(&can, CAN_RX_FIFO0), 0);
+
+    mocks.NeverCallFunc(canDispatch);
+    canio.dispatch(CanIO::NOTIFY_RX_PENDING);
 }
 
 TEST_F(CanIOTest, canDispatch)
@@ -174,20 +190,13 @@ TEST_F(CanIOTest, canDispatch)
     static constexpr UNS8 data[8] = {1, 2, 3, 4, 5, 6, 7, 0};
 
     // test queuing of correct header
-    mocks.ExpectCallFunc(HAL_CAN_GetRxMessage)
-        .Do([](CAN_HandleTypeDef *hcan, uint32_t RxFifo, CAN_RxHeaderTypeDef *pHeader,
-               uint8_t aData[]) -> HAL_StatusTypeDef {
-            pHeader->IDE = CAN_ID_STD;
-            pHeader->StdId = cob_id;
-            pHeader->RTR = rtr == 1 ? CAN_RTR_REMOTE : CAN_RTR_DATA;
-            pHeader->DLC = len;
-            for (size_t i = 0; i < 8; ++i)
-            {
-                aData[i] = data[i];
-            }
-            return HAL_OK;
-        });
-    CanIO::retrieveMessageFromISR(canio, nullptr, 0);
+    CAN_RxHeaderTypeDef header{};
+    header.IDE = CAN_ID_STD;
+    header.StdId = cob_id;
+    header.RTR = rtr == 1 ? CAN_RTR_REMOTE : CAN_RTR_DATA;
+    header.DLC = len;
+    fake::can::receiveFrame(CAN_RX_FIFO1, header, data);
+    ASSERT_EQ(CanIO::drainRxFifoFromISR(canio, &can, CAN_RX_FIFO1), CanIO::NOTIFY_RX_PENDING);
 
     mocks.ExpectCallFunc(canDispatch).Do([](CO_Data *d, Message *m) -> void {
         for (int i = 0; i < 8; ++i)
@@ -240,4 +249,577 @@ TEST_F(CanIOTest, dispatch_MultipleFlags)
     mocks.ExpectCallFunc(CanIO::testing_Overload);
     canio.dispatch(CanIO::NOTIFY_ATTEMPT_TX | CanIO::NOTIFY_OVERLOAD | CanIO::NOTIFY_ERROR |
                    CanIO::NOTIFY_RX_PENDING);
-}
\ No newline at end of file
+}
+
+TEST_F(CanIOTest, acceptanceFilters)
+{
+    // everything passes until the consumed ids are known
+    EXPECT_EQ(fake::can::getActiveBanks(), 1);
+    EXPECT_TRUE(fake::can::acceptsFrame(0x123));
+
+    // incomplete id set keeps accepting everything
+    CanFilter incomplete;
+    incomplete.addId(0x182);
+    EXPECT_FALSE(incomplete.addId(0x800));
+    canio.configureAcceptanceFilters(incomplete);
+    EXPECT_EQ(fake::can::getActiveBanks(), 1);
+    EXPECT_TRUE(fake::can::acceptsFrame(0x123));
+
+    CanFilter filter;
+    filter.addId(0x182);
+    canio.configureAcceptanceFilters(filter);
+    EXPECT_EQ(fake::can::getActiveBanks(), 1);
+    EXPECT_TRUE(fake::can::acceptsFrame(0x182));
+    EXPECT_FALSE(fake::can::acceptsFrame(0x123));
+}
+
+namespace
+{
+CAN_RxHeaderTypeDef makeHeader(uint16_t cobId)
+{
+    CAN_RxHeaderTypeDef header{};
+    header.IDE = CAN_ID_STD;
+    header.StdId = cobId;
+    header.RTR = CAN_RTR_DATA;
+    header.DLC = 8;
+    return header;
+}
+} // namespace
+
+TEST_F(CanIOTest, rxBurstDrainedByOneInterrupt)
+{
+    MockRepository mocks;
+    static constexpr uint8_t data[8] = {};
+
+    // fifo 0 is 3 deep, everything pending is read in one go
+    for (uint16_t cobId = 0x181; cobId <= 0x183; ++cobId)
+    {
+        ASSERT_TRUE(fake::can::receiveFrame(CAN_RX_FIFO0, makeHeader(cobId), data));
+    }
+    ASSERT_FALSE(fake::can::receiveFrame(CAN_RX_FIFO0, makeHeader(0x184), data));
+    fake::can::raiseRxInterrupt(CAN_RX_FIFO0);
+    ASSERT_EQ(HAL_CAN_GetRxFifoFillLevel(&can, CAN_RX_FIFO0), 0);
+
+    std::vector<uint16_t> dispatched;
+    mocks.OnCallFunc(canDispatch).Do([&dispatched](CO_Data *d, Message *m) -> void {
+        dispatched.push_back(m->cob_id);
+    });
+    canio.dispatch(CanIO::NOTIFY_RX_PENDING);
+    EXPECT_EQ(dispatched, std::vector<uint16_t>({0x181, 0x182, 0x183}));
+    EXPECT_EQ(canio.getRxDroppedCount(), 0);
+}
+
+TEST_F(CanIOTest, rxRingOverflow)
+{
+    MockRepository mocks;
+    static constexpr uint8_t data[8] = {};
+    static constexpr uint16_t Overflow = 5;
+
+    uint32_t flags = 0;
+    for (uint16_t i = 0; i < CanIO::RX_RING_SIZE + Overflow; ++i)
+    {
+        fake::can::receiveFrame(CAN_RX_FIFO0, makeHeader(i), data);
+        flags |= CanIO::drainRxFifoFromISR(canio, &can, CAN_RX_FIFO0);
+    }
+    EXPECT_EQ(flags, CanIO::NOTIFY_RX_PENDING | CanIO::NOTIFY_OVERLOAD);
+    EXPECT_EQ(canio.getRxDroppedCount(), Overflow);
+
+    // oldest frames are kept
+    std::vector<uint16_t> dispatched;
+    mocks.OnCallFunc(canDispatch).Do([&dispatched](CO_Data *d, Message *m) -> void {
+        dispatched.push_back(m->cob_id);
+    });
+    mocks.ExpectCallFunc(CanIO::testing_Overload);
+    canio.dispatch(flags);
+    ASSERT_EQ(dispatched.size(), CanIO::RX_RING_SIZE);
+    for (uint16_t i = 0; i < CanIO::RX_RING_SIZE; ++i)
+    {
+        EXPECT_EQ(dispatched[i], i);
+    }
+}
+
+namespace
+{
+/**
+ * @brief A flood of back to back frames, the CanIO task only gets to run every
+ * framesPerTaskRun frames. The interrupt sees up to 3 pending frames (fifo depth).
+ *
+ */
+constexpr uint32_t FloodFrames = 30000;
+constexpr uint32_t FramesPerInterrupt = 3;
+
+struct FloodResult
+{
+    uint32_t dropped;
+    double nsPerFrame;
+};
+
+/**
+ * @brief Receive path before the RX ring: one frame per interrupt entry pushed through a
+ * FreeRTOS queue of QUEUES_SIZE, task notified for every frame
+ *
+ */
+FloodResult floodQueue(CAN_HandleTypeDef &can, uint32_t framesPerTaskRun)
+{
+    static constexpr uint8_t data[8] = {};
+    QueueHandle_t queue = xQueueCreate(CanIO::QUEUES_SIZE, sizeof(Message));
+    FakeTaskContainer task;
+    uint32_t dropped = 0;
+
+    const auto start = std::chrono::steady_clock::now();
+    for (uint32_t sent = 0; sent < FloodFrames;)
+    {
+        for (uint32_t i = 0; i < framesPerTaskRun && sent < FloodFrames; i += FramesPerInterrupt)
+        {
+            for (uint32_t j = 0; j < FramesPerInterrupt && sent < FloodFrames; ++j, ++sent)
+            {
+                fake::can::receiveFrame(CAN_RX_FIFO0, makeHeader(0x182), data);
+            }
+            // interrupt fires again as long as the fifo isn't empty
+            while (HAL_CAN_GetRxFifoFillLevel(&can, CAN_RX_FIFO0) > 0)
+            {
+                BaseType_t woken = pdFALSE;
+                CAN_RxHeaderTypeDef header;
+                Message m = Message_Initializer;
+                HAL_CAN_GetRxMessage(&can, CAN_RX_FIFO0, &header, m.data);
+                m.cob_id = header.StdId;
+                m.len = header.DLC;
+                if (xQueueSendToBackFromISR(queue, &m, &woken) != pdPASS)
+                {
+                    dropped++;
+                }
+                xTaskNotifyFromISR(task.get(), CanIO::NOTIFY_RX_PENDING, eSetBits, &woken);
+            }
+        }
+
+        CFLocker locker;
+        Message m;
+        while (xQueueReceive(queue, &m, 0) != errQUEUE_EMPTY)
+        {
+            canDispatch(locker.getOD(), &m);
+        }
+    }
+    const auto end = std::chrono::steady_clock::now();
+    vQueueDelete(queue);
+    return {dropped, std::chrono::duration<double, std::nano>(end - start).count() / FloodFrames};
+}
+
+FloodResult floodRing(CanIO &canio, uint32_t framesPerTaskRun)
+{
+    static constexpr uint8_t data[8] = {};
+    const uint32_t droppedBefore = canio.getRxDroppedCount();
+
+    const auto start = std::chrono::steady_clock::now();
+    for (uint32_t sent = 0; sent < FloodFrames;)
+    {
+        for (uint32_t i = 0; i < framesPerTaskRun && sent < FloodFrames; i += FramesPerInterrupt)
+        {
+            for (uint32_t j = 0; j < FramesPerInterrupt && sent < FloodFrames; ++j, ++sent)
+            {
+                fake::can::receiveFrame(CAN_RX_FIFO0, makeHeader(0x182), data);
+            }
+            fake::can::raiseRxInterrupt(CAN_RX_FIFO0);
+        }
+        canio.dispatch(CanIO::NOTIFY_RX_PENDING);
+    }
+    const auto end = std::chrono::steady_clock::now();
+    return {canio.getRxDroppedCount() - droppedBefore,
+            std::chrono::duration<double, std::nano>(end - start).count() / FloodFrames};
+}
+} // namespace
+
+TEST_F(CanIOTest, benchmark_RxFlood)
+{
+    MockRepository mocks;
+    // only measure the transport into canfestival
+    mocks.OnCallFunc(canDispatch).Do([](CO_Data *d, Message *m) -> void {});
+
+    for (uint32_t framesPerTaskRun : {9, 30, 60, 120})
+    {
+        const FloodResult queue = floodQueue(can, framesPerTaskRun);
+        const FloodResult ring = floodRing(canio, framesPerTaskRun);
+        std::cout << "[ BENCHMARK] CanIO RX flood, task runs every " << framesPerTaskRun
+                  << " frames: queue dropped " << queue.dropped << " (" << queue.nsPerFrame
+                  << " ns/frame), ring dropped " << ring.dropped << " (" << ring.nsPerFrame
+                  << " ns/frame)\n";
+
+        EXPECT_LE(ring.dropped, queue.dropped);
+        if (framesPerTaskRun <= CanIO::RX_RING_SIZE)
+        {
+            EXPECT_EQ(ring.dropped, 0);
+        }
+    }
+}
+
+namespace
+{
+Message makeTxMessage(uint16_t cobId, uint32_t tag = 0)
+{
+    Message m = Message_Initializer;
+    m.cob_id = cobId;
+    m.len = 8;
+    std::memcpy(m.data, &tag, sizeof(tag));
+    return m;
+}
+
+/**
+ * @brief Puts up to frames frames on the emulated bus, the CanIO task refills the mailboxes
+ * after every one like it would after the TX complete interrupt
+ *
+ */
+void transmitFrames(CanIO &canio, uint32_t frames,
+                    const std::function<void(uint16_t cobId, uint32_t tag)> &onSent)
+{
+    for (uint32_t i = 0; i < frames; ++i)
+    {
+        CAN_TxHeaderTypeDef header;
+        uint8_t data[8];
+        if (!fake::can::transmitNext(header, data))
+        {
+            return;
+        }
+        uint32_t tag;
+        std::memcpy(&tag, data, sizeof(tag));
+        onSent(header.StdId, tag);
+        canio.dispatch(CanIO::NOTIFY_ATTEMPT_TX);
+    }
+}
+} // namespace
+
+TEST_F(CanIOTest, txLowestCobIdFirst)
+{
+    for (uint16_t cobId : {0x701, 0x620, 0x210, 0x181})
+    {
+        Message m = makeTxMessage(cobId);
+        canio.canSend(&m);
+    }
+    canio.dispatch(CanIO::NOTIFY_ATTEMPT_TX);
+
+    std::vector<uint16_t> sent;
+    transmitFrames(canio, 10, [&sent](uint16_t cobId, uint32_t) { sent.push_back(cobId); });
+    EXPECT_EQ(sent, std::vector<uint16_t>({0x181, 0x210, 0x620, 0x701}));
+}
+
+TEST_F(CanIOTest, txAbortOnPriorityInversion)
+{
+    MockRepository mocks;
+
+    for (uint16_t cobId : {0x701, 0x702, 0x703})
+    {
+        Message m = makeTxMessage(cobId);
+        canio.canSend(&m);
+    }
+    canio.dispatch(CanIO::NOTIFY_ATTEMPT_TX);
+    ASSERT_EQ(HAL_CAN_GetTxMailboxesFreeLevel(&can), 0);
+    // 0x701 is already on the bus and can't be aborted anymore
+    ASSERT_TRUE(fake::can::startTransmission());
+
+    // mailboxes are sent in request order, so without the abort 0x200 would be the last one
+    Message m = makeTxMessage(0x200);
+    canio.canSend(&m);
+    mocks.ExpectCallFunc(CanIO::testing_TxAbort);
+    canio.dispatch(CanIO::NOTIFY_ATTEMPT_TX);
+    canio.dispatch(CanIO::NOTIFY_ATTEMPT_TX);
+
+    std::vector<uint16_t> sent;
+    transmitFrames(canio, 10, [&sent](uint16_t cobId, uint32_t) { sent.push_back(cobId); });
+    EXPECT_EQ(sent, std::vector<uint16_t>({0x701, 0x200, 0x702, 0x703}));
+}
+
+TEST_F(CanIOTest, txAgedFrameNotStarved)
+{
+    static constexpr uint32_t FramesPerMs = 4;
+    uint32_t now = 0;
+    EXPECT_CALL(halMock, GetTick).WillRepeatedly([&now]() { return now; });
+
+    Message diagnostic = makeTxMessage(0x7E0);
+    canio.canSend(&diagnostic);
+    uint32_t sentAt = 0;
+    // the bus is saturated with more important frames
+    for (; now < 2 * CanIO::TX_AGING_TIME_ms && sentAt == 0; ++now)
+    {
+        for (uint16_t cobId = 0x200; cobId < 0x200 + FramesPerMs; ++cobId)
+        {
+            Message m = makeTxMessage(cobId);
+            canio.canSend(&m);
+        }
+        canio.dispatch(CanIO::NOTIFY_ATTEMPT_TX);
+        transmitFrames(canio, FramesPerMs, [&sentAt, &now](uint16_t cobId, uint32_t) {
+            if (cobId == 0x7E0)
+            {
+                sentAt = now;
+            }
+        });
+    }
+    EXPECT_GE(sentAt, CanIO::TX_AGING_TIME_ms);
+    EXPECT_LE(sentAt, CanIO::TX_AGING_TIME_ms + 1);
+}
+
+TEST_F(CanIOTest, trafficStatistics)
+{
+    uint32_t now = 0;
+    EXPECT_CALL(halMock, GetTick).WillRepeatedly([&now]() { return now; });
+
+    // counted by the ISR, no need to dispatch them
+    static constexpr uint8_t data[8] = {};
+    fake::can::receiveFrame(CAN_RX_FIFO0, makeHeader(0x182), data);
+    fake::can::receiveFrame(CAN_RX_FIFO0, makeHeader(0x182), data);
+    fake::can::raiseRxInterrupt(CAN_RX_FIFO0);
+
+    for (int i = 0; i < 4; ++i)
+    {
+        Message m = makeTxMessage(0x201);
+        canio.canSend(&m);
+    }
+    canio.dispatch(CanIO::NOTIFY_ATTEMPT_TX);
+    now = 3;
+    transmitFrames(canio, 1, [](uint16_t, uint32_t) {});
+
+    CanTrafficSnapshot snapshot = canio.getTrafficSnapshot();
+    ASSERT_EQ(snapshot.cobIdCount, 2);
+    EXPECT_EQ(snapshot.cobIds[0].cobId, 0x182);
+    EXPECT_EQ(snapshot.cobIds[0].rxFrames, 2);
+    EXPECT_EQ(snapshot.cobIds[1].cobId, 0x201);
+    EXPECT_EQ(snapshot.cobIds[1].txFrames, 1);
+    EXPECT_EQ(snapshot.cobIds[1].maxTxResidency_ms, 3);
+    // the fourth frame had to wait
+    EXPECT_EQ(snapshot.totals.mailboxFullEvents, 1);
+
+    // 3 frames in the first window
+    now = CanTrafficStats::LoadWindow_ms;
+    snapshot = canio.getTrafficSnapshot();
+    EXPECT_EQ(snapshot.totals.busLoad_permille,
+              (3 * canFrameBitsWorstCase(8) * 1000) / (CanIO::CAN_BITRATE / 1000 * now));
+
+    canio.resetTrafficStatistics();
+    snapshot = canio.getTrafficSnapshot();
+    EXPECT_EQ(snapshot.cobIds[0].rxFrames, 0);
+    EXPECT_EQ(snapshot.cobIds[1].txFrames, 0);
+    EXPECT_EQ(snapshot.totals.mailboxFullEvents, 0);
+}
+
+TEST_F(CanIOTest, txTimedAgainstSync)
+{
+    static constexpr uint32_t Cycles_us = HAL::CyclesPerMicrosecond;
+    static constexpr uint32_t Period_us = Canopen::SyncPeriod_ms * 1000;
+    uint32_t cycles = 0;
+    EXPECT_CALL(halMock, GetCycleCount).WillRepeatedly([&cycles]() { return cycles; });
+
+    auto send = [this](std::initializer_list<uint16_t> cobIds) {
+        for (uint16_t cobId : cobIds)
+        {
+            Message m = makeTxMessage(cobId);
+            canio.canSend(&m);
+        }
+        canio.dispatch(CanIO::NOTIFY_ATTEMPT_TX);
+    };
+    // completes the next frame at us
+    auto completeAt = [this, &cycles](uint32_t us) {
+        cycles = us * Cycles_us;
+        transmitFrames(canio, 1, [](uint16_t, uint32_t) {});
+    };
+    auto counters = [this](uint16_t cobId) {
+        const CanTrafficSnapshot snapshot = canio.getTrafficSnapshot();
+        const auto end = snapshot.cobIds.begin() + snapshot.cobIdCount;
+        const auto found =
+            std::find_if(snapshot.cobIds.begin(), end,
+                         [cobId](const CanCobIdCounters &c) { return c.cobId == cobId; });
+        return found != end ? *found : CanCobIdCounters();
+    };
+
+    // nothing to time against yet
+    send({0x220});
+    completeAt(500);
+    EXPECT_EQ(counters(0x220).syncFrames, 0);
+
+    // two periods of our own SYNC followed by the PDOs
+    uint32_t sync_us = 1000;
+    send({Canopen::SyncCobId, 0x210, 0x220});
+    completeAt(sync_us);
+    completeAt(sync_us + 250);
+    completeAt(sync_us + 500);
+    sync_us += Period_us;
+    send({Canopen::SyncCobId, 0x210, 0x220});
+    completeAt(sync_us);
+    completeAt(sync_us + 100);
+    completeAt(sync_us + 700);
+
+    CanCobIdCounters pdo = counters(0x210);
+    EXPECT_EQ(pdo.syncFrames, 2);
+    EXPECT_EQ(pdo.minSyncOffset_us, 100);
+    EXPECT_EQ(pdo.maxSyncOffset_us, 250);
+    pdo = counters(0x220);
+    EXPECT_EQ(pdo.syncFrames, 2);
+    EXPECT_EQ(pdo.minSyncOffset_us, 500);
+    EXPECT_EQ(pdo.maxSyncOffset_us, 700);
+    EXPECT_EQ(counters(Canopen::SyncCobId).syncFrames, 0);
+
+    // a SYNC period later it isn't related to that SYNC anymore
+    send({0x220});
+    completeAt(sync_us + Period_us);
+    EXPECT_EQ(counters(0x220).syncFrames, 2);
+
+    // SYNC of another node, timed from its RX interrupt
+    static constexpr uint8_t data[8] = {};
+    sync_us += 2 * Period_us;
+    cycles = sync_us * Cycles_us;
+    fake::can::receiveFrame(CAN_RX_FIFO0, makeHeader(Canopen::SyncCobId), data);
+    fake::can::raiseRxInterrupt(CAN_RX_FIFO0);
+    send({0x210});
+    completeAt(sync_us + 40);
+    pdo = counters(0x210);
+    EXPECT_EQ(pdo.syncFrames, 3);
+    EXPECT_EQ(pdo.minSyncOffset_us, 40);
+    std::cout << "[  REPORT  ] 0x210 after SYNC " << pdo.minSyncOffset_us << " - "
+              << pdo.maxSyncOffset_us << " us, jitter "
+              << pdo.maxSyncOffset_us - pdo.minSyncOffset_us << " us\n";
+
+    canio.resetTrafficStatistics();
+    EXPECT_EQ(counters(0x210).syncFrames, 0);
+    EXPECT_EQ(counters(0x210).minSyncOffset_us, 0);
+}
+
+namespace
+{
+/**
+ * @brief 500 kbit/s, 8 byte frames with stuff bits take about 250us
+ *
+ */
+constexpr uint32_t FramesPerMs = 4;
+constexpr uint32_t FrameTime_us = 1000 / FramesPerMs;
+constexpr uint32_t LoadDuration_ms = 10000;
+
+/**
+ * @brief Traffic of a busy node: 4 actuator PDOs every 20ms and the heartbeat, with an
+ * SDO transfer of 8 segments every 50ms and a burst of 6 diagnostic frames every 20ms
+ * queued right before the PDOs
+ *
+ */
+void generateTxLoad(uint32_t now, const std::function<void(uint16_t cobId)> &send)
+{
+    if (now % 50 == 49)
+    {
+        for (int i = 0; i < 8; ++i)
+        {
+            send(0x620);
+        }
+    }
+    if (now % 20 == 19)
+    {
+        for (int i = 0; i < 6; ++i)
+        {
+            send(0x7E0);
+        }
+    }
+    if (now % 100 == 0)
+    {
+        send(0x701);
+    }
+    if (now % 20 == 0)
+    {
+        for (uint16_t cobId : {0x200, 0x210, 0x220, 0x230})
+        {
+            send(cobId);
+        }
+    }
+}
+
+struct TxDelay
+{
+    uint32_t frames{0};
+    uint64_t sum_us{0};
+    uint32_t max_us{0};
+
+    void add(uint32_t delay_us)
+    {
+        frames++;
+        sum_us += delay_us;
+        max_us = std::max(max_us, delay_us);
+    }
+};
+using TxDelays = std::map<uint16_t, TxDelay>;
+
+/**
+ * @brief Queueing delay from canSend until the frame is on the bus, per COB-ID
+ *
+ */
+TxDelays measureCanIO(CanIO &canio, uint32_t &now)
+{
+    TxDelays delays;
+    std::vector<uint32_t> queuedAt_us;
+    uint32_t bus_us = 0;
+    auto send = [&canio, &queuedAt_us, &bus_us](uint16_t cobId) {
+        Message m = makeTxMessage(cobId, queuedAt_us.size());
+        queuedAt_us.push_back(bus_us);
+        canio.canSend(&m);
+    };
+    auto sent = [&delays, &queuedAt_us, &bus_us](uint16_t cobId, uint32_t tag) {
+        delays[cobId].add(bus_us - queuedAt_us.at(tag));
+    };
+
+    for (; now < LoadDuration_ms; ++now)
+    {
+        // new frames show up while one is on the bus, that one can't be aborted anymore
+        fake::can::startTransmission();
+        generateTxLoad(now, send);
+        canio.dispatch(CanIO::NOTIFY_ATTEMPT_TX);
+        // woken again by the abort interrupts
+        canio.dispatch(CanIO::NOTIFY_ATTEMPT_TX);
+        for (uint32_t i = 0; i < FramesPerMs; ++i, bus_us += FrameTime_us)
+        {
+            transmitFrames(canio, 1, sent);
+        }
+    }
+    return delays;
+}
+
+/**
+ * @brief The same with a single FIFO, like the TX path before the priority queue
+ *
+ */
+TxDelays measureFifo()
+{
+    TxDelays delays;
+    std::deque<std::pair<uint16_t, uint32_t>> fifo;
+    uint32_t bus_us = 0;
+    for (uint32_t now = 0; now < LoadDuration_ms; ++now)
+    {
+        generateTxLoad(now, [&fifo, &bus_us](uint16_t cobId) { fifo.emplace_back(cobId, bus_us); });
+        for (uint32_t i = 0; i < FramesPerMs && !fifo.empty(); ++i, bus_us += FrameTime_us)
+        {
+            delays[fifo.front().first].add(bus_us - fifo.front().second);
+            fifo.pop_front();
+        }
+        bus_us = (now + 1) * 1000;
+    }
+    return delays;
+}
+} // namespace
+
+TEST_F(CanIOTest, benchmark_TxQueueingDelay)
+{
+    uint32_t now = 0;
+    EXPECT_CALL(halMock, GetTick).WillRepeatedly([&now]() { return now; });
+
+    const TxDelays priority = measureCanIO(canio, now);
+    const TxDelays fifo = measureFifo();
+
+    ASSERT_EQ(priority.size(), fifo.size());
+    for (const auto &[cobId, delay] : priority)
+    {
+        const TxDelay &reference = fifo.at(cobId);
+        std::cout << "[ BENCHMARK] CanIO TX delay COB-ID 0x" << std::hex << cobId << std::dec
+                  << ": priority avg " << delay.sum_us / delay.frames << " us max "
+                  << delay.max_us << " us, fifo avg " << reference.sum_us / reference.frames
+                  << " us max " << reference.max_us << " us\n";
+        // nothing dropped
+        EXPECT_EQ(delay.frames, reference.frames);
+        if (cobId < 0x300)
+        {
+            // actuator PDOs only wait for the frame on the bus and each other
+            EXPECT_LE(delay.max_us, FramesPerMs * FrameTime_us);
+            EXPECT_LT(delay.max_us, reference.max_us);
+        }
+        EXPECT_LT(delay.max_us, CanIO::TX_AGING_TIME_ms * 1000);
+    }
+}
@@ -0,0 +1,157 @@
+#include "PeripheralDrivers/CanTrafficStats.hpp"
+#include "gtest/gtest.h"
+
+using namespace remote_control_device;
+
+namespace
+{
+constexpr uint32_t BitRate = 500000;
+}
+
+TEST(CanTrafficStatsTest, frameBitsWorstCase)
+{
+    // 8 byte frame: 111 bits unstuffed, up to 24 stuff bits
+    EXPECT_EQ(canFrameBitsWorstCase(8), 135);
+    EXPECT_EQ(canFrameBitsWorstCase(0), 55);
+}
+
+TEST(CanTrafficStatsTest, countPerCobId)
+{
+    CanTrafficStats stats(BitRate);
+    stats.countRx(0x182, 8);
+    stats.countRx(0x182, 8);
+    stats.countRx(0x710, 1);
+    stats.countTx(0x201, 8, 2);
+    stats.countTx(0x201, 8, 6);
+    stats.countTx(0x182, 8, 1);
+
+    const CanTrafficSnapshot snapshot = stats.getSnapshot();
+    ASSERT_EQ(snapshot.cobIdCount, 3);
+    EXPECT_EQ(snapshot.cobIds[0].cobId, 0x182);
+    EXPECT_EQ(snapshot.cobIds[0].rxFrames, 2);
+    EXPECT_EQ(snapshot.cobIds[0].txFrames, 1);
+    EXPECT_EQ(snapshot.cobIds[1].cobId, 0x201);
+    EXPECT_EQ(snapshot.cobIds[1].rxFrames, 0);
+    EXPECT_EQ(snapshot.cobIds[1].txFrames, 2);
+    EXPECT_EQ(snapshot.cobIds[1].totalTxResidency_ms, 8);
+    EXPECT_EQ(snapshot.cobIds[1].maxTxResidency_ms, 6);
+    EXPECT_EQ(snapshot.cobIds[2].cobId, 0x710);
+    EXPECT_EQ(snapshot.cobIds[2].rxFrames, 1);
+    EXPECT_EQ(snapshot.totals.untrackedFrames, 0);
+}
+
+TEST(CanTrafficStatsTest, tableFull)
+{
+    CanTrafficStats stats(BitRate);
+    // colliding hashes on purpose
+    for (uint16_t i = 0; i < CanTrafficSnapshot::MaxCobIds; ++i)
+    {
+        stats.countRx(i * CanTrafficSnapshot::MaxCobIds, 0);
+    }
+    stats.countRx(0x7FF, 0);
+    stats.countTx(0x7FE, 0, 0);
+    stats.countRx(0, 0);
+
+    const CanTrafficSnapshot snapshot = stats.getSnapshot();
+    EXPECT_EQ(snapshot.cobIdCount, CanTrafficSnapshot::MaxCobIds);
+    EXPECT_EQ(snapshot.cobIds[0].rxFrames, 2);
+    EXPECT_EQ(snapshot.totals.untrackedFrames, 2);
+}
+
+TEST(CanTrafficStatsTest, busLoad)
+{
+    CanTrafficStats stats(BitRate);
+    // 1000 8 byte frames in a second, 27% of 500 kbit/s
+    for (uint32_t now = 0; now < 1000; ++now)
+    {
+        stats.updateBusLoad(now);
+        stats.countRx(0x182, 8);
+    }
+    stats.updateBusLoad(1000);
+    EXPECT_EQ(stats.getTotals().busLoad_permille, 270);
+    EXPECT_EQ(stats.getTotals().peakBusLoad_permille, 270);
+
+    // window not complete yet, the last one stays
+    for (int i = 0; i < 500; ++i)
+    {
+        stats.countTx(0x201, 8, 0);
+    }
+    stats.updateBusLoad(1000 + CanTrafficStats::LoadWindow_ms - 1);
+    EXPECT_EQ(stats.getTotals().busLoad_permille, 270);
+    stats.updateBusLoad(1000 + CanTrafficStats::LoadWindow_ms);
+    EXPECT_EQ(stats.getTotals().busLoad_permille, 540);
+
+    // idle bus
+    stats.updateBusLoad(1000 + 2 * CanTrafficStats::LoadWindow_ms);
+    EXPECT_EQ(stats.getTotals().busLoad_permille, 0);
+    EXPECT_EQ(stats.getTotals().peakBusLoad_permille, 540);
+}
+
+TEST(CanTrafficStatsTest, syncOffsets)
+{
+    CanTrafficStats stats(BitRate);
+    stats.countTx(0x210, 2, 0);
+    stats.countSyncOffset(0x210, 300);
+    stats.countTx(0x210, 2, 0);
+    stats.countSyncOffset(0x210, 120);
+    stats.countTx(0x220, 2, 0);
+
+    CanCobIdCounters counters;
+    uint8_t slot = 0;
+    for (; slot < CanTrafficSnapshot::MaxCobIds; ++slot)
+    {
+        if (stats.getCobIdCounters(slot, counters) && counters.cobId == 0x210)
+        {
+            break;
+        }
+    }
+    ASSERT_LT(slot, CanTrafficSnapshot::MaxCobIds);
+    EXPECT_EQ(counters.syncFrames, 2);
+    EXPECT_EQ(counters.minSyncOffset_us, 120);
+    EXPECT_EQ(counters.maxSyncOffset_us, 300);
+
+    // never timed
+    const CanTrafficSnapshot snapshot = stats.getSnapshot();
+    EXPECT_EQ(snapshot.cobIds[1].cobId, 0x220);
+    EXPECT_EQ(snapshot.cobIds[1].syncFrames, 0);
+    EXPECT_EQ(snapshot.cobIds[1].minSyncOffset_us, 0);
+}
+
+TEST(CanTrafficStatsTest, reset)
+{
+    CanTrafficStats stats(BitRate);
+    stats.countRx(0x182, 8);
+    stats.countTx(0x201, 8, 10);
+    stats.countRxDropped();
+    stats.countTxDropped();
+    stats.countMailboxFull();
+    for (int i = 0; i < 500; ++i)
+    {
+        stats.countRx(0x182, 8);
+    }
+    stats.updateBusLoad(CanTrafficStats::LoadWindow_ms);
+    stats.updateBusLoad(2 * CanTrafficStats::LoadWindow_ms);
+
+    CanTrafficSnapshot snapshot = stats.getSnapshot();
+    EXPECT_EQ(snapshot.totals.rxDropped, 1);
+    EXPECT_EQ(snapshot.totals.txDropped, 1);
+    EXPECT_EQ(snapshot.totals.mailboxFullEvents, 1);
+    EXPECT_GT(snapshot.totals.peakBusLoad_permille, 0);
+
+    stats.reset();
+    snapshot = stats.getSnapshot();
+    // seen COB-IDs keep their slots
+    ASSERT_EQ(snapshot.cobIdCount, 2);
+    for (uint8_t i = 0; i < snapshot.cobIdCount; ++i)
+    {
+        EXPECT_EQ(snapshot.cobIds[i].rxFrames, 0);
+        EXPECT_EQ(snapshot.cobIds[i].txFrames, 0);
+        EXPECT_EQ(snapshot.cobIds[i].totalTxResidency_ms, 0);
+        EXPECT_EQ(snapshot.cobIds[i].maxTxResidency_ms, 0);
+    }
+    EXPECT_EQ(snapshot.totals.rxDropped, 0);
+    EXPECT_EQ(snapshot.totals.txDropped, 0);
+    EXPECT_EQ(snapshot.totals.mailboxFullEvents, 0);
+    EXPECT_EQ(snapshot.totals.peakBusLoad_permille, snapshot.totals.busLoad_permille);
+    EXPECT_EQ(stats.getRxDropped(), 0);
+}
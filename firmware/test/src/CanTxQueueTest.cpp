@@ -0,0 +1,97 @@
+#include "PeripheralDrivers/CanTxQueue.hpp"
+#include "gtest/gtest.h"
+#include <vector>
+
+using namespace remote_control_device;
+
+namespace
+{
+constexpr uint32_t AgingTime = 50;
+
+Message makeMessage(uint16_t cobId, uint8_t tag = 0)
+{
+    Message m = Message_Initializer;
+    m.cob_id = cobId;
+    m.len = 1;
+    m.data[0] = tag;
+    return m;
+}
+
+template <size_t Capacity>
+std::vector<uint16_t> drain(CanTxQueue<Capacity> &queue, uint32_t now)
+{
+    std::vector<uint16_t> ids;
+    CanTxEntry entry;
+    while (queue.pop(entry, now))
+    {
+        ids.push_back(entry.msg.cob_id);
+    }
+    return ids;
+}
+} // namespace
+
+TEST(CanTxQueueTest, lowestCobIdFirst)
+{
+    CanTxQueue<8> queue(AgingTime);
+    for (uint16_t cobId : {0x701, 0x620, 0x210, 0x181, 0x230, 0x200})
+    {
+        EXPECT_TRUE(queue.push(makeMessage(cobId), 0));
+    }
+    EXPECT_EQ(queue.size(), 6);
+
+    CanTxEntry next;
+    ASSERT_TRUE(queue.peek(next, 0));
+    EXPECT_EQ(next.msg.cob_id, 0x181);
+    EXPECT_EQ(drain(queue, 0), std::vector<uint16_t>({0x181, 0x200, 0x210, 0x230, 0x620, 0x701}));
+    EXPECT_FALSE(queue.peek(next, 0));
+}
+
+TEST(CanTxQueueTest, sameCobIdKeepsOrder)
+{
+    // e.g. SDO segments
+    CanTxQueue<8> queue(AgingTime);
+    queue.push(makeMessage(0x620, 0), 0);
+    queue.push(makeMessage(0x701, 0), 0);
+    queue.push(makeMessage(0x620, 1), 0);
+    queue.push(makeMessage(0x620, 2), 0);
+
+    CanTxEntry first;
+    ASSERT_TRUE(queue.pop(first, 0));
+    // aborted frame goes back to where it was
+    EXPECT_TRUE(queue.requeue(first, 0));
+
+    for (uint8_t tag = 0; tag < 3; ++tag)
+    {
+        CanTxEntry entry;
+        ASSERT_TRUE(queue.pop(entry, 0));
+        EXPECT_EQ(entry.msg.cob_id, 0x620);
+        EXPECT_EQ(entry.msg.data[0], tag);
+    }
+}
+
+TEST(CanTxQueueTest, agedFramesFirst)
+{
+    CanTxQueue<8> queue(AgingTime);
+    queue.push(makeMessage(0x7E0), 0);
+    queue.push(makeMessage(0x701), 10);
+    queue.push(makeMessage(0x200), AgingTime - 1);
+
+    CanTxEntry next;
+    ASSERT_TRUE(queue.peek(next, AgingTime - 1));
+    EXPECT_EQ(next.msg.cob_id, 0x200);
+    // the first two are aged now, oldest first no matter the COB-ID
+    EXPECT_EQ(drain(queue, AgingTime + 10), std::vector<uint16_t>({0x7E0, 0x701, 0x200}));
+}
+
+TEST(CanTxQueueTest, fullQueueDropsLowestPriority)
+{
+    CanTxQueue<3> queue(AgingTime);
+    queue.push(makeMessage(0x300), 0);
+    queue.push(makeMessage(0x700), 0);
+    queue.push(makeMessage(0x200), 0);
+
+    EXPECT_FALSE(queue.push(makeMessage(0x100), 0));
+    EXPECT_FALSE(queue.push(makeMessage(0x7FF), 0));
+    EXPECT_EQ(queue.size(), 3);
+    EXPECT_EQ(drain(queue, 0), std::vector<uint16_t>({0x100, 0x200, 0x300}));
+}
@@ -0,0 +1,41 @@
+#include "CanopenTestFixture.hpp"
+#include "fake/CanHardware.hpp"
+#include <PeripheralDrivers/CanFilter.hpp>
+
+TEST_F(CanopenTest, acceptanceFilterFromObjectDictionary)
+{
+    using BusDevices = Canopen::BusDevices;
+    uint8_t idCount = 0;
+    fake::can::resetFilters();
+    EXPECT_CALL(canIO, configureAcceptanceFilters)
+        .WillOnce([&](const CanFilter &filter) -> void {
+            idCount = filter.getIdCount();
+            // program the banks through the can stub
+            canIO.CanIO::configureAcceptanceFilters(filter);
+        });
+    Canopen co(canIO, log);
+
+    std::vector<uint16_t> required = {NMT_CobId, 0x80, Canopen::RPDO1_RTD_State};
+    for (BusDevices dev : co.getMonitoredDevices())
+    {
+        required.push_back(NMTErrorControl_BaseCobId + static_cast<uint16_t>(dev));
+    }
+    for (BusDevices dev : {BusDevices::BrakeActuator, BusDevices::SteeringActuator})
+    {
+        required.push_back(SDO_Response_BaseCobId + static_cast<uint16_t>(dev));
+    }
+    EXPECT_EQ(idCount, required.size());
+    EXPECT_GT(fake::can::getActiveBanks(), 0);
+    EXPECT_LE(fake::can::getActiveBanks(), CanFilter::BankCount);
+
+    // own transmissions, other nodes' pdos / sdos / heartbeats and remote frames are dropped
+    size_t accepted = 0;
+    for (uint16_t id = 0; id <= 0x7FF; ++id)
+    {
+        const bool isRequired = std::find(required.begin(), required.end(), id) != required.end();
+        EXPECT_EQ(fake::can::acceptsFrame(id), isRequired) << "COB-ID " << std::hex << id;
+        EXPECT_FALSE(fake::can::acceptsFrame(id, true)) << "RTR COB-ID " << std::hex << id;
+        accepted += fake::can::acceptsFrame(id) ? 1 : 0;
+    }
+    EXPECT_EQ(accepted, required.size());
+}
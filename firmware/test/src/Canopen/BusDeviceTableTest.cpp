@@ -0,0 +1,71 @@
+#include "CanopenTestFixture.hpp"
+#include <Statemachine/BusDeviceTable.hpp>
+
+TEST(BusDeviceTableTest, nodeSlotsMatchDeviceLists)
+{
+    for (uint8_t i = 0; i < bus_devices::MonitoredCount; ++i)
+    {
+        EXPECT_EQ(bus_devices::getNodeSlots(bus_devices::Monitored[i]).monitored, i);
+    }
+    for (uint8_t i = 0; i < bus_devices::StateControlledCount; ++i)
+    {
+        EXPECT_EQ(bus_devices::getNodeSlots(bus_devices::StateControlled[i]).stateControlled, i);
+    }
+    for (uint8_t i = 0; i < bus_devices::CouplingCount; ++i)
+    {
+        EXPECT_EQ(bus_devices::getNodeSlots(bus_devices::Couplings[i]).coupling, i);
+    }
+
+    // every other node id has no record at all
+    size_t described = 0;
+    for (const bus_devices::NodeSlots &slots : bus_devices::NodeTable)
+    {
+        if (slots.description != bus_devices::NoSlot)
+        {
+            described++;
+        }
+        else
+        {
+            EXPECT_EQ(slots.monitored, bus_devices::NoSlot);
+            EXPECT_EQ(slots.stateControlled, bus_devices::NoSlot);
+            EXPECT_EQ(slots.coupling, bus_devices::NoSlot);
+        }
+    }
+    EXPECT_EQ(described, bus_devices::Devices.size());
+
+    for (auto device : {BusDevices::NO_DEVICE, static_cast<BusDevices>(0x80),
+                        static_cast<BusDevices>(0x7F)})
+    {
+        EXPECT_EQ(bus_devices::getNodeSlots(device).description, bus_devices::NoSlot);
+    }
+}
+
+TEST_F(CanopenTest, deviceTableDrivesCanopen)
+{
+    EXPECT_CALL(canIO, canSend).Times(AnyNumber());
+    EXPECT_CALL(halMock, GetTick).WillRepeatedly(Return(1));
+    MockRepository mocks;
+    mocks.OnCallFunc(Canopen::testHook_signalRTDRecovery);
+    Canopen co(canIO, log);
+
+    EXPECT_EQ(co.getMonitoredDevices(), bus_devices::Monitored);
+    EXPECT_EQ(co.getStateControlledDevices(), bus_devices::StateControlled);
+
+    // heartbeat consumers written into the OD
+    CFLocker locker;
+    CO_Data *d = locker.getOD();
+    ASSERT_EQ(*d->ConsumerHeartbeatCount, bus_devices::MonitoredCount);
+    for (uint8_t i = 0; i < bus_devices::MonitoredCount; ++i)
+    {
+        EXPECT_EQ(d->ConsumerHeartbeatEntries[i] >> 16, // NOLINT
+                  static_cast<uint8_t>(bus_devices::Monitored[i]));
+        EXPECT_EQ(d->ConsumerHeartbeatEntries[i] & 0xFFFF, // NOLINT
+                  bus_devices::getDescription(bus_devices::Monitored[i]).heartbeatTimeout_ms);
+    }
+
+    // unlisted devices are never online, monitored ones start disconnected until their first
+    // heartbeat
+    EXPECT_FALSE(co.isDeviceOnline(BusDevices::WheelSpeedSensor));
+    EXPECT_FALSE(co.isDeviceOnline(BusDevices::NO_DEVICE));
+    EXPECT_FALSE(co.isDeviceOnline(BusDevices::BrakeActuator));
+}
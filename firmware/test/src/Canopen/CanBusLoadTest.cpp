@@ -0,0 +1,121 @@
+#include "CanopenTestFixture.hpp"
+#include <Statemachine/CanBusLoad.hpp>
+#include <iomanip>
+
+namespace
+{
+const bus_load::PeriodicFrame *findFrame(uint16_t cobId)
+{
+    for (const auto &frame : bus_load::PeriodicFrames)
+    {
+        if (frame.cobId == cobId)
+        {
+            return &frame;
+        }
+    }
+    return nullptr;
+}
+
+template <typename T>
+T readOD(CO_Data *d, UNS16 offset, UNS8 subIndex)
+{
+    return *static_cast<const T *>(d->objdict[offset].pSubindex[subIndex].pObject); // NOLINT
+}
+} // namespace
+
+TEST(CanBusLoadTest, frameRates)
+{
+    // 8 byte frame every 20ms, 135 bits
+    EXPECT_EQ(bus_load::bitsPerSecond({"", 0x200, 8, 20}), 6750);
+    // rounded up
+    EXPECT_EQ(bus_load::bitsPerSecond({"", 0x182, 1, 150}), 434);
+    EXPECT_EQ(bus_load::load_permille(CanIO::CAN_BITRATE / 2), 500);
+    EXPECT_EQ(bus_load::load_permille(1), 1);
+}
+
+TEST(CanBusLoadTest, report)
+{
+    for (const auto &frame : bus_load::PeriodicFrames)
+    {
+        std::cout << "[  REPORT  ] " << std::left << std::setw(32) << frame.name << std::right
+                  << " 0x" << std::hex << std::setw(3) << std::setfill('0') << frame.cobId
+                  << std::dec << std::setfill(' ') << ", " << static_cast<int>(frame.length)
+                  << " bytes every " << std::setw(3) << frame.period_ms << " ms: " << std::setw(5)
+                  << bus_load::bitsPerSecond(frame) << " bit/s\n";
+    }
+    std::cout << "[  REPORT  ] Periodic CAN load " << bus_load::totalBitsPerSecond()
+              << " bit/s, " << bus_load::PeriodicLoad_permille / 10.0 << "% of "
+              << CanIO::CAN_BITRATE / 1000 << " kbit/s, ceiling "
+              << bus_load::Ceiling_permille / 10.0 << "%\n";
+    EXPECT_LE(bus_load::PeriodicLoad_permille, bus_load::Ceiling_permille);
+}
+
+TEST_F(CanopenTest, busLoadModelMatchesObjectDictionary)
+{
+    static constexpr UNS8 CobIdSubIndex = 1;
+    static constexpr UNS8 EventTimerSubIndex = 5;
+    static constexpr UNS32 CobIdMask = 0x7FF;
+    static constexpr UNS32 MappingLengthMask = 0xFF;
+
+    Canopen co(canIO, log);
+    CFLocker locker;
+    CO_Data *d = locker.getOD();
+    size_t modeled = 0;
+
+    auto checkPDOs = [&](UNS16 first, UNS16 last, UNS16 firstMap, bool transmit) {
+        for (UNS16 i = 0; first != 0 && first + i <= last; ++i)
+        {
+            const UNS32 cobId = readOD<UNS32>(d, first + i, CobIdSubIndex) & CobIdMask;
+            const bus_load::PeriodicFrame *frame = findFrame(cobId);
+            ASSERT_NE(frame, nullptr) << "PDO COB-ID " << std::hex << cobId;
+
+            uint16_t mappedBits = 0;
+            const UNS8 mappings = readOD<UNS8>(d, firstMap + i, 0);
+            for (UNS8 sub = 1; sub <= mappings; ++sub)
+            {
+                mappedBits += readOD<UNS32>(d, firstMap + i, sub) & MappingLengthMask;
+            }
+            EXPECT_EQ(frame->length * 8, mappedBits) << frame->name;
+            const UNS16 eventTimer = readOD<UNS16>(d, first + i, EventTimerSubIndex);
+            if (transmit)
+            {
+                const TPDOPolicy &policy = Canopen::DefaultTPDOPolicies.at(i);
+                EXPECT_EQ(eventTimer, policy.period_ms) << frame->name;
+                EXPECT_EQ(frame->period_ms, policy.worstCasePeriod_ms()) << frame->name;
+            }
+            else
+            {
+                EXPECT_EQ(frame->period_ms, eventTimer) << frame->name;
+            }
+            modeled++;
+        }
+    };
+    checkPDOs(d->firstIndex->PDO_TRS, d->lastIndex->PDO_TRS, d->firstIndex->PDO_TRS_MAP, true);
+    checkPDOs(d->firstIndex->PDO_RCV, d->lastIndex->PDO_RCV, d->firstIndex->PDO_RCV_MAP, false);
+
+    const bus_load::PeriodicFrame *own =
+        findFrame(bus_load::heartbeatCobId(Canopen::BusDevices::RemoteControlDevice));
+    ASSERT_NE(own, nullptr);
+    EXPECT_EQ(own->period_ms, *d->ProducerHeartBeatTime);
+    modeled++;
+
+    // whoever produces it, the actuator PDOs follow it
+    const bus_load::PeriodicFrame *sync = findFrame(Canopen::SyncCobId);
+    ASSERT_NE(sync, nullptr);
+    EXPECT_EQ(sync->period_ms, Canopen::ActuatorPDOEventTime_ms);
+    modeled++;
+
+    for (UNS8 i = 0; i < *d->ConsumerHeartbeatCount; ++i)
+    {
+        const UNS8 nodeId = (d->ConsumerHeartbeatEntries[i] >> 16) & 0x7F; // NOLINT
+        const UNS16 timeout = d->ConsumerHeartbeatEntries[i] & 0xFFFF;     // NOLINT
+        const bus_load::PeriodicFrame *frame =
+            findFrame(bus_load::heartbeatCobId(static_cast<Canopen::BusDevices>(nodeId)));
+        ASSERT_NE(frame, nullptr) << "Heartbeat of node " << static_cast<int>(nodeId);
+        EXPECT_LT(frame->period_ms, timeout) << frame->name;
+        modeled++;
+    }
+
+    // nothing in the model that isn't configured anymore
+    EXPECT_EQ(modeled, bus_load::PeriodicFrames.size());
+}
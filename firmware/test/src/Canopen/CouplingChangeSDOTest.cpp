@@ -100,12 +100,12 @@ TEST_F(CanopenTest, integrationCouplingChange)
         state++;
     }
 
-    // test sdo timeout and retransmission after
+    // test sdo timeout and retransmission after a growing backoff
     co.setCouplingStates(brakeState, steeringState);
     assertSDORequest(msgs, brakeState, steeringState);
-    for (int i = 0; i < 100; ++i)
+    uint32_t backoff = SdoClientQueue::RetryBackoffBase_ms;
+    for (int i = 0; i < 10; ++i)
     {
-        // some delay that is lower than timeout
         for (int j = 0; j < (SDO_TIMEOUT_MS / 10); ++j)
         {
             time += 10;
@@ -113,10 +113,27 @@ TEST_F(CanopenTest, integrationCouplingChange)
             cft.dispatch();
         }
         expectSelfState_Hearbeat(msgs, NMTErrorControl_Heartbeat_Operational, StateId::Start, -1);
-
         assertSDOAbortTransfer(msgs);
+        ASSERT_TRUE(msgs.empty());
+
+        // quiet until the backoff is over
+        for (uint32_t j = 0; j < backoff / 10; ++j)
+        {
+            ASSERT_TRUE(msgs.empty());
+            time += 10;
+            EXPECT_CALL(halMock, GetTick).WillRepeatedly(Return(time));
+            cft.dispatch();
+            // heartbeats and self state
+            msgs.erase(std::remove_if(msgs.begin(), msgs.end(),
+                                      [](const Message &m) -> bool {
+                                          return m.cob_id < SDO_Request_BaseCobId ||
+                                                 m.cob_id >= NMTErrorControl_BaseCobId;
+                                      }),
+                       msgs.end());
+        }
         assertSDORequest(msgs, brakeState, steeringState);
         ASSERT_TRUE(msgs.empty());
+        backoff = std::min(backoff * 2, SdoClientQueue::RetryBackoffMax_ms);
     }
 
     std::cout << "finished SDOs timeout test\n";
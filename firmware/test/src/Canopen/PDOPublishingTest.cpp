@@ -1,4 +1,5 @@
 #include "CanopenTestFixture.hpp"
+#include <algorithm>
 
 /**
  * @brief Tests if actuator pdos have been published the correct amount of time and with the
@@ -144,4 +145,251 @@ void checkActuatorPDOValues(std::vector<Message> &msgs, float value, int count)
     CanopenTest::ExpectFrameContent(targetMsg, NOT_A_REQUEST, 8,
                        {rawDataWheel[0], rawDataWheel[1], rawDataBr[0], rawDataBr[1],
                         rawDataSteer[0], rawDataSteer[1], rawDataSteer[2], rawDataSteer[3]});
-}
\ No newline at end of file
+}
+TEST_F(CanopenTest, actuatorPDOsPhaseShifted)
+{
+    uint32_t time = 1;
+    std::vector<std::pair<uint16_t, uint32_t>> sent;
+    EXPECT_CALL(canIO, canSend).WillRepeatedly([&](Message *m) -> void {
+        sent.emplace_back(m->cob_id, time);
+    });
+    EXPECT_CALL(halMock, GetTick).WillRepeatedly(Return(time));
+    MockRepository mocks;
+    mocks.OnCallFunc(Canopen::testHook_signalRTDRecovery);
+    Canopen co(canIO, log);
+
+    co.setActuatorPDOs(true);
+
+    // the first burst is sent from within setActuatorPDOs, only look at the event timers
+    sent.clear();
+    // ten periods plus the largest phase offset
+    for (int i = 0; i < Canopen::ActuatorPDOEventTime_ms * 11; ++i)
+    {
+        time += 1;
+        EXPECT_CALL(halMock, GetTick).WillRepeatedly(Return(time));
+        cft.dispatch();
+    }
+
+    const std::array<uint16_t, 4> actuatorCobIds = {
+        Canopen::TPDO2_BrakeCobId, Canopen::TPDO3_SteeringCobId, Canopen::TPDO4_WheelTorqueCobId,
+        Canopen::TPDO5_TargetValues};
+    std::vector<uint32_t> phases;
+    for (const auto cobId : actuatorCobIds)
+    {
+        std::vector<uint32_t> times;
+        for (const auto &s : sent)
+        {
+            if (s.first == cobId)
+            {
+                times.push_back(s.second);
+            }
+        }
+
+        // no drift, every pdo keeps its own slot within the period
+        ASSERT_EQ(times.size(), 10);
+        for (size_t i = 1; i < times.size(); ++i)
+        {
+            EXPECT_EQ(times[i] - times[i - 1], Canopen::ActuatorPDOEventTime_ms);
+        }
+        phases.push_back(times.front() % Canopen::ActuatorPDOEventTime_ms);
+    }
+
+    std::sort(phases.begin(), phases.end());
+    EXPECT_EQ(std::adjacent_find(phases.begin(), phases.end()), phases.end());
+}
+
+namespace
+{
+using SentFrames = std::vector<std::pair<Message, uint32_t>>;
+
+constexpr std::array<uint16_t, 4> ActuatorCobIds = {
+    Canopen::TPDO2_BrakeCobId, Canopen::TPDO3_SteeringCobId, Canopen::TPDO4_WheelTorqueCobId,
+    Canopen::TPDO5_TargetValues};
+
+bool isActuatorPDO(const Message &m)
+{
+    return std::find(ActuatorCobIds.begin(), ActuatorCobIds.end(), m.cob_id) !=
+           ActuatorCobIds.end();
+}
+
+size_t countActuatorPDOs(const SentFrames &sent)
+{
+    return std::count_if(sent.begin(), sent.end(), [](const std::pair<Message, uint32_t> &s) {
+        return isActuatorPDO(s.first);
+    });
+}
+
+/**
+ * @brief Checks that sent holds every actuator PDO once from first on, all sent at time
+ *
+ */
+void expectActuatorPDOsAt(const SentFrames &sent, size_t first, uint32_t time)
+{
+    ASSERT_GE(sent.size(), first + ActuatorCobIds.size());
+    std::vector<uint16_t> cobIds;
+    for (size_t i = first; i < first + ActuatorCobIds.size(); ++i)
+    {
+        EXPECT_EQ(sent[i].second, time);
+        cobIds.push_back(sent[i].first.cob_id);
+    }
+    std::sort(cobIds.begin(), cobIds.end());
+    std::vector<uint16_t> expected(ActuatorCobIds.begin(), ActuatorCobIds.end());
+    std::sort(expected.begin(), expected.end());
+    EXPECT_EQ(cobIds, expected);
+}
+} // namespace
+
+TEST_F(CanopenTest, actuatorPDOsAfterOwnSync)
+{
+    static constexpr uint32_t Periods = 10;
+    static constexpr float Target = 0.5f;
+    uint32_t time = 1;
+    SentFrames sent;
+    EXPECT_CALL(canIO, canSend).WillRepeatedly([&](Message *m) -> void {
+        sent.emplace_back(*m, time);
+    });
+    EXPECT_CALL(halMock, GetTick).WillRepeatedly([&time]() -> uint32_t { return time; });
+    MockRepository mocks;
+    mocks.OnCallFunc(Canopen::testHook_signalRTDRecovery);
+    Canopen co(canIO, log);
+
+    co.setActuatorPDOSchedule(Canopen::PDOSchedule::SyncProducer);
+    co.setActuatorPDOs(true);
+    // enabling still sends them once
+    EXPECT_EQ(countActuatorPDOs(sent), ActuatorCobIds.size());
+    sent.clear();
+
+    for (uint32_t i = 1; i <= Canopen::SyncPeriod_ms * Periods; ++i)
+    {
+        time += 1;
+        cft.dispatch();
+        if (i == Canopen::SyncPeriod_ms * (Periods / 2) + 1)
+        {
+            // not sent right away, they wait for the next SYNC
+            co.setActuatorSetpoints({Target, Target, Target}, true);
+        }
+    }
+
+    std::vector<uint32_t> syncs;
+    for (size_t i = 0; i < sent.size(); ++i)
+    {
+        if (sent[i].first.cob_id == Canopen::SyncCobId)
+        {
+            EXPECT_EQ(sent[i].first.len, 0);
+            syncs.push_back(sent[i].second);
+            expectActuatorPDOsAt(sent, i + 1, sent[i].second);
+        }
+    }
+    ASSERT_EQ(syncs.size(), Periods);
+    for (size_t i = 1; i < syncs.size(); ++i)
+    {
+        EXPECT_EQ(syncs[i] - syncs[i - 1], Canopen::SyncPeriod_ms);
+    }
+    // none on their own event timers
+    EXPECT_EQ(countActuatorPDOs(sent), ActuatorCobIds.size() * Periods);
+
+    // the SYNC after the transaction carries all of its values
+    std::vector<Message> targetValues;
+    for (const auto &s : sent)
+    {
+        if (s.first.cob_id == Canopen::TPDO5_TargetValues)
+        {
+            targetValues.push_back(s.first);
+        }
+    }
+    ASSERT_EQ(targetValues.size(), Periods);
+    EXPECT_EQ(WheelTargetTorque,
+              (Canopen::mapValue<float, int32_t>(-1.0f, 1.0f, Canopen::WheelDriveTorqueRaw_Min,
+                                                 Canopen::WheelDriveTorqueRaw_Max, Target)));
+    auto *rawWheel = reinterpret_cast<UNS8 *>(&WheelTargetTorque);
+    auto *rawBrake = reinterpret_cast<UNS8 *>(&BrakeTargetForce);
+    auto *rawSteering = reinterpret_cast<UNS8 *>(&SteeringTargetAngle);
+    for (uint32_t i = Periods / 2; i < Periods; ++i)
+    {
+        CanopenTest::ExpectFrameContent(targetValues[i], NOT_A_REQUEST, 8,
+                                        {rawWheel[0], rawWheel[1], rawBrake[0], rawBrake[1],
+                                         rawSteering[0], rawSteering[1], rawSteering[2],
+                                         rawSteering[3]});
+    }
+    EXPECT_NE(std::memcmp(targetValues[Periods / 2 - 1].data, targetValues[Periods / 2].data, 8),
+              0);
+
+    /**
+     * back on the event timers
+     */
+    co.setActuatorPDOSchedule(Canopen::PDOSchedule::Event);
+    sent.clear();
+    for (uint32_t i = 0; i < Canopen::ActuatorPDOEventTime_ms * (Periods + 1); ++i)
+    {
+        time += 1;
+        cft.dispatch();
+    }
+    for (const auto &s : sent)
+    {
+        EXPECT_NE(s.first.cob_id, Canopen::SyncCobId);
+    }
+    for (const auto cobId : ActuatorCobIds)
+    {
+        std::vector<uint32_t> times;
+        for (const auto &s : sent)
+        {
+            if (s.first.cob_id == cobId)
+            {
+                times.push_back(s.second);
+            }
+        }
+        ASSERT_EQ(times.size(), Periods);
+        for (size_t i = 1; i < times.size(); ++i)
+        {
+            EXPECT_EQ(times[i] - times[i - 1], Canopen::ActuatorPDOEventTime_ms);
+        }
+    }
+}
+
+TEST_F(CanopenTest, actuatorPDOsAfterForeignSync)
+{
+    uint32_t time = 1;
+    SentFrames sent;
+    EXPECT_CALL(canIO, canSend).WillRepeatedly([&](Message *m) -> void {
+        sent.emplace_back(*m, time);
+    });
+    EXPECT_CALL(halMock, GetTick).WillRepeatedly([&time]() -> uint32_t { return time; });
+    MockRepository mocks;
+    mocks.OnCallFunc(Canopen::testHook_signalRTDRecovery);
+    Canopen co(canIO, log);
+
+    co.setActuatorPDOSchedule(Canopen::PDOSchedule::SyncConsumer);
+    co.setActuatorPDOs(true);
+    sent.clear();
+
+    auto advance = [&](uint32_t ms) {
+        for (uint32_t i = 0; i < ms; ++i)
+        {
+            time += 1;
+            cft.dispatch();
+        }
+    };
+
+    // neither a SYNC of our own nor PDOs without one
+    advance(Canopen::ActuatorPDOEventTime_ms * 5);
+    for (const auto &s : sent)
+    {
+        EXPECT_NE(s.first.cob_id, Canopen::SyncCobId);
+    }
+    EXPECT_EQ(countActuatorPDOs(sent), 0);
+
+    // the RTD's SYNC, whenever it comes
+    for (uint32_t gap : {7, 23, 1, 40})
+    {
+        advance(gap);
+        sent.clear();
+        Message sync = Message_Initializer;
+        sync.cob_id = Canopen::SyncCobId;
+        {
+            CFLocker locker;
+            canDispatch(locker.getOD(), &sync);
+        }
+        EXPECT_EQ(sent.size(), ActuatorCobIds.size());
+        expectActuatorPDOsAt(sent, 0, time);
+    }
+}
@@ -0,0 +1,262 @@
+#include "CouplingChangeSDOTest.hpp"
+#include <CanFestival/SdoClientQueue.hpp>
+#include <algorithm>
+#include <iterator>
+
+namespace
+{
+// the only nodes the OD has SDO clients for
+constexpr uint8_t Brake = static_cast<uint8_t>(Canopen::BusDevices::BrakeActuator);
+constexpr uint8_t Steering = static_cast<uint8_t>(Canopen::BusDevices::SteeringActuator);
+constexpr uint16_t ObjectA = 0x60FE;
+constexpr uint16_t ObjectB = 0x6040;
+
+struct ReceivedRequest
+{
+    uint32_t time;
+    uint8_t nodeId;
+    uint16_t odIndex;
+    uint32_t value;
+};
+
+/**
+ * @brief Expedited download server for the actuators. Takes the SDO frames out of the sent
+ * ones and answers them after ResponseTime_ms unless the node is dead
+ *
+ */
+class SimulatedSdoServer
+{
+public:
+    static constexpr uint32_t ResponseTime_ms = 20;
+
+    std::array<bool, 128> dead{};
+    std::vector<ReceivedRequest> requests;
+    uint32_t aborts{0};
+
+    void receive(std::vector<Message> &msgs, uint32_t now)
+    {
+        auto isSdo = [](const Message &m) -> bool {
+            return m.cob_id == CanopenTest::SDO_Request_BaseCobId + Brake ||
+                   m.cob_id == CanopenTest::SDO_Request_BaseCobId + Steering;
+        };
+        for (const Message &m : msgs)
+        {
+            if (!isSdo(m))
+            {
+                continue;
+            }
+            const auto nodeId =
+                static_cast<uint8_t>(m.cob_id - CanopenTest::SDO_Request_BaseCobId);
+            SDORequestFlagByte fb;
+            fb.raw = m.data[0];
+            if (fb.flags.clientCommandSpecifier != INITIATE_DOWNLOAD_REQUEST)
+            {
+                aborts++;
+                continue;
+            }
+            const uint16_t odIndex = m.data[1] | (m.data[2] << 8);
+            uint32_t value = 0;
+            std::memcpy(&value, &m.data[4], sizeof(value));
+            requests.push_back({now, nodeId, odIndex, value});
+            if (!dead[nodeId])
+            {
+                const auto device = static_cast<Canopen::BusDevices>(nodeId);
+                _responses.push_back(
+                    {now + ResponseTime_ms, constructSDOResponse(odIndex, m.data[3], device)});
+            }
+        }
+        msgs.erase(std::remove_if(msgs.begin(), msgs.end(), isSdo), msgs.end());
+    }
+
+    void respond(uint32_t now)
+    {
+        CFLocker locker;
+        while (!_responses.empty() && _responses.front().first <= now)
+        {
+            // copy, dispatching may queue the next response
+            Message response = _responses.front().second;
+            _responses.erase(_responses.begin());
+            canDispatch(locker.getOD(), &response);
+        }
+    }
+
+    std::vector<ReceivedRequest> requestsTo(uint8_t nodeId) const
+    {
+        std::vector<ReceivedRequest> to;
+        std::copy_if(requests.begin(), requests.end(), std::back_inserter(to),
+                     [nodeId](const ReceivedRequest &r) -> bool { return r.nodeId == nodeId; });
+        return to;
+    }
+
+private:
+    std::vector<std::pair<uint32_t, Message>> _responses;
+};
+
+class SdoClientQueueTest : public CanopenTest
+{
+protected:
+    void SetUp() override
+    {
+        CanopenTest::SetUp();
+        EXPECT_CALL(canIO, canSend).WillRepeatedly([this](Message *m) -> void {
+            msgs.emplace_back(*m);
+        });
+        EXPECT_CALL(halMock, GetTick).WillRepeatedly([this]() -> uint32_t { return time; });
+    }
+
+    bool write(uint8_t nodeId, uint16_t odIndex, uint32_t value)
+    {
+        CFLocker locker;
+        const bool queued = SdoClientQueue::write(locker.getOD(), {nodeId, odIndex, 0x1, value});
+        server.receive(msgs, time);
+        return queued;
+    }
+
+    uint8_t getPending(uint8_t nodeId)
+    {
+        CFLocker locker;
+        return SdoClientQueue::getPending(nodeId);
+    }
+
+    void advance(uint32_t ms)
+    {
+        for (uint32_t i = 0; i < ms; ++i)
+        {
+            time++;
+            cft.dispatch();
+            server.receive(msgs, time);
+            server.respond(time);
+            server.receive(msgs, time);
+        }
+    }
+
+    uint32_t time{1};
+    std::vector<Message> msgs;
+    SimulatedSdoServer server;
+};
+
+uint32_t backoff_ms(uint8_t timeouts)
+{
+    uint32_t backoff = SdoClientQueue::RetryBackoffBase_ms;
+    for (uint8_t i = 1; i < timeouts; ++i)
+    {
+        backoff = std::min(backoff * 2, SdoClientQueue::RetryBackoffMax_ms);
+    }
+    return backoff;
+}
+} // namespace
+
+TEST_F(SdoClientQueueTest, fifoPerNodeConcurrentAcrossNodes)
+{
+    Canopen co(canIO, log);
+    SdoClientQueue::resetStatistics();
+
+    ASSERT_TRUE(write(Brake, ObjectA, 1));
+    ASSERT_TRUE(write(Brake, ObjectB, 2));
+    ASSERT_TRUE(write(Steering, ObjectA, 3));
+
+    // one transfer per node, both nodes at once
+    ASSERT_EQ(server.requests.size(), 2);
+    EXPECT_EQ(server.requestsTo(Brake).at(0).value, 1);
+    EXPECT_EQ(server.requestsTo(Steering).at(0).value, 3);
+    EXPECT_EQ(getPending(Brake), 2);
+
+    // second brake request right after the first confirmation
+    advance(SimulatedSdoServer::ResponseTime_ms * 3);
+    const auto brake = server.requestsTo(Brake);
+    ASSERT_EQ(brake.size(), 2);
+    EXPECT_EQ(brake[1].odIndex, ObjectB);
+    EXPECT_EQ(brake[1].value, 2);
+    EXPECT_EQ(brake[1].time - brake[0].time, SimulatedSdoServer::ResponseTime_ms);
+    EXPECT_EQ(getPending(Brake), 0);
+    EXPECT_EQ(getPending(Steering), 0);
+
+    const SdoClientQueue::Statistics stats = SdoClientQueue::getStatistics();
+    EXPECT_EQ(stats.completed, 3);
+    EXPECT_EQ(stats.timeouts, 0);
+    EXPECT_EQ(stats.maxLatency_ms, SimulatedSdoServer::ResponseTime_ms * 2);
+    EXPECT_EQ(stats.totalLatency_ms, SimulatedSdoServer::ResponseTime_ms * 4);
+    std::cout << "[  REPORT  ] SDO latency max " << stats.maxLatency_ms << " ms, avg "
+              << stats.totalLatency_ms / stats.completed << " ms\n";
+}
+
+TEST_F(SdoClientQueueTest, coalescesSupersededWrites)
+{
+    Canopen co(canIO, log);
+    SdoClientQueue::resetStatistics();
+
+    // 1 goes out, 2 gets replaced by 3, the second 3 is the same as the waiting one
+    ASSERT_TRUE(write(Brake, ObjectA, 1));
+    ASSERT_TRUE(write(Brake, ObjectA, 2));
+    ASSERT_TRUE(write(Brake, ObjectA, 3));
+    ASSERT_TRUE(write(Brake, ObjectA, 3));
+    EXPECT_EQ(getPending(Brake), 2);
+
+    advance(SimulatedSdoServer::ResponseTime_ms * 3);
+    auto brake = server.requestsTo(Brake);
+    ASSERT_EQ(brake.size(), 2);
+    EXPECT_EQ(brake[0].value, 1);
+    EXPECT_EQ(brake[1].value, 3);
+
+    // equal to the one in flight, nothing to do
+    ASSERT_TRUE(write(Brake, ObjectA, 4));
+    ASSERT_TRUE(write(Brake, ObjectA, 4));
+    advance(SimulatedSdoServer::ResponseTime_ms * 2);
+    EXPECT_EQ(server.requestsTo(Brake).size(), 3);
+    EXPECT_EQ(SdoClientQueue::getStatistics().coalesced, 3);
+
+    // queue full, the rest gets dropped
+    server.dead[Brake] = true;
+    for (uint16_t i = 0; i < SdoClientQueue::QueueDepth; ++i)
+    {
+        ASSERT_TRUE(write(Brake, ObjectB + i, i));
+    }
+    EXPECT_FALSE(write(Brake, ObjectA, 5));
+    EXPECT_EQ(SdoClientQueue::getStatistics().dropped, 1);
+}
+
+TEST_F(SdoClientQueueTest, backoffOnTimeout)
+{
+    static constexpr uint8_t Timeouts = 8;
+    Canopen co(canIO, log);
+    SdoClientQueue::resetStatistics();
+
+    server.dead[Brake] = true;
+    ASSERT_TRUE(write(Brake, ObjectA, 1));
+
+    uint32_t duration = 0;
+    for (uint8_t i = 1; i <= Timeouts; ++i)
+    {
+        duration += SDO_TIMEOUT_MS + backoff_ms(i);
+    }
+    advance(duration);
+
+    // the dead node doesn't hold up the other one
+    ASSERT_TRUE(write(Steering, ObjectA, 2));
+    advance(SimulatedSdoServer::ResponseTime_ms);
+    EXPECT_EQ(SdoClientQueue::getStatistics().lastLatency_ms, SimulatedSdoServer::ResponseTime_ms);
+
+    const auto brake = server.requestsTo(Brake);
+    ASSERT_EQ(brake.size(), Timeouts + 1);
+    for (uint8_t i = 1; i <= Timeouts; ++i)
+    {
+        EXPECT_EQ(brake[i].time - brake[i - 1].time, SDO_TIMEOUT_MS + backoff_ms(i))
+            << "after timeout " << static_cast<int>(i);
+    }
+    EXPECT_EQ(server.aborts, Timeouts);
+    EXPECT_EQ(SdoClientQueue::getStatistics().timeouts, Timeouts);
+
+    // node is back, retry right away instead of waiting for the backoff
+    advance(SDO_TIMEOUT_MS);
+    server.dead[Brake] = false;
+    {
+        CFLocker locker;
+        SdoClientQueue::nodeOnline(locker.getOD(), Brake);
+    }
+    server.receive(msgs, time);
+    ASSERT_EQ(server.requestsTo(Brake).size(), Timeouts + 2);
+    EXPECT_EQ(server.requestsTo(Brake).back().time, time);
+    advance(SimulatedSdoServer::ResponseTime_ms);
+    EXPECT_EQ(getPending(Brake), 0);
+    EXPECT_EQ(SdoClientQueue::getStatistics().completed, 2);
+}
@@ -0,0 +1,271 @@
+#include "CanopenTestFixture.hpp"
+#include <FreeRTOS.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <task.h>
+#include <tuple>
+
+namespace
+{
+using RawTriple = std::tuple<INTEGER16, INTEGER16, INTEGER32>;
+
+/**
+ * @brief Raw values of TPDO5 (wheel torque, brake force, steering angle)
+ *
+ */
+RawTriple decodeTargetValues(const Message &msg)
+{
+    INTEGER16 wheel = 0;
+    INTEGER16 brake = 0;
+    INTEGER32 steering = 0;
+    std::memcpy(&wheel, &msg.data[0], sizeof(wheel));
+    std::memcpy(&brake, &msg.data[2], sizeof(brake));
+    std::memcpy(&steering, &msg.data[4], sizeof(steering));
+    return {wheel, brake, steering};
+}
+
+RawTriple expectedTriple(float value)
+{
+    return {Canopen::mapValue<float, INTEGER16>(-1.0f, 1.0f, Canopen::WheelDriveTorqueRaw_Min,
+                                                Canopen::WheelDriveTorqueRaw_Max, value),
+            Canopen::mapValue<float, INTEGER16>(0.0f, 1.0f, Canopen::BrakeForceRaw_Min,
+                                                Canopen::BrakeForceRaw_Max, value),
+            Canopen::mapValue<float, INTEGER32>(-1.0f, 1.0f, Canopen::SteeringAngleRaw_Min,
+                                                Canopen::SteeringAngleRaw_Max, -value)};
+}
+} // namespace
+
+TEST_F(CanopenTest, setpointTransactionPublishNow)
+{
+    uint32_t time = 1;
+    std::vector<Message> msgs;
+    EXPECT_CALL(canIO, canSend).WillRepeatedly([&](Message *m) -> void { msgs.emplace_back(*m); });
+    EXPECT_CALL(halMock, GetTick).WillRepeatedly(Return(time));
+    MockRepository mocks;
+    mocks.OnCallFunc(Canopen::testHook_signalRTDRecovery);
+    Canopen co(canIO, log);
+
+    // nothing to publish while the actuator pdos are off
+    msgs.clear();
+    co.setActuatorSetpoints({0.5f, 0.5f, 0.5f}, true);
+    EXPECT_TRUE(msgs.empty());
+
+    co.setActuatorPDOs(true);
+    msgs.clear();
+    co.setActuatorSetpoints({0.25f, 0.25f, 0.25f}, true);
+
+    // sent right away, without a single timer dispatch
+    Message targetMsg = Message_Initializer;
+    EXPECT_EQ(extractFrame(msgs, Canopen::TPDO5_TargetValues, targetMsg), 1);
+    EXPECT_EQ(decodeTargetValues(targetMsg), expectedTriple(0.25f));
+    EXPECT_EQ(extractFrame(msgs, Canopen::TPDO2_BrakeCobId, targetMsg), 1);
+    EXPECT_EQ(extractFrame(msgs, Canopen::TPDO3_SteeringCobId, targetMsg), 1);
+    EXPECT_EQ(extractFrame(msgs, Canopen::TPDO4_WheelTorqueCobId, targetMsg), 1);
+    EXPECT_TRUE(msgs.empty());
+
+    // without publishNow the event timers take care of it
+    co.setActuatorSetpoints({0.75f, 0.75f, 0.75f}, false);
+    EXPECT_TRUE(msgs.empty());
+    for (int i = 0; i < Canopen::ActuatorPDOEventTime_ms * 2; ++i)
+    {
+        time += 1;
+        EXPECT_CALL(halMock, GetTick).WillRepeatedly(Return(time));
+        cft.dispatch();
+    }
+    ASSERT_GE(extractFrame(msgs, Canopen::TPDO5_TargetValues, targetMsg), 1);
+    EXPECT_EQ(decodeTargetValues(targetMsg), expectedTriple(0.75f));
+}
+
+TEST_F(CanopenTest, setpointTransactionCoherentUnderFastTimer)
+{
+#ifdef BUILDCONFIG_CANOPEN_ACTOR
+    GTEST_SKIP() << "Only the actor task touches the OD, nothing can interleave";
+#endif
+    static constexpr uint32_t Steps = 20;
+    static constexpr uint32_t TargetFrames = 100;
+    // fake ms per dispatch, the timer task runs every tick
+    static constexpr uint32_t TimePerDispatch_ms = 5;
+
+    std::vector<RawTriple> valid;
+    for (uint32_t k = 0; k <= Steps; ++k)
+    {
+        valid.push_back(expectedTriple(static_cast<float>(k) / Steps));
+    }
+
+    std::atomic<uint32_t> time{1};
+    std::vector<Message> msgs;
+    EXPECT_CALL(canIO, canSend).WillRepeatedly([&](Message *m) -> void { msgs.emplace_back(*m); });
+    EXPECT_CALL(halMock, GetTick).WillRepeatedly([&]() -> uint32_t { return time.load(); });
+    MockRepository mocks;
+    mocks.OnCallFunc(Canopen::testHook_signalRTDRecovery);
+    Canopen co(canIO, log);
+
+    co.setActuatorSetpoints({0.0f, 0.0f, 0.0f}, false);
+    co.setActuatorPDOs(true);
+    {
+        CFLocker locker;
+        msgs.clear();
+    }
+
+    struct Context
+    {
+        CanFestivalTimers &cft;
+        std::atomic<uint32_t> &time;
+        std::atomic<bool> stop;
+        std::atomic<bool> done;
+    } ctx{cft, time, false, false};
+
+    // preempts the test task at every tick, possibly right between two OD writes
+    xTaskCreate(
+        [](void *param) -> void {
+            auto &c = *reinterpret_cast<Context *>(param);
+            while (!c.stop)
+            {
+                c.time += TimePerDispatch_ms;
+                c.cft.dispatch();
+                vTaskDelay(1);
+            }
+            c.done = true;
+            vTaskDelete(nullptr);
+        },
+        "fastTimer", configMINIMAL_STACK_SIZE * 4, &ctx, uxTaskPriorityGet(nullptr) + 1, nullptr);
+
+    const uint32_t dispatchesNeeded =
+        TargetFrames * Canopen::ActuatorPDOEventTime_ms / TimePerDispatch_ms;
+    uint32_t k = 0;
+    while (time.load() < 1 + (dispatchesNeeded * TimePerDispatch_ms))
+    {
+        const float value = static_cast<float>(k) / Steps;
+        co.setActuatorSetpoints({value, value, value}, false);
+        k = (k + 1) % (Steps + 1);
+    }
+    ctx.stop = true;
+    while (!ctx.done)
+    {
+        vTaskDelay(1);
+    }
+
+    size_t frames = 0;
+    for (const Message &msg : msgs)
+    {
+        if (msg.cob_id != Canopen::TPDO5_TargetValues)
+        {
+            continue;
+        }
+        frames++;
+        EXPECT_NE(std::find(valid.begin(), valid.end(), decodeTargetValues(msg)), valid.end())
+            << "TPDO5 mixes values of two transactions";
+    }
+    EXPECT_GE(frames, TargetFrames - 1);
+}
+
+namespace
+{
+/**
+ * @brief A Statemachine task publishing setpoints every cycle while the test task runs the
+ * CanFestivalTimers task's loop. Through the CFLocker or, in actor mode, the CanopenActor
+ *
+ */
+struct SetpointBench
+{
+    static constexpr uint32_t Cycles = 50;
+
+    Canopen *co{nullptr};
+    std::atomic<bool> done{false};
+    // set before the call, cleared by the frame carrying the values
+    std::atomic<bool> pending{false};
+    RawTriple expected{};
+    std::chrono::steady_clock::time_point issuedAt{};
+
+    uint32_t frames{0};
+    double latencySum_us{0};
+    double latencyMax_us{0};
+    double callMax_us{0};
+};
+
+double elapsed_us(std::chrono::steady_clock::time_point since)
+{
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - since)
+        .count();
+}
+
+void setpointTask(void *param)
+{
+    auto &bench = *reinterpret_cast<SetpointBench *>(param);
+    TickType_t lastWake = xTaskGetTickCount();
+    for (uint32_t k = 0; k < SetpointBench::Cycles; ++k)
+    {
+        // a different frame every cycle
+        const float value = static_cast<float>(k % 21) / 20;
+        bench.expected = expectedTriple(value);
+        bench.issuedAt = std::chrono::steady_clock::now();
+        bench.pending = true;
+        bench.co->setActuatorSetpoints({value, value, value}, true);
+        bench.callMax_us = std::max(bench.callMax_us, elapsed_us(bench.issuedAt));
+        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(Statemachine::CyclePeriod_ms));
+    }
+    bench.done = true;
+    vTaskDelete(nullptr);
+}
+} // namespace
+
+TEST_F(CanopenTest, benchmark_SetpointToFrameLatency)
+{
+#ifdef BUILDCONFIG_CANOPEN_ACTOR
+    static constexpr const char *Mode = "actor";
+#else
+    static constexpr const char *Mode = "mutex";
+#endif
+    static constexpr UBaseType_t NormalPriority = tskIDLE_PRIORITY + 2;
+
+    SetpointBench bench;
+    EXPECT_CALL(canIO, canSend).WillRepeatedly([&bench](Message *m) -> void {
+        if (m->cob_id == Canopen::TPDO5_TargetValues && bench.pending &&
+            decodeTargetValues(*m) == bench.expected)
+        {
+            const double latency = elapsed_us(bench.issuedAt);
+            bench.pending = false;
+            bench.frames++;
+            bench.latencySum_us += latency;
+            bench.latencyMax_us = std::max(bench.latencyMax_us, latency);
+        }
+    });
+    EXPECT_CALL(halMock, GetTick).WillRepeatedly([]() -> uint32_t { return xTaskGetTickCount(); });
+    MockRepository mocks;
+    mocks.OnCallFunc(Canopen::testHook_signalRTDRecovery);
+    // constructed on the test task, which makes it the actor's task as well
+    Canopen co(canIO, log);
+    co.setActuatorPDOs(true);
+    bench.co = &co;
+
+    // same priority as on target: Application task and Statemachine both normal
+    const UBaseType_t testPriority = uxTaskPriorityGet(nullptr);
+    vTaskPrioritySet(nullptr, NormalPriority);
+    const uint32_t locksBefore = CFLocker::getAcquisitionCount();
+    xTaskCreate(&setpointTask, "statemachine", configMINIMAL_STACK_SIZE * 4, &bench,
+                NormalPriority, nullptr);
+    while (!bench.done)
+    {
+        cft.runOnce(1);
+    }
+    // whatever was posted last
+    cft.runOnce(0);
+    const uint32_t locks = CFLocker::getAcquisitionCount() - locksBefore;
+    vTaskPrioritySet(nullptr, testPriority);
+
+    std::cout << "[ BENCHMARK] " << Mode << ": setpoint call max " << bench.callMax_us
+              << " us, until TPDO5 is sent avg "
+              << bench.latencySum_us / std::max<uint32_t>(bench.frames, 1) << " us max "
+              << bench.latencyMax_us << " us, "
+              << static_cast<double>(locks) / SetpointBench::Cycles
+              << " CFLocker locks per cycle\n";
+
+    // every setpoint made it onto the bus
+    EXPECT_EQ(bench.frames, SetpointBench::Cycles);
+#ifdef BUILDCONFIG_CANOPEN_ACTOR
+    EXPECT_EQ(locks, 0);
+    // the actor is an equal priority task, it runs once the Statemachine waits for its next cycle
+    EXPECT_LT(bench.latencyMax_us, 1000.0 * Statemachine::CyclePeriod_ms);
+#endif
+}
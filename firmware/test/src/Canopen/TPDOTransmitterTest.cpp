@@ -0,0 +1,355 @@
+#include "CanopenTestFixture.hpp"
+#include <CanFestival/TPDOTransmitter.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <iomanip>
+#include <map>
+
+namespace
+{
+constexpr uint8_t TargetValues = static_cast<uint8_t>(Canopen::TPDOIndex::TargetValues);
+constexpr uint32_t CycleTime_ms = 20;
+
+constexpr std::array<uint16_t, 4> ActuatorCobIds = {
+    Canopen::TPDO2_BrakeCobId, Canopen::TPDO3_SteeringCobId, Canopen::TPDO4_WheelTorqueCobId,
+    Canopen::TPDO5_TargetValues};
+
+/**
+ * @brief Same policy for every TPDO
+ *
+ */
+Canopen::TPDOPolicies allTPDOs(const TPDOPolicy &policy)
+{
+    Canopen::TPDOPolicies policies;
+    policies.fill(policy);
+    return policies;
+}
+
+struct SessionPart
+{
+    const char *name;
+    uint32_t duration_ms;
+    Canopen::ActuatorSetpoints (*setpoints)(uint32_t t_ms);
+};
+
+/**
+ * @brief What the Statemachine wrote in a drive on the test stand: standing in Idle, driving in
+ * Manual with the sticks quantized to SBUS steps plus a step of jitter, sticks centered and an
+ * emergency stop
+ *
+ */
+class DrivingSession
+{
+public:
+    static constexpr float SBUSStep = 2.0f / 1639;
+
+    static float stick(float value, uint32_t t_ms)
+    {
+        // deterministic jitter of -1, 0 or +1 step
+        const int jitter = static_cast<int>(((t_ms * 2654435761U) >> 16) % 3) - 1;
+        return (std::round(value / SBUSStep) + static_cast<float>(jitter)) * SBUSStep;
+    }
+
+    static constexpr std::array<SessionPart, 5> Parts = {{
+        {"Idle", 5000,
+         [](uint32_t) -> Canopen::ActuatorSetpoints {
+             return {Canopen::NoWheelDriveTorque, 0.0f, 0.0f};
+         }},
+        {"Manual driving", 20000,
+         [](uint32_t t) -> Canopen::ActuatorSetpoints {
+             const float s = static_cast<float>(t) / 1000.0f;
+             const float throttle = std::min(s / 5.0f, 0.6f);
+             return {stick(throttle, t), 0.0f, stick(0.5f * std::sin(s * 1.5f), t + 1)};
+         }},
+        {"Manual standing", 5000,
+         [](uint32_t t) -> Canopen::ActuatorSetpoints {
+             return {stick(0.0f, t), 0.0f, stick(0.0f, t + 1)};
+         }},
+        {"Emergency", 3000,
+         [](uint32_t) -> Canopen::ActuatorSetpoints {
+             return {Canopen::NoWheelDriveTorque, Canopen::MaxBrakePressure, 0.0f};
+         }},
+        {"Idle", 5000,
+         [](uint32_t) -> Canopen::ActuatorSetpoints {
+             return {Canopen::NoWheelDriveTorque, 0.0f, 0.0f};
+         }},
+    }};
+};
+
+class TPDOTransmitterTest : public CanopenTest
+{
+protected:
+    void SetUp() override
+    {
+        CanopenTest::SetUp();
+        EXPECT_CALL(canIO, canSend).WillRepeatedly([this](Message *m) -> void {
+            sent.emplace_back(*m, time);
+        });
+        EXPECT_CALL(halMock, GetTick).WillRepeatedly([this]() -> uint32_t { return time; });
+        mocks.OnCallFunc(Canopen::testHook_signalRTDRecovery);
+    }
+
+    void advance(uint32_t ms)
+    {
+        for (uint32_t i = 0; i < ms; ++i)
+        {
+            time++;
+            cft.dispatch();
+        }
+    }
+
+    std::vector<uint32_t> timesOf(uint16_t cobId, uint32_t from = 0) const
+    {
+        std::vector<uint32_t> times;
+        for (const auto &s : sent)
+        {
+            if (s.first.cob_id == cobId && s.second >= from)
+            {
+                times.push_back(s.second);
+            }
+        }
+        return times;
+    }
+
+    uint32_t time{1};
+    std::vector<std::pair<Message, uint32_t>> sent;
+    MockRepository mocks;
+};
+} // namespace
+
+TEST_F(TPDOTransmitterTest, differsBeyondDeadband)
+{
+    Canopen co(canIO, log);
+    CFLocker locker;
+    CO_Data *d = locker.getOD();
+
+    // torque 16 bit, brake 16 bit, steering 32 bit
+    Message a = {Canopen::TPDO5_TargetValues, NOT_A_REQUEST, 8, {0xFE, 0xFF, 0, 0, 0, 0, 0, 0}};
+    Message b = a;
+    EXPECT_FALSE(TPDOTransmitter::differs(d, TargetValues, a, b, 0));
+
+    // -2 to 6 crosses zero, sign extended it is 8 counts
+    b.data[0] = 6;
+    b.data[1] = 0;
+    EXPECT_TRUE(TPDOTransmitter::differs(d, TargetValues, a, b, 7));
+    EXPECT_FALSE(TPDOTransmitter::differs(d, TargetValues, a, b, 8));
+
+    b = a;
+    b.data[6] = 1;
+    EXPECT_TRUE(TPDOTransmitter::differs(d, TargetValues, a, b, UINT16_MAX));
+
+    b = a;
+    b.cob_id = Canopen::TPDO2_BrakeCobId;
+    EXPECT_TRUE(TPDOTransmitter::differs(d, TargetValues, a, b, UINT16_MAX));
+}
+
+TEST_F(TPDOTransmitterTest, inhibitTimeAndKeepAlive)
+{
+    static constexpr TPDOPolicy Policy = {100, true, 0, 20};
+    Canopen co(canIO, log);
+    co.setTPDOPolicies(allTPDOs(Policy));
+    co.setActuatorPDOs(true);
+    advance(Policy.period_ms * 2);
+    TPDOTransmitter::resetStatistics();
+
+    // unchanged values only go out on the keep-alive
+    sent.clear();
+    advance(Policy.period_ms * 5);
+    for (const auto cobId : ActuatorCobIds)
+    {
+        EXPECT_EQ(timesOf(cobId).size(), 5) << std::hex << cobId;
+    }
+
+    // first change right away, the next one waits for the inhibit time and carries the latest
+    // value
+    sent.clear();
+    const uint32_t start = time;
+    co.setBrakeForce(0.2f);
+    advance(5);
+    co.setBrakeForce(0.3f);
+    advance(5);
+    co.setBrakeForce(0.4f);
+    advance(Policy.inhibit_ms);
+    const std::vector<uint32_t> brake = timesOf(Canopen::TPDO2_BrakeCobId);
+    ASSERT_EQ(brake.size(), 2);
+    EXPECT_EQ(brake[0], start);
+    EXPECT_EQ(brake[1], start + Policy.inhibit_ms);
+    const auto last = std::find_if(sent.rbegin(), sent.rend(), [](const auto &s) -> bool {
+        return s.first.cob_id == Canopen::TPDO2_BrakeCobId;
+    });
+    ASSERT_NE(last, sent.rend());
+    auto *rawBrake = reinterpret_cast<UNS8 *>(&BrakeTargetForce);
+    ExpectFrameContent(last->first, NOT_A_REQUEST, 2, {rawBrake[0], rawBrake[1]});
+
+    // the keep-alive restarts from the last transmission
+    sent.clear();
+    advance(Policy.period_ms);
+    EXPECT_EQ(timesOf(Canopen::TPDO2_BrakeCobId),
+              std::vector<uint32_t>{start + Policy.inhibit_ms + Policy.period_ms});
+
+    const TPDOTransmitter::Statistics stats = TPDOTransmitter::getStatistics();
+    // brake and target values each once right away, once after the inhibit time
+    EXPECT_EQ(stats.changeTriggered, 4);
+    EXPECT_EQ(stats.inhibited, 2);
+}
+
+namespace
+{
+/**
+ * @brief Statistics as the UI task sees them
+ *
+ */
+TPDOTransmitter::Statistics statisticsOnOtherTask()
+{
+    struct Context
+    {
+        TPDOTransmitter::Statistics statistics;
+        std::atomic<bool> done{false};
+    } ctx;
+    xTaskCreate(
+        [](void *param) -> void {
+            auto &c = *reinterpret_cast<Context *>(param);
+            c.statistics = TPDOTransmitter::getStatistics();
+            c.done = true;
+            vTaskDelete(nullptr);
+        },
+        "ui", configMINIMAL_STACK_SIZE * 4, &ctx, uxTaskPriorityGet(nullptr) + 1, nullptr);
+    while (!ctx.done)
+    {
+        vTaskDelay(1);
+    }
+    return ctx.statistics;
+}
+} // namespace
+
+TEST_F(TPDOTransmitterTest, statisticsOnOtherTasks)
+{
+    static constexpr TPDOPolicy Policy = {100, true, 0, 20};
+    Canopen co(canIO, log);
+    co.setTPDOPolicies(allTPDOs(Policy));
+    co.setActuatorPDOs(true);
+    advance(Policy.period_ms * 2);
+    TPDOTransmitter::resetStatistics();
+    co.setBrakeForce(0.2f);
+    const uint32_t changes = TPDOTransmitter::getStatistics().changeTriggered;
+    ASSERT_GT(changes, 0);
+
+#ifdef BUILDCONFIG_CANOPEN_ACTOR
+    // other tasks read what the actor published after its last commands, nothing so far
+    EXPECT_EQ(statisticsOnOtherTask().changeTriggered, 0);
+    cft.runOnce(0);
+#endif
+    EXPECT_EQ(statisticsOnOtherTask().changeTriggered, changes);
+}
+
+TEST_F(TPDOTransmitterTest, framesPerPolicyAcrossDrivingSession)
+{
+    struct NamedPolicy
+    {
+        const char *name;
+        TPDOPolicy policy;
+    };
+    static constexpr std::array<NamedPolicy, 3> Policies = {{
+        {"periodic", Canopen::PeriodicTPDOPolicies.at(TargetValues)},
+        {"on change", {Canopen::ActuatorKeepAlive_ms, true, 0, Canopen::ActuatorPDOEventTime_ms}},
+        {"on change, deadband", Canopen::OnChangeTPDOPolicies.at(TargetValues)},
+    }};
+
+    Canopen co(canIO, log);
+    co.setActuatorPDOs(true);
+
+    // actuator PDO frames per session part and policy
+    std::map<std::string, std::vector<size_t>> frames;
+    for (const NamedPolicy &named : Policies)
+    {
+        co.setTPDOPolicies(allTPDOs(named.policy));
+        advance(Canopen::ActuatorKeepAlive_ms);
+
+        std::vector<size_t> &counts = frames[named.name];
+        for (const SessionPart &part : DrivingSession::Parts)
+        {
+            sent.clear();
+            for (uint32_t t = 0; t < part.duration_ms; t += CycleTime_ms)
+            {
+                co.setActuatorSetpoints(part.setpoints(t), false);
+                advance(CycleTime_ms);
+            }
+
+            size_t count = 0;
+            for (const auto cobId : ActuatorCobIds)
+            {
+                const std::vector<uint32_t> times = timesOf(cobId);
+                count += times.size();
+                // the actuators' watchdogs stay fed
+                for (size_t i = 1; i < times.size(); ++i)
+                {
+                    EXPECT_LE(times[i] - times[i - 1], named.policy.period_ms)
+                        << named.name << ", " << part.name;
+                }
+            }
+            counts.push_back(count);
+
+            // nothing held back at the end of a part, the last frames carry what was written
+            CFLocker locker;
+            CO_Data *d = locker.getOD();
+            for (const auto index :
+                 {Canopen::TPDOIndex::BrakeForce, Canopen::TPDOIndex::SteeringAngle,
+                  Canopen::TPDOIndex::MotorTorque, Canopen::TPDOIndex::TargetValues})
+            {
+                const auto i = static_cast<uint8_t>(index);
+                Message current = Message_Initializer;
+                ASSERT_EQ(buildPDO(d, i, &current), 0);
+                EXPECT_FALSE(TPDOTransmitter::differs(d, i, d->PDO_status[i].last_message,
+                                                      current, named.policy.deadband))
+                    << named.name << ", " << part.name;
+            }
+        }
+    }
+
+    size_t total[Policies.size()] = {0};
+    for (size_t p = 0; p < DrivingSession::Parts.size(); ++p)
+    {
+        std::cout << "[  REPORT  ] " << std::left << std::setw(18)
+                  << DrivingSession::Parts[p].name << std::right;
+        for (size_t i = 0; i < Policies.size(); ++i)
+        {
+            const size_t count = frames[Policies[i].name][p];
+            total[i] += count;
+            std::cout << " " << Policies[i].name << ": " << std::setw(5) << count;
+        }
+        std::cout << " actuator PDOs\n";
+    }
+    std::cout << "[  REPORT  ] Session total     ";
+    for (size_t i = 0; i < Policies.size(); ++i)
+    {
+        std::cout << " " << Policies[i].name << ": " << std::setw(5) << total[i];
+    }
+    std::cout << " actuator PDOs\n";
+
+    const std::vector<size_t> &periodic = frames[Policies[0].name];
+    const std::vector<size_t> &onChange = frames[Policies[1].name];
+    const std::vector<size_t> &deadband = frames[Policies[2].name];
+    for (size_t p = 0; p < DrivingSession::Parts.size(); ++p)
+    {
+        const uint32_t duration = DrivingSession::Parts[p].duration_ms;
+        EXPECT_NEAR(periodic[p], ActuatorCobIds.size() * duration / CycleTime_ms,
+                    ActuatorCobIds.size());
+        EXPECT_LE(onChange[p], periodic[p]);
+        EXPECT_LE(deadband[p], onChange[p]);
+    }
+    // standing still only the keep-alive and the change when entering, on every policy but the
+    // periodic one
+    for (const size_t p : {size_t(0), size_t(3), size_t(4)})
+    {
+        const uint32_t keepAlives =
+            DrivingSession::Parts[p].duration_ms / Canopen::ActuatorKeepAlive_ms;
+        EXPECT_LE(onChange[p], ActuatorCobIds.size() * (keepAlives + 2));
+    }
+    // jitter of the centered sticks stays within the deadband
+    const uint32_t standing = DrivingSession::Parts[2].duration_ms / Canopen::ActuatorKeepAlive_ms;
+    EXPECT_GT(onChange[2], ActuatorCobIds.size() * (standing + 2));
+    EXPECT_LE(deadband[2], ActuatorCobIds.size() * (standing + 2));
+    // while driving the values change every cycle, the inhibit time keeps the periodic rate
+    EXPECT_LE(deadband[1], periodic[1]);
+}
@@ -0,0 +1,380 @@
+#include "CanFestival/CanFestivalLocker.hpp"
+#include "CanFestival/CanopenActor.hpp"
+#include "gtest/gtest.h"
+#include <FreeRTOS.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <task.h>
+#include <vector>
+
+using namespace remote_control_device;
+
+namespace
+{
+std::vector<CanopenCommand> executed;
+uint32_t publishCount = 0;
+
+void recordCommand(const CanopenCommand &command)
+{
+    executed.push_back(command);
+}
+
+void countPublish()
+{
+    publishCount++;
+}
+
+class CanopenActorTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        executed.clear();
+        publishCount = 0;
+    }
+};
+
+/**
+ * @brief Runs f in a task preempting the test task, returns once it finished
+ *
+ */
+template <typename F>
+void runInOtherTask(F f)
+{
+    struct Context
+    {
+        F f;
+        bool done;
+    } ctx{f, false};
+    xTaskCreate(
+        [](void *param) -> void {
+            auto &c = *reinterpret_cast<Context *>(param);
+            c.f();
+            c.done = true;
+            vTaskDelete(nullptr);
+        },
+        "other", configMINIMAL_STACK_SIZE * 4, &ctx, uxTaskPriorityGet(nullptr) + 1, nullptr);
+    while (!ctx.done)
+    {
+        vTaskDelay(1);
+    }
+}
+} // namespace
+
+TEST_F(CanopenActorTest, ownerContext)
+{
+    // no actor, everyone may lock the OD
+    EXPECT_TRUE(CanopenActor::isOwnerContext());
+    EXPECT_FALSE(CanopenActor::post({CanopenCommand::Type::RxFrames}));
+
+    CanopenActor actor;
+    EXPECT_TRUE(CanopenActor::isOwnerContext());
+    bool otherIsOwner = true;
+    runInOtherTask([&]() { otherIsOwner = CanopenActor::isOwnerContext(); });
+    EXPECT_FALSE(otherIsOwner);
+}
+
+TEST_F(CanopenActorTest, executesInPostingOrder)
+{
+    CanopenActor actor;
+    CanopenActor::setHandlers(&recordCommand, &countPublish);
+
+    runInOtherTask([]() {
+        EXPECT_TRUE(CanopenActor::post({CanopenCommand::Type::Setpoint, 1, 5000}));
+        EXPECT_TRUE(CanopenActor::post({CanopenCommand::Type::SelfState, 0, 3}));
+        EXPECT_TRUE(CanopenActor::post({CanopenCommand::Type::RxFrames}));
+    });
+
+    // nothing happens outside of the owner's process()
+    EXPECT_TRUE(executed.empty());
+    uint32_t notification = 0;
+    xTaskNotifyWait(0, 0, &notification, 0);
+    EXPECT_EQ(notification & CanopenActor::NOTIFY_COMMAND, CanopenActor::NOTIFY_COMMAND);
+
+    actor.process();
+    ASSERT_EQ(executed.size(), 3);
+    EXPECT_EQ(executed[0].type, CanopenCommand::Type::Setpoint);
+    EXPECT_EQ(executed[0].target, 1);
+    EXPECT_EQ(executed[0].value, 5000);
+    EXPECT_EQ(executed[1].type, CanopenCommand::Type::SelfState);
+    EXPECT_EQ(executed[1].value, 3);
+    EXPECT_EQ(executed[2].type, CanopenCommand::Type::RxFrames);
+    EXPECT_EQ(publishCount, 1);
+
+    // publishes after every run, commands or not
+    actor.process();
+    EXPECT_EQ(executed.size(), 3);
+    EXPECT_EQ(publishCount, 2);
+
+    const auto stats = actor.getStatistics();
+    EXPECT_EQ(stats.posted, 3);
+    EXPECT_EQ(stats.executed, 3);
+    EXPECT_EQ(stats.dropped, 0);
+    EXPECT_EQ(stats.maxQueued, 3);
+}
+
+TEST_F(CanopenActorTest, queueFull)
+{
+    CanopenActor actor;
+    CanopenActor::setHandlers(&recordCommand, nullptr);
+
+    for (int32_t i = 0; i < static_cast<int32_t>(CanopenActor::QueueSize); ++i)
+    {
+        EXPECT_TRUE(CanopenActor::post({CanopenCommand::Type::SelfState, 0, i}));
+    }
+    EXPECT_FALSE(CanopenActor::post({CanopenCommand::Type::SelfState, 0, -1}));
+    EXPECT_EQ(actor.getStatistics().dropped, 1);
+
+    actor.process();
+    ASSERT_EQ(executed.size(), CanopenActor::QueueSize);
+    EXPECT_EQ(executed.back().value, CanopenActor::QueueSize - 1);
+    EXPECT_TRUE(CanopenActor::post({CanopenCommand::Type::SelfState, 0, 0}));
+}
+
+namespace
+{
+/**
+ * @brief Same three tasks sharing the OD as on target, once with CFLocker and once with the
+ * CFT task as actor:
+ * - Statemachine (normal priority) does 8 OD accesses every cycle like the RemoteControl state
+ * - CanIO (high priority) hands received frames to canfestival every ms
+ * - CanFestivalTimers (normal priority) dispatches alarms every ms
+ *
+ */
+struct BenchContext
+{
+    static constexpr TickType_t CyclePeriod = 2;
+    static constexpr uint8_t AccessesPerCycle = 8;
+    static constexpr std::chrono::microseconds RxDispatchWork{30};
+    static constexpr std::chrono::microseconds AlarmWork{20};
+
+    bool useActor = false;
+    std::optional<CanopenActor> actor;
+    CanopenActor::Statistics actorStatistics;
+    std::atomic<bool> stopProducers{false};
+    std::atomic<bool> stopTimers{false};
+    std::atomic<uint8_t> finished{0};
+
+    // the "object dictionary"
+    std::array<int32_t, 3> setpoints{};
+    uint32_t rxBatches = 0;
+
+    // setpoint call until the value is in the OD
+    std::array<std::chrono::steady_clock::time_point, 256> issuedAt{};
+    uint32_t accesses = 0;
+    double latencySum_us = 0;
+    double latencyMax_us = 0;
+    int32_t lastIssued = -1;
+    uint8_t lastTarget = 0;
+    // time the high priority CanIO task spends in its canfestival call, minus the work itself
+    double canIOBlockedMax_us = 0;
+    std::atomic<bool> rxPending{false};
+};
+BenchContext *bench = nullptr;
+
+double elapsed_us(std::chrono::steady_clock::time_point since)
+{
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - since)
+        .count();
+}
+
+void work(std::chrono::microseconds duration)
+{
+    const auto end = std::chrono::steady_clock::now() + duration;
+    while (std::chrono::steady_clock::now() < end)
+    {
+    }
+}
+
+void applySetpoint(uint8_t target, int32_t value)
+{
+    bench->setpoints[target] = value;
+    const double latency = elapsed_us(bench->issuedAt[value % bench->issuedAt.size()]);
+    bench->accesses++;
+    bench->latencySum_us += latency;
+    bench->latencyMax_us = std::max(bench->latencyMax_us, latency);
+}
+
+void benchExecute(const CanopenCommand &command)
+{
+    if (command.type == CanopenCommand::Type::RxFrames)
+    {
+        bench->rxPending = false;
+        work(BenchContext::RxDispatchWork);
+        bench->rxBatches++;
+    }
+    else
+    {
+        applySetpoint(command.target, command.value);
+    }
+}
+
+void statemachineTask(void *)
+{
+    int32_t sequence = 0;
+    TickType_t lastWake = xTaskGetTickCount();
+    while (!bench->stopProducers)
+    {
+        for (uint8_t i = 0; i < BenchContext::AccessesPerCycle; ++i)
+        {
+            const uint8_t target = i % bench->setpoints.size();
+            bench->issuedAt[sequence % bench->issuedAt.size()] = std::chrono::steady_clock::now();
+            if (bench->useActor)
+            {
+                CanopenActor::post({CanopenCommand::Type::Setpoint, target, sequence});
+            }
+            else
+            {
+                CFLocker locker;
+                applySetpoint(target, sequence);
+            }
+            bench->lastIssued = sequence++;
+            bench->lastTarget = target;
+        }
+        vTaskDelayUntil(&lastWake, BenchContext::CyclePeriod);
+    }
+    bench->finished++;
+    vTaskDelete(nullptr);
+}
+
+void canIOTask(void *)
+{
+    while (!bench->stopProducers)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        double blocked = 0;
+        if (bench->useActor)
+        {
+            if (!bench->rxPending.exchange(true))
+            {
+                CanopenActor::post({CanopenCommand::Type::RxFrames});
+            }
+            blocked = elapsed_us(start);
+        }
+        else
+        {
+            CFLocker locker;
+            blocked = elapsed_us(start);
+            work(BenchContext::RxDispatchWork);
+            bench->rxBatches++;
+        }
+        bench->canIOBlockedMax_us = std::max(bench->canIOBlockedMax_us, blocked);
+        vTaskDelay(1);
+    }
+    bench->finished++;
+    vTaskDelete(nullptr);
+}
+
+void timersTask(void *)
+{
+    if (bench->useActor)
+    {
+        bench->actor.emplace();
+        CanopenActor::setHandlers(&benchExecute, nullptr);
+    }
+    while (!bench->stopTimers)
+    {
+        if (bench->useActor)
+        {
+            work(BenchContext::AlarmWork);
+            bench->actor->process();
+            xTaskNotifyWait(0, std::numeric_limits<uint32_t>::max(), nullptr, 1);
+        }
+        else
+        {
+            {
+                CFLocker locker;
+                work(BenchContext::AlarmWork);
+            }
+            vTaskDelay(1);
+        }
+    }
+    if (bench->useActor)
+    {
+        // whatever the others posted last
+        bench->actor->process();
+        bench->actorStatistics = bench->actor->getStatistics();
+        bench->actor.reset();
+    }
+    bench->finished++;
+    vTaskDelete(nullptr);
+}
+
+void runBenchmark(BenchContext &ctx)
+{
+    static constexpr TickType_t Duration = pdMS_TO_TICKS(400);
+    static constexpr UBaseType_t NormalPriority = tskIDLE_PRIORITY + 2;
+    bench = &ctx;
+
+    const UBaseType_t testPriority = uxTaskPriorityGet(nullptr);
+    vTaskPrioritySet(nullptr, NormalPriority + 2);
+
+    // actor has to exist before anyone posts
+    xTaskCreate(&timersTask, "timers", configMINIMAL_STACK_SIZE * 4, nullptr, NormalPriority,
+                nullptr);
+    vTaskDelay(1);
+    xTaskCreate(&statemachineTask, "statemachine", configMINIMAL_STACK_SIZE * 4, nullptr,
+                NormalPriority, nullptr);
+    xTaskCreate(&canIOTask, "canio", configMINIMAL_STACK_SIZE * 4, nullptr, NormalPriority + 1,
+                nullptr);
+
+    vTaskDelay(Duration);
+    ctx.stopProducers = true;
+    while (ctx.finished < 2)
+    {
+        vTaskDelay(1);
+    }
+    ctx.stopTimers = true;
+    while (ctx.finished < 3)
+    {
+        vTaskDelay(1);
+    }
+    vTaskPrioritySet(nullptr, testPriority);
+    bench = nullptr;
+}
+} // namespace
+
+TEST_F(CanopenActorTest, benchmark_MutexVsActor)
+{
+#ifdef BUILDCONFIG_CANOPEN_ACTOR
+    GTEST_SKIP() << "CFLocker has no mutex in actor mode";
+#endif
+    BenchContext mutex;
+    const uint32_t locksBefore = CFLocker::getAcquisitionCount();
+    runBenchmark(mutex);
+    const uint32_t mutexLocks = CFLocker::getAcquisitionCount() - locksBefore;
+
+    BenchContext actor;
+    actor.useActor = true;
+    const uint32_t locksBeforeActor = CFLocker::getAcquisitionCount();
+    runBenchmark(actor);
+    const uint32_t actorLocks = CFLocker::getAcquisitionCount() - locksBeforeActor;
+    const CanopenActor::Statistics &stats = actor.actorStatistics;
+
+    for (const BenchContext *ctx : {&mutex, &actor})
+    {
+        const uint32_t cycles = ctx->accesses / BenchContext::AccessesPerCycle;
+        const uint32_t locks = ctx->useActor ? actorLocks : mutexLocks;
+        std::cout << "[ BENCHMARK] " << (ctx->useActor ? "actor: " : "mutex: ") << locks
+                  << " locks (" << static_cast<double>(locks) / std::max<uint32_t>(cycles, 1)
+                  << " per Statemachine cycle), setpoint latency avg "
+                  << ctx->latencySum_us / std::max<uint32_t>(ctx->accesses, 1) << " us max "
+                  << ctx->latencyMax_us << " us, CanIO blocked max " << ctx->canIOBlockedMax_us
+                  << " us, " << ctx->rxBatches << " RX batches\n";
+    }
+    std::cout << "[ BENCHMARK] actor: " << stats.posted << " commands, max " << stats.maxQueued
+              << " queued, " << stats.dropped << " dropped\n";
+
+    EXPECT_GE(mutexLocks, mutex.accesses + mutex.rxBatches);
+    EXPECT_EQ(actorLocks, 0);
+    EXPECT_GT(actor.accesses, 0);
+    EXPECT_EQ(stats.dropped, 0);
+    EXPECT_EQ(stats.posted, stats.executed);
+    // everything issued made it into the OD, the last one last
+    EXPECT_EQ(actor.setpoints[actor.lastTarget], actor.lastIssued);
+}
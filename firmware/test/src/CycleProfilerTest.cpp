@@ -0,0 +1,83 @@
+#include "Statemachine/CycleProfiler.hpp"
+#include "Wrapper/HAL.hpp"
+#include "gtest/gtest.h"
+
+using namespace remote_control_device;
+
+namespace
+{
+constexpr uint32_t us(uint32_t value)
+{
+    return value * wrapper::HAL::CyclesPerMicrosecond;
+}
+
+constexpr uint8_t index(CyclePhase phase)
+{
+    return static_cast<uint8_t>(phase);
+}
+} // namespace
+
+TEST(CycleProfilerTest, phasesAndHistogram)
+{
+    CycleProfiler profiler;
+
+    // counter wraps around in the first dispatch
+    uint32_t now = UINT32_MAX - us(2);
+    profiler.start(now);
+    profiler.phaseDone(CyclePhase::Canopen, now += us(5));
+    profiler.phaseDone(CyclePhase::RemoteControl, now += us(40));
+    profiler.phaseDone(CyclePhase::HardwareSwitches, now += us(1));
+    profiler.phaseDone(CyclePhase::Selection, now += us(3));
+    profiler.phaseDone(CyclePhase::Process, now += us(200));
+    profiler.phaseDone(CyclePhase::LEDs, now += us(10));
+    profiler.finish();
+
+    // remote control waiting for the frame, no process without state
+    profiler.start(now += us(20000));
+    profiler.phaseDone(CyclePhase::Canopen, now += us(7));
+    profiler.phaseDone(CyclePhase::RemoteControl, now += us(30000));
+    profiler.phaseDone(CyclePhase::HardwareSwitches, now += us(1));
+    profiler.phaseDone(CyclePhase::Selection, now += us(3));
+    profiler.finish();
+
+    // woken up between cycles, kept out of the cycle's figures
+    profiler.start(now += us(1000), false);
+    profiler.phaseDone(CyclePhase::Canopen, now += us(4));
+    profiler.phaseDone(CyclePhase::RemoteControl, now += us(60000));
+    profiler.phaseDone(CyclePhase::HardwareSwitches, now += us(1));
+    profiler.phaseDone(CyclePhase::Selection, now += us(3));
+    profiler.finish();
+
+    profiler.deadlineMissed();
+
+    const CycleProfiler::Statistics &stats = profiler.getStatistics();
+    const CycleProfiler::Timing &canopen = stats.phases[index(CyclePhase::Canopen)];
+    EXPECT_EQ(canopen.count, 2);
+    EXPECT_EQ(canopen.min_us, 5);
+    EXPECT_EQ(canopen.max_us, 7);
+    EXPECT_EQ(canopen.avg_us(), 6);
+    EXPECT_EQ(canopen.histogram[0], 2);
+
+    const CycleProfiler::Timing &rc = stats.phases[index(CyclePhase::RemoteControl)];
+    EXPECT_EQ(rc.histogram[1], 1);
+    EXPECT_EQ(rc.histogram[CycleProfiler::Buckets - 1], 1);
+    EXPECT_EQ(stats.phases[index(CyclePhase::Process)].count, 1);
+    EXPECT_EQ(stats.phases[index(CyclePhase::StateSwitch)].count, 0);
+
+    EXPECT_EQ(stats.dispatch.count, 2);
+    EXPECT_EQ(stats.dispatch.min_us, 259);
+    EXPECT_EQ(stats.dispatch.max_us, 30011);
+
+    // the slow one with its breakdown
+    EXPECT_EQ(stats.worst.total_us, 30011);
+    EXPECT_EQ(stats.worst.phases_us[index(CyclePhase::RemoteControl)], 30000);
+    EXPECT_EQ(stats.worst.phases_us[index(CyclePhase::Process)], 0);
+
+    EXPECT_EQ(stats.wakeUp.count, 1);
+    EXPECT_EQ(stats.wakeUp.max_us, 60008);
+    EXPECT_EQ(stats.missedDeadlines, 1);
+
+    profiler.reset();
+    EXPECT_EQ(profiler.getStatistics().dispatch.count, 0);
+    EXPECT_EQ(profiler.getStatistics().worst.total_us, 0);
+}
@@ -26,4 +26,21 @@ TEST(HardwareSwitchesTest, update)
 
     EXPECT_TRUE(state.ManualSwitch);
     EXPECT_FALSE(state.BikeEmergency);
-}
\ No newline at end of file
+}
+
+TEST(HardwareSwitchesTest, edgeHoldOff)
+{
+    // a bouncing contact wakes the Statemachine once
+    static constexpr uint32_t Now = 100000;
+    EXPECT_TRUE(HardwareSwitches::edgeWakesUp(Now));
+    for (uint32_t i = 0; i < HardwareSwitches::EdgeHoldOff_ms; ++i)
+    {
+        EXPECT_FALSE(HardwareSwitches::edgeWakesUp(Now + i));
+    }
+    EXPECT_TRUE(HardwareSwitches::edgeWakesUp(Now + HardwareSwitches::EdgeHoldOff_ms));
+
+    // across the tick's wrap around
+    EXPECT_TRUE(HardwareSwitches::edgeWakesUp(UINT32_MAX - 1));
+    EXPECT_FALSE(HardwareSwitches::edgeWakesUp(1));
+    EXPECT_TRUE(HardwareSwitches::edgeWakesUp(HardwareSwitches::EdgeHoldOff_ms - 2));
+}
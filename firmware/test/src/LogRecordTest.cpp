@@ -0,0 +1,163 @@
+#include "LogRecord.hpp"
+#include "Logging.hpp"
+#include "Wrapper/MpscRing.hpp"
+#include "fake/LogFrameDecoder.hpp"
+#include "gtest/gtest.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+using namespace remote_control_device;
+
+namespace
+{
+void encodeInto(LogRecord &record, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    record.encodeArgs(format, args);
+    va_end(args);
+}
+
+template <typename... Args>
+LogRecord encode(const char *format, Args... args)
+{
+    LogRecord record;
+    encodeInto(record, format, args...);
+    return record;
+}
+
+template <typename T>
+T argAt(const LogRecord &record, size_t offset)
+{
+    T value;
+    memcpy(&value, &record.args[offset], sizeof(T));
+    return value;
+}
+} // namespace
+
+TEST(LogRecordTest, encodeArgs)
+{
+    const LogRecord record = encode("%d %% %lu 0x%02x %s %1.1f", -5, 70000UL, 0xAB, "abc", 3.14);
+    ASSERT_EQ(record.argsSize, 4 + 4 + 4 + 1 + 3 + 8);
+    EXPECT_FALSE(record.truncated);
+    EXPECT_EQ(argAt<int32_t>(record, 0), -5);
+    EXPECT_EQ(argAt<uint32_t>(record, 4), 70000);
+    EXPECT_EQ(argAt<uint32_t>(record, 8), 0xAB);
+    EXPECT_EQ(record.args[12], 3);
+    EXPECT_EQ(memcmp(&record.args[13], "abc", 3), 0);
+    EXPECT_EQ(argAt<double>(record, 16), 3.14);
+
+    // width from the arguments
+    const LogRecord star = encode("%*d", 4, 7);
+    ASSERT_EQ(star.argsSize, 8);
+    EXPECT_EQ(argAt<int32_t>(star, 0), 4);
+    EXPECT_EQ(argAt<int32_t>(star, 4), 7);
+}
+
+TEST(LogRecordTest, encodeArgsTruncated)
+{
+    // strings are cut off
+    const LogRecord longString = encode("%s", "0123456789abcdefghij");
+    EXPECT_EQ(longString.argsSize, 1 + LogRecord::MaxStringSize);
+    EXPECT_EQ(longString.args[0], LogRecord::MaxStringSize);
+    EXPECT_FALSE(longString.truncated);
+
+    // 4 doubles fit, the 5th and everything after doesn't
+    const LogRecord record = encode("%f %f %f %f %f %d", 1.0, 2.0, 3.0, 4.0, 5.0, 6);
+    EXPECT_EQ(record.argsSize, LogRecord::MaxArgsSize);
+    EXPECT_TRUE(record.truncated);
+    EXPECT_EQ(argAt<double>(record, 24), 4.0);
+}
+
+TEST(LogRecordTest, frame)
+{
+    LogRecord record = encode("%u %u", 0U, 0x100U);
+    record.timestamp_ms = 0x01000200;
+    record.id = logId("format");
+    record.origin = static_cast<uint8_t>(Logging::Origin::CanIO);
+    record.level = static_cast<uint8_t>(Logging::Level::Error);
+
+    std::array<uint8_t, LogFrameMaxSize> frame{};
+    const size_t size = encodeLogFrame(record, frame);
+    ASSERT_LE(size, LogFrameMaxSize);
+
+    // zeros only as delimiters
+    EXPECT_EQ(frame[0], 0);
+    EXPECT_EQ(frame[size - 1], 0);
+    for (size_t i = 1; i < size - 1; ++i)
+    {
+        EXPECT_NE(frame[i], 0) << "at " << i;
+    }
+
+    // payload decoded, CRC checked
+    const fake::log::Frame decoded = fake::log::decodeFrame(&frame[1], size - 2);
+    ASSERT_TRUE(decoded.valid);
+    EXPECT_EQ(decoded.timestamp_ms, record.timestamp_ms);
+    EXPECT_EQ(decoded.id, record.id);
+    EXPECT_EQ(decoded.origin, record.origin);
+    EXPECT_EQ(decoded.level, record.level);
+    EXPECT_EQ(decoded.flags, 0);
+    ASSERT_EQ(decoded.args.size(), record.argsSize);
+    EXPECT_EQ(memcmp(decoded.args.data(), record.args.data(), record.argsSize), 0);
+
+    // a flipped bit in the CRC is caught
+    frame[size - 2] ^= 0x10;
+    EXPECT_FALSE(fake::log::decodeFrame(&frame[1], size - 2).valid);
+}
+
+TEST(LogRecordTest, benchmark_TextVsBinary)
+{
+    static constexpr int Iterations = 200000;
+    static constexpr const char *Format = "Node %u changed state to %s, %lu errors";
+    volatile size_t sink = 0;
+
+    // what vlog does for text: prefix, message, then TerminalIO sends it
+    char text[Logging::BUFFER_SIZE];
+    size_t textBytes = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < Iterations; ++i)
+    {
+        const int prefix = snprintf(text, sizeof(text), "%s%s ", "[WARNING]", "[Bus Devices]");
+        textBytes = prefix + snprintf(text + prefix, sizeof(text) - prefix, Format, i & 0x7F,
+                                      "Operational", 3UL);
+        textBytes += 2;
+        sink = sink + textBytes;
+    }
+    const double textNs = std::chrono::duration<double, std::nano>(
+                              std::chrono::steady_clock::now() - start)
+                              .count() /
+                          Iterations;
+
+    // binary: record in the logging task, frame in the TerminalIO task
+    wrapper::MpscRing<LogRecord, Logging::RECORD_QUEUE_SIZE> ring;
+    std::array<uint8_t, LogFrameMaxSize> frame{};
+    size_t binaryBytes = 0;
+    std::chrono::duration<double, std::nano> recordTime{0};
+    std::chrono::duration<double, std::nano> frameTime{0};
+    for (int i = 0; i < Iterations; ++i)
+    {
+        start = std::chrono::steady_clock::now();
+        ring.emplace([i](LogRecord &record) {
+            encodeInto(record, Format, i & 0x7F, "Operational", 3UL);
+            record.timestamp_ms = i;
+            record.id = logId(Format);
+        });
+        const auto recorded = std::chrono::steady_clock::now();
+        ring.consume([&](const LogRecord &record) { binaryBytes = encodeLogFrame(record, frame); });
+        sink = sink + binaryBytes;
+        recordTime += recorded - start;
+        frameTime += std::chrono::steady_clock::now() - recorded;
+    }
+
+    // 10 bits per byte on the UART
+    static constexpr double BaudRate = 115200;
+    std::cout << "[ BENCHMARK] log text:   " << textNs << " ns/call, " << textBytes
+              << " bytes, " << textBytes * 10 / BaudRate * 1e3 << " ms on the wire\n";
+    std::cout << "[ BENCHMARK] log binary: " << recordTime.count() / Iterations
+              << " ns/call, framing " << frameTime.count() / Iterations << " ns/call, "
+              << binaryBytes << " bytes, " << binaryBytes * 10 / BaudRate * 1e3
+              << " ms on the wire\n";
+    EXPECT_LT(binaryBytes, textBytes);
+}
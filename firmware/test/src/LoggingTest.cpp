@@ -1,14 +1,19 @@
 #include "Logging.hpp"
+#include "fake/LogFrameDecoder.hpp"
 #include "mock/HALMock.hpp"
 #include "mock/TerminalIOMock.hpp"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include <array>
+#include <cstdio>
+#include <cstring>
 #include <iostream>
 #include <sstream>
+#include <string>
+#include <vector>
 #include <stm32f3xx_hal.h>
 
 using namespace remote_control_device;
-using ::testing::StrEq;
 using ::testing::Return;
 
 class LoggingTest : public ::testing::Test
@@ -18,6 +23,18 @@ protected:
     {
     }
 
+    // what the TerminalIO task would send
+    std::string takeOutput()
+    {
+        std::string output;
+        std::array<char, Logging::OUTPUT_SIZE> buffer{};
+        for (size_t size = logg.takeOutput(buffer); size > 0; size = logg.takeOutput(buffer))
+        {
+            output.append(buffer.data(), size);
+        }
+        return output;
+    }
+
     HALMock hal;
     TerminalIOMock termIO;
     Logging logg;
@@ -33,53 +50,221 @@ std::string constructTimeoutMessage(int repeats)
 
 TEST_F(LoggingTest, formatting)
 {
+#ifdef BUILDCONFIG_BINARY_LOGGING
+    GTEST_SKIP() << "Text logging only";
+#endif
     ON_CALL(hal, GetTick).WillByDefault(Return(0));
 
-    EXPECT_CALL(termIO, write(StrEq("[ERROR][Bus Devices] Test1 123\r\n")));
     logg.log(Logging::Origin::BusDevices, Logging::Level::Error, "Test1 %d", 123);
+    EXPECT_EQ(takeOutput(), "[ERROR][Bus Devices] Test1 123\r\n");
 
-    EXPECT_CALL(termIO, write(StrEq("[INFO][CanFestival] Test2 3.1\r\n")));
     logg.log(Logging::Origin::CanFestival, Logging::Level::Info, "Test2 %1.1f", 3.14);
+    EXPECT_EQ(takeOutput(), "[INFO][CanFestival] Test2 3.1\r\n");
+
+    const std::string tooLarge(Logging::MESSAGE_SIZE, 'x');
+    logg.log(Logging::Origin::General, Logging::Level::Info, "%s", tooLarge.c_str());
+    EXPECT_EQ(takeOutput(), Logging::TOO_LARGE_MSG);
 }
 
 TEST_F(LoggingTest, repeatMessageWithTimeout)
 {
+#ifdef BUILDCONFIG_BINARY_LOGGING
+    GTEST_SKIP() << "Text logging only";
+#endif
     static constexpr uint32_t Repeats = 100;
     uint32_t time = 0;
 
     // first instance of message should be printed out
-    EXPECT_CALL(termIO, write(StrEq("[ERROR][Bus Devices] Test1 123\r\n"))).Times(1);
-
     EXPECT_CALL(hal, GetTick).WillRepeatedly(Return(time++));
     logg.log(Logging::Origin::BusDevices, Logging::Level::Error, "Test1 %d", 123);
-    for (size_t i = 0; i < 100; ++i)
+    EXPECT_EQ(takeOutput(), "[ERROR][Bus Devices] Test1 123\r\n");
+    for (size_t i = 0; i < Repeats; ++i)
     {
         EXPECT_CALL(hal, GetTick).WillRepeatedly(Return(time++));
         logg.log(Logging::Origin::BusDevices, Logging::Level::Error, "Test1 %d", 123);
-
-        // repeats > 0, so get tick is actually called
-        EXPECT_CALL(hal, GetTick).WillRepeatedly(Return(time++));
         logg.writeRepeatMessageAfterTimeout();
+        EXPECT_EQ(takeOutput(), "");
     }
 
     // no messages for long time, repeated message is printed after timeout
-    EXPECT_CALL(termIO, write(StrEq(constructTimeoutMessage(100))));
     EXPECT_CALL(hal, GetTick).WillRepeatedly(Return(time + Logging::REPEAT_MSG_TIMEOUT_SEC * 1000 + 1));
     logg.writeRepeatMessageAfterTimeout();
+    EXPECT_EQ(takeOutput(), constructTimeoutMessage(Repeats));
 }
 
 TEST_F(LoggingTest, repeatMessageWithNewMessage)
 {
+#ifdef BUILDCONFIG_BINARY_LOGGING
+    GTEST_SKIP() << "Text logging only";
+#endif
     ON_CALL(hal, GetTick).WillByDefault(Return(0));
-    static constexpr uint32_t Repeats = 2;
 
     // first instance of message should be printed out
-    EXPECT_CALL(termIO, write(StrEq("[ERROR][Bus Devices] Test1 123\r\n"))).Times(1);
     logg.log(Logging::Origin::BusDevices, Logging::Level::Error, "Test1 %d", 123);
     logg.log(Logging::Origin::BusDevices, Logging::Level::Error, "Test1 %d", 123);
+    EXPECT_EQ(takeOutput(), "[ERROR][Bus Devices] Test1 123\r\n");
 
     // message repeats
-    EXPECT_CALL(termIO, write(StrEq(constructTimeoutMessage(1)))).Times(1);
-    EXPECT_CALL(termIO, write(StrEq("[ERROR][Bus Devices] Test2 456\r\n"))).Times(1);
     logg.log(Logging::Origin::BusDevices, Logging::Level::Error, "Test2 %d", 456);
-}
\ No newline at end of file
+    EXPECT_EQ(takeOutput(), constructTimeoutMessage(1) + "[ERROR][Bus Devices] Test2 456\r\n");
+}
+
+TEST_F(LoggingTest, droppedMessagesReported)
+{
+#ifdef BUILDCONFIG_BINARY_LOGGING
+    GTEST_SKIP() << "Text logging only";
+#endif
+    ON_CALL(hal, GetTick).WillByDefault(Return(0));
+
+    // nothing sent in between, the ring runs full
+    std::string expected;
+    for (int i = 0; i < static_cast<int>(Logging::QUEUE_SIZE) + 3; ++i)
+    {
+        logg.log(Logging::Origin::CanIO, Logging::Level::Warning, "Test %d", i);
+        if (i < static_cast<int>(Logging::QUEUE_SIZE))
+        {
+            expected += "[WARNING][CanIO] Test " + std::to_string(i) + "\r\n";
+        }
+    }
+    EXPECT_EQ(logg.getDropped(), 3);
+    EXPECT_EQ(takeOutput(), expected + "... 3 log messages dropped\r\n");
+
+    // reported once
+    logg.log(Logging::Origin::CanIO, Logging::Level::Warning, "Test");
+    EXPECT_EQ(takeOutput(), "[WARNING][CanIO] Test\r\n");
+}
+
+TEST_F(LoggingTest, floodDoesNotCrowdOutOthers)
+{
+#ifdef BUILDCONFIG_BINARY_LOGGING
+    GTEST_SKIP() << "Text logging only";
+#endif
+    static constexpr int Rounds = 10;
+    static constexpr int FloodPerRound = 1000;
+    ON_CALL(hal, GetTick).WillByDefault(Return(0));
+
+    // far more than the ring holds between two runs of the TerminalIO task
+    std::string output;
+    for (int round = 0; round < Rounds; ++round)
+    {
+        for (int i = 0; i < FloodPerRound; ++i)
+        {
+            logg.log(Logging::Origin::CanIO, Logging::Level::Error, "Flood");
+            if (i == FloodPerRound / 2)
+            {
+                logg.log(Logging::Origin::General, Logging::Level::Info, "Distinct %d", round);
+            }
+        }
+        output += takeOutput();
+    }
+    logg.writeRepeatMessageAfterTimeout(true);
+    output += takeOutput();
+    EXPECT_EQ(logg.getDropped(), 0);
+
+    // every distinct message made it, the flood is fully accounted for
+    std::istringstream lines(output);
+    std::string line;
+    int distinct = 0;
+    int floodLines = 0;
+    int repeats = 0;
+    while (std::getline(lines, line))
+    {
+        int value = 0;
+        if (sscanf(line.c_str(), "[INFO][General] Distinct %d", &value) == 1)
+        {
+            EXPECT_EQ(value, distinct);
+            distinct++;
+        }
+        else if (line == "[ERROR][CanIO] Flood\r")
+        {
+            floodLines++;
+        }
+        else if (sscanf(line.c_str(), "... was repeated %d", &value) == 1)
+        {
+            repeats += value;
+        }
+        else
+        {
+            ADD_FAILURE() << "unexpected " << line;
+        }
+    }
+    EXPECT_EQ(distinct, Rounds);
+    EXPECT_EQ(floodLines + repeats, Rounds * FloodPerRound);
+    // the first and one after each distinct message
+    EXPECT_EQ(floodLines, Rounds + 1);
+}
+
+TEST_F(LoggingTest, disabledDiscardsQueued)
+{
+    ON_CALL(hal, GetTick).WillByDefault(Return(0));
+
+    logg.log(Logging::Origin::CanIO, Logging::Level::Warning, "Test");
+    logg.disableLogging();
+    logg.log(Logging::Origin::CanIO, Logging::Level::Warning, "Test 2");
+    EXPECT_EQ(takeOutput(), "");
+}
+
+TEST_F(LoggingTest, binaryFrames)
+{
+#ifndef BUILDCONFIG_BINARY_LOGGING
+    GTEST_SKIP() << "Needs BUILDCONFIG_BINARY_LOGGING";
+#endif
+    static constexpr const char *Format1 = "Node %u changed state to %s";
+    static constexpr const char *Format2 = "Test2 %1.1f";
+    ON_CALL(hal, GetTick).WillByDefault(Return(1234));
+
+    logg.log(Logging::Origin::BusDevices, Logging::Level::Error, Format1, 5U, "Operational");
+    logg.log(Logging::Origin::CanFestival, Logging::Level::Info, Format2, 3.14);
+    const std::vector<fake::log::Frame> frames = fake::log::decodeFrames(takeOutput());
+    ASSERT_EQ(frames.size(), 2);
+
+    ASSERT_TRUE(frames[0].valid);
+    EXPECT_EQ(frames[0].timestamp_ms, 1234);
+    EXPECT_EQ(frames[0].id, logId(Format1));
+    EXPECT_EQ(frames[0].origin, static_cast<uint8_t>(Logging::Origin::BusDevices));
+    EXPECT_EQ(frames[0].level, static_cast<uint8_t>(Logging::Level::Error));
+    EXPECT_EQ(frames[0].flags, 0);
+    ASSERT_EQ(frames[0].args.size(), 4 + 1 + strlen("Operational"));
+    EXPECT_EQ(frames[0].arg<uint32_t>(0), 5);
+    EXPECT_EQ(frames[0].stringArg(4), "Operational");
+
+    ASSERT_TRUE(frames[1].valid);
+    EXPECT_EQ(frames[1].id, logId(Format2));
+    EXPECT_EQ(frames[1].origin, static_cast<uint8_t>(Logging::Origin::CanFestival));
+    EXPECT_EQ(frames[1].level, static_cast<uint8_t>(Logging::Level::Info));
+    EXPECT_EQ(frames[1].arg<double>(0), 3.14);
+}
+
+TEST_F(LoggingTest, binaryDroppedReported)
+{
+#ifndef BUILDCONFIG_BINARY_LOGGING
+    GTEST_SKIP() << "Needs BUILDCONFIG_BINARY_LOGGING";
+#endif
+    static constexpr const char *Format = "Test %d";
+    ON_CALL(hal, GetTick).WillByDefault(Return(0));
+
+    // nothing sent in between, the ring runs full
+    for (int i = 0; i < static_cast<int>(Logging::RECORD_QUEUE_SIZE) + 3; ++i)
+    {
+        logg.log(Logging::Origin::CanIO, Logging::Level::Warning, Format, i);
+    }
+    EXPECT_EQ(logg.getDropped(), 3);
+
+    const std::vector<fake::log::Frame> frames = fake::log::decodeFrames(takeOutput());
+    ASSERT_EQ(frames.size(), Logging::RECORD_QUEUE_SIZE + 1);
+    for (size_t i = 0; i < Logging::RECORD_QUEUE_SIZE; ++i)
+    {
+        ASSERT_TRUE(frames[i].valid);
+        EXPECT_EQ(frames[i].id, logId(Format));
+        EXPECT_EQ(frames[i].arg<int32_t>(0), i);
+    }
+    ASSERT_TRUE(frames.back().valid);
+    EXPECT_EQ(frames.back().id, LogRecord::DroppedId);
+    EXPECT_EQ(frames.back().arg<uint32_t>(0), 3);
+
+    // reported once
+    logg.log(Logging::Origin::CanIO, Logging::Level::Warning, Format, 42);
+    const std::vector<fake::log::Frame> next = fake::log::decodeFrames(takeOutput());
+    ASSERT_EQ(next.size(), 1);
+    EXPECT_EQ(next[0].id, logId(Format));
+}
@@ -0,0 +1,226 @@
+#include "Wrapper/MpscRing.hpp"
+#include "gtest/gtest.h"
+#include <FreeRTOS.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <iostream>
+#include <task.h>
+
+namespace
+{
+struct Element
+{
+    uint8_t producer{0};
+    uint32_t counter{0};
+    // all derived from counter, a torn element doesn't match
+    std::array<uint32_t, 6> payload{};
+};
+
+void fill(Element &element, uint8_t producer, uint32_t counter)
+{
+    element.producer = producer;
+    element.counter = counter;
+    for (size_t i = 0; i < element.payload.size(); ++i)
+    {
+        element.payload[i] = counter * (i + 1) + producer;
+    }
+}
+
+bool isConsistent(const Element &element)
+{
+    Element expected;
+    fill(expected, element.producer, element.counter);
+    return element.payload == expected.payload;
+}
+
+constexpr uint8_t Producers = 4;
+using Ring = wrapper::MpscRing<Element, 8>;
+
+struct StressContext
+{
+    Ring ring;
+    std::atomic<bool> stop{false};
+    std::atomic<uint8_t> finished{0};
+    std::array<uint32_t, Producers> produced{};
+    std::array<uint32_t, Producers> consumed{};
+    // period of the last producer, 0 = cpu bound like the others
+    TickType_t isrPeriod = 0;
+    uint32_t outOfOrder = 0;
+    uint32_t tornElements = 0;
+};
+
+struct ProducerParam
+{
+    StressContext *ctx;
+    uint8_t id;
+};
+
+void producerTask(void *param)
+{
+    const auto &p = *reinterpret_cast<ProducerParam *>(param);
+    StressContext &ctx = *p.ctx;
+    const bool periodic = p.id == Producers - 1 && ctx.isrPeriod > 0;
+    while (!ctx.stop)
+    {
+        const uint32_t counter = ++ctx.produced[p.id];
+        ctx.ring.emplace([&](Element &element) { fill(element, p.id, counter); });
+        if (periodic)
+        {
+            vTaskDelay(ctx.isrPeriod);
+        }
+        else if (counter % 4 == 0)
+        {
+            // lets the others and the consumer in, the ring isn't just full all the time
+            taskYIELD();
+        }
+    }
+    ctx.finished++;
+    vTaskDelete(nullptr);
+}
+
+void consume(StressContext &ctx, std::array<uint32_t, Producers> &last)
+{
+    ctx.ring.consume([&](const Element &element) {
+        if (!isConsistent(element))
+        {
+            ctx.tornElements++;
+        }
+        if (element.counter <= last[element.producer])
+        {
+            ctx.outOfOrder++;
+        }
+        last[element.producer] = element.counter;
+        ctx.consumed[element.producer]++;
+    });
+}
+
+void consumerTask(void *param)
+{
+    auto &ctx = *reinterpret_cast<StressContext *>(param);
+    std::array<uint32_t, Producers> last{};
+    while (!ctx.stop)
+    {
+        consume(ctx, last);
+    }
+    // producers are done by now
+    while (ctx.finished < Producers)
+    {
+        vTaskDelay(1);
+    }
+    for (size_t i = 0; i < Ring::capacity(); ++i)
+    {
+        consume(ctx, last);
+    }
+    ctx.finished++;
+    vTaskDelete(nullptr);
+}
+
+void runStressTest(StressContext &ctx, UBaseType_t isrPriority)
+{
+    static constexpr TickType_t Duration = pdMS_TO_TICKS(300);
+    static constexpr UBaseType_t TaskPriority = tskIDLE_PRIORITY + 2;
+
+    // test task has to be able to preempt everyone to stop them
+    const UBaseType_t testPriority = uxTaskPriorityGet(nullptr);
+    vTaskPrioritySet(nullptr, std::max(isrPriority, TaskPriority) + 1);
+
+    std::array<ProducerParam, Producers> params{};
+    for (uint8_t i = 0; i < Producers; ++i)
+    {
+        params[i] = {&ctx, i};
+        xTaskCreate(&producerTask, "producer", configMINIMAL_STACK_SIZE * 4, &params[i],
+                    i == Producers - 1 ? isrPriority : TaskPriority, nullptr);
+    }
+    xTaskCreate(&consumerTask, "consumer", configMINIMAL_STACK_SIZE * 4, &ctx, TaskPriority,
+                nullptr);
+
+    vTaskDelay(Duration);
+    ctx.stop = true;
+    while (ctx.finished < Producers + 1)
+    {
+        vTaskDelay(1);
+    }
+    vTaskPrioritySet(nullptr, testPriority);
+}
+
+void expectNothingLost(const StressContext &ctx)
+{
+    uint32_t produced = 0;
+    uint32_t consumed = 0;
+    for (uint8_t i = 0; i < Producers; ++i)
+    {
+        EXPECT_GT(ctx.produced[i], 0) << "producer " << static_cast<int>(i);
+        produced += ctx.produced[i];
+        consumed += ctx.consumed[i];
+    }
+    EXPECT_GT(consumed, 0);
+    EXPECT_EQ(ctx.tornElements, 0);
+    EXPECT_EQ(ctx.outOfOrder, 0);
+    // whatever didn't make it is counted
+    EXPECT_EQ(consumed + ctx.ring.getDropped(), produced);
+    std::cout << "[ STRESS   ] produced " << produced << " consumed " << consumed << " dropped "
+              << ctx.ring.getDropped() << std::endl;
+}
+} // namespace
+
+TEST(MpscRingTest, fullRingDrops)
+{
+    Ring ring;
+    Element element;
+    for (uint32_t i = 1; i <= Ring::capacity() + 2; ++i)
+    {
+        fill(element, 0, i);
+        EXPECT_EQ(ring.push(element), i <= Ring::capacity());
+    }
+    EXPECT_EQ(ring.getDropped(), 2);
+
+    for (uint32_t i = 1; i <= Ring::capacity(); ++i)
+    {
+        ASSERT_TRUE(ring.pop(element));
+        EXPECT_EQ(element.counter, i);
+    }
+    EXPECT_FALSE(ring.pop(element));
+
+    // slots are reused after a lap
+    fill(element, 0, 42);
+    EXPECT_TRUE(ring.push(element));
+    ASSERT_TRUE(ring.pop(element));
+    EXPECT_EQ(element.counter, 42);
+}
+
+TEST(MpscRingTest, consumerWaitsForCommit)
+{
+    Ring ring;
+    Element element;
+
+    // an ISR logging between reservation and commit of a task
+    ring.emplace([&](Element &reserved) {
+        fill(element, 1, 2);
+        EXPECT_TRUE(ring.push(element));
+        EXPECT_FALSE(ring.pop(element));
+        fill(reserved, 0, 1);
+    });
+
+    ASSERT_TRUE(ring.pop(element));
+    EXPECT_EQ(element.producer, 0);
+    ASSERT_TRUE(ring.pop(element));
+    EXPECT_EQ(element.producer, 1);
+    EXPECT_FALSE(ring.pop(element));
+}
+
+TEST(MpscRingTest, stress_EqualPriority_NothingLostOrTorn)
+{
+    StressContext ctx;
+    runStressTest(ctx, tskIDLE_PRIORITY + 2);
+    expectNothingLost(ctx);
+}
+
+TEST(MpscRingTest, stress_PeriodicHighPriorityProducer_NothingLostOrTorn)
+{
+    // like an ISR preempting the logging tasks and the TerminalIO task
+    StressContext ctx;
+    ctx.isrPeriod = 1;
+    runStressTest(ctx, tskIDLE_PRIORITY + 3);
+    expectNothingLost(ctx);
+}
@@ -1,12 +1,16 @@
 #include "PeripheralDrivers/ReceiverModule.hpp"
+#include "TestDataSBUSFrame.hpp"
 #include "mock/LoggingMock.hpp"
 #include "gtest/gtest.h"
 #include <FreeRTOS.h>
+#include <algorithm>
 #include <array>
 #include <exception>
 #include <hippomocks.h>
+#include <random>
 #include <stm32f3xx_hal.h>
 #include <stm32f3xx_hal_uart.h>
+#include <vector>
 
 using namespace remote_control_device;
 using ::testing::Return;
@@ -78,4 +82,280 @@ TEST_F(ReceiverModuleTest, notifyRxSucessful_ErrorDecode)
     // check if reception is started again after processing
     mocks.ExpectCallFunc(HAL_UART_Receive_DMA).Return(HAL_OK);
     recv.dispatch(ReceiverModule::NOTIFY_RX_SUCCESSFUL);
-}
\ No newline at end of file
+}
+
+class ReceiverModuleCircularTest : public ::testing::Test
+{
+protected:
+    ReceiverModuleCircularTest()
+        : term(hal), log(term, hal),
+          recv(uart, tim, hal, log, ReceiverModule::RxMode::CircularDMA)
+    {
+        recv.dispatch(ReceiverModule::NOTIFY_RX_START);
+    }
+
+    /**
+     * @brief Emulates the circular dma with half transfer disabled
+     * and lets the task process every event unless taskIsLate
+     *
+     * @param data bytes arriving at once
+     * @param idle line goes idle afterwards
+     */
+    void receive(const std::vector<uint8_t> &data, bool idle)
+    {
+        for (uint8_t byte : data)
+        {
+            uart.pRxBuffPtr[dmaPos++] = byte;
+            if (dmaPos == uart.RxXferSize)
+            {
+                dmaPos = 0;
+                uart.RxEventCallback(&uart, uart.RxXferSize);
+                dispatchEvent();
+            }
+        }
+        // hal doesn't report idle directly after a wrap around
+        if (idle && dmaPos != 0)
+        {
+            uart.RxEventCallback(&uart, dmaPos);
+            dispatchEvent();
+        }
+    }
+
+    void dispatchEvent()
+    {
+        if (!taskIsLate)
+        {
+            recv.dispatch(ReceiverModule::NOTIFY_RX_DATA);
+        }
+    }
+
+    HALMock hal;
+    TerminalIOMock term;
+    LoggingMock log;
+    UART_HandleTypeDef uart{};
+    TIM_HandleTypeDef tim{};
+    ReceiverModule recv;
+    uint16_t dmaPos = 0;
+    // events pile up until the test dispatches
+    bool taskIsLate = false;
+};
+
+TEST_F(ReceiverModuleCircularTest, notifyStartRX_HALError)
+{
+    MockRepository mocks;
+
+    mocks.ExpectCallFunc(HAL_UARTEx_ReceiveToIdle_DMA).Return(HAL_ERROR);
+    mocks.ExpectCallFunc(ReceiverModule::testing_RxRestart);
+    recv.dispatch(ReceiverModule::NOTIFY_RX_START);
+}
+
+TEST_F(ReceiverModuleCircularTest, notifyError_RestartRXWithoutBlocking)
+{
+    MockRepository mocks;
+
+    uart.RxState = HAL_UART_STATE_BUSY_RX;
+    mocks.ExpectCallFunc(HAL_UART_AbortReceive).Return(HAL_OK);
+    mocks.ExpectCallFunc(HAL_UARTEx_ReceiveToIdle_DMA).Return(HAL_OK);
+    mocks.NeverCallFunc(HAL_UART_Receive);
+    recv.dispatch(ReceiverModule::NOTIFY_ERROR);
+}
+
+TEST_F(ReceiverModuleCircularTest, randomlyFragmentedStream_EveryFrameDecoded)
+{
+    MockRepository mocks;
+    static constexpr int FrameCount = 200;
+
+    int decoded = 0;
+    mocks.OnCallFunc(ReceiverModule::testing_SuccessfulDecode).Do([&]() { decoded++; });
+    mocks.NeverCallFunc(ReceiverModule::testing_ErrorDecode);
+    EXPECT_CALL(hal, GetTick).WillRepeatedly(Return(0));
+
+    std::mt19937 rng(420);
+    std::uniform_int_distribution<size_t> chunkSize(1, 20);
+    std::uniform_int_distribution<uint16_t> channelDist(
+        SBUS::Protocol::Analog_Channel_RawQX7Range_Min,
+        SBUS::Protocol::Analog_Channel_RawQX7Range_Max);
+
+    std::array<uint16_t, SBUS::Protocol::ANALOG_CHANNEL_COUNT> channels{};
+    for (int i = 0; i < FrameCount; ++i)
+    {
+        for (uint16_t &ch : channels)
+        {
+            ch = channelDist(rng);
+        }
+        const auto frame = TestDataSBUSFrame::packFrame(channels, 0);
+
+        // uart driver reports data in arbitrary chunks
+        for (size_t pos = 0; pos < frame.size();)
+        {
+            const size_t len = std::min(chunkSize(rng), frame.size() - pos);
+            const bool last = pos + len == frame.size();
+            receive(std::vector<uint8_t>(frame.begin() + pos, frame.begin() + pos + len), last);
+            pos += len;
+        }
+    }
+
+    EXPECT_EQ(decoded, FrameCount);
+    EXPECT_EQ(recv.getResyncCount(), 0);
+
+    SBUS::Frame myframe;
+    ASSERT_TRUE(recv.getSBUSFrame(myframe));
+    for (size_t i = 0; i < channels.size(); ++i)
+    {
+        EXPECT_EQ(myframe.analogChannels[i], SBUS::Decoder::scaleRawValue(channels[i]));
+    }
+}
+
+TEST_F(ReceiverModuleCircularTest, corruptedByte_NextFrameNotLost)
+{
+    MockRepository mocks;
+
+    int decoded = 0;
+    mocks.OnCallFunc(ReceiverModule::testing_SuccessfulDecode).Do([&]() { decoded++; });
+    EXPECT_CALL(hal, GetTick).WillRepeatedly(Return(0));
+
+    const std::vector<uint8_t> good(TestDataSBUSFrame::GoodFrame::frameData.begin(),
+                                    TestDataSBUSFrame::GoodFrame::frameData.end());
+    std::vector<uint8_t> lostByte = good;
+    lostByte.erase(lostByte.begin() + 7);
+    std::vector<uint8_t> badEnd = good;
+    badEnd.back() = 0x42;
+
+    // started mid frame
+    receive(std::vector<uint8_t>(good.begin() + 12, good.end()), true);
+    receive(good, true);
+    receive(lostByte, true);
+    receive(good, true);
+    receive(badEnd, true);
+    receive(good, true);
+
+    EXPECT_EQ(decoded, 3);
+    EXPECT_GT(recv.getResyncCount(), 0);
+}
+
+TEST_F(ReceiverModuleCircularTest, idleThenWrapBeforeTaskRuns_NextFrameKept)
+{
+    int decoded = 0;
+    recv.setFrameCallback([](void *context, const SBUS::Frame &) -> void {
+        (*reinterpret_cast<int *>(context))++;
+    }, &decoded);
+    EXPECT_CALL(hal, GetTick).WillRepeatedly(Return(0));
+
+    const std::vector<uint8_t> good(TestDataSBUSFrame::GoodFrame::frameData.begin(),
+                                    TestDataSBUSFrame::GoodFrame::frameData.end());
+    const size_t head = ReceiverModule::RxRingSize - 2 * good.size();
+    ASSERT_LT(head, good.size());
+
+    // idle after the second frame, the next one's first bytes wrap the ring before the task runs
+    taskIsLate = true;
+    receive(good, true);
+    receive(good, true);
+    receive(std::vector<uint8_t>(good.begin(), good.begin() + head), false);
+    recv.dispatch(ReceiverModule::NOTIFY_RX_DATA);
+    EXPECT_EQ(decoded, 2);
+
+    taskIsLate = false;
+    receive(std::vector<uint8_t>(good.begin() + head, good.end()), true);
+    EXPECT_EQ(decoded, 3);
+    EXPECT_EQ(recv.getResyncCount(), 0);
+}
+
+TEST_F(ReceiverModuleCircularTest, dmaOverrunsTask_CountedAsResync)
+{
+    int decoded = 0;
+    recv.setFrameCallback([](void *context, const SBUS::Frame &) -> void {
+        (*reinterpret_cast<int *>(context))++;
+    }, &decoded);
+    EXPECT_CALL(hal, GetTick).WillRepeatedly(Return(0));
+
+    const std::vector<uint8_t> good(TestDataSBUSFrame::GoodFrame::frameData.begin(),
+                                    TestDataSBUSFrame::GoodFrame::frameData.end());
+
+    // whole laps without the task running, the dma ends where the task stopped reading
+    taskIsLate = true;
+    for (size_t i = 0; i < ReceiverModule::RxRingSize; ++i)
+    {
+        receive(good, true);
+    }
+    recv.dispatch(ReceiverModule::NOTIFY_RX_DATA);
+    EXPECT_EQ(decoded, 0);
+    EXPECT_EQ(recv.getResyncCount(), 1);
+
+    // reception continues right away
+    taskIsLate = false;
+    receive(good, true);
+    receive(good, true);
+    EXPECT_EQ(decoded, 2);
+    EXPECT_EQ(recv.getResyncCount(), 1);
+
+    SBUS::LinkStatistics stats;
+    ASSERT_TRUE(recv.getLinkStatistics(stats));
+    EXPECT_EQ(stats.resyncCount, 1);
+}
+
+TEST_F(ReceiverModuleCircularTest, linkStatistics)
+{
+    uint32_t cycles = 0;
+    EXPECT_CALL(hal, GetTick).WillRepeatedly(Return(0));
+    EXPECT_CALL(hal, GetCycleCount).WillRepeatedly(::testing::Invoke([&]() {
+        cycles += 9000 * wrapper::HAL::CyclesPerMicrosecond;
+        return cycles;
+    }));
+
+    const std::vector<uint8_t> good(TestDataSBUSFrame::GoodFrame::frameData.begin(),
+                                    TestDataSBUSFrame::GoodFrame::frameData.end());
+    const std::vector<uint8_t> rangeError(
+        TestDataSBUSFrame::BadFrameChannelValue::frameData.begin(),
+        TestDataSBUSFrame::BadFrameChannelValue::frameData.end());
+
+    receive(std::vector<uint8_t>(good.begin() + 12, good.end()), true);
+    receive(good, true);
+    receive(good, true);
+    receive(rangeError, true);
+    receive(good, true);
+
+    SBUS::LinkStatistics stats;
+    ASSERT_TRUE(recv.getLinkStatistics(stats));
+    EXPECT_EQ(stats.decodeResults[static_cast<uint8_t>(SBUS::DecodeError::NoError)], 3);
+    EXPECT_EQ(stats.decodeResults[static_cast<uint8_t>(
+                  SBUS::DecodeError::AnalogChannelSanityCheckRange)],
+              1);
+    EXPECT_EQ(stats.resyncCount, recv.getResyncCount());
+    EXPECT_GT(stats.resyncCount, 0);
+    EXPECT_EQ(stats.maxInterArrival_us, 9000);
+    EXPECT_EQ(stats.jitterHistogram[0], 2);
+}
+
+TEST_F(ReceiverModuleCircularTest, frameCallbackForDecodedFrames)
+{
+    struct Received
+    {
+        int frames{0};
+        SBUS::Frame last;
+    } received;
+    recv.setFrameCallback(
+        [](void *context, const SBUS::Frame &frame) -> void {
+            auto r = reinterpret_cast<Received *>(context);
+            r->frames++;
+            r->last = frame;
+        },
+        &received);
+    EXPECT_CALL(hal, GetTick).WillRepeatedly(Return(42));
+
+    const std::vector<uint8_t> good(TestDataSBUSFrame::GoodFrame::frameData.begin(),
+                                    TestDataSBUSFrame::GoodFrame::frameData.end());
+    const std::vector<uint8_t> rangeError(
+        TestDataSBUSFrame::BadFrameChannelValue::frameData.begin(),
+        TestDataSBUSFrame::BadFrameChannelValue::frameData.end());
+
+    receive(good, true);
+    receive(rangeError, true);
+    receive(good, true);
+
+    // only decoded frames, already readable
+    EXPECT_EQ(received.frames, 2);
+    EXPECT_EQ(received.last.lastUpdate, 42);
+    SBUS::Frame stored;
+    ASSERT_TRUE(recv.getSBUSFrame(stored));
+    EXPECT_EQ(stored.analogChannels, received.last.analogChannels);
+}
@@ -161,4 +161,54 @@ TEST_F(RemoteControlTest, throttleIsUp)
     frame.analogChannels.at(RemoteControl::ChannelMap::Throttle) = (SBUS::Decoder::ANALOG_CHANNEL_MAX / 2) + RemoteControl::Deadband + 1;
     rc._update(frame, rcs);
     EXPECT_TRUE(rcs.throttleIsUp);
-}
\ No newline at end of file
+}
+
+TEST_F(RemoteControlTest, urgentInputsChanged)
+{
+    static constexpr uint32_t FramePeriod_ms = 9;
+    const auto nextFrame = [this]() -> void { frame.lastUpdate += FramePeriod_ms; };
+    const auto setChannel = [this](uint8_t channel, bool on) -> void {
+        frame.analogChannels.at(channel) =
+            on ? RemoteControl::SwitchOn_MinValue + 1 : RemoteControl::SwitchOn_MinValue - 1;
+    };
+    setChannel(RemoteControl::ChannelMap::SwitchUnlock, false);
+    setChannel(RemoteControl::ChannelMap::ButtonEmcy, false);
+    frame.failsafe = false;
+
+    // the first frame ends the startup timeout
+    frame.lastUpdate = 100;
+    EXPECT_TRUE(rc.urgentInputsChanged(frame));
+
+    // sticks and the other switches wait for the next cycle
+    for (uint16_t i = 0; i < 100; ++i)
+    {
+        nextFrame();
+        frame.analogChannels.at(RemoteControl::ChannelMap::Throttle) = i * 20;
+        frame.analogChannels.at(RemoteControl::ChannelMap::Steering) = 2000 - i * 20;
+        setChannel(RemoteControl::ChannelMap::SwitchRemote, (i / 10) % 2 == 0);
+        setChannel(RemoteControl::ChannelMap::SwitchAutonomous, (i / 20) % 2 == 0);
+        EXPECT_FALSE(rc.urgentInputsChanged(frame)) << "frame " << i;
+    }
+
+    // once per change
+    const auto expectOneChange = [&]() -> void {
+        nextFrame();
+        EXPECT_TRUE(rc.urgentInputsChanged(frame));
+        nextFrame();
+        EXPECT_FALSE(rc.urgentInputsChanged(frame));
+    };
+    setChannel(RemoteControl::ChannelMap::ButtonEmcy, true);
+    expectOneChange();
+    setChannel(RemoteControl::ChannelMap::ButtonEmcy, false);
+    expectOneChange();
+    setChannel(RemoteControl::ChannelMap::SwitchUnlock, true);
+    expectOneChange();
+    frame.failsafe = true;
+    expectOneChange();
+    frame.failsafe = false;
+    expectOneChange();
+
+    // frames again after the link was lost
+    frame.lastUpdate += RemoteControl::Timeout_Ms;
+    expectOneChange();
+}
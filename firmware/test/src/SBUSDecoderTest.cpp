@@ -1,5 +1,8 @@
 #include "TestDataSBUSFrame.hpp"
 #include "gtest/gtest.h"
+#include <chrono>
+#include <iostream>
+#include <random>
 
 using namespace remote_control_device::SBUS;
 using namespace TestDataSBUSFrame;
@@ -59,4 +62,77 @@ TEST(SBUSDecoderTest, decode_VariousBadFrames)
     EXPECT_NE(Decoder::decode(BadFrameFlagBytes::frameData).first, DecodeError::NoError);
     EXPECT_NE(Decoder::decode(BadFrameChannelValue::frameData).first, DecodeError::NoError);
     EXPECT_NE(Decoder::decode(BadFrameChannelValue2::frameData).first, DecodeError::NoError);
-}
\ No newline at end of file
+}
+
+namespace
+{
+void expectSameResult(const std::pair<DecodeError, Frame> &a,
+                      const std::pair<DecodeError, Frame> &b)
+{
+    EXPECT_EQ(a.first, b.first);
+    EXPECT_EQ(a.second.analogChannels, b.second.analogChannels);
+    EXPECT_EQ(a.second.digitalCh17, b.second.digitalCh17);
+    EXPECT_EQ(a.second.digitalCh18, b.second.digitalCh18);
+    EXPECT_EQ(a.second.frameLost, b.second.frameLost);
+    EXPECT_EQ(a.second.failsafe, b.second.failsafe);
+    EXPECT_EQ(a.second.lastUpdate, b.second.lastUpdate);
+}
+
+const std::array<Protocol::FrameData *, 7> AllTestFrames = {
+    &GoodFrame::frameData,         &GoodFrameTimeout::frameData,
+    &BadFrameStartByte::frameData, &BadFrameEndByte::frameData,
+    &BadFrameFlagBytes::frameData, &BadFrameChannelValue::frameData,
+    &BadFrameChannelValue2::frameData};
+} // namespace
+
+TEST(SBUSDecoderTest, decodeGrouped_BitExactTestVectors)
+{
+    for (const auto *frame : AllTestFrames)
+    {
+        expectSameResult(Decoder::decodeBitwise(*frame), Decoder::decodeGrouped(*frame));
+    }
+}
+
+TEST(SBUSDecoderTest, decodeGrouped_BitExactRandomFrames)
+{
+    // deterministic so failures are reproducible
+    std::mt19937 rng(420);
+    std::uniform_int_distribution<uint16_t> channelDist(0, (1 << Protocol::Analog_Channel_Bit_Width) - 1);
+    std::uniform_int_distribution<uint16_t> saneDist(Protocol::Analog_Channel_RawSanityRange_Min,
+                                                     Protocol::Analog_Channel_RawSanityRange_Max);
+    std::uniform_int_distribution<uint16_t> flagDist(0, 0x0f);
+
+    for (int i = 0; i < 10000; ++i)
+    {
+        std::array<uint16_t, Protocol::ANALOG_CHANNEL_COUNT> channels{};
+        for (uint16_t &ch : channels)
+        {
+            // mostly good frames, some with out of range channels
+            ch = (i % 4 == 0) ? channelDist(rng) : saneDist(rng);
+        }
+        const auto data = packFrame(channels, static_cast<uint8_t>(flagDist(rng)));
+        expectSameResult(Decoder::decodeBitwise(data), Decoder::decodeGrouped(data));
+    }
+}
+
+TEST(SBUSDecoderTest, benchmark_Engines)
+{
+    static constexpr int Iterations = 200000;
+    volatile uint16_t sink = 0;
+
+    auto measure = [&](auto engine) -> double {
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < Iterations; ++i)
+        {
+            const auto ret = engine(GoodFrame::frameData);
+            sink = sink + ret.second.analogChannels[i % Protocol::ANALOG_CHANNEL_COUNT];
+        }
+        const auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::nano>(end - start).count() / Iterations;
+    };
+
+    const double bitwise = measure(&Decoder::decodeBitwise);
+    const double grouped = measure(&Decoder::decodeGrouped);
+    std::cout << "[ BENCHMARK] SBUS decodeBitwise: " << bitwise << " ns/frame\n";
+    std::cout << "[ BENCHMARK] SBUS decodeGrouped: " << grouped << " ns/frame\n";
+}
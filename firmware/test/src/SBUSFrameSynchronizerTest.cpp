@@ -0,0 +1,185 @@
+#include "SBUSFrameSynchronizer.hpp"
+#include "TestDataSBUSFrame.hpp"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace remote_control_device::SBUS;
+using namespace TestDataSBUSFrame;
+
+namespace
+{
+struct TestStream
+{
+    std::vector<uint8_t> bytes;
+    // positions after which the line is idle
+    std::vector<size_t> gaps;
+};
+
+std::vector<Protocol::FrameData> feed(FrameSynchronizer &sync, const TestStream &stream)
+{
+    std::vector<Protocol::FrameData> frames;
+    auto gap = stream.gaps.begin();
+    for (size_t i = 0; i < stream.bytes.size(); ++i)
+    {
+        if (sync.pushByte(stream.bytes[i]))
+        {
+            frames.push_back(sync.getFrame());
+        }
+        if (gap != stream.gaps.end() && *gap == i + 1)
+        {
+            sync.signalGap();
+            ++gap;
+        }
+    }
+    return frames;
+}
+
+Protocol::FrameData randomFrame(std::mt19937 &rng)
+{
+    std::uniform_int_distribution<uint16_t> channelDist(Protocol::Analog_Channel_RawSanityRange_Min,
+                                                        Protocol::Analog_Channel_RawSanityRange_Max);
+    std::uniform_int_distribution<uint16_t> flagDist(0, 0x0f);
+    std::array<uint16_t, Protocol::ANALOG_CHANNEL_COUNT> channels{};
+    for (uint16_t &ch : channels)
+    {
+        ch = channelDist(rng);
+    }
+    return packFrame(channels, static_cast<uint8_t>(flagDist(rng)));
+}
+
+bool isSubsequence(const std::vector<Protocol::FrameData> &needle,
+                   const std::vector<Protocol::FrameData> &haystack)
+{
+    auto it = haystack.begin();
+    for (const auto &frame : needle)
+    {
+        it = std::find(it, haystack.end(), frame);
+        if (it == haystack.end())
+        {
+            return false;
+        }
+        ++it;
+    }
+    return true;
+}
+} // namespace
+
+TEST(SBUSFrameSynchronizerTest, cleanStream)
+{
+    FrameSynchronizer sync;
+    TestStream stream;
+    for (int i = 0; i < 3; ++i)
+    {
+        stream.bytes.insert(stream.bytes.end(), GoodFrame::frameData.begin(),
+                            GoodFrame::frameData.end());
+    }
+
+    const auto frames = feed(sync, stream);
+    ASSERT_EQ(frames.size(), 3);
+    for (const auto &frame : frames)
+    {
+        EXPECT_EQ(frame, GoodFrame::frameData);
+    }
+    EXPECT_EQ(sync.getResyncCount(), 0);
+}
+
+TEST(SBUSFrameSynchronizerTest, startMidFrame_NoGaps)
+{
+    FrameSynchronizer sync;
+    TestStream stream;
+    // tail of a frame whose payload contains start bytes
+    stream.bytes = {0x12, Protocol::StartByte, 0x34, Protocol::StartByte, 0x00, 0x03, 0x00};
+    for (int i = 0; i < 3; ++i)
+    {
+        stream.bytes.insert(stream.bytes.end(), GoodFrame::frameData.begin(),
+                            GoodFrame::frameData.end());
+    }
+
+    // without gap information sliding to the next start byte has to find the boundary
+    const auto frames = feed(sync, stream);
+    ASSERT_GE(frames.size(), 2);
+    EXPECT_EQ(frames.back(), GoodFrame::frameData);
+    EXPECT_GT(sync.getResyncCount(), 0);
+}
+
+TEST(SBUSFrameSynchronizerTest, partialFrameDroppedOnGap)
+{
+    FrameSynchronizer sync;
+    TestStream stream;
+    stream.bytes.assign(GoodFrame::frameData.begin(), GoodFrame::frameData.begin() + 10);
+    stream.gaps.push_back(stream.bytes.size());
+    stream.bytes.insert(stream.bytes.end(), GoodFrameTimeout::frameData.begin(),
+                        GoodFrameTimeout::frameData.end());
+
+    const auto frames = feed(sync, stream);
+    ASSERT_EQ(frames.size(), 1);
+    EXPECT_EQ(frames.front(), GoodFrameTimeout::frameData);
+    EXPECT_EQ(sync.getResyncCount(), 1);
+}
+
+TEST(SBUSFrameSynchronizerTest, implausibleFramesRejected)
+{
+    FrameSynchronizer sync;
+    TestStream stream;
+    for (const auto *data : {&BadFrameEndByte::frameData, &BadFrameFlagBytes::frameData})
+    {
+        stream.bytes.insert(stream.bytes.end(), data->begin(), data->end());
+        stream.gaps.push_back(stream.bytes.size());
+    }
+
+    EXPECT_TRUE(feed(sync, stream).empty());
+}
+
+TEST(SBUSFrameSynchronizerTest, randomCorruptedStream_NoCleanFrameLost)
+{
+    std::mt19937 rng(420);
+    std::uniform_int_distribution<int> percent(0, 99);
+    std::uniform_int_distribution<size_t> position(0, Protocol::RAW_FRAME_SIZE - 1);
+    std::uniform_int_distribution<uint16_t> byteDist(0, 0xff);
+
+    for (int run = 0; run < 100; ++run)
+    {
+        FrameSynchronizer sync;
+        TestStream stream;
+        std::vector<Protocol::FrameData> cleanFrames;
+
+        // receiver might be switched on mid frame
+        for (int i = percent(rng) % 30; i > 0; --i)
+        {
+            stream.bytes.push_back(static_cast<uint8_t>(byteDist(rng)));
+        }
+        stream.gaps.push_back(stream.bytes.size());
+
+        for (int i = 0; i < 50; ++i)
+        {
+            const auto frame = randomFrame(rng);
+            std::vector<uint8_t> bytes(frame.begin(), frame.end());
+
+            const int corruption = percent(rng);
+            if (corruption < 10)
+            {
+                bytes[position(rng)] = static_cast<uint8_t>(byteDist(rng));
+            }
+            else if (corruption < 20)
+            {
+                bytes.erase(bytes.begin() + position(rng));
+            }
+            else if (corruption < 30)
+            {
+                bytes.insert(bytes.begin() + position(rng), static_cast<uint8_t>(byteDist(rng)));
+            }
+
+            if (bytes == std::vector<uint8_t>(frame.begin(), frame.end()))
+            {
+                cleanFrames.push_back(frame);
+            }
+            stream.bytes.insert(stream.bytes.end(), bytes.begin(), bytes.end());
+            stream.gaps.push_back(stream.bytes.size());
+        }
+
+        const auto frames = feed(sync, stream);
+        EXPECT_TRUE(isSubsequence(cleanFrames, frames)) << "run " << run;
+    }
+}
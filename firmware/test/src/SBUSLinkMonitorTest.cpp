@@ -0,0 +1,84 @@
+#include "SBUSLinkMonitor.hpp"
+#include "gtest/gtest.h"
+
+using namespace remote_control_device::SBUS;
+
+namespace
+{
+Frame makeFrame(bool frameLost, bool failsafe)
+{
+    Frame frame;
+    frame.frameLost = frameLost;
+    frame.failsafe = failsafe;
+    return frame;
+}
+} // namespace
+
+TEST(SBUSLinkMonitorTest, framesPerSecond)
+{
+    LinkMonitor monitor;
+    const Frame frame = makeFrame(false, false);
+
+    // 9ms frame period, window is evaluated with the first frame after it
+    uint32_t now = 0;
+    for (; now < LinkMonitor::Window_Ms + 9; now += 9)
+    {
+        monitor.frameReceived(DecodeError::NoError, frame, now, 9000);
+    }
+    // 113 frames within 1008ms
+    EXPECT_EQ(monitor.getStatistics().framesPerSecond, 112);
+    EXPECT_EQ(LinkMonitor::getFramesPerSecond(monitor.getStatistics(), now), 112);
+
+    // link died
+    EXPECT_EQ(LinkMonitor::getFramesPerSecond(monitor.getStatistics(), now + 3000), 0);
+}
+
+TEST(SBUSLinkMonitorTest, decodeResultsAndFlags)
+{
+    LinkMonitor monitor;
+
+    monitor.frameReceived(DecodeError::NoError, makeFrame(false, false), 0, 0);
+    monitor.frameReceived(DecodeError::NoError, makeFrame(true, false), 0, 0);
+    monitor.frameReceived(DecodeError::NoError, makeFrame(true, true), 0, 0);
+    // flags of undecodable frames are garbage
+    monitor.frameReceived(DecodeError::IllegalFlagByte, makeFrame(true, true), 0, 0);
+    monitor.frameReceived(DecodeError::AnalogChannelSanityCheckRange, makeFrame(true, true), 0,
+                          0);
+    monitor.addResyncs(3);
+
+    const auto &stats = monitor.getStatistics();
+    EXPECT_EQ(stats.decodeResults[static_cast<uint8_t>(DecodeError::NoError)], 3);
+    EXPECT_EQ(stats.decodeResults[static_cast<uint8_t>(DecodeError::StartOrEndbyte)], 0);
+    EXPECT_EQ(stats.decodeResults[static_cast<uint8_t>(DecodeError::IllegalFlagByte)], 1);
+    EXPECT_EQ(stats.decodeResults[static_cast<uint8_t>(DecodeError::AnalogChannelIndexOOB)], 0);
+    EXPECT_EQ(
+        stats.decodeResults[static_cast<uint8_t>(DecodeError::AnalogChannelSanityCheckRange)], 1);
+    EXPECT_EQ(stats.frameLostCount, 2);
+    EXPECT_EQ(stats.failsafeCount, 1);
+    EXPECT_EQ(stats.resyncCount, 3);
+}
+
+TEST(SBUSLinkMonitorTest, jitterHistogram)
+{
+    EXPECT_EQ(LinkMonitor::getJitterBucket(0), 0);
+    EXPECT_EQ(LinkMonitor::getJitterBucket(100), 0);
+    EXPECT_EQ(LinkMonitor::getJitterBucket(101), 1);
+    EXPECT_EQ(LinkMonitor::getJitterBucket(5000), LinkStatistics::JitterBucketCount - 2);
+    EXPECT_EQ(LinkMonitor::getJitterBucket(5001), LinkStatistics::JitterBucketCount - 1);
+
+    LinkMonitor monitor;
+    const Frame frame = makeFrame(false, false);
+
+    // first frame has no inter arrival time, second has no previous one to compare to
+    monitor.frameReceived(DecodeError::NoError, frame, 0, 0);
+    monitor.frameReceived(DecodeError::NoError, frame, 9, 9000);
+    monitor.frameReceived(DecodeError::NoError, frame, 18, 9050);
+    monitor.frameReceived(DecodeError::NoError, frame, 27, 9000);
+    // stalled for a frame
+    monitor.frameReceived(DecodeError::NoError, frame, 45, 18000);
+
+    const auto &stats = monitor.getStatistics();
+    EXPECT_EQ(stats.jitterHistogram[0], 2);
+    EXPECT_EQ(stats.jitterHistogram[LinkStatistics::JitterBucketCount - 1], 1);
+    EXPECT_EQ(stats.maxInterArrival_us, 18000);
+}
@@ -0,0 +1,150 @@
+#include "SBUSDecoder.hpp"
+#include "Wrapper/SeqLock.hpp"
+#include "gtest/gtest.h"
+#include <FreeRTOS.h>
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <task.h>
+
+using namespace remote_control_device;
+
+namespace
+{
+struct StressContext
+{
+    wrapper::SeqLock<SBUS::Frame> lock;
+    std::atomic<bool> stop{false};
+    std::atomic<uint8_t> finished{0};
+    // 0 = writer is cpu bound
+    TickType_t writerPeriod = 0;
+    uint32_t writes = 0;
+    uint32_t reads = 0;
+    uint32_t failedReads = 0;
+    uint32_t tornFrames = 0;
+};
+
+// every field of a published frame is derived from the same counter
+SBUS::Frame makeFrame(uint32_t counter)
+{
+    SBUS::Frame frame;
+    frame.analogChannels.fill(static_cast<uint16_t>(counter));
+    frame.digitalCh17 = (counter & 1) > 0;
+    frame.digitalCh18 = (counter & 1) > 0;
+    frame.frameLost = (counter & 1) > 0;
+    frame.failsafe = (counter & 1) > 0;
+    frame.lastUpdate = counter;
+    return frame;
+}
+
+bool isConsistent(const SBUS::Frame &frame)
+{
+    const SBUS::Frame expected = makeFrame(frame.lastUpdate);
+    return frame.analogChannels == expected.analogChannels &&
+           frame.digitalCh17 == expected.digitalCh17 &&
+           frame.digitalCh18 == expected.digitalCh18 && frame.frameLost == expected.frameLost &&
+           frame.failsafe == expected.failsafe;
+}
+
+void writerTask(void *param)
+{
+    auto &ctx = *reinterpret_cast<StressContext *>(param);
+    while (!ctx.stop)
+    {
+        ctx.lock.write(makeFrame(++ctx.writes));
+        if (ctx.writerPeriod > 0)
+        {
+            vTaskDelay(ctx.writerPeriod);
+        }
+    }
+    ctx.finished++;
+    vTaskDelete(nullptr);
+}
+
+void readerTask(void *param)
+{
+    auto &ctx = *reinterpret_cast<StressContext *>(param);
+    SBUS::Frame frame;
+    while (!ctx.stop)
+    {
+        ctx.reads++;
+        if (!ctx.lock.read(frame))
+        {
+            ctx.failedReads++;
+        }
+        else if (!isConsistent(frame))
+        {
+            ctx.tornFrames++;
+        }
+    }
+    ctx.finished++;
+    vTaskDelete(nullptr);
+}
+
+void runStressTest(StressContext &ctx, UBaseType_t writerPriority, UBaseType_t readerPriority)
+{
+    static constexpr TickType_t Duration = pdMS_TO_TICKS(300);
+
+    // test task has to be able to preempt both to stop them
+    const UBaseType_t testPriority = uxTaskPriorityGet(nullptr);
+    vTaskPrioritySet(nullptr, std::max(writerPriority, readerPriority) + 1);
+
+    // the scheduler interrupts both at arbitrary points
+    xTaskCreate(&writerTask, "writer", configMINIMAL_STACK_SIZE * 4, &ctx, writerPriority,
+                nullptr);
+    xTaskCreate(&readerTask, "reader", configMINIMAL_STACK_SIZE * 4, &ctx, readerPriority,
+                nullptr);
+
+    vTaskDelay(Duration);
+    ctx.stop = true;
+    while (ctx.finished < 2)
+    {
+        vTaskDelay(1);
+    }
+    vTaskPrioritySet(nullptr, testPriority);
+}
+} // namespace
+
+TEST(SeqLockTest, readWrite)
+{
+    wrapper::SeqLock<SBUS::Frame> lock;
+    SBUS::Frame frame;
+
+    ASSERT_TRUE(lock.read(frame));
+    EXPECT_EQ(frame.lastUpdate, SBUS::Frame().lastUpdate);
+
+    for (uint32_t i = 1; i < 5; ++i)
+    {
+        lock.write(makeFrame(i));
+        ASSERT_TRUE(lock.read(frame));
+        EXPECT_EQ(frame.lastUpdate, i);
+        EXPECT_TRUE(isConsistent(frame));
+    }
+    EXPECT_EQ(lock.getRetryCount(), 0);
+}
+
+TEST(SeqLockTest, stress_EqualPriority_NoTornFrames)
+{
+    StressContext ctx;
+    runStressTest(ctx, tskIDLE_PRIORITY + 2, tskIDLE_PRIORITY + 2);
+
+    EXPECT_GT(ctx.writes, 0);
+    EXPECT_GT(ctx.reads, 0);
+    EXPECT_EQ(ctx.tornFrames, 0);
+    EXPECT_EQ(ctx.failedReads, 0);
+    std::cout << "[ STRESS   ] writes " << ctx.writes << " reads " << ctx.reads << " retries "
+              << ctx.lock.getRetryCount() << std::endl;
+}
+
+TEST(SeqLockTest, stress_PeriodicHighPriorityWriter_NoTornFrames)
+{
+    // same setup as ReceiverModule preempting Statemachine
+    StressContext ctx;
+    ctx.writerPeriod = 1;
+    runStressTest(ctx, tskIDLE_PRIORITY + 3, tskIDLE_PRIORITY + 2);
+
+    EXPECT_GT(ctx.writes, 0);
+    EXPECT_GT(ctx.reads, 0);
+    EXPECT_EQ(ctx.tornFrames, 0);
+    EXPECT_EQ(ctx.failedReads, 0);
+}
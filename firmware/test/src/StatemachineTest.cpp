@@ -5,22 +5,52 @@
 #include "mock/LEDUpdaterMock.hpp"
 #include "mock/LEDsMock.hpp"
 #include "mock/RemoteControlMock.hpp"
-#include "mock/StateCallbacksMock.hpp"
 #include "mock/TerminalIOMock.hpp"
-#include "mock/CanFestivalTimersMock.hpp"
 #include "gtest/gtest.h"
 #include <FreeRTOS.h>
 #include <Statemachine/StateSources.hpp>
 #include <Statemachine/Statemachine.hpp>
 #include <Statemachine/States.hpp>
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <chrono>
 #include <exception>
+#include <iomanip>
 #include <iostream>
+#include <memory>
 #include <task.h>
+#include <vector>
 
 using namespace remote_control_device;
 using ::testing::Return;
 
+namespace
+{
+/**
+ * @brief How often the CountingCallbacks were called
+ *
+ */
+struct CallbackCalls
+{
+    int process{0};
+    int checkConditions{0};
+    int oneTimeSetup{0};
+};
+CallbackCalls calls;
+
+constexpr StateCallbacks CountingCallbacks = {
+    /* process function*/
+    [](StateChaningSources &) -> void { calls.process++; },
+    /* check conditions */
+    [](StateChaningSources &) -> bool {
+        calls.checkConditions++;
+        return false;
+    },
+    /* one time setup */
+    [](StateChaningSources &) -> void { calls.oneTimeSetup++; }};
+} // namespace
+
 class StatemachineTest : public ::testing::Test
 {
 protected:
@@ -29,12 +59,12 @@ protected:
           log(term, hal),
           canIO(hal, log),
           ledU(canIO),
-          cft(hal, log),
             recv(hal, log),
            rc(hal, log, recv),
           co(canIO, log),
-          sm(co, rc, hws, ledU, term, hal, iwdg, cft)
+          sm(co, rc, hws, ledU, term, iwdg)
     {
+        calls = CallbackCalls();
     }
 
     HALMock hal;
@@ -44,7 +74,6 @@ protected:
 
     LEDUpdaterMock ledU;
 
-    CanFestivalTimersMock cft;
     CanopenMock co;
     HardwareSwitchesMock hws;
 
@@ -57,9 +86,6 @@ protected:
 
 TEST_F(StatemachineTest, enterStateSetProperties)
 {
-    auto pSc = new StateCallbacksMock();
-    auto & sc = *pSc;
-
     State states[] = {State(
         /* id */ StateId::Start,
         /* priority */ 255,
@@ -74,7 +100,7 @@ TEST_F(StatemachineTest, enterStateSetProperties)
 
         /* requires unlock */ false,
 
-     pSc)};
+     CountingCallbacks)};
 
     // dont care about led updater here
     EXPECT_CALL(ledU, update).WillRepeatedly(Return());
@@ -109,17 +135,17 @@ TEST_F(StatemachineTest, enterStateSetProperties)
                                       states[0].couplingSteering == CouplingState::Engaged))
         .Times(1);
 
-    // check for state functions to be called
-    EXPECT_CALL(sc, process).Times(dispatchRepeatCnt);
-    EXPECT_CALL(sc, oneTimeSetup).Times(1);
-    EXPECT_CALL(sc, checkConditions).Times(dispatchRepeatCnt);
-
     // Dispatch should setup the system to the stuff defined in states
     for (int i = 0; i < 10; ++i)
     {
         sm._dispatch(std::span(states, 1), states[0]);
         ASSERT_EQ(sm.getCurrentState(), StateId::Start);
     }
+
+    // check for state functions to be called
+    EXPECT_EQ(calls.process, dispatchRepeatCnt);
+    EXPECT_EQ(calls.oneTimeSetup, 1);
+    EXPECT_EQ(calls.checkConditions, dispatchRepeatCnt);
 }
 
 TEST_F(StatemachineTest, statePriorisationAndUnlock)
@@ -139,14 +165,14 @@ TEST_F(StatemachineTest, statePriorisationAndUnlock)
 
               /* requires unlock */ false,
 
-               new StateCallbacks(
+               StateCallbacks{
                    /* process function*/
                    [](StateChaningSources &) -> void {},
                    /* check conditions */
                    [](StateChaningSources &) -> bool { return true; },
                    /* one time setup */
                    [](StateChaningSources &) -> void {}
-               )
+               }
         ),
 
         State(
@@ -163,7 +189,7 @@ TEST_F(StatemachineTest, statePriorisationAndUnlock)
 
             /* requires unlock */ false,
 
-            new StateCallbacks(
+            StateCallbacks{
                 /* process function*/
                 [](StateChaningSources & src) -> void {
                     if (!src.busDevicesState.timeout) {
@@ -174,7 +200,7 @@ TEST_F(StatemachineTest, statePriorisationAndUnlock)
                 [](StateChaningSources & src) -> bool { return !src.isStartedUp(); },
                 /* one time setup */
                 [](StateChaningSources &) -> void {}
-                )
+                }
         ),
 
         State(
@@ -190,14 +216,14 @@ TEST_F(StatemachineTest, statePriorisationAndUnlock)
             /* drive motor status */ CanDeviceState::Operational,
 
             /* requires unlock */ true,
-             new StateCallbacks(
+             StateCallbacks{
                  /* process function*/
                  [](StateChaningSources &) -> void {},
                  /* check conditions */
                  [](StateChaningSources & src) -> bool { return src.remoteControl.switchRemoteControl; },
                  /* one time setup */
                  [](StateChaningSources &) -> void {}
-             )
+             }
         ),
 
         State(
@@ -214,14 +240,14 @@ TEST_F(StatemachineTest, statePriorisationAndUnlock)
 
             /* requires unlock */ false,
 
-         new StateCallbacks(
+         StateCallbacks{
              /* process function*/
              [](StateChaningSources &) -> void {},
              /* check conditions */
              [](StateChaningSources & src) -> bool { return src.remoteControl.buttonEmergency; },
              /* one time setup */
              [](StateChaningSources &) -> void {}
-            )
+            }
         )
     }};
     const auto & idleState = states[0];
@@ -334,4 +360,436 @@ TEST_F(StatemachineTest, statePriorisationAndUnlock)
     });
     dispatch();
     ASSERT_EQ(sm.getCurrentState(), StateId::Idle);
-}
\ No newline at end of file
+}
+
+TEST_F(StatemachineTest, wakeUpDispatchProcessesOnlyOnStateChange)
+{
+    State states[] = {State(
+        /* id */ StateId::Start,
+        /* priority */ 255,
+
+        /* brake coupling */ CouplingState::Disengaged,
+        /* steering coupling */ CouplingState::Disengaged,
+
+        /* send targets */ false,
+        /* steering status */ CanDeviceState::Operational,
+        /* brake status */ CanDeviceState::Operational,
+        /* drive motor status */ CanDeviceState::Operational,
+
+        /* requires unlock */ false,
+
+        CountingCallbacks)};
+
+    EXPECT_CALL(co, update).Times(4);
+    EXPECT_CALL(rc, update).Times(4);
+    EXPECT_CALL(hws, update).Times(4);
+    EXPECT_CALL(co, setSelfState).Times(1);
+    EXPECT_CALL(co, setActuatorPDOs).Times(1);
+    EXPECT_CALL(co, setDeviceState).Times(4);
+    EXPECT_CALL(co, setCouplingStates).Times(1);
+    EXPECT_CALL(ledU, update).Times(1);
+
+    // the switch gets its outputs out right away
+    sm._dispatch(std::span(states, 1), states[0], false);
+    ASSERT_EQ(sm.getCurrentState(), StateId::Start);
+    EXPECT_EQ(calls.oneTimeSetup, 1);
+    EXPECT_EQ(calls.process, 1);
+
+    // without a switch the state's outputs keep the cycle's cadence
+    sm._dispatch(std::span(states, 1), states[0], false);
+    sm._dispatch(std::span(states, 1), states[0], false);
+    EXPECT_EQ(calls.process, 1);
+
+    sm._dispatch(std::span(states, 1), states[0], true);
+    EXPECT_EQ(calls.process, 2);
+    EXPECT_EQ(calls.checkConditions, 4);
+    EXPECT_EQ(calls.oneTimeSetup, 1);
+
+    // wake ups timed apart from the cycles
+    EXPECT_EQ(sm.getCycleProfiler().getStatistics().dispatch.count, 1);
+    EXPECT_EQ(sm.getCycleProfiler().getStatistics().wakeUp.count, 3);
+}
+
+namespace
+{
+/**
+ * @brief The callbacks as they were before the constexpr table: heap allocated per state and
+ * called through virtual functions forwarding to the function pointers
+ *
+ */
+class LegacyStateCallbacks
+{
+public:
+    explicit LegacyStateCallbacks(const StateCallbacks &cb) : _cb(cb)
+    {
+    }
+    virtual ~LegacyStateCallbacks() = default;
+
+    LegacyStateCallbacks(const LegacyStateCallbacks &) = delete;
+    LegacyStateCallbacks(LegacyStateCallbacks &&) = delete;
+    LegacyStateCallbacks &operator=(const LegacyStateCallbacks &) = delete;
+    LegacyStateCallbacks &operator=(LegacyStateCallbacks &&) = delete;
+
+    virtual void process(StateChaningSources &src) const
+    {
+        _cb.process(src);
+    }
+    virtual bool checkConditions(StateChaningSources &src) const
+    {
+        return _cb.checkConditions(src);
+    }
+    virtual void oneTimeSetup(StateChaningSources &src) const
+    {
+        _cb.oneTimeSetup(src);
+    }
+
+private:
+    StateCallbacks _cb;
+};
+
+struct LegacyState
+{
+    StateId id;
+    uint8_t priority;
+    CouplingState couplingBrake;
+    CouplingState couplingSteering;
+    bool sendTargets;
+    CanDeviceState stateSteering;
+    CanDeviceState stateBrake;
+    CanDeviceState stateDriveMotor;
+    bool requiresUnlock;
+    std::unique_ptr<LegacyStateCallbacks> callbacks;
+};
+
+/**
+ * @brief The selection loop of Statemachine::_dispatch
+ *
+ */
+template <typename States, typename Check>
+size_t selectState(const States &states, size_t idle, StateId current, StateChaningSources &src,
+                   Check check)
+{
+    size_t selected = idle;
+    for (size_t i = 0; i < states.size(); ++i)
+    {
+        const auto &state = states[i];
+        if (check(state, src) && state.priority >= states[selected].priority &&
+            ((state.requiresUnlock && src.remoteControl.switchUnlock) || !state.requiresUnlock ||
+             current == state.id))
+        {
+            selected = i;
+        }
+    }
+    return selected;
+}
+} // namespace
+
+TEST_F(StatemachineTest, benchmark_StateSelection)
+{
+    static constexpr uint32_t Iterations = 1000000;
+    const StatesArray &table = States::get();
+    size_t idle = 0;
+    std::vector<LegacyState> legacy;
+    for (size_t i = 0; i < table.size(); ++i)
+    {
+        const State &s = table[i];
+        legacy.push_back({s.id, s.priority, s.couplingBrake, s.couplingSteering, s.sendTargets,
+                          s.stateSteering, s.stateBrake, s.stateDriveMotor, s.requiresUnlock,
+                          std::make_unique<LegacyStateCallbacks>(s.callbacks)});
+        idle = &s == &States::getIdleState() ? i : idle;
+    }
+
+    // idle, remote control, manual and emergency inputs in turn
+    StateId current = StateId::Idle;
+    bool startedUp = true;
+    BusDevicesState bus;
+    bus.timeout = false;
+    bus.rtdBootedUp = true;
+    RemoteControlState rc;
+    HardwareSwitchesState hws;
+    StateChaningSources src(current, co, startedUp, bus, rc, hws);
+    const auto setInputs = [&](uint32_t i) -> void {
+        rc.switchUnlock = (i & 1) != 0;
+        rc.switchRemoteControl = (i & 1) != 0;
+        hws.ManualSwitch = (i & 2) != 0;
+        hws.BikeEmergency = (i & 7) == 7;
+    };
+
+    const auto time = [&](auto &&select) -> double {
+        volatile size_t sink = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < Iterations; ++i)
+        {
+            setInputs(i);
+            sink = sink + select();
+        }
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start)
+                   .count() /
+               Iterations;
+    };
+    const auto tableSelect = [&]() -> size_t {
+        return selectState(table, idle, current, src, [](const State &state, auto &sources) {
+            return state.callbacks.checkConditions(sources);
+        });
+    };
+    const auto legacySelect = [&]() -> size_t {
+        return selectState(legacy, idle, current, src, [](const LegacyState &state, auto &sources) {
+            return state.callbacks->checkConditions(sources);
+        });
+    };
+
+    // both pick the same state for every input
+    for (uint32_t i = 0; i < 8; ++i)
+    {
+        setInputs(i);
+        EXPECT_EQ(tableSelect(), legacySelect()) << "inputs " << i;
+    }
+
+    const double legacyNs = time(legacySelect);
+    const double tableNs = time(tableSelect);
+    std::cout << "[ BENCHMARK] state selection, heap states with virtual callbacks: " << legacyNs
+              << " ns, " << legacy.size() << " x (" << sizeof(LegacyState) << " + "
+              << sizeof(LegacyStateCallbacks) << " heap) bytes\n";
+    std::cout << "[ BENCHMARK] state selection, constexpr table: " << tableNs << " ns, "
+              << table.size() << " x " << sizeof(State) << " const bytes\n";
+}
+
+namespace
+{
+/**
+ * @brief Bike emergency switch flipped at different points of the Statemachine's cycle, measures
+ * the time until the Statemachine announces the Emergency state on the bus
+ *
+ */
+struct ReactionBench
+{
+    static constexpr uint32_t Flips = 25;
+    static constexpr UBaseType_t LoopPriority = tskIDLE_PRIORITY + 2;
+
+    Statemachine *sm{nullptr};
+    bool eventDriven{false};
+    std::atomic<bool> emergency{false};
+    std::atomic<bool> reacted{false};
+    std::atomic<bool> stop{false};
+    std::atomic<bool> stopped{false};
+    std::chrono::steady_clock::time_point flippedAt;
+    double latencyMax_us{0};
+    double latencySum_us{0};
+};
+
+void statemachineLoop(void *param)
+{
+    auto &bench = *static_cast<ReactionBench *>(param);
+    TickType_t nextCycle = xTaskGetTickCount();
+    while (!bench.stop)
+    {
+        if (bench.eventDriven)
+        {
+            bench.sm->runCycle(nextCycle);
+        }
+        else
+        {
+            // the task's loop before it could be woken up
+            bench.sm->dispatch();
+            vTaskDelayUntil(&nextCycle, pdMS_TO_TICKS(Statemachine::CyclePeriod_ms));
+        }
+    }
+    bench.stopped = true;
+    vTaskDelete(nullptr);
+}
+
+/**
+ * @brief Lets lower priority tasks run until done or timeout
+ *
+ */
+template <typename F>
+bool waitFor(F done, TickType_t timeout = pdMS_TO_TICKS(1000))
+{
+    for (TickType_t waited = 0; !done(); ++waited)
+    {
+        if (waited >= timeout)
+        {
+            return false;
+        }
+        vTaskDelay(1);
+    }
+    return true;
+}
+} // namespace
+
+TEST_F(StatemachineTest, benchmark_EmergencyReactionLatency)
+{
+    ReactionBench *bench = nullptr;
+
+    // started up, no remote control, only the bike emergency switch changes
+    EXPECT_CALL(ledU, update).WillRepeatedly(Return());
+    EXPECT_CALL(co, update).WillRepeatedly([](BusDevicesState &state) -> void {
+        state.timeout = false;
+        state.rtdEmergency = false;
+        state.rtdBootedUp = true;
+    });
+    EXPECT_CALL(rc, update).WillRepeatedly([](RemoteControlState &state) -> void {
+        state = RemoteControlState();
+        state.timeout = false;
+    });
+    EXPECT_CALL(hws, update).WillRepeatedly([&bench](HardwareSwitchesState &state) -> void {
+        state.ManualSwitch = false;
+        state.BikeEmergency = bench != nullptr && bench->emergency;
+    });
+    EXPECT_CALL(co, setSelfState).WillRepeatedly([&bench](const StateId id) -> void {
+        if (id != StateId::Emergency || bench == nullptr || bench->reacted)
+        {
+            return;
+        }
+        const double latency = std::chrono::duration<double, std::micro>(
+                                   std::chrono::steady_clock::now() - bench->flippedAt)
+                                   .count();
+        bench->latencySum_us += latency;
+        bench->latencyMax_us = std::max(bench->latencyMax_us, latency);
+        bench->reacted = true;
+    });
+    EXPECT_CALL(co, setActuatorPDOs).WillRepeatedly(Return());
+    EXPECT_CALL(co, setDeviceState).WillRepeatedly(Return());
+    EXPECT_CALL(co, setCouplingStates).WillRepeatedly(Return());
+    EXPECT_CALL(co, setBrakeForce).WillRepeatedly(Return());
+    EXPECT_CALL(co, setWheelDriveTorque).WillRepeatedly(Return());
+
+    // the switch's EXTI preempts the Statemachine
+    const UBaseType_t testPriority = uxTaskPriorityGet(nullptr);
+    vTaskPrioritySet(nullptr, ReactionBench::LoopPriority + 1);
+
+    // polled first, the woken up loop leaves its task registered for wake ups
+    std::array<ReactionBench, 2> benches;
+    benches[1].eventDriven = true;
+    for (ReactionBench &b : benches)
+    {
+        b.sm = &sm;
+        bench = &b;
+        xTaskCreate(&statemachineLoop, "statemachine", configMINIMAL_STACK_SIZE * 4, &b,
+                    ReactionBench::LoopPriority, nullptr);
+        ASSERT_TRUE(waitFor([this]() -> bool { return sm.getCurrentState() == StateId::Idle; }));
+
+        for (uint32_t i = 0; i < ReactionBench::Flips; ++i)
+        {
+            // spread over the cycle
+            vTaskDelay(1 + (i * 7) % Statemachine::CyclePeriod_ms);
+            b.reacted = false;
+            b.flippedAt = std::chrono::steady_clock::now();
+            b.emergency = true;
+            Statemachine::wakeUp(Statemachine::NOTIFY_SWITCH_EDGE);
+            ASSERT_TRUE(waitFor([&b]() -> bool { return b.reacted; }));
+
+            b.emergency = false;
+            Statemachine::wakeUp(Statemachine::NOTIFY_SWITCH_EDGE);
+            ASSERT_TRUE(
+                waitFor([this]() -> bool { return sm.getCurrentState() == StateId::Idle; }));
+        }
+
+        b.stop = true;
+        ASSERT_TRUE(waitFor([&b]() -> bool { return b.stopped; }));
+    }
+    bench = nullptr;
+    vTaskPrioritySet(nullptr, testPriority);
+
+    for (const ReactionBench &b : benches)
+    {
+        std::cout << "[ BENCHMARK] " << (b.eventDriven ? "woken up: " : "polled: ")
+                  << "emergency switch to Emergency state avg "
+                  << b.latencySum_us / ReactionBench::Flips << " us max " << b.latencyMax_us
+                  << " us\n";
+    }
+
+    // the polled loop sees the switch up to a cycle late, the woken up one right away
+    EXPECT_LT(benches[1].latencyMax_us, benches[0].latencyMax_us);
+    EXPECT_LT(benches[1].latencyMax_us, 1000.0 * Statemachine::CyclePeriod_ms / 2);
+}
+
+TEST_F(StatemachineTest, cycleProfileWithBlockingRemoteControl)
+{
+    static constexpr uint32_t Cycles = 25;
+    static constexpr uint32_t BlockEvery = 8;
+    static constexpr uint32_t Block_ms = Statemachine::CyclePeriod_ms + 10;
+
+    // started up and idle, every 8th remote control update waits for its frame longer than a
+    // cycle
+    uint32_t rcUpdates = 0;
+    EXPECT_CALL(ledU, update).WillRepeatedly(Return());
+    EXPECT_CALL(co, update).WillRepeatedly([](BusDevicesState &state) -> void {
+        state.timeout = false;
+        state.rtdEmergency = false;
+        state.rtdBootedUp = true;
+    });
+    EXPECT_CALL(rc, update).WillRepeatedly([&rcUpdates](RemoteControlState &state) -> void {
+        state = RemoteControlState();
+        state.timeout = false;
+        if (++rcUpdates % BlockEvery == 0)
+        {
+            vTaskDelay(pdMS_TO_TICKS(Block_ms));
+        }
+    });
+    EXPECT_CALL(hws, update).WillRepeatedly(Return());
+    EXPECT_CALL(co, setSelfState).WillRepeatedly(Return());
+    EXPECT_CALL(co, setActuatorPDOs).WillRepeatedly(Return());
+    EXPECT_CALL(co, setDeviceState).WillRepeatedly(Return());
+    EXPECT_CALL(co, setCouplingStates).WillRepeatedly(Return());
+    EXPECT_CALL(co, setBrakeForce).WillRepeatedly(Return());
+    EXPECT_CALL(co, setWheelDriveTorque).WillRepeatedly(Return());
+
+    TickType_t nextCycle = xTaskGetTickCount();
+    for (uint32_t i = 0; i < Cycles; ++i)
+    {
+        sm.runCycle(nextCycle);
+    }
+
+    const CycleProfiler::Statistics &stats = sm.getCycleProfiler().getStatistics();
+    std::cout << "[  REPORT  ] Statemachine phases, count, min / avg / max us, worst dispatch us, "
+                 "buckets <10 <50 <100 <500 <1k <5k <20k >=20k us\n";
+    const auto print = [](const char *name, const CycleProfiler::Timing &timing,
+                          uint32_t worst_us) -> void {
+        std::cout << "[  REPORT  ] " << std::left << std::setw(18) << name << std::right
+                  << std::setw(4) << timing.count << ", " << (timing.count == 0 ? 0 : timing.min_us)
+                  << " / " << timing.avg_us() << " / " << timing.max_us << ", " << worst_us
+                  << ",";
+        for (uint32_t bucket : timing.histogram)
+        {
+            std::cout << " " << bucket;
+        }
+        std::cout << "\n";
+    };
+    for (uint8_t i = 0; i < CycleProfiler::PhaseCount; ++i)
+    {
+        print(getCyclePhaseName(static_cast<CyclePhase>(i)), stats.phases[i],
+              stats.worst.phases_us[i]);
+    }
+    print("Dispatch", stats.dispatch, stats.worst.total_us);
+    std::cout << "[  REPORT  ] Missed deadlines " << stats.missedDeadlines << " of " << Cycles
+              << " cycles\n";
+
+    constexpr auto RemoteControl = static_cast<uint8_t>(CyclePhase::RemoteControl);
+    constexpr uint32_t Blocked = Cycles / BlockEvery;
+    // nothing woke the task, every dispatch is a cycle
+    EXPECT_EQ(stats.dispatch.count, Cycles);
+    EXPECT_EQ(stats.phases[static_cast<uint8_t>(CyclePhase::LEDs)].count, Cycles);
+    // startup and idle
+    EXPECT_EQ(stats.phases[static_cast<uint8_t>(CyclePhase::StateSwitch)].count, 2);
+    EXPECT_GE(stats.missedDeadlines, Blocked);
+    EXPECT_EQ(stats.phases[RemoteControl].histogram.back(), Blocked);
+    // the worst cycle blames the remote control
+    EXPECT_GE(stats.worst.phases_us[RemoteControl], (Block_ms - 1) * 1000);
+    EXPECT_GE(stats.worst.total_us, stats.worst.phases_us[RemoteControl]);
+
+    // other tasks get the missed deadlines every cycle, the statistics only on request
+    std::cout << "[  REPORT  ] Status " << sizeof(Statemachine::Status)
+              << " bytes, cycle statistics " << sizeof(CycleProfiler::Statistics) << " bytes\n";
+    Statemachine::Status status;
+    ASSERT_TRUE(sm.readStatus(status));
+    EXPECT_EQ(status.missedDeadlines, stats.missedDeadlines);
+    ASSERT_NE(sm.getCycleStatistics(), nullptr);
+    EXPECT_EQ(sm.getCycleStatistics()->dispatch.count, 0);
+
+    sm.requestCycleStatistics();
+    EXPECT_EQ(sm.getCycleStatistics(), nullptr);
+    sm.runCycle(nextCycle);
+    ASSERT_NE(sm.getCycleStatistics(), nullptr);
+    EXPECT_EQ(sm.getCycleStatistics()->dispatch.count, Cycles + 1);
+}
@@ -0,0 +1,155 @@
+#include "ANSIEscapeCodes.hpp"
+#include "PeripheralDrivers/TerminalFrame.hpp"
+#include "gtest/gtest.h"
+#include <string>
+
+using namespace remote_control_device;
+
+namespace
+{
+class CapturingWriter : public TerminalWriter
+{
+public:
+    void write(const char *str) override
+    {
+        output += str;
+    }
+    void write(std::span<const char> str) override
+    {
+        output.append(str.data(), str.size());
+    }
+
+    std::string output;
+};
+
+std::string row(unsigned row)
+{
+    return "\x1b[" + std::to_string(row) + ";1H";
+}
+
+void drawLines(TerminalFrame &frame, const char *second, bool third = true)
+{
+    frame.begin();
+    frame.write(ANSIEscapeCodes::ColorSection_WhiteText_GrayBackground);
+    frame.write("Header:\r\n");
+    frame.write(ANSIEscapeCodes::ColorSection_End);
+    frame.write("Value: ");
+    frame.write(second);
+    frame.write("\r\n");
+    if (third)
+    {
+        frame.write("Static\r\n");
+    }
+    frame.end();
+}
+} // namespace
+
+TEST(TerminalFrameTest, firstFrameClearsAndDrawsEverything)
+{
+    CapturingWriter term;
+    TerminalFrame frame(term);
+    drawLines(frame, "1");
+
+    EXPECT_EQ(term.output.rfind(ANSIEscapeCodes::ClearTerminal, 0), 0);
+    EXPECT_NE(term.output.find(row(1) + ANSIEscapeCodes::ColorSection_End +
+                               ANSIEscapeCodes::ColorSection_WhiteText_GrayBackground + "Header:"),
+              std::string::npos);
+    // the gray background is still in effect at the start of the second line
+    EXPECT_NE(term.output.find(row(2) + ANSIEscapeCodes::ColorSection_WhiteText_GrayBackground +
+                               ANSIEscapeCodes::ColorSection_End + "Value: 1"),
+              std::string::npos);
+    EXPECT_NE(term.output.find(row(3)), std::string::npos);
+    EXPECT_EQ(frame.getStatistics().linesWritten, 3);
+    EXPECT_EQ(frame.getStatistics().bytesWritten, term.output.size());
+}
+
+TEST(TerminalFrameTest, onlyChangedLinesRedrawn)
+{
+    CapturingWriter term;
+    TerminalFrame frame(term);
+    drawLines(frame, "1");
+
+    term.output.clear();
+    drawLines(frame, "1");
+    EXPECT_TRUE(term.output.empty());
+    EXPECT_EQ(frame.getStatistics().linesSkipped, 3);
+
+    drawLines(frame, "22");
+    EXPECT_EQ(term.output, row(2) + ANSIEscapeCodes::ColorSection_WhiteText_GrayBackground +
+                               ANSIEscapeCodes::ColorSection_End + "Value: 22" +
+                               ANSIEscapeCodes::ColorSection_End +
+                               ANSIEscapeCodes::ClearToEndOfLine);
+
+    // a line less clears the rest of the screen
+    term.output.clear();
+    drawLines(frame, "22", false);
+    EXPECT_EQ(term.output, row(3) + ANSIEscapeCodes::ClearToEndOfScreen);
+
+    // the line comes back
+    term.output.clear();
+    drawLines(frame, "22");
+    EXPECT_EQ(term.output.find(row(3)), 0);
+}
+
+TEST(TerminalFrameTest, colorChangeRedrawsFollowingLine)
+{
+    CapturingWriter term;
+    TerminalFrame frame(term);
+    frame.begin();
+    frame.write("A\r\n");
+    frame.write("B\r\n");
+    frame.end();
+
+    // same text, but the second line now starts red
+    term.output.clear();
+    frame.begin();
+    frame.write("A");
+    frame.write(ANSIEscapeCodes::ColorSection_WhiteText_RedBackground);
+    frame.write("\r\n");
+    frame.write("B\r\n");
+    frame.end();
+    EXPECT_NE(term.output.find(row(1)), std::string::npos);
+    EXPECT_NE(term.output.find(row(2) + ANSIEscapeCodes::ColorSection_WhiteText_RedBackground + "B"),
+              std::string::npos);
+}
+
+TEST(TerminalFrameTest, fullRedrawPeriodicallyAndOnInvalidate)
+{
+    CapturingWriter term;
+    TerminalFrame frame(term);
+    drawLines(frame, "1");
+
+    for (uint8_t i = 1; i <= TerminalFrame::FullRedrawFrames; ++i)
+    {
+        term.output.clear();
+        drawLines(frame, "1");
+        EXPECT_EQ(term.output.empty(), i < TerminalFrame::FullRedrawFrames) << int(i);
+    }
+    EXPECT_EQ(term.output.rfind(ANSIEscapeCodes::ClearTerminal, 0), 0);
+
+    term.output.clear();
+    frame.invalidate();
+    drawLines(frame, "1");
+    EXPECT_EQ(term.output.rfind(ANSIEscapeCodes::ClearTerminal, 0), 0);
+    EXPECT_NE(term.output.find("Static"), std::string::npos);
+}
+
+TEST(TerminalFrameTest, longLinesCutOffButChangesNoticed)
+{
+    CapturingWriter term;
+    TerminalFrame frame(term);
+    const std::string tail(TerminalFrame::LineSize, 'x');
+
+    frame.begin();
+    frame.write(std::span(tail.data(), tail.size()));
+    frame.write("1\r\n");
+    frame.end();
+    EXPECT_EQ(term.output.find(tail + "1"), std::string::npos);
+
+    term.output.clear();
+    frame.begin();
+    frame.write(std::span(tail.data(), tail.size()));
+    frame.write("2\r\n");
+    frame.end();
+    EXPECT_EQ(term.output.find(row(1)), 0);
+}
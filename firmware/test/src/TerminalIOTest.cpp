@@ -1,3 +1,4 @@
+#include "fake/LogFrameDecoder.hpp"
 #include "fake/Task.hpp"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -6,6 +7,7 @@
 #include <hippomocks.h>
 #include <iostream>
 #include <stm32f3xx_hal.h>
+#include <string>
 #include "mock/HALMock.hpp"
 
 using namespace remote_control_device;
@@ -164,4 +166,79 @@ TEST_F(TerminalIOTest, successfulTx)
             return HAL_OK;
         });
     term.dispatch(TerminalIO::NOTIFY_TX_START);
-}
\ No newline at end of file
+}
+TEST_F(TerminalIOTest, logStreamedAcrossTransfers)
+{
+#ifdef BUILDCONFIG_BINARY_LOGGING
+    GTEST_SKIP() << "Text logging only";
+#endif
+    MockRepository mocks;
+    static std::string sent;
+    sent.clear();
+
+    // longer than the stream, the task never blocks on it but continues after each transfer
+    const std::string message(70, 'x');
+    ASSERT_GT(message.size(), TerminalIO::TX_BUFFER_SIZE);
+    term.getLogging().logInfo(Logging::Origin::General, "%s", message.c_str());
+
+    mocks.OnCallFunc(HAL_UART_Transmit_DMA)
+        .Do([](UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size) -> HAL_StatusTypeDef {
+            sent.append(reinterpret_cast<const char *>(pData), Size);
+            return HAL_OK;
+        });
+    term.dispatch(TerminalIO::NOTIFY_LOG);
+    for (int i = 0; i < 10; ++i)
+    {
+        term.signalTXSuccessFromISR();
+        term.dispatch(TerminalIO::NOTIFY_TX_START);
+    }
+    EXPECT_EQ(sent, "[INFO][General] " + message + "\r\n");
+}
+
+TEST_F(TerminalIOTest, logFramesStreamedAcrossTransfers)
+{
+#ifndef BUILDCONFIG_BINARY_LOGGING
+    GTEST_SKIP() << "Needs BUILDCONFIG_BINARY_LOGGING";
+#endif
+    static constexpr const char *Format = "%s %d";
+    static constexpr int Records = 4;
+    MockRepository mocks;
+    static std::string sent;
+    sent.clear();
+    ON_CALL(hal, GetTick).WillByDefault(Return(100));
+
+    // together longer than the stream, sent in many transfers like the text
+    const std::string message(70, 'x');
+    for (int i = 0; i < Records; ++i)
+    {
+        term.getLogging().logWarning(Logging::Origin::CMD, Format, message.c_str(), i);
+    }
+
+    mocks.OnCallFunc(HAL_UART_Transmit_DMA)
+        .Do([](UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size) -> HAL_StatusTypeDef {
+            sent.append(reinterpret_cast<const char *>(pData), Size);
+            return HAL_OK;
+        });
+    term.dispatch(TerminalIO::NOTIFY_LOG);
+    for (int i = 0; i < 20; ++i)
+    {
+        term.signalTXSuccessFromISR();
+        term.dispatch(TerminalIO::NOTIFY_TX_START);
+    }
+    ASSERT_GT(sent.size(), TerminalIO::TX_BUFFER_SIZE);
+
+    // what LogDecoder.py would see
+    const std::vector<fake::log::Frame> frames = fake::log::decodeFrames(sent);
+    ASSERT_EQ(frames.size(), Records);
+    for (int i = 0; i < Records; ++i)
+    {
+        ASSERT_TRUE(frames[i].valid) << "frame " << i;
+        EXPECT_EQ(frames[i].timestamp_ms, 100);
+        EXPECT_EQ(frames[i].id, logId(Format));
+        EXPECT_EQ(frames[i].origin, static_cast<uint8_t>(Logging::Origin::CMD));
+        EXPECT_EQ(frames[i].level, static_cast<uint8_t>(Logging::Level::Warning));
+        // cut off after MaxStringSize
+        EXPECT_EQ(frames[i].stringArg(0), message.substr(0, LogRecord::MaxStringSize));
+        EXPECT_EQ(frames[i].arg<int32_t>(1 + LogRecord::MaxStringSize), i);
+    }
+}
@@ -117,4 +117,25 @@ Protocol::FrameData BadFrameChannelValue2::frameData = {
     0x00        
 };
 
-} // namespace TestDataSBUSFrame
\ No newline at end of file
+Protocol::FrameData packFrame(
+    const std::array<uint16_t, Protocol::ANALOG_CHANNEL_COUNT> &channels, uint8_t flags)
+{
+    Protocol::FrameData data{};
+    data[0] = Protocol::StartByte;
+    size_t bit = 0;
+    for (uint16_t ch : channels)
+    {
+        for (uint8_t i = 0; i < Protocol::Analog_Channel_Bit_Width; ++i, ++bit)
+        {
+            if ((ch & (1 << i)) > 0)
+            {
+                data[1 + bit / 8] |= 1 << (bit % 8);
+            }
+        }
+    }
+    data[Protocol::RAW_FRAME_SIZE - 2] = flags;
+    data[Protocol::RAW_FRAME_SIZE - 1] = Protocol::EndByte;
+    return data;
+}
+
+} // namespace TestDataSBUSFrame
@@ -78,4 +78,11 @@ static constexpr bool Ch17 = true;
 static Protocol::FrameData frameData;
 }; 
 
+/**
+ * @brief Packs channels the same way the receiver does (11 bit, LSB first)
+ *
+ */
+Protocol::FrameData packFrame(
+    const std::array<uint16_t, Protocol::ANALOG_CHANNEL_COUNT> &channels, uint8_t flags);
+
 } // namespace TestDataSBUSFrame
\ No newline at end of file
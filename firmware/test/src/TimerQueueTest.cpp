@@ -0,0 +1,213 @@
+#include "CanFestival/TimerQueue.hpp"
+#include "gtest/gtest.h"
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace remote_control_device;
+
+template <typename Queue>
+class TimerQueueTest : public ::testing::Test
+{
+protected:
+    Queue queue;
+};
+
+using TimerQueueTypes = ::testing::Types<LinearTimerQueue<16>, HeapTimerQueue<16>>;
+TYPED_TEST_SUITE(TimerQueueTest, TimerQueueTypes);
+
+TYPED_TEST(TimerQueueTest, allocateUntilFull)
+{
+    auto &queue = this->queue;
+    EXPECT_EQ(queue.nextDeadline(), TypeParam::NoDeadline);
+
+    for (int i = 0; i < 16; ++i)
+    {
+        EXPECT_EQ(queue.getFreeSlots(), 16 - i);
+        // handed out lowest first, same as the old slot search
+        EXPECT_EQ(queue.allocate(100 - i), i);
+    }
+    EXPECT_EQ(queue.allocate(0), TypeParam::None);
+    EXPECT_EQ(queue.getFreeSlots(), 0);
+    EXPECT_EQ(queue.nextDeadline(), 85);
+
+    queue.release(3);
+    EXPECT_EQ(queue.getFreeSlots(), 1);
+    EXPECT_FALSE(queue.isAllocated(3));
+    EXPECT_EQ(queue.allocate(0), 3);
+}
+
+TYPED_TEST(TimerQueueTest, popExpiredInDeadlineOrder)
+{
+    auto &queue = this->queue;
+    const std::vector<TIMEVAL> deadlines = {50, 10, 40, 20, 30};
+    for (TIMEVAL d : deadlines)
+    {
+        queue.allocate(d);
+    }
+
+    EXPECT_EQ(queue.popExpired(9), TypeParam::None);
+    EXPECT_EQ(queue.nextDeadline(), 10);
+
+    std::vector<TIMEVAL> fired;
+    for (auto handle = queue.popExpired(35); handle != TypeParam::None;
+         handle = queue.popExpired(35))
+    {
+        // dequeued but still owned by the caller
+        EXPECT_TRUE(queue.isAllocated(handle));
+        EXPECT_FALSE(queue.isQueued(handle));
+        fired.push_back(queue.getDeadline(handle));
+    }
+    EXPECT_EQ(fired, std::vector<TIMEVAL>({10, 20, 30}));
+    EXPECT_EQ(queue.nextDeadline(), 40);
+    EXPECT_EQ(queue.getFreeSlots(), 16 - deadlines.size());
+}
+
+TYPED_TEST(TimerQueueTest, scheduleAndRelease)
+{
+    auto &queue = this->queue;
+    const auto a = queue.allocate(100);
+    const auto b = queue.allocate(200);
+    const auto c = queue.allocate(300);
+
+    // move in both directions while queued
+    queue.schedule(c, 50);
+    EXPECT_EQ(queue.nextDeadline(), 50);
+    queue.schedule(c, 400);
+    EXPECT_EQ(queue.nextDeadline(), 100);
+
+    // requeue after firing
+    EXPECT_EQ(queue.popExpired(100), a);
+    EXPECT_EQ(queue.nextDeadline(), 200);
+    queue.schedule(a, 150);
+    EXPECT_TRUE(queue.isQueued(a));
+    EXPECT_EQ(queue.nextDeadline(), 150);
+
+    // release queued and dequeued slots
+    queue.release(a);
+    EXPECT_EQ(queue.nextDeadline(), 200);
+    EXPECT_EQ(queue.popExpired(200), b);
+    queue.release(b);
+    EXPECT_EQ(queue.nextDeadline(), 400);
+
+    // invalid handles are ignored
+    queue.release(a);
+    queue.release(TypeParam::None);
+    queue.schedule(a, 1);
+    EXPECT_EQ(queue.nextDeadline(), 400);
+    EXPECT_EQ(queue.getFreeSlots(), 15);
+}
+
+TEST(HeapTimerQueueTest, matchesLinearRandomized)
+{
+    // deterministic so failures are reproducible
+    std::mt19937 rng(420);
+    std::uniform_int_distribution<int> opDist(0, 3);
+    std::uniform_int_distribution<size_t> timerDist(0, 63);
+    std::uniform_int_distribution<TIMEVAL> deadlineDist(0, 1000);
+
+    LinearTimerQueue<64> linear;
+    HeapTimerQueue<64> heap;
+    // free handles are reused in a different order, so track them per queue
+    std::vector<std::pair<int16_t, int16_t>> timers;
+    TIMEVAL now = 0;
+
+    for (int i = 0; i < 20000; ++i)
+    {
+        const TIMEVAL deadline = now + deadlineDist(rng);
+        const int op = opDist(rng);
+        if (op == 0)
+        {
+            const auto l = linear.allocate(deadline);
+            const auto h = heap.allocate(deadline);
+            ASSERT_EQ(l == -1, h == -1);
+            if (l != -1)
+            {
+                timers.emplace_back(l, h);
+            }
+        }
+        else if (op == 3 || timers.empty())
+        {
+            now += 10;
+            // order of equal deadlines may differ, only compare what is left
+            for (auto h = heap.popExpired(now); h != -1; h = heap.popExpired(now))
+            {
+                ASSERT_LE(heap.getDeadline(h), now);
+            }
+            while (linear.popExpired(now) != -1)
+            {
+            }
+        }
+        else
+        {
+            const size_t timer = timerDist(rng) % timers.size();
+            if (op == 1)
+            {
+                linear.release(timers[timer].first);
+                heap.release(timers[timer].second);
+                timers.erase(timers.begin() + timer);
+            }
+            else
+            {
+                linear.schedule(timers[timer].first, deadline);
+                heap.schedule(timers[timer].second, deadline);
+            }
+        }
+        ASSERT_EQ(linear.nextDeadline(), heap.nextDeadline());
+        ASSERT_EQ(linear.getFreeSlots(), heap.getFreeSlots());
+    }
+}
+
+namespace
+{
+/**
+ * @brief Mimics CanFestivalTimers waking every ms: fire everything due, rearm
+ * as periodic and look up the next deadline. Periods 10 - 1000 ms like PDO
+ * event timers, heartbeats and SDO timeouts
+ *
+ */
+template <typename Queue, size_t Timers>
+double measureDispatch()
+{
+    static constexpr int Wakes = 20000;
+    Queue queue;
+    std::array<TIMEVAL, Timers> periods;
+    std::mt19937 rng(420);
+    std::uniform_int_distribution<TIMEVAL> periodDist(10, 1000);
+    for (auto &p : periods)
+    {
+        p = periodDist(rng);
+        queue.allocate(p);
+    }
+
+    volatile TIMEVAL sink = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (TIMEVAL now = 1; now <= Wakes; ++now)
+    {
+        for (auto h = queue.popExpired(now); h != Queue::None; h = queue.popExpired(now))
+        {
+            queue.schedule(h, now + periods[h]);
+        }
+        sink = sink + queue.nextDeadline();
+    }
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / Wakes;
+}
+
+template <size_t Timers>
+void benchmark()
+{
+    const double linear = measureDispatch<LinearTimerQueue<Timers>, Timers>();
+    const double heap = measureDispatch<HeapTimerQueue<Timers>, Timers>();
+    std::cout << "[ BENCHMARK] TimerQueue " << Timers << " timers: linear " << linear
+              << " ns/wake, heap " << heap << " ns/wake\n";
+}
+} // namespace
+
+TEST(HeapTimerQueueTest, benchmark_Dispatch)
+{
+    benchmark<16>();
+    benchmark<64>();
+    benchmark<256>();
+}
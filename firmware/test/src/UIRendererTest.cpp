@@ -0,0 +1,275 @@
+#include "mock/CanFestivalTimersMock.hpp"
+#include "mock/CanIOMock.hpp"
+#include "mock/CanopenMock.hpp"
+#include "mock/HALMock.hpp"
+#include "mock/HardwareSwitchesMock.hpp"
+#include "mock/LEDUpdaterMock.hpp"
+#include "mock/RemoteControlMock.hpp"
+#include "mock/TerminalIOMock.hpp"
+#include "gtest/gtest.h"
+#include <ANSIEscapeCodes.hpp>
+#include <FreeRTOS.h>
+#include <Statemachine/Statemachine.hpp>
+#include <Statemachine/UIRenderer.hpp>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <task.h>
+#include <vector>
+
+using namespace remote_control_device;
+using ::testing::_;
+using ::testing::Return;
+
+class UIRendererTest : public ::testing::Test
+{
+protected:
+    UIRendererTest()
+        : term(hal), log(term, hal), canIO(hal, log), ledU(canIO), cft(hal, log), co(canIO, log),
+          recv(hal, log), rc(hal, log, recv), sm(co, rc, hws, ledU, term, iwdg),
+          ui(sm, rc, co, canIO, cft, term, hal)
+    {
+        term.getLogging().disableLogging();
+
+        EXPECT_CALL(hal, GetTick).WillRepeatedly(Return(0));
+        EXPECT_CALL(cft, getTimersRemaining).WillRepeatedly(Return(3));
+        EXPECT_CALL(cft, getLatenessStatistics)
+            .WillRepeatedly(Return(CanFestivalTimers::LatenessStatistics()));
+        EXPECT_CALL(canIO, drawUITrafficPart).WillRepeatedly(Return());
+
+        // started up and idle
+        EXPECT_CALL(ledU, update).WillRepeatedly(Return());
+        EXPECT_CALL(co, update).WillRepeatedly([](BusDevicesState &state) -> void {
+            state.timeout = false;
+            state.rtdEmergency = false;
+            state.rtdBootedUp = true;
+        });
+        EXPECT_CALL(rc, update).WillRepeatedly([](RemoteControlState &state) -> void {
+            state = RemoteControlState();
+            state.timeout = false;
+        });
+        EXPECT_CALL(hws, update).WillRepeatedly(Return());
+        EXPECT_CALL(co, setSelfState).WillRepeatedly(Return());
+        EXPECT_CALL(co, setActuatorPDOs).WillRepeatedly(Return());
+        EXPECT_CALL(co, setDeviceState).WillRepeatedly(Return());
+        EXPECT_CALL(co, setCouplingStates).WillRepeatedly(Return());
+        EXPECT_CALL(co, setBrakeForce).WillRepeatedly(Return());
+        EXPECT_CALL(co, setWheelDriveTorque).WillRepeatedly(Return());
+    }
+
+    HALMock hal;
+    TerminalIOMock term;
+    LoggingMock log;
+    CanIOMock canIO;
+    LEDUpdaterMock ledU;
+    CanFestivalTimersMock cft;
+    CanopenMock co;
+    HardwareSwitchesMock hws;
+    ReceiverModuleMock recv;
+    RemoteControlMock rc;
+    IWDG_HandleTypeDef iwdg;
+    Statemachine sm;
+    UIRenderer ui;
+};
+
+TEST_F(UIRendererTest, drawsStatusPublishedByStatemachine)
+{
+    std::string output;
+    EXPECT_CALL(term, write(_)).WillRepeatedly([&output](const char *str) -> void {
+        output += str;
+    });
+
+    ui.render();
+    EXPECT_EQ(output.rfind(ANSIEscapeCodes::ClearTerminal, 0), 0);
+    EXPECT_NE(output.find("Git Hash: "), std::string::npos);
+    EXPECT_NE(output.find("Current State:NO_STATE"), std::string::npos);
+
+    // only the new state and the UI's own counters change
+    TickType_t nextCycle = xTaskGetTickCount();
+    sm.runCycle(nextCycle);
+    output.clear();
+    ui.render();
+    EXPECT_EQ(output.find(ANSIEscapeCodes::ClearTerminal), std::string::npos);
+    EXPECT_EQ(output.find("Git Hash: "), std::string::npos);
+    EXPECT_NE(output.find(std::string("Current State:") + getStateIdName(sm.getCurrentState())),
+              std::string::npos);
+    EXPECT_LT(ui.getFrame().getStatistics().linesWritten * 2,
+              ui.getFrame().getStatistics().linesSkipped * 3);
+}
+
+namespace
+{
+/**
+ * @brief TerminalIO's write at 115200 baud: blocks the writing task as soon as more than the TX
+ * buffer waits for transmission
+ *
+ */
+class SimulatedUART
+{
+public:
+    static constexpr double Bytes_per_ms = 115200.0 / 10 / 1000;
+    static constexpr double Buffered_ms = TerminalIO::TX_BUFFER_SIZE / Bytes_per_ms;
+
+    void write(size_t bytes)
+    {
+        const auto now = static_cast<double>(xTaskGetTickCount());
+        _transmittedAt = std::max(_transmittedAt, now) + static_cast<double>(bytes) / Bytes_per_ms;
+        const double wait = _transmittedAt - now - Buffered_ms;
+        if (wait > 0)
+        {
+            vTaskDelay(static_cast<TickType_t>(std::ceil(wait)));
+        }
+    }
+
+private:
+    // everything written so far is out at this tick
+    double _transmittedAt{0};
+};
+
+enum class UIMode
+{
+    InlineFullRedraw,
+    InlineIncremental,
+    Task
+};
+
+struct JitterBench
+{
+    static constexpr uint32_t Cycles = 60;
+    static constexpr uint32_t FrameEveryCycles = 10;
+    static constexpr UBaseType_t LoopPriority = tskIDLE_PRIORITY + 3;
+    static constexpr UBaseType_t UIPriority = tskIDLE_PRIORITY + 2;
+
+    const char *name;
+    UIMode mode;
+    Statemachine *sm{nullptr};
+    UIRenderer *ui{nullptr};
+    std::vector<std::chrono::steady_clock::time_point> starts;
+    std::atomic<bool> done{false};
+    std::atomic<bool> uiStopped{false};
+};
+
+void controlLoop(void *param)
+{
+    auto &bench = *static_cast<JitterBench *>(param);
+    TickType_t nextCycle = xTaskGetTickCount();
+    for (uint32_t i = 0; i < JitterBench::Cycles; ++i)
+    {
+        bench.starts.push_back(std::chrono::steady_clock::now());
+        bench.sm->runCycle(nextCycle);
+        // where the Statemachine's task used to draw
+        if (bench.mode != UIMode::Task && i % JitterBench::FrameEveryCycles == 0)
+        {
+            if (bench.mode == UIMode::InlineFullRedraw)
+            {
+                bench.ui->invalidate();
+            }
+            bench.ui->render();
+        }
+    }
+    bench.done = true;
+    vTaskDelete(nullptr);
+}
+
+void uiLoop(void *param)
+{
+    auto &bench = *static_cast<JitterBench *>(param);
+    TickType_t lastFrame = xTaskGetTickCount();
+    while (!bench.done)
+    {
+        bench.ui->render();
+        vTaskDelayUntil(&lastFrame,
+                        pdMS_TO_TICKS(JitterBench::FrameEveryCycles * Statemachine::CyclePeriod_ms));
+    }
+    bench.uiStopped = true;
+    vTaskDelete(nullptr);
+}
+} // namespace
+
+TEST_F(UIRendererTest, benchmark_ControlLoopJitter)
+{
+    SimulatedUART uart;
+    EXPECT_CALL(term, write(_)).WillRepeatedly([&uart](const char *str) -> void {
+        uart.write(strlen(str));
+    });
+
+    std::array<JitterBench, 3> benches = {{
+        {"UI drawn in the loop, full redraw", UIMode::InlineFullRedraw},
+        {"UI drawn in the loop, incremental", UIMode::InlineIncremental},
+        {"UI task, incremental", UIMode::Task},
+    }};
+
+    struct Result
+    {
+        double maxJitter_us{0};
+        double avgJitter_us{0};
+        uint32_t missedDeadlines{0};
+        uint32_t bytesPerFrame{0};
+    };
+    std::array<Result, benches.size()> results;
+
+    for (size_t b = 0; b < benches.size(); ++b)
+    {
+        JitterBench &bench = benches[b];
+        bench.sm = &sm;
+        bench.ui = &ui;
+        ui.invalidate();
+        Statemachine::Status before;
+        ASSERT_TRUE(sm.readStatus(before));
+        const TerminalFrame::Statistics frameBefore = ui.getFrame().getStatistics();
+
+        xTaskCreate(&controlLoop, "control", configMINIMAL_STACK_SIZE * 4, &bench,
+                    JitterBench::LoopPriority, nullptr);
+        if (bench.mode == UIMode::Task)
+        {
+            xTaskCreate(&uiLoop, "ui", configMINIMAL_STACK_SIZE * 4, &bench,
+                        JitterBench::UIPriority, nullptr);
+        }
+        while (!bench.done || (bench.mode == UIMode::Task && !bench.uiStopped))
+        {
+            vTaskDelay(pdMS_TO_TICKS(Statemachine::CyclePeriod_ms));
+        }
+
+        Result &result = results[b];
+        constexpr double Period_us = Statemachine::CyclePeriod_ms * 1000.0;
+        for (size_t i = 1; i < bench.starts.size(); ++i)
+        {
+            const double interval =
+                std::chrono::duration<double, std::micro>(bench.starts[i] - bench.starts[i - 1])
+                    .count();
+            const double jitter = std::abs(interval - Period_us);
+            result.maxJitter_us = std::max(result.maxJitter_us, jitter);
+            result.avgJitter_us += jitter / static_cast<double>(bench.starts.size() - 1);
+        }
+        Statemachine::Status after;
+        ASSERT_TRUE(sm.readStatus(after));
+        result.missedDeadlines = after.missedDeadlines - before.missedDeadlines;
+        const TerminalFrame::Statistics &frameAfter = ui.getFrame().getStatistics();
+        // the first frame is a full redraw in every mode
+        result.bytesPerFrame = (frameAfter.bytesWritten - frameBefore.bytesWritten) /
+                               std::max<uint32_t>(frameAfter.frames - frameBefore.frames, 1);
+    }
+
+    for (size_t b = 0; b < benches.size(); ++b)
+    {
+        std::cout << "[ BENCHMARK] " << std::left << std::setw(36) << benches[b].name
+                  << std::right << " cycle jitter avg " << std::setw(7) << std::fixed
+                  << std::setprecision(0) << results[b].avgJitter_us << " us max " << std::setw(7)
+                  << results[b].maxJitter_us << " us, missed deadlines " << std::setw(2)
+                  << results[b].missedDeadlines << " of " << JitterBench::Cycles << ", "
+                  << results[b].bytesPerFrame << " bytes per frame\n";
+    }
+
+    // drawing in the loop delays the cycles by the transmission, the UI task doesn't
+    EXPECT_GT(results[0].missedDeadlines, 0);
+    EXPECT_LT(results[1].bytesPerFrame, results[0].bytesPerFrame);
+    EXPECT_LT(results[2].maxJitter_us, results[0].maxJitter_us);
+    EXPECT_LT(results[2].maxJitter_us, 1000.0 * Statemachine::CyclePeriod_ms / 2);
+    EXPECT_EQ(results[2].missedDeadlines, 0);
+}
@@ -1,24 +1,280 @@
+#include "fake/CanHardware.hpp"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <deque>
 #include <canfestival/can.h>
 #include <stm32f3xx_hal.h>
 #include <stm32f3xx_hal_can.h>
 #include <cmsis_os.h>
 
+namespace
+{
+// emulated filter registers of the single bxCAN, handles in tests aren't initialized
+constexpr uint8_t FilterBankCount = 14;
+std::array<CAN_FilterTypeDef, FilterBankCount> filterBanks{};
+std::array<bool, FilterBankCount> filterBankActive{};
+
+struct RxFrame
+{
+    CAN_RxHeaderTypeDef header;
+    std::array<uint8_t, 8> data;
+};
+constexpr size_t RxFifoDepth = 3;
+std::array<std::deque<RxFrame>, 2> rxFifos;
+std::array<void (*)(CAN_HandleTypeDef *), 2> rxPendingCallbacks{};
+CAN_HandleTypeDef *registeredHandle = nullptr;
+
+struct TxMailbox
+{
+    CAN_TxHeaderTypeDef header;
+    std::array<uint8_t, 8> data;
+    uint32_t requestOrder;
+    bool pending;
+};
+constexpr uint8_t TxMailboxCount = 3;
+std::array<TxMailbox, TxMailboxCount> txMailboxes{};
+uint32_t txRequestCount = 0;
+// index of the mailbox on the bus, -1 for none
+int8_t txOnBus = -1;
+std::array<void (*)(CAN_HandleTypeDef *), TxMailboxCount> txCompleteCallbacks{};
+std::array<void (*)(CAN_HandleTypeDef *), TxMailboxCount> txAbortCallbacks{};
+
+int8_t oldestPendingMailbox()
+{
+    int8_t oldest = -1;
+    for (int8_t i = 0; i < TxMailboxCount; ++i)
+    {
+        if (txMailboxes[i].pending &&
+            (oldest < 0 || txMailboxes[i].requestOrder < txMailboxes[oldest].requestOrder))
+        {
+            oldest = i;
+        }
+    }
+    return oldest;
+}
+
+bool bankAccepts(const CAN_FilterTypeDef &bank, uint16_t stdId, bool rtr)
+{
+    const uint32_t rtrBit = rtr ? 1 : 0;
+    if (bank.FilterScale == CAN_FILTERSCALE_16BIT)
+    {
+        // STID[10:0] RTR IDE EXID[17:15], two id / mask pairs or four ids
+        const uint32_t frame = (uint32_t{stdId} << 5) | (rtrBit << 4);
+        const std::array<uint32_t, 4> regs = {bank.FilterIdLow, bank.FilterMaskIdLow,
+                                              bank.FilterIdHigh, bank.FilterMaskIdHigh};
+        if (bank.FilterMode == CAN_FILTERMODE_IDMASK)
+        {
+            return ((frame ^ regs[0]) & regs[1] & 0xFFFF) == 0 ||
+                   ((frame ^ regs[2]) & regs[3] & 0xFFFF) == 0;
+        }
+        for (uint32_t reg : regs)
+        {
+            if ((reg & 0xFFFF) == frame)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // STID[10:0] EXID[17:0] IDE RTR 0
+    const uint32_t frame = (uint32_t{stdId} << 21) | (rtrBit << 1);
+    const uint32_t fr1 = ((bank.FilterIdHigh & 0xFFFF) << 16) | (bank.FilterIdLow & 0xFFFF);
+    const uint32_t fr2 = ((bank.FilterMaskIdHigh & 0xFFFF) << 16) | (bank.FilterMaskIdLow & 0xFFFF);
+    if (bank.FilterMode == CAN_FILTERMODE_IDMASK)
+    {
+        return ((frame ^ fr1) & fr2) == 0;
+    }
+    return frame == fr1 || frame == fr2;
+}
+} // namespace
+
+namespace fake::can
+{
+void resetFilters()
+{
+    filterBankActive.fill(false);
+}
+
+uint8_t getActiveBanks()
+{
+    uint8_t count = 0;
+    for (bool active : filterBankActive)
+    {
+        count += active ? 1 : 0;
+    }
+    return count;
+}
+
+bool acceptsFrame(uint16_t stdId, bool rtr)
+{
+    for (uint8_t i = 0; i < FilterBankCount; ++i)
+    {
+        if (filterBankActive[i] && bankAccepts(filterBanks[i], stdId, rtr))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void resetRx()
+{
+    for (auto &fifo : rxFifos)
+    {
+        fifo.clear();
+    }
+}
+
+bool receiveFrame(uint32_t fifo, const CAN_RxHeaderTypeDef &header, const uint8_t *data)
+{
+    if (rxFifos.at(fifo).size() >= RxFifoDepth)
+    {
+        return false;
+    }
+    RxFrame frame{header, {}};
+    std::memcpy(frame.data.data(), data, frame.data.size());
+    rxFifos.at(fifo).push_back(frame);
+    return true;
+}
+
+void raiseRxInterrupt(uint32_t fifo)
+{
+    if (!rxFifos.at(fifo).empty() && rxPendingCallbacks.at(fifo) != nullptr)
+    {
+        rxPendingCallbacks.at(fifo)(registeredHandle);
+    }
+}
+
+void resetTx()
+{
+    for (auto &mailbox : txMailboxes)
+    {
+        mailbox.pending = false;
+    }
+    txOnBus = -1;
+}
+
+bool startTransmission()
+{
+    txOnBus = oldestPendingMailbox();
+    return txOnBus >= 0;
+}
+
+bool transmitNext(CAN_TxHeaderTypeDef &header, uint8_t *data)
+{
+    const int8_t mailbox = txOnBus >= 0 ? txOnBus : oldestPendingMailbox();
+    txOnBus = -1;
+    if (mailbox < 0)
+    {
+        return false;
+    }
+    header = txMailboxes[mailbox].header;
+    if (data != nullptr)
+    {
+        std::copy(txMailboxes[mailbox].data.begin(), txMailboxes[mailbox].data.end(), data);
+    }
+    txMailboxes[mailbox].pending = false;
+    if (txCompleteCallbacks[mailbox] != nullptr)
+    {
+        txCompleteCallbacks[mailbox](registeredHandle);
+    }
+    return true;
+}
+} // namespace fake::can
+
 
 extern "C" HAL_StatusTypeDef HAL_CAN_RegisterCallback(CAN_HandleTypeDef *hcan,
                                                       HAL_CAN_CallbackIDTypeDef CallbackID,
                                                       void (*pCallback)(CAN_HandleTypeDef *_hcan))
 {
+    registeredHandle = hcan;
+    if (CallbackID == HAL_CAN_RX_FIFO0_MSG_PENDING_CB_ID)
+    {
+        rxPendingCallbacks[CAN_RX_FIFO0] = pCallback;
+    }
+    else if (CallbackID == HAL_CAN_RX_FIFO1_MSG_PENDING_CB_ID)
+    {
+        rxPendingCallbacks[CAN_RX_FIFO1] = pCallback;
+    }
+    else if (CallbackID >= HAL_CAN_TX_MAILBOX0_COMPLETE_CB_ID &&
+             CallbackID <= HAL_CAN_TX_MAILBOX2_COMPLETE_CB_ID)
+    {
+        txCompleteCallbacks[CallbackID - HAL_CAN_TX_MAILBOX0_COMPLETE_CB_ID] = pCallback;
+    }
+    else if (CallbackID >= HAL_CAN_TX_MAILBOX0_ABORT_CB_ID &&
+             CallbackID <= HAL_CAN_TX_MAILBOX2_ABORT_CB_ID)
+    {
+        txAbortCallbacks[CallbackID - HAL_CAN_TX_MAILBOX0_ABORT_CB_ID] = pCallback;
+    }
     return HAL_OK;
 }
 
 extern "C" uint32_t HAL_CAN_GetTxMailboxesFreeLevel(CAN_HandleTypeDef *hcan)
 {
-    return 0;
+    uint32_t free = 0;
+    for (const auto &mailbox : txMailboxes)
+    {
+        free += mailbox.pending ? 0 : 1;
+    }
+    return free;
 }
 
 extern "C" HAL_StatusTypeDef HAL_CAN_AddTxMessage(CAN_HandleTypeDef *hcan,
                                                   CAN_TxHeaderTypeDef *pHeader, uint8_t aData[],
                                                   uint32_t *pTxMailbox)
+{
+    for (uint8_t i = 0; i < TxMailboxCount; ++i)
+    {
+        if (!txMailboxes[i].pending)
+        {
+            txMailboxes[i].header = *pHeader;
+            std::copy(aData, aData + txMailboxes[i].data.size(), txMailboxes[i].data.begin());
+            txMailboxes[i].requestOrder = txRequestCount++;
+            txMailboxes[i].pending = true;
+            *pTxMailbox = CAN_TX_MAILBOX0 << i;
+            return HAL_OK;
+        }
+    }
+    return HAL_ERROR;
+}
+
+HAL_StatusTypeDef HAL_CAN_AbortTxRequest(CAN_HandleTypeDef *hcan, uint32_t TxMailboxes)
+{
+    for (int8_t i = 0; i < TxMailboxCount; ++i)
+    {
+        // a frame on the bus finishes normally
+        if ((TxMailboxes & (CAN_TX_MAILBOX0 << i)) > 0 && txMailboxes[i].pending && i != txOnBus)
+        {
+            txMailboxes[i].pending = false;
+            if (txAbortCallbacks[i] != nullptr)
+            {
+                txAbortCallbacks[i](registeredHandle);
+            }
+        }
+    }
+    return HAL_OK;
+}
+
+uint32_t HAL_CAN_IsTxMessagePending(CAN_HandleTypeDef *hcan, uint32_t TxMailboxes)
+{
+    for (uint8_t i = 0; i < TxMailboxCount; ++i)
+    {
+        if ((TxMailboxes & (CAN_TX_MAILBOX0 << i)) > 0 && txMailboxes[i].pending)
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+uint32_t HAL_CAN_GetError(CAN_HandleTypeDef *hcan)
+{
+    return HAL_CAN_ERROR_NONE;
+}
+
+HAL_StatusTypeDef HAL_CAN_ResetError(CAN_HandleTypeDef *hcan)
 {
     return HAL_OK;
 }
@@ -26,14 +282,34 @@ extern "C" HAL_StatusTypeDef HAL_CAN_AddTxMessage(CAN_HandleTypeDef *hcan,
 HAL_StatusTypeDef HAL_CAN_GetRxMessage(CAN_HandleTypeDef *hcan, uint32_t RxFifo,
                                        CAN_RxHeaderTypeDef *pHeader, uint8_t aData[])
 {
+    auto &fifo = rxFifos.at(RxFifo);
+    if (fifo.empty())
+    {
+        return HAL_ERROR;
+    }
+    *pHeader = fifo.front().header;
+    std::memcpy(aData, fifo.front().data.data(), fifo.front().data.size());
+    fifo.pop_front();
     return HAL_OK;
 }
 
+uint32_t HAL_CAN_GetRxFifoFillLevel(CAN_HandleTypeDef *hcan, uint32_t RxFifo)
+{
+    return rxFifos.at(RxFifo).size();
+}
+
 HAL_StatusTypeDef HAL_CAN_Start(CAN_HandleTypeDef *hcan) {
     return HAL_OK;
 }
 
 HAL_StatusTypeDef HAL_CAN_ConfigFilter(CAN_HandleTypeDef *hcan, CAN_FilterTypeDef *sFilterConfig) {
+    if (sFilterConfig->FilterBank >= FilterBankCount)
+    {
+        return HAL_ERROR;
+    }
+    filterBanks[sFilterConfig->FilterBank] = *sFilterConfig;
+    filterBankActive[sFilterConfig->FilterBank] =
+        sFilterConfig->FilterActivation == CAN_FILTER_ENABLE;
     return HAL_OK;
 }
 
@@ -42,4 +42,20 @@ HAL_StatusTypeDef HAL_UART_Receive(UART_HandleTypeDef *huart, uint8_t *pData, ui
                                    uint32_t Timeout)
 {
     return HAL_OK;
-}
\ No newline at end of file
+}
+HAL_StatusTypeDef HAL_UART_RegisterRxEventCallback(UART_HandleTypeDef *huart,
+                                                   pUART_RxEventCallbackTypeDef pCallback)
+{
+    // kept so tests can emulate dma events
+    huart->RxEventCallback = pCallback;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_DMA(UART_HandleTypeDef *huart, uint8_t *pData,
+                                               uint16_t Size)
+{
+    // kept so tests can emulate dma transfers
+    huart->pRxBuffPtr = pData;
+    huart->RxXferSize = Size;
+    return HAL_OK;
+}